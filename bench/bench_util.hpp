@@ -0,0 +1,117 @@
+#pragma once
+
+#include <bcod/belief_rasteriser.hpp>
+#include <bcod/sac_scheduler.hpp>
+#include <bcod/sensor_defs.hpp>
+#include <bcod/student_planner.hpp>
+#include <opencv2/core.hpp>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace bcod::bench {
+
+// Fixed-seed inputs so every run of a benchmark measures the same work.
+constexpr uint32_t kSeed = 42;
+
+inline BeliefRasteriser::Params rasteriser_params(int size) {
+    BeliefRasteriser::Params p{};
+    p.raster_H = size;
+    p.raster_W = size;
+    p.raster_C = 5;
+    p.min_window = 2.0;
+    p.max_window = 50.0;
+    p.sigma_scale = 6.0;
+    p.normalize = false;
+    return p;
+}
+
+// Gaussian particle cloud around (50, 50) with uniform weights.
+inline std::vector<Particle> make_particles(int n, uint32_t seed = kSeed) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> offset(0.0, 2.0);
+    std::uniform_real_distribution<double> yaw(-M_PI, M_PI);
+
+    std::vector<Particle> particles(n);
+    for (auto& p : particles) {
+        p.position = Eigen::Vector2d(50.0 + offset(rng), 50.0 + offset(rng));
+        p.yaw = yaw(rng);
+        p.weight = 1.0 / n;
+        p.covariance = {0.1, 0.0, 0.0, 0.1};
+        p.confidence = 1.0;
+        p.timestamp = 0;
+    }
+    return particles;
+}
+
+inline cv::Mat random_image(int channels, uint32_t seed = kSeed) {
+    cv::Mat image(64, 64, CV_32FC(channels));
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> value(0.0f, 1.0f);
+    float* data = reinterpret_cast<float*>(image.data);
+    for (size_t i = 0; i < image.total() * channels; ++i) data[i] = value(rng);
+    return image;
+}
+
+inline StudentParams student_params(int horizon = 20) {
+    StudentParams p{};
+    p.input_channels = 9;   // belief, semantic map and goal mask
+    p.hidden_dim = 64;
+    p.num_layers = 3;
+    p.num_heads = 4;
+    p.trajectory_horizon = horizon;
+    p.cvar_percentile = 0.95;
+    p.risk_threshold = 0.2;
+    return p;
+}
+
+inline PlanningContext planning_context() {
+    PlanningContext c{};
+    c.belief_image = random_image(5);
+    c.semantic_map = random_image(3, kSeed + 1);
+    c.goal_mask = random_image(1, kSeed + 2);
+    c.active_sensors.assign(kNumSensors, true);
+    c.current_pose = Eigen::Vector3d::Zero();
+    c.max_velocity = 2.0;
+    c.max_angular_velocity = 1.0;
+    c.risk_threshold = 0.2;
+    return c;
+}
+
+inline SchedulerParams scheduler_params(int threads, bool mask_search) {
+    SchedulerParams p{};
+    p.belief_dim = 64;
+    p.hidden_dim = 64;
+    p.num_layers = 3;
+    p.learning_rate = 3e-4;
+    p.temperature = 0.2;
+    p.tau = 0.005;
+    p.discount_factor = 0.99;
+    p.batch_size = 32;
+    p.buffer_size = 10000;
+    p.target_update_interval = 1;
+    p.risk_threshold = 0.2;
+    p.violation_rate = 0.05;
+    p.lambda_init = 0.5;
+    p.lambda_lr = 1e-3;
+    p.lambda_max = 10.0;
+    p.energy_weight = 0.3;
+    p.safety_weight = 0.7;
+    p.use_mask_search = mask_search;
+    p.power_budget = 1e9;
+    p.power_coefficients.assign(SensorConfig::POWER_CONSUMPTION.begin(), SensorConfig::POWER_CONSUMPTION.end());
+    p.device = "cpu";
+    p.num_threads = threads;
+    return p;
+}
+
+inline SchedulerState scheduler_state(uint32_t seed = kSeed) {
+    SchedulerState s{};
+    s.belief_raster = random_image(5, seed);
+    s.cvar_risk = 0.1;
+    s.goal_distance = 10.0;
+    s.prev_actions.assign(kNumSensors, true);
+    return s;
+}
+
+} // namespace bcod::bench
@@ -0,0 +1,55 @@
+#include "bench_util.hpp"
+#include <bcod/vector_env.hpp>
+#include <benchmark/benchmark.h>
+#include <nlohmann/json.hpp>
+
+using namespace bcod;
+
+// Args: {environments, worker threads}
+static void BM_VectorEnvStep(benchmark::State& state) {
+    auto world = nlohmann::json::parse(R"({
+        "world": {
+            "size": [100.0, 100.0],
+            "resolution": 0.1,
+            "origin": [0.0, 0.0],
+            "obstacles": [
+                {"type": "static", "shape": "circle", "center": [50.0, 50.0], "radius": 5.0}
+            ],
+            "features": [
+                {"type": "landmark", "position": [25.0, 25.0], "uncertainty": 0.1}
+            ]
+        },
+        "simulation": {"time_step": 0.1, "max_steps": 1000}
+    })");
+
+    VectorEnv::Params p{};
+    p.num_envs = static_cast<int>(state.range(0));
+    p.num_threads = static_cast<int>(state.range(1));
+    p.num_particles = 500;
+    p.seed = bench::kSeed;
+    p.initial_spread = 1.0;
+    p.min_goal_distance = 20.0;
+    p.goal_tolerance = 1.0;
+    p.goal_reward = 10.0;
+    p.collision_penalty = 10.0;
+    p.progress_weight = 1.0;
+    p.energy_weight = 0.01;
+    p.error_weight = 0.1;
+    p.lost_threshold = 50.0;
+    p.rasteriser = bench::rasteriser_params(64);
+    p.world = parse_world(world);
+
+    VectorEnv env(p);
+    env.reset();
+    const std::vector<uint32_t> masks(p.num_envs, (1u << kNumSensors) - 1);
+
+    for (auto _ : state) {
+        const auto& result = env.step(masks);
+        benchmark::DoNotOptimize(result.belief.data());
+    }
+    state.SetItemsProcessed(state.iterations() * p.num_envs);
+}
+BENCHMARK(BM_VectorEnvStep)
+    ->ArgNames({"envs", "threads"})
+    ->ArgsProduct({{4, 16, 64}, {1, 2, 4, 8}})
+    ->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -0,0 +1,78 @@
+#include "bench_util.hpp"
+#include <bcod/particle_filter.hpp>
+#include <benchmark/benchmark.h>
+
+using namespace bcod;
+
+// One filter tick: predict, GNSS + IMU update, resample when degenerate.
+static void BM_FilterStep(benchmark::State& state) {
+    ParticleFilter::Params p{};
+    p.num_particles = static_cast<int>(state.range(0));
+    p.seed = bench::kSeed;
+    p.position_noise = 0.1;
+    p.orientation_noise = 0.01;
+    ParticleFilter filter(p);
+    filter.reset(Eigen::Vector3d(50.0, 50.0, 0.0), 2.0, 0.3);
+
+    Measurement gnss{};
+    gnss.sensor = SensorType::GNSS;
+    gnss.position = Eigen::Vector2d(50.0, 50.0);
+    gnss.inflation = 20.0;
+    Measurement imu{};
+    imu.sensor = SensorType::IMU;
+    imu.inflation = 20.0;
+
+    for (auto _ : state) {
+        filter.predict(1.0, 0.1, 0.1);
+        filter.update(gnss);
+        filter.update(imu);
+        filter.resample();
+        benchmark::DoNotOptimize(filter.particles().x);
+    }
+    state.SetItemsProcessed(state.iterations() * p.num_particles);
+}
+BENCHMARK(BM_FilterStep)->ArgName("particles")->RangeMultiplier(10)->Range(1000, 100000)
+    ->Unit(benchmark::kMicrosecond);
+
+// Rasterising the filter's columns directly, no AoS conversion.
+static void BM_RasteriseFilter(benchmark::State& state) {
+    ParticleFilter::Params p{};
+    p.num_particles = static_cast<int>(state.range(0));
+    p.seed = bench::kSeed;
+    ParticleFilter filter(p);
+    filter.reset(Eigen::Vector3d(50.0, 50.0, 0.0), 2.0, 0.3);
+    BeliefRasteriser rasteriser(bench::rasteriser_params(64));
+
+    for (auto _ : state) {
+        BeliefRaster raster = rasteriser.rasterise(filter.particles());
+        benchmark::DoNotOptimize(raster.data.data);
+    }
+    state.SetItemsProcessed(state.iterations() * p.num_particles);
+}
+BENCHMARK(BM_RasteriseFilter)->ArgName("particles")->RangeMultiplier(10)->Range(1000, 100000)
+    ->Unit(benchmark::kMicrosecond);
+
+// Fused measurement update of 100k particles for typical sensor masks: GNSS
+// + IMU, plus RGB, and everything on.
+static void BM_FilterUpdateMask(benchmark::State& state) {
+    ParticleFilter::Params p{};
+    p.num_particles = 100000;
+    p.seed = bench::kSeed;
+    ParticleFilter filter(p);
+    filter.reset(Eigen::Vector3d(50.0, 50.0, 0.0), 2.0, 0.3);
+
+    std::array<Measurement, kNumSensors> readings{};
+    for (auto& z : readings) {
+        z.position = Eigen::Vector2d(50.0, 50.0);
+        z.inflation = 50.0;
+    }
+    const uint32_t mask = static_cast<uint32_t>(state.range(0));
+
+    for (auto _ : state) {
+        filter.update(mask, readings);
+        benchmark::DoNotOptimize(filter.particles().weight);
+    }
+    state.SetItemsProcessed(state.iterations() * p.num_particles);
+}
+BENCHMARK(BM_FilterUpdateMask)->ArgName("mask")->Arg(0b011000)->Arg(0b011010)->Arg(0b111111)
+    ->Unit(benchmark::kMicrosecond);
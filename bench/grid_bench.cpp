@@ -0,0 +1,67 @@
+#include "bcod/context_encoder.hpp"
+#include "bcod/rasteriser.hpp"
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace bcod;
+
+// ContextEncoder only loads weights from disk, so the fixture writes a random
+// set to the temp directory.
+namespace {
+    // Three FiLM layers: the raster plus goal into 128, then 128 into 128.
+    std::string write_weights() {
+        const std::string path = "/tmp/bcod_bench_grid_weights.bin";
+        const size_t input = BeliefRaster::WIDTH * BeliefRaster::HEIGHT * BeliefRaster::CHANNELS + 2;
+        const size_t hidden = 128;
+        std::vector<float> weights((input * hidden + 2 * hidden) + 2 * (hidden * hidden + 2 * hidden));
+        std::mt19937 rng(42);
+        std::normal_distribution<float> value(0.0f, 0.01f);
+        for (auto& w : weights) w = value(rng);
+        std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(weights.data()),
+                                                    weights.size() * sizeof(float));
+        return path;
+    }
+
+    ParticleSet make_particles(int n) {
+        std::mt19937 rng(42);
+        std::normal_distribution<double> offset(0.0, 1.0);
+        ParticleSet particles(n);
+        for (auto& p : particles) {
+            p.pose = Eigen::Vector3d(offset(rng), offset(rng), offset(rng));
+            p.cov = Eigen::Matrix3d::Identity() * 0.1;
+            p.weight = 1.0 / n;
+        }
+        return particles;
+    }
+}
+
+static void BM_GridGenerate(benchmark::State& state) {
+    BeliefRasteriser rasteriser(RasteriserParams{0.1, 10.0, 0.01, 0.0, 0.0});
+    const ParticleSet particles = make_particles(static_cast<int>(state.range(0)));
+    BeliefRaster raster;
+
+    for (auto _ : state) {
+        rasteriser.generate(particles, raster);
+        benchmark::DoNotOptimize(raster.data.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_GridGenerate)->ArgName("particles")->RangeMultiplier(4)->Range(256, 16384)
+    ->Unit(benchmark::kMicrosecond);
+
+static void BM_ContextEncode(benchmark::State& state) {
+    ContextEncoder encoder(write_weights());
+    BeliefRaster raster;
+    raster.data.fill(0.5f);
+    std::vector<float> context;
+
+    for (auto _ : state) {
+        encoder.encode(raster, Eigen::Vector2d(1.0, 2.0), context);
+        benchmark::DoNotOptimize(context.data());
+    }
+}
+BENCHMARK(BM_ContextEncode)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,58 @@
+#include "bench_util.hpp"
+#include <benchmark/benchmark.h>
+#include <torch/torch.h>
+
+using namespace bcod;
+
+// Arg: torch intra-op threads
+static void BM_Plan(benchmark::State& state) {
+    torch::set_num_threads(static_cast<int>(state.range(0)));
+    torch::manual_seed(bench::kSeed);
+    StudentPlanner planner(bench::student_params());
+    const PlanningContext context = bench::planning_context();
+
+    for (auto _ : state) {
+        Trajectory traj = planner.plan(context);
+        benchmark::DoNotOptimize(traj.cvar_95);
+    }
+}
+BENCHMARK(BM_Plan)->ArgName("threads")->RangeMultiplier(2)->Range(1, 8)
+    ->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Repeated identical inputs with the plan cache on: fingerprint plus lookup
+static void BM_PlanCacheHit(benchmark::State& state) {
+    torch::set_num_threads(1);
+    torch::manual_seed(bench::kSeed);
+    StudentParams params = bench::student_params();
+    params.plan_cache_size = 16;
+    params.plan_cache_tolerance = 0.02;
+    StudentPlanner planner(params);
+    const PlanningContext context = bench::planning_context();
+    planner.plan(context);
+
+    for (auto _ : state) {
+        Trajectory traj = planner.plan(context);
+        benchmark::DoNotOptimize(traj.cvar_95);
+    }
+}
+BENCHMARK(BM_PlanCacheHit)->Unit(benchmark::kMicrosecond);
+
+// Arg: horizon
+static void BM_TrajectoryMetrics(benchmark::State& state) {
+    const int horizon = static_cast<int>(state.range(0));
+    std::mt19937 rng(bench::kSeed);
+    std::normal_distribution<double> step(0.0, 0.5);
+
+    Trajectory traj{};
+    for (int t = 0; t < horizon; ++t) {
+        traj.waypoints.emplace_back(step(rng), step(rng), step(rng));
+        for (int d = 0; d < 3; ++d) traj.log_variances.push_back(step(rng));
+    }
+
+    for (auto _ : state) {
+        compute_trajectory_metrics(traj, 0.95);
+        benchmark::DoNotOptimize(traj.cvar_95);
+    }
+    state.SetItemsProcessed(state.iterations() * horizon);
+}
+BENCHMARK(BM_TrajectoryMetrics)->ArgName("horizon")->RangeMultiplier(2)->Range(8, 256);
@@ -0,0 +1,35 @@
+#include "bench_util.hpp"
+#include <benchmark/benchmark.h>
+
+using namespace bcod;
+
+// Args: {particles, raster size}
+static void BM_Rasterise(benchmark::State& state) {
+    const int n = static_cast<int>(state.range(0));
+    const int size = static_cast<int>(state.range(1));
+    BeliefRasteriser rasteriser(bench::rasteriser_params(size));
+    const auto particles = bench::make_particles(n);
+
+    for (auto _ : state) {
+        BeliefRaster raster = rasteriser.rasterise(particles);
+        benchmark::DoNotOptimize(raster.data.data);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+    state.counters["cells"] = size * size;
+}
+BENCHMARK(BM_Rasterise)
+    ->ArgNames({"particles", "size"})
+    ->ArgsProduct({{256, 1024, 4096, 16384}, {32, 64, 128}})
+    ->Unit(benchmark::kMicrosecond);
+
+static void BM_ComputeWindow(benchmark::State& state) {
+    BeliefRasteriser rasteriser(bench::rasteriser_params(64));
+    const auto particles = bench::make_particles(static_cast<int>(state.range(0)));
+
+    for (auto _ : state) {
+        RasterWindow window = rasteriser.compute_window(particles);
+        benchmark::DoNotOptimize(window);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ComputeWindow)->ArgName("particles")->RangeMultiplier(4)->Range(256, 16384);
@@ -0,0 +1,66 @@
+#include "bench_util.hpp"
+#include <bcod/replay_buffer.hpp>
+#include <benchmark/benchmark.h>
+#include <torch/torch.h>
+
+using namespace bcod;
+
+// Args: {torch threads, mask search, shared trunk}. With the shared trunk the
+// raster repeats every iteration, so this times the heads on cached features.
+static void BM_Schedule(benchmark::State& state) {
+    const int threads = static_cast<int>(state.range(0));
+    torch::set_num_threads(threads);
+    torch::manual_seed(bench::kSeed);
+    SchedulerParams params = bench::scheduler_params(threads, state.range(1) != 0);
+    params.share_encoder = state.range(2) != 0;
+    SACScheduler scheduler(params);
+    const SchedulerState s = bench::scheduler_state();
+
+    for (auto _ : state) {
+        SchedulerAction action = scheduler.schedule(s);
+        benchmark::DoNotOptimize(action.total_cost);
+    }
+}
+BENCHMARK(BM_Schedule)
+    ->ArgNames({"threads", "search", "shared"})
+    ->ArgsProduct({{1, 2, 4, 8}, {0, 1}, {0, 1}})
+    ->Unit(benchmark::kMicrosecond)->UseRealTime();
+
+// One gradient step on a full replay buffer. Arg: batch size
+static void BM_Update(benchmark::State& state) {
+    torch::set_num_threads(1);
+    torch::manual_seed(bench::kSeed);
+    SchedulerParams params = bench::scheduler_params(1, false);
+    params.batch_size = static_cast<int>(state.range(0));
+    SACScheduler scheduler(params);
+
+    const SchedulerState s = bench::scheduler_state(bench::kSeed);
+    const SchedulerState next = bench::scheduler_state(bench::kSeed + 1);
+    const SchedulerAction action = scheduler.schedule(s);
+    for (int i = 0; i < params.batch_size; ++i) scheduler.update(s, action, 0.0, next);
+
+    for (auto _ : state) {
+        scheduler.update(s, action, 0.0, next);
+    }
+}
+BENCHMARK(BM_Update)->ArgName("batch")->RangeMultiplier(2)->Range(16, 256)
+    ->Unit(benchmark::kMillisecond);
+
+// Arg: batch size
+static void BM_ReplaySample(benchmark::State& state) {
+    const int capacity = 10000;
+    ReplayBuffer buffer(capacity, bench::kSeed);
+    const auto zeros = torch::zeros({1, 5, 64, 64});
+    const auto context = torch::zeros({1, 3});
+    const auto action = torch::zeros({1, kNumSensors});
+    for (int i = 0; i < capacity; ++i) {
+        buffer.push({zeros, context, action, 0.0, zeros, context, false});
+    }
+
+    for (auto _ : state) {
+        auto batch = buffer.sample(static_cast<int>(state.range(0)));
+        benchmark::DoNotOptimize(batch.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ReplaySample)->ArgName("batch")->RangeMultiplier(2)->Range(16, 256);
@@ -25,6 +25,16 @@ struct Particle {
     std::vector<double> features;
 };
 
+// Structure-of-arrays view of a particle set, such as ParticleFilter's state.
+// The arrays are borrowed for the duration of the call they are passed to.
+struct ParticleArrays {
+    const float* x;
+    const float* y;
+    const float* yaw;
+    const float* weight;
+    size_t size;
+};
+
 struct RasterWindow {
     Eigen::Vector2d center;
     double size;
@@ -64,6 +74,11 @@ struct BeliefRaster {
     std::vector<double> channel_max;
 };
 
+// Sets `mask` (CV_32FC1, one value per raster cell) to the one-hot cell of
+// `goal` in `window`, clamped to the border when the goal lies outside the
+// window so it still gives the direction.
+void rasterise_goal(const RasterWindow& window, const Eigen::Vector2d& goal, cv::Mat& mask);
+
 class BeliefRasteriser {
 public:
     struct Params {
@@ -103,6 +118,7 @@ public:
     ~BeliefRasteriser();
 
     BeliefRaster rasterise(const std::vector<Particle>& particles);
+    BeliefRaster rasterise(const ParticleArrays& particles);
     RasterWindow compute_window(const std::vector<Particle>& particles) const;
     void fill_cells(const std::vector<Particle>& particles, RasterWindow& window, std::vector<RasterCell>& cells) const;
     void normalize_raster(BeliefRaster& raster) const;
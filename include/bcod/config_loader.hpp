@@ -0,0 +1,38 @@
+#pragma once
+
+#include "json_config.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace bcod {
+
+struct LoadedConfig {
+    JsonConfig config;
+    std::vector<std::string> inputs;  // Every file of the import graph, in merge order
+    uint64_t content_hash;            // Over the paths and contents of `inputs`
+    bool from_cache;
+};
+
+// Loads a YAML (or JSON) config together with everything it pulls in through
+// `imports:`. Imports are resolved relative to the importing file and merged
+// depth-first, so a file overrides whatever it imports and later imports
+// override earlier ones. Nested maps are flattened to the dotted keys
+// JsonConfig expects ("planner.batch_size"), which keeps every lookup a single
+// map access. Missing imports and import cycles are errors.
+//
+// The merged result is cached at `cache_path` (default: `path` + ".cache") as
+// MessagePack, keyed by the content hash of all inputs. When nothing changed
+// the next load only hashes the inputs and decodes the cache, without parsing
+// any YAML. Failing to write the cache is logged and otherwise ignored.
+LoadedConfig load_config(const std::string& path, const std::string& cache_path = "");
+
+// Parses a single YAML (or JSON) file as written: no imports, no flattening
+// and no validation. For documents that are not planner configs, such as the
+// environment description the simulator reads.
+nlohmann::json load_config_document(const std::string& path);
+
+// Hash of the listed files' paths and contents; the cache key of load_config.
+uint64_t hash_config_inputs(const std::vector<std::string>& inputs);
+
+} // namespace bcod
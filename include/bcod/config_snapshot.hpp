@@ -0,0 +1,75 @@
+#pragma once
+
+#include "config_loader.hpp"
+#include "instrumentation.hpp"
+#include "json_config.hpp"
+#include "rasteriser_params.hpp"
+#include "sac_scheduler.hpp"
+#include "student_planner.hpp"
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace bcod {
+
+// Typed parameters for every component, compiled and validated once from a
+// JsonConfig. A snapshot is never modified after it is published, so it can
+// be read from any thread without locking.
+struct ConfigSnapshot {
+    uint64_t version;
+    RasteriserParams rasteriser;
+    StudentParams student;
+    SchedulerParams scheduler;
+    ProfilingParams profiling;
+};
+
+// Each throws std::invalid_argument naming the offending key when a value
+// has the wrong type or is out of range. Missing keys take their defaults.
+RasteriserParams compile_rasteriser_params(const JsonConfig& config);
+StudentParams compile_student_params(const JsonConfig& config);
+SchedulerParams compile_scheduler_params(const JsonConfig& config);
+ProfilingParams compile_profiling_params(const JsonConfig& config);
+std::shared_ptr<const ConfigSnapshot> compile_config(const JsonConfig& config, uint64_t version = 1);
+
+// Owns the active snapshot of a config file, loaded with load_config(), and
+// replaces it atomically on reload. The control path polls version() (one relaxed load) and only calls
+// current() when it changed; a failed reload is logged and leaves the active
+// snapshot in place, so nothing downstream ever sees a half-valid config.
+//
+// Network shapes (hidden sizes, layer and head counts, horizon, sensor count)
+// are fixed at construction; a reload that changes them is rejected. The
+// profiling settings are applied to Instrumentation when a snapshot that
+// changes them is published.
+class ConfigStore {
+public:
+    explicit ConfigStore(const std::string& path, const std::string& cache_path = "");
+
+    std::shared_ptr<const ConfigSnapshot> current() const;
+    uint64_t version() const {
+        return version_.load(std::memory_order_acquire);
+    }
+
+    // Re-reads the file. Returns false, keeping the current snapshot, if it
+    // fails to parse or validate.
+    bool reload();
+    // reload() only if a file of the import graph was modified since the last load.
+    bool reload_if_changed();
+
+private:
+    void publish(std::shared_ptr<const ConfigSnapshot> snapshot);
+    void track(std::vector<std::string> inputs);
+
+    std::string path_;
+    std::string cache_path_;
+    std::shared_ptr<const ConfigSnapshot> snapshot_;   // Accessed through std::atomic_load/store
+    std::atomic<uint64_t> version_{0};
+    std::mutex reload_mutex_;
+    std::vector<std::string> inputs_;
+    std::vector<std::filesystem::file_time_type> loaded_mtimes_;
+};
+
+} // namespace bcod
@@ -22,6 +22,8 @@ private:
     void load_weights(const std::string& path);
     
     void apply_film(const float* input,
+                   int input_dim,
+                   const float* weights,
                    const float* gamma,
                    const float* beta,
                    float* output,
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "environment.hpp"
+#include <Eigen/Dense>
+#include <vector>
+
+namespace bcod {
+
+// Signed distance to the world's obstacles (negative inside), sampled at the
+// world resolution with cell centres at origin + (i + 0.5) * resolution.
+//
+// Static obstacles are rasterised once and turned into an exact Euclidean
+// distance transform. Dynamic obstacles only touch a window of
+// `dynamic_radius` around their footprint, so update() rewrites the windows
+// they left and entered instead of the whole grid. Beyond that radius their
+// contribution is clipped, which keeps the field exact wherever the clearance
+// is below `dynamic_radius`.
+//
+// Lookups and update() must not run concurrently.
+class DistanceField {
+public:
+    explicit DistanceField(const WorldParams& world, double dynamic_radius = 10.0);
+
+    // Moves the dynamic obstacles to time t.
+    void update(double t);
+
+    // Bilinear lookup; points outside the world take the nearest border value.
+    double distance(const Eigen::Vector2d& p) const;
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+    double resolution() const { return resolution_; }
+    double time() const { return time_; }
+
+private:
+    struct Window {
+        int x0, y0, x1, y1;  // Half-open cell range
+    };
+
+    std::vector<Obstacle> dynamic_;
+    Eigen::Vector2d origin_;
+    double resolution_;
+    double dynamic_radius_;
+    int width_;
+    int height_;
+    double time_ = 0.0;
+    std::vector<float> static_field_;
+    std::vector<float> field_;     // static_field_ with dynamic obstacles at time_
+    std::vector<Window> windows_;  // Cells the dynamic obstacles currently cover
+
+    Window window(const Obstacle& obstacle, double t) const;
+};
+
+// Lowest clearance along a trajectory whose waypoints are offsets from
+// `start` (x, y, yaw) in the start pose's frame. One lookup per waypoint.
+double trajectory_clearance(const std::vector<Eigen::Vector3d>& waypoints, const Eigen::Vector3d& start,
+                            const DistanceField& field);
+
+} // namespace bcod
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <Eigen/Dense>
+#include <nlohmann/json.hpp>
+#include <vector>
+#include <cstdint>
+
+namespace bcod {
+
+enum class ObstacleShape : uint8_t {
+    POLYGON,
+    CIRCLE,
+    RECTANGLE
+};
+
+struct Obstacle {
+    ObstacleShape shape;
+    bool dynamic;
+    std::vector<Eigen::Vector2d> vertices;  // POLYGON, counter-clockwise or clockwise
+    Eigen::Vector2d center;                 // CIRCLE centre, RECTANGLE centre at t = 0
+    double radius;                          // CIRCLE
+    Eigen::Vector2d size;                   // RECTANGLE extent (axis aligned)
+    Eigen::Vector2d velocity;               // Dynamic obstacles only
+};
+
+struct Landmark {
+    Eigen::Vector2d position;
+    double uncertainty;
+};
+
+struct NoiseSource {
+    Eigen::Vector2d position;
+    double intensity;
+    double radius;
+};
+
+// Static description of the simulated lake, mirroring environment_config.yaml.
+struct WorldParams {
+    Eigen::Vector2d size;
+    double resolution;
+    Eigen::Vector2d origin;
+    std::vector<Obstacle> obstacles;
+    std::vector<Landmark> landmarks;
+    std::vector<NoiseSource> noise_sources;
+
+    double time_step;
+    int max_steps;
+    double position_noise;
+    double orientation_noise;
+    std::vector<double> sensor_ranges;  // Per SensorType, <= 0 means no landmark needed
+
+    double max_velocity;
+    double max_angular_velocity;
+};
+
+// Parses the `environment` node of environment_config.yaml (after conversion to JSON).
+WorldParams parse_world(const nlohmann::json& environment);
+
+// Exact signed distance to an obstacle (negative inside), with dynamic obstacles
+// advanced to time t.
+double signed_distance(const Obstacle& obstacle, const Eigen::Vector2d& p, double t = 0.0);
+double signed_distance(const WorldParams& world, const Eigen::Vector2d& p, double t = 0.0);
+
+// Multiplicative measurement-noise inflation from nearby noise sources (>= 1).
+double noise_inflation(const WorldParams& world, const Eigen::Vector2d& p);
+
+// Nearest landmark within range, or nullptr.
+const Landmark* visible_landmark(const WorldParams& world, const Eigen::Vector2d& p, double range);
+
+bool inside_world(const WorldParams& world, const Eigen::Vector2d& p);
+
+} // namespace bcod
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <torch/torch.h>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace bcod {
+
+// 64-bit content hash of a raster's pixels, shape and type. Used to recognise
+// a frame that has already been encoded.
+uint64_t hash_raster(const cv::Mat& raster);
+
+// Cache key of the features `encoder` computes for a raster with hash
+// `raster_hash`. Owners number their encoders, so one cache can serve several.
+uint64_t feature_key(uint64_t raster_hash, uint32_t encoder);
+
+// Memoises encoder outputs for the last few frames, keyed by feature_key().
+// Owners must clear() it whenever encoder weights change.
+class FeatureCache {
+public:
+    explicit FeatureCache(size_t capacity = 4);
+
+    // Returns the cached features for `key`, or runs `encode` and keeps its
+    // result. Hits and misses are counted as features.cache_hits/_misses.
+    torch::Tensor get_or_compute(uint64_t key, const std::function<torch::Tensor()>& encode);
+    void clear();
+
+    size_t capacity() const { return capacity_; }
+
+private:
+    struct Entry {
+        uint64_t key;
+        torch::Tensor features;
+    };
+
+    size_t capacity_;
+    size_t next_ = 0;   // Slot overwritten by the next miss once the cache is full
+    std::vector<Entry> entries_;
+    std::mutex mutex_;
+};
+
+} // namespace bcod
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace bcod {
+
+// Lock-free log-linear latency histogram in the style of HdrHistogram: every
+// power of two is split into 16 linear sub-buckets, so any recorded value is
+// reported within ~6% from 1 ns up to ~70 minutes. record() is wait-free and
+// may be called from any number of threads.
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BITS = 4;
+    static constexpr int SUB_BUCKETS = 1 << SUB_BITS;
+    static constexpr int MAX_EXPONENT = 42;
+    static constexpr int NUM_BUCKETS = (MAX_EXPONENT - SUB_BITS + 2) * SUB_BUCKETS;
+
+    void record(int64_t ns);
+    uint64_t count() const;
+    double percentile(double p) const;  // ms, bucket upper bound capped at the maximum
+    double mean_ms() const;
+    double max_ms() const;
+    void reset();
+
+private:
+    std::array<std::atomic<uint64_t>, NUM_BUCKETS> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<int64_t> sum_ns_{0};
+    std::atomic<int64_t> max_ns_{0};
+};
+
+class Counter {
+public:
+    void add(uint64_t n = 1) { value_.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+    void reset() { value_.store(0, std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> value_{0};
+};
+
+class Gauge {
+public:
+    void set(double v) { value_.store(v, std::memory_order_relaxed); }
+    double value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<double> value_{0.0};
+};
+
+struct ProfilingParams {
+    bool enabled;
+    int interval_ms;           // performance.profiling.interval
+    std::string output;        // performance.profiling.output, a directory
+    bool monitor_process;      // performance.monitoring.enabled: CPU time and RSS gauges
+};
+
+namespace detail {
+    extern std::atomic<bool> instrumentation_enabled;
+}
+
+inline bool instrumentation_enabled() {
+    return detail::instrumentation_enabled.load(std::memory_order_relaxed);
+}
+
+// Heap allocations made by the calling thread. Only counts when the library is
+// built with BCOD_COUNT_ALLOCATIONS, which replaces global operator new;
+// otherwise always 0.
+uint64_t thread_allocation_count();
+
+// Process-wide registry of named metrics. Metrics are created on first use and
+// live for the lifetime of the process, so call sites can cache references.
+// A reporter thread appends a snapshot of every metric to
+// <output>/profile_<pid>.tsv once per interval.
+class Instrumentation {
+public:
+    static Instrumentation& instance();
+
+    void configure(const ProfilingParams& params);
+    void set_enabled(bool enabled);
+    bool enabled() const { return instrumentation_enabled(); }
+
+    LatencyHistogram& histogram(const std::string& name);
+    Counter& counter(const std::string& name);
+    Gauge& gauge(const std::string& name);
+
+    // Writes one snapshot immediately.
+    void dump();
+    void reset();
+
+private:
+    Instrumentation();
+    ~Instrumentation();
+
+    Instrumentation(const Instrumentation&) = delete;
+    Instrumentation& operator=(const Instrumentation&) = delete;
+
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+// Records the lifetime of a scope into a histogram, plus the heap allocations
+// made in it when a counter is given. Costs one relaxed load while
+// instrumentation is disabled.
+class ScopedTimer {
+public:
+    explicit ScopedTimer(LatencyHistogram& latency, Counter* allocations = nullptr)
+        : latency_(instrumentation_enabled() ? &latency : nullptr), allocations_(allocations) {
+        if (latency_) {
+            start_ = std::chrono::steady_clock::now();
+            if (allocations_) start_allocations_ = thread_allocation_count();
+        }
+    }
+
+    ~ScopedTimer() {
+        if (!latency_) return;
+        latency_->record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start_).count());
+        if (allocations_) allocations_->add(thread_allocation_count() - start_allocations_);
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    LatencyHistogram* latency_;
+    Counter* allocations_;
+    std::chrono::steady_clock::time_point start_;
+    uint64_t start_allocations_ = 0;
+};
+
+#define BCOD_CONCAT_IMPL(a, b) a##b
+#define BCOD_CONCAT(a, b) BCOD_CONCAT_IMPL(a, b)
+
+// Times the enclosing scope as `name` (a string literal), counting allocations
+// under `name.allocs`. The metric lookup happens once per call site.
+#define BCOD_SCOPED_TIMER(name) \
+    static bcod::LatencyHistogram& BCOD_CONCAT(bcod_latency_, __LINE__) = \
+        bcod::Instrumentation::instance().histogram(name); \
+    static bcod::Counter& BCOD_CONCAT(bcod_allocs_, __LINE__) = \
+        bcod::Instrumentation::instance().counter(name ".allocs"); \
+    bcod::ScopedTimer BCOD_CONCAT(bcod_timer_, __LINE__)( \
+        BCOD_CONCAT(bcod_latency_, __LINE__), &BCOD_CONCAT(bcod_allocs_, __LINE__))
+
+} // namespace bcod
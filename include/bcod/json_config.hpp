@@ -2,6 +2,7 @@
 
 #include <string>
 #include <memory>
+#include <vector>
 #include <nlohmann/json.hpp>
 
 namespace bcod {
@@ -10,22 +11,23 @@ class JsonConfig {
 public:
     explicit JsonConfig(const std::string& config_path);
     
+    // Validates and fills defaults for an already-flattened object of dotted
+    // keys, as produced by load_config().
+    static JsonConfig from_json(nlohmann::json config);
+    
+    // Missing keys return the default. A key holding a value of the wrong
+    // type throws nlohmann::json::type_error; compile_config() turns that into
+    // a load-time error so components never see it.
     template<typename T>
     T get(const std::string& key, const T& default_value = T()) const {
-        try {
-            return config_.at(key).get<T>();
-        } catch (const nlohmann::json::exception&) {
-            return default_value;
-        }
+        const auto it = config_.find(key);
+        return it != config_.end() ? it->template get<T>() : default_value;
     }
     
     template<typename T>
     std::vector<T> get_array(const std::string& key) const {
-        try {
-            return config_.at(key).get<std::vector<T>>();
-        } catch (const nlohmann::json::exception&) {
-            return {};
-        }
+        const auto it = config_.find(key);
+        return it != config_.end() ? it->template get<std::vector<T>>() : std::vector<T>{};
     }
     
     bool has(const std::string& key) const {
@@ -38,7 +40,13 @@ public:
     
     void save(const std::string& path) const;
     
+    const nlohmann::json& data() const {
+        return config_;
+    }
+    
 private:
+    JsonConfig() = default;
+    
     nlohmann::json config_;
     
     void validate_config() const;
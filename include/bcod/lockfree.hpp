@@ -0,0 +1,147 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace bcod {
+
+// Single-producer/single-consumer mailbox with latest-value semantics. The
+// producer never blocks: publishing over an unread value replaces it. The
+// consumer always sees the newest complete value. Both sides work on their own
+// slot, so values are moved in and out without copies or locks.
+template<typename T>
+class TripleBuffer {
+public:
+    // Producer side
+    T& back() { return slots_[back_]; }
+
+    // Returns true if an unread value was overwritten (i.e. dropped).
+    bool publish() {
+        uint8_t prev = middle_.exchange(static_cast<uint8_t>(back_ | kDirty), std::memory_order_acq_rel);
+        back_ = prev & kIndexMask;
+        return (prev & kDirty) != 0;
+    }
+
+    // Consumer side
+    bool has_new() const {
+        return (middle_.load(std::memory_order_acquire) & kDirty) != 0;
+    }
+
+    // Swaps in the newest value if there is one; returns false otherwise.
+    bool fetch() {
+        if (!has_new()) return false;
+        uint8_t prev = middle_.exchange(front_, std::memory_order_acq_rel);
+        front_ = prev & kIndexMask;
+        return true;
+    }
+
+    T& front() { return slots_[front_]; }
+
+private:
+    static constexpr uint8_t kDirty = 0x4;
+    static constexpr uint8_t kIndexMask = 0x3;
+
+    std::array<T, 3> slots_;
+    uint8_t back_ = 0;
+    uint8_t front_ = 1;
+    alignas(64) std::atomic<uint8_t> middle_{2};
+};
+
+// Bounded single-producer/single-consumer FIFO. Each side caches the other's
+// index so the shared cache lines are only touched when the cached view says
+// the ring is full (producer) or empty (consumer). Slots are written and read
+// in place through claim/commit and peek/pop to avoid copying large records.
+template<typename T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity) : slots_(round_up(capacity)), mask_(slots_.size() - 1) {}
+
+    // Producer side. Returns nullptr when the ring is full.
+    T* claim() {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_cache_ > mask_) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (tail - head_cache_ > mask_) return nullptr;
+        }
+        return &slots_[tail & mask_];
+    }
+
+    void commit() {
+        tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    bool try_push(const T& value) {
+        T* slot = claim();
+        if (!slot) return false;
+        *slot = value;
+        commit();
+        return true;
+    }
+
+    // Consumer side. Returns nullptr when the ring is empty.
+    T* peek() {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_cache_) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            if (head == tail_cache_) return nullptr;
+        }
+        return &slots_[head & mask_];
+    }
+
+    void pop() {
+        head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    bool try_pop(T& value) {
+        T* slot = peek();
+        if (!slot) return false;
+        value = std::move(*slot);
+        pop();
+        return true;
+    }
+
+    bool empty() const {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const { return mask_ + 1; }
+
+private:
+    static size_t round_up(size_t n) {
+        size_t p = 1;
+        while (p < n) p <<= 1;
+        return p;
+    }
+
+    std::vector<T> slots_;
+    size_t mask_;
+    alignas(64) std::atomic<size_t> head_{0};  // Written by the consumer
+    size_t tail_cache_ = 0;
+    alignas(64) std::atomic<size_t> tail_{0};  // Written by the producer
+    size_t head_cache_ = 0;
+};
+
+// Spin, then yield, then sleep until `ready()` or `!running()`. Keeps wakeup
+// latency in the microseconds while a stage is busy without burning a core
+// when the pipeline is idle.
+template<typename Ready, typename Running>
+bool wait_until(Ready ready, Running running, std::chrono::microseconds idle_sleep) {
+    for (int i = 0; running(); ++i) {
+        if (ready()) return true;
+        if (i < 64) continue;
+        if (i < 128) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(idle_sleep);
+        }
+    }
+    return false;
+}
+
+} // namespace bcod
@@ -1,9 +1,14 @@
 #pragma once
 
-#include <string>
+#include <atomic>
 #include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
 #include <sstream>
-#include <iomanip>
+#include <string>
+#include <string_view>
+#include <type_traits>
 
 namespace bcod {
 
@@ -15,71 +20,193 @@ enum class LogLevel {
     FATAL
 };
 
+namespace detail {
+
+enum class LogArg : uint8_t {
+    INT,
+    UINT,
+    DOUBLE,
+    BOOL,
+    CHAR,
+    STRING
+};
+
+// Fixed-size binary log entry. Arguments are appended as a type tag followed by
+// their raw bytes (strings as a 16-bit length plus characters) and formatted
+// later on the logging thread. Arguments that do not fit are cut off and the
+// record is marked truncated.
+struct LogRecord {
+    static constexpr size_t SIZE = 256;
+
+    int64_t wall_ns;
+    const char* file;
+    int32_t line;
+    uint8_t level;
+    uint8_t truncated;
+    uint16_t size;
+    char payload[SIZE - 24];
+
+    void reset() {
+        size = 0;
+        truncated = 0;
+    }
+
+    void put(LogArg tag, const void* data, size_t n) {
+        if (truncated || size + 1 + n > sizeof(payload)) {
+            truncated = 1;
+            return;
+        }
+        payload[size] = static_cast<char>(tag);
+        std::memcpy(payload + size + 1, data, n);
+        size = static_cast<uint16_t>(size + 1 + n);
+    }
+
+    void put_string(std::string_view s) {
+        if (truncated) return;
+        const size_t room = sizeof(payload) - size;
+        if (room < 1 + sizeof(uint16_t)) {
+            truncated = 1;
+            return;
+        }
+        size_t n = s.size();
+        if (n > room - 1 - sizeof(uint16_t)) {
+            n = room - 1 - sizeof(uint16_t);
+            truncated = 1;
+        }
+        const uint16_t len = static_cast<uint16_t>(n);
+        payload[size] = static_cast<char>(LogArg::STRING);
+        std::memcpy(payload + size + 1, &len, sizeof(len));
+        std::memcpy(payload + size + 1 + sizeof(len), s.data(), n);
+        size = static_cast<uint16_t>(size + 1 + sizeof(len) + n);
+    }
+};
+
+static_assert(sizeof(LogRecord) == LogRecord::SIZE, "LogRecord must stay one fixed-size slot");
+
+template<typename T>
+void encode(LogRecord& record, const T& value) {
+    using U = std::decay_t<T>;
+    if constexpr (std::is_same_v<U, bool>) {
+        const uint8_t v = value ? 1 : 0;
+        record.put(LogArg::BOOL, &v, sizeof(v));
+    } else if constexpr (std::is_same_v<U, char> || std::is_same_v<U, signed char> ||
+                         std::is_same_v<U, unsigned char>) {
+        record.put(LogArg::CHAR, &value, 1);
+    } else if constexpr (std::is_integral_v<U> && std::is_signed_v<U>) {
+        const int64_t v = value;
+        record.put(LogArg::INT, &v, sizeof(v));
+    } else if constexpr (std::is_integral_v<U>) {
+        const uint64_t v = value;
+        record.put(LogArg::UINT, &v, sizeof(v));
+    } else if constexpr (std::is_enum_v<U>) {
+        const int64_t v = static_cast<int64_t>(value);
+        record.put(LogArg::INT, &v, sizeof(v));
+    } else if constexpr (std::is_floating_point_v<U>) {
+        const double v = value;
+        record.put(LogArg::DOUBLE, &v, sizeof(v));
+    } else if constexpr (std::is_array_v<T>) {
+        record.put_string(std::string_view(value));
+    } else if constexpr (std::is_same_v<U, const char*> || std::is_same_v<U, char*>) {
+        record.put_string(value ? std::string_view(value) : std::string_view("(null)"));
+    } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+        record.put_string(std::string_view(value));
+    } else {
+        // Slow path for anything else with an operator<<
+        std::ostringstream ss;
+        ss << value;
+        record.put_string(ss.str());
+    }
+}
+
+} // namespace detail
+
+// Asynchronous logger. Call sites encode their arguments into a compact binary
+// record and push it onto a lock-free ring owned by the calling thread; a
+// background thread formats, merges and writes records in batches. Logging
+// never takes a lock or touches the file on the caller's thread, except for
+// FATAL, which waits until the message is written. Records are dropped (and
+// the drop reported) rather than blocking if a thread's ring is full.
 class Logger {
 public:
     static Logger& instance() {
         static Logger instance;
         return instance;
     }
-    
+
     void set_level(LogLevel level) {
-        current_level_ = level;
+        current_level_.store(level, std::memory_order_relaxed);
     }
-    
+
+    bool enabled(LogLevel level) const {
+        return level >= current_level_.load(std::memory_order_relaxed);
+    }
+
     template<typename... Args>
-    void log(LogLevel level, const char* file, int line, Args&&... args) {
-        if (level < current_level_) return;
-        
-        std::stringstream ss;
-        ss << get_timestamp() << " [" << get_level_str(level) << "] "
-           << file << ":" << line << " - ";
-        (ss << ... << std::forward<Args>(args));
-        
-        write_log(level, ss.str());
+    void log(LogLevel level, const char* file, int line, const Args&... args) {
+        if (!enabled(level)) return;
+
+        detail::LogRecord* record = claim();
+        if (!record) return;
+
+        record->wall_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        record->file = file;
+        record->line = line;
+        record->level = static_cast<uint8_t>(level);
+        record->reset();
+        (detail::encode(*record, args), ...);
+
+        commit(level);
     }
-    
+
+    void set_log_file(const std::string& path);
+    void set_use_colors(bool use);
+
+    // Blocks until every record logged before the call has been written.
+    void flush();
+    uint64_t dropped() const;
+
 private:
-    Logger() = default;
-    ~Logger() = default;
-    
+    Logger();
+    ~Logger();
+
     Logger(const Logger&) = delete;
     Logger& operator=(const Logger&) = delete;
-    
-    std::string get_timestamp() const {
-        auto now = std::chrono::system_clock::now();
-        auto time = std::chrono::system_clock::to_time_t(now);
-        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-            now.time_since_epoch()) % 1000;
-            
-        std::stringstream ss;
-        ss << std::put_time(std::localtime(&time), "%Y-%m-%d %H:%M:%S")
-           << '.' << std::setfill('0') << std::setw(3) << ms.count();
-        return ss.str();
-    }
-    
-    const char* get_level_str(LogLevel level) const {
-        switch (level) {
-            case LogLevel::DEBUG:   return "DEBUG";
-            case LogLevel::INFO:    return "INFO";
-            case LogLevel::WARNING: return "WARNING";
-            case LogLevel::ERROR:   return "ERROR";
-            case LogLevel::FATAL:   return "FATAL";
-            default:               return "UNKNOWN";
-        }
-    }
-    
-    void write_log(LogLevel level, const std::string& message);
-    
-    LogLevel current_level_ = LogLevel::INFO;
+
+    detail::LogRecord* claim();
+    void commit(LogLevel level);
+
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+    std::atomic<LogLevel> current_level_{LogLevel::INFO};
 };
 
+// The level check runs before the arguments are evaluated
 #define BCOD_LOG(level, ...) \
-    bcod::Logger::instance().log(level, __FILE__, __LINE__, __VA_ARGS__)
+    do { \
+        bcod::Logger& bcod_logger_ = bcod::Logger::instance(); \
+        if (bcod_logger_.enabled(level)) { \
+            bcod_logger_.log(level, __FILE__, __LINE__, __VA_ARGS__); \
+        } \
+    } while (0)
+
+// Sites below BCOD_MIN_LOG_LEVEL (0 = DEBUG .. 4 = FATAL) are compiled out,
+// arguments included. Set through the BCOD_MIN_LOG_LEVEL CMake option.
+#ifndef BCOD_MIN_LOG_LEVEL
+#define BCOD_MIN_LOG_LEVEL 0
+#endif
+
+#define BCOD_LOG_AT(min_level, level, ...) \
+    do { \
+        if constexpr (BCOD_MIN_LOG_LEVEL <= (min_level)) { \
+            BCOD_LOG(level, __VA_ARGS__); \
+        } \
+    } while (0)
 
-#define BCOD_DEBUG(...) BCOD_LOG(bcod::LogLevel::DEBUG, __VA_ARGS__)
-#define BCOD_INFO(...)  BCOD_LOG(bcod::LogLevel::INFO, __VA_ARGS__)
-#define BCOD_WARN(...)  BCOD_LOG(bcod::LogLevel::WARNING, __VA_ARGS__)
-#define BCOD_ERROR(...) BCOD_LOG(bcod::LogLevel::ERROR, __VA_ARGS__)
+#define BCOD_DEBUG(...) BCOD_LOG_AT(0, bcod::LogLevel::DEBUG, __VA_ARGS__)
+#define BCOD_INFO(...)  BCOD_LOG_AT(1, bcod::LogLevel::INFO, __VA_ARGS__)
+#define BCOD_WARN(...)  BCOD_LOG_AT(2, bcod::LogLevel::WARNING, __VA_ARGS__)
+#define BCOD_ERROR(...) BCOD_LOG_AT(3, bcod::LogLevel::ERROR, __VA_ARGS__)
 #define BCOD_FATAL(...) BCOD_LOG(bcod::LogLevel::FATAL, __VA_ARGS__)
 
-} // namespace bcod 
\ No newline at end of file
+} // namespace bcod
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "belief_rasteriser.hpp"
+#include "mapped_file.hpp"
+#include <opencv2/core.hpp>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace bcod {
+
+// On-disk layout of a map store: this header, one MapLevelHeader per pyramid
+// level, then each level's tiles in row-major tile order. A tile is
+// tile_size x tile_size pixels of `channels` interleaved bytes, zero-padded
+// at the map edge. Level offsets are page aligned. Native byte order.
+struct MapStoreHeader {
+    static constexpr char MAGIC[8] = {'B', 'C', 'O', 'D', 'M', 'A', 'P', '\0'};
+    static constexpr uint32_t VERSION = 1;
+
+    char magic[8];
+    uint32_t version;
+    uint32_t channels;
+    uint32_t tile_size;
+    uint32_t levels;
+    double resolution;  // m per level-0 pixel
+    double origin_x;    // World position of the corner of pixel (0, 0)
+    double origin_y;
+};
+
+struct MapLevelHeader {
+    uint32_t width;
+    uint32_t height;
+    uint32_t tiles_x;
+    uint32_t tiles_y;
+    uint64_t offset;
+};
+
+// Semantic map served from a tiled pyramid in a memory-mapped file, so large
+// survey areas never have to be decoded into memory as a whole. Pixel (x, y)
+// of level 0 covers origin + [x, x + 1) x [y, y + 1) * resolution; rows grow
+// with world y. Each level halves the one below.
+//
+// The tile LRU bounds resident memory: pages of evicted tiles are handed back
+// to the kernel. Thread-safe.
+class MapStore {
+public:
+    explicit MapStore(const std::string& path, size_t tile_capacity = 64);
+
+    // Writes `image` (8-bit, 1-4 channels, row 0 at origin.y) as a store
+    // with levels down to one tile.
+    static void build(const cv::Mat& image, double resolution, const Eigen::Vector2d& origin,
+                      const std::string& path, int tile_size = 256);
+
+    // Samples the map under a raster window into `channels()` float planes of
+    // rows x cols at `dst`, scaled to [0, 1]. Output cell (u, v) is the
+    // raster cell at offset (u + 0.5, v + 0.5) * window.scale - window.size / 2
+    // from the centre along window.axes, i.e. the same cell the belief raster
+    // fills. Reads the coarsest level that still resolves window.scale,
+    // bilinearly; samples off the map are 0.
+    void crop(const RasterWindow& window, int rows, int cols, float* dst) const;
+
+    // As crop(), into a rows x cols HWC float image.
+    cv::Mat crop(const RasterWindow& window, int rows, int cols) const;
+
+    int channels() const { return header_.channels; }
+    int width() const { return levels_.front().width; }
+    int height() const { return levels_.front().height; }
+    int levels() const { return header_.levels; }
+    int tile_size() const { return header_.tile_size; }
+    double resolution() const { return header_.resolution; }
+    Eigen::Vector2d origin() const { return {header_.origin_x, header_.origin_y}; }
+    size_t resident_tiles() const;
+
+private:
+    MappedFile file_;
+    MapStoreHeader header_;
+    std::vector<MapLevelHeader> levels_;
+    size_t tile_capacity_;
+
+    mutable std::mutex mtx_;
+    mutable std::list<uint64_t> lru_;  // Most recently used first
+    mutable std::unordered_map<uint64_t, std::list<uint64_t>::iterator> resident_;
+
+    size_t tile_bytes() const;
+    const uint8_t* touch(int level, int tx, int ty) const;
+};
+
+} // namespace bcod
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace bcod {
+
+// Read-only memory mapping of a whole file. Pages are shared between every
+// mapping of the same file, so several workers (threads or processes) can
+// read one dataset without duplicating it.
+class MappedFile {
+public:
+    enum class Access {
+        SEQUENTIAL,
+        RANDOM
+    };
+
+    explicit MappedFile(const std::string& path, Access access = Access::SEQUENTIAL);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    const uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+    const std::string& path() const { return path_; }
+
+    // Hint that [offset, offset + length) is no longer needed in memory.
+    void release(size_t offset, size_t length) const;
+
+    struct Range {
+        size_t offset;
+        size_t length;
+    };
+
+    // Splits a text file into consecutive ranges of roughly `chunk_bytes`
+    // that each start at the beginning of a line, for parallel parsing.
+    std::vector<Range> line_chunks(size_t chunk_bytes) const;
+
+private:
+    std::string path_;
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+
+    void unmap();
+};
+
+} // namespace bcod
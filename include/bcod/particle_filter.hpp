@@ -0,0 +1,85 @@
+#pragma once
+
+#include "belief_rasteriser.hpp"
+#include "sensor_defs.hpp"
+#include <Eigen/Dense>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace bcod {
+
+// One sensor reading in world coordinates. As in VectorEnv, GNSS observes
+// position only, IMU heading only and every other sensor both.
+struct Measurement {
+    SensorType sensor;
+    Eigen::Vector2d position;
+    double yaw;
+    double inflation = 1.0;    // Multiplies MEASUREMENT_NOISE, e.g. noise_inflation()
+    double extra_sigma = 0.0;  // Added on top, e.g. the uncertainty of the landmark used; the sum must be positive
+};
+
+// Bootstrap particle filter over (x, y, yaw) with structure-of-arrays state.
+//
+// All randomness comes from a counter-based generator keyed on the seed and
+// indexed by (step, particle), so results do not depend on how the particle
+// loops are blocked or vectorised, and two filters with the same seed and
+// inputs stay bit-identical. Weights are kept normalised after every call.
+// particles() views the state without copying and feeds
+// BeliefRasteriser::rasterise directly.
+class ParticleFilter {
+public:
+    struct Params {
+        int num_particles;
+        uint64_t seed;
+        double position_noise;     // Motion diffusion, m / sqrt(s)
+        double orientation_noise;  // rad / sqrt(s)
+        double resample_ratio;     // Resample once ESS < ratio * N, 0 for 0.5
+    };
+
+    explicit ParticleFilter(const Params& params);
+
+    // Gaussian cloud around `pose` with uniform weights.
+    void reset(const Eigen::Vector3d& pose, double position_spread, double yaw_spread);
+
+    // Unicycle motion: turn by angular_velocity * dt, then advance
+    // velocity * dt along the new heading, plus diffusion scaled by `inflation`.
+    void predict(double velocity, double angular_velocity, double dt, double inflation = 1.0);
+
+    // Reweights by the Gaussian likelihood of one reading.
+    void update(const Measurement& z);
+
+    // Reweights by the joint likelihood of the readings of every sensor in
+    // `mask` (bit i for SensorType i, as in to_bitmask) in a single pass;
+    // readings[i] is used for sensor i only and its `sensor` field is
+    // ignored. Each mask dispatches to its own kernel with the inactive
+    // sensors compiled out, so an empty mask costs nothing. The time spent is
+    // recorded per mask as "filter.update.<mask>", bits in sensor order.
+    // VectorEnv does not go through here: it keeps its own per-sensor
+    // update so its RNG streams stay as they were, and scheduler training
+    // does not see these kernels.
+    void update(uint32_t mask, const std::array<Measurement, kNumSensors>& readings);
+
+    // Systematic resampling in O(N) when the effective sample size has
+    // dropped below the threshold. Returns whether it resampled.
+    bool resample();
+
+    // Weighted mean position and circular mean heading.
+    Eigen::Vector3d estimate() const;
+    double effective_sample_size() const;
+
+    ParticleArrays particles() const { return {x_.data(), y_.data(), yaw_.data(), weight_.data(), x_.size()}; }
+    size_t size() const { return x_.size(); }
+    uint64_t steps() const { return step_; }
+
+private:
+    Params params_;
+    uint64_t step_ = 0;
+    std::vector<float> x_, y_, yaw_, weight_;
+    std::vector<float> scratch_x_, scratch_y_, scratch_yaw_;  // Resampling targets
+    std::vector<float> log_likelihood_;
+
+    void reweight();
+};
+
+} // namespace bcod
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "belief_rasteriser.hpp"
+#include "student_planner.hpp"
+#include "sac_scheduler.hpp"
+#include "config_snapshot.hpp"
+#include "instrumentation.hpp"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace bcod {
+
+// Everything that travels through the pipeline for one control tick. The
+// caller fills particles plus the non-belief fields of `planning` and
+// `scheduling`; the stages fill in the rest.
+struct PipelineFrame {
+    uint64_t sequence = 0;      // Assigned by BcodPipeline::submit
+    int64_t capture_ns = 0;     // steady_clock time of submit
+    std::vector<Particle> particles;
+    PlanningContext planning;   // belief_image set by the rasterise stage
+    SchedulerState scheduling;  // belief_raster, cvar_risk, risk_forecast and forecast_* set by the plan stage
+    BeliefRaster raster;
+    Trajectory trajectory;
+    SchedulerAction action;
+    std::array<int64_t, 3> stage_ns{};  // rasterise, plan, schedule
+    int64_t end_to_end_ns = 0;
+};
+
+// Runs rasterise -> plan -> schedule on three dedicated threads connected by
+// latest-value SPSC mailboxes, so frame N+1 rasterises while frame N plans.
+// A stage that falls behind only ever sees the newest frame; frames older than
+// `max_latency` are dropped at every stage boundary instead of being acted on.
+// Stage latencies are <name>.rasterise, .plan, .schedule and .end_to_end
+// histograms of the Instrumentation registry, one set per pipeline, and are
+// recorded whether or not profiling is enabled.
+// The rasteriser, planner and scheduler are borrowed and must not be used by
+// anyone else while the pipeline is running. With watch_config(), each stage
+// applies a newer config snapshot to its component between frames, and the
+// plan stage takes the waypoint interval from planner.waypoint_interval.
+class BcodPipeline {
+public:
+    enum Stage { RASTERISE = 0, PLAN = 1, SCHEDULE = 2, NUM_STAGES = 3 };
+
+    struct Params {
+        double max_latency;   // s, performance.max_latency
+        int idle_sleep_us;    // Backoff once a stage has spun and yielded
+        double waypoint_interval;  // s between waypoints, the scheduler's forecast step
+        std::string name;     // Metric prefix; empty gives "pipeline.<n>", unique in the process
+    };
+
+    struct Stats {
+        uint64_t submitted;
+        uint64_t completed;
+        uint64_t overwritten;  // Replaced by a newer frame before a stage took it
+        uint64_t stale;        // Dropped for exceeding max_latency
+    };
+
+    using Callback = std::function<void(const PipelineFrame&)>;
+
+    BcodPipeline(BeliefRasteriser& rasteriser, StudentPlanner& planner,
+                 SACScheduler& scheduler, const Params& params, Callback on_result);
+    ~BcodPipeline();
+
+    // Call before start(). The store must outlive the pipeline; the snapshot
+    // active at start() is assumed to be the one the components were built from.
+    void watch_config(const ConfigStore* store);
+
+    void start();
+    void stop();
+    bool running() const;
+
+    // Never blocks; call from a single producer thread. Returns the sequence
+    // number assigned to the frame.
+    uint64_t submit(PipelineFrame frame);
+
+    Stats stats() const;
+    const LatencyHistogram& stage_latency(Stage stage) const;
+    const LatencyHistogram& end_to_end_latency() const;
+    void reset_stats();
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+} // namespace bcod
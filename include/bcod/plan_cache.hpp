@@ -0,0 +1,53 @@
+#pragma once
+
+#include "student_planner.hpp"
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+namespace bcod {
+
+// Bounded LRU of planned trajectories keyed on a coarse fingerprint of the
+// planning inputs. Belief, semantic map and goal mask are average-pooled to a
+// grid x grid descriptor and every cell is quantised to `tolerance`, so inputs
+// whose pooled values fall in the same buckets share a key; the active sensor
+// mask must match exactly. Not thread-safe: StudentPlanner calls it under its
+// own lock.
+class PlanCache {
+public:
+    struct Stats {
+        uint64_t hits;
+        uint64_t misses;
+        size_t size;
+    };
+
+    PlanCache(size_t capacity, double tolerance, int grid = 8);
+
+    // `variant` folds in anything else that selects a different plan for the
+    // same inputs, such as the decoded horizon.
+    uint64_t fingerprint(const PlanningContext& context, uint64_t variant = 0) const;
+
+    // On a hit copies the cached plan into `out` and marks it most recent.
+    bool lookup(uint64_t key, Trajectory& out);
+    void insert(uint64_t key, const Trajectory& trajectory);
+    void clear();
+
+    Stats stats() const { return {hits_, misses_, entries_.size()}; }
+    size_t capacity() const { return capacity_; }
+
+private:
+    using Entry = std::pair<uint64_t, Trajectory>;
+
+    size_t capacity_;
+    double tolerance_;
+    int grid_;
+    std::list<Entry> entries_;   // Most recently used first
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> index_;
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+
+    void pool(const cv::Mat& raster, std::vector<double>& cells) const;
+};
+
+} // namespace bcod
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "belief_rasteriser.hpp"
+#include "instrumentation.hpp"
+#include "replay_log.hpp"
+#include "sac_scheduler.hpp"
+#include "student_planner.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace bcod {
+
+// Wire format of PlanServer, in host byte order over a Unix stream socket. A
+// request is a ServerRequest followed by frame.num_particles LoggedParticle
+// records, i.e. a replay log frame with a small prefix, so recorders and
+// clients share one layout. A reply is a ServerReply followed by
+// num_waypoints ServerWaypoint records. Clients may pipeline requests on one
+// connection and match replies by id. Each connection is one vehicle to the
+// scheduler's lookahead, which keeps its warmup clocks per connection.
+enum class RequestKind : uint32_t {
+    PLAN = 1,      // Trajectory for the frame
+    SCHEDULE = 2,  // Sensor mask for the frame, given cvar_risk and prev_mask
+    STEP = 3       // Both, scheduling on the risk of the fresh plan
+};
+
+struct ServerRequest {
+    static constexpr uint32_t MAGIC = 0x444f4342;  // "BCOD"
+
+    uint32_t magic;
+    RequestKind kind;
+    uint64_t id;             // Echoed in the reply
+    uint32_t prev_mask;      // SCHEDULE, STEP: sensors active during the last tick
+    float cvar_risk;         // SCHEDULE: risk forecast of the current plan
+    ReplayFrameHeader frame;
+};
+
+struct ServerReply {
+    enum Status : uint32_t { OK = 0, REJECTED = 1, FAILED = 2 };
+
+    uint32_t magic;
+    uint32_t status;
+    uint64_t id;
+    int64_t queue_ns;        // From arrival until its batch started
+    int64_t compute_ns;      // Processing the whole batch
+    uint32_t batch_size;
+    uint32_t sensor_mask;    // SCHEDULE, STEP
+    float total_power;       // SCHEDULE, STEP
+    float cvar_95;           // PLAN, STEP
+    float min_clearance;     // PLAN, STEP
+    uint32_t num_waypoints;  // PLAN, STEP
+};
+
+struct ServerWaypoint {
+    float x, y, yaw;         // Increments, as in Trajectory::waypoints
+    float risk;
+};
+
+static_assert(sizeof(ServerRequest) % 8 == 0 && sizeof(ServerReply) % 8 == 0 && sizeof(ServerWaypoint) % 8 == 0,
+              "Server records must keep 8-byte alignment");
+
+// Serves plan and schedule requests of other processes on a Unix domain
+// socket. Each connection has a reader thread that queues its requests; a
+// single worker takes everything queued within `batch_window_us` of the
+// oldest request (or `max_batch`, if that comes first), rasterises the
+// frames and runs them through StudentPlanner::plan_batch and
+// SACScheduler::schedule_batch. Replies report how long each request queued
+// and how long its batch took; the same split is recorded in the
+// server.queue and server.compute histograms of the Instrumentation
+// registry whether or not profiling is enabled. The rasteriser, planner and
+// scheduler are borrowed and must not be used by anyone else while the
+// server is running.
+class PlanServer {
+public:
+    struct Params {
+        std::string socket_path;
+        int batch_window_us;        // 0 batches only what is already queued
+        int max_batch;
+        uint32_t max_particles;     // Larger requests are rejected
+        double max_velocity;        // Planning context limits
+        double max_angular_velocity;
+        double waypoint_interval;   // s between waypoints, the forecast step of STEP schedules
+    };
+
+    struct Stats {
+        uint64_t requests;
+        uint64_t batches;
+        uint64_t rejected;
+        uint64_t connections;
+    };
+
+    PlanServer(BeliefRasteriser& rasteriser, StudentPlanner& planner, SACScheduler& scheduler, const Params& params);
+    ~PlanServer();
+
+    // Binds the socket, replacing a stale socket file, and starts serving.
+    void start();
+    void stop();
+    bool running() const;
+
+    Stats stats() const;
+    const LatencyHistogram& queue_latency() const;
+    const LatencyHistogram& compute_latency() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+// Blocking client for one connection, for C++ processes and tests.
+class PlanClient {
+public:
+    explicit PlanClient(const std::string& socket_path);
+    ~PlanClient();
+
+    PlanClient(const PlanClient&) = delete;
+    PlanClient& operator=(const PlanClient&) = delete;
+
+    // Sends one request; `request.magic` and `frame.num_particles` are filled in.
+    void send(ServerRequest request, const std::vector<LoggedParticle>& particles);
+    // Reads the next reply; throws if the connection closes.
+    ServerReply receive(std::vector<ServerWaypoint>* waypoints = nullptr);
+
+    ServerReply call(const ServerRequest& request, const std::vector<LoggedParticle>& particles,
+                     std::vector<ServerWaypoint>* waypoints = nullptr) {
+        send(request, particles);
+        return receive(waypoints);
+    }
+
+private:
+    int fd_ = -1;
+};
+
+} // namespace bcod
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace bcod {
+
+// Libtorch-free forward pass of the SAC actor, loaded from the packed format
+// written by SACScheduler::export_policy. BatchNorm is folded into the conv
+// weights at export time, convolutions run as im2col + GEMM with a fused
+// bias/ReLU epilogue, and all scratch memory is allocated once at load so a
+// forward pass performs no allocation.
+class PolicyRuntime {
+public:
+    enum class Precision : uint32_t {
+        FP32 = 0,
+        INT8 = 1   // Per-output-channel symmetric weights, fp32 activations
+    };
+
+    static constexpr uint32_t FORMAT_VERSION = 1;
+
+    explicit PolicyRuntime(const std::string& path);
+    ~PolicyRuntime();
+
+    // belief: [channels, height, width] fp32, context: [context_dim],
+    // probabilities: [num_sensors] sigmoid outputs of the policy mean.
+    void forward(const float* belief, const float* context, float* probabilities);
+
+    int in_channels() const;
+    int height() const;
+    int width() const;
+    int num_sensors() const;
+    int hidden_dim() const;
+    int context_dim() const;
+    Precision precision() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+// Host-side description of the actor used to write the packed file. Conv
+// weights are [out, in * 3 * 3] with BatchNorm already folded in, linear
+// weights are [out, in], both row-major.
+struct PackedPolicy {
+    struct Layer {
+        int rows;
+        int cols;
+        std::vector<float> weight;
+        std::vector<float> bias;
+    };
+
+    struct Norm {
+        std::vector<float> gamma;
+        std::vector<float> beta;
+    };
+
+    int in_channels;
+    int height;
+    int width;
+    int hidden_dim;
+    int num_sensors;
+    int context_dim;
+
+    Layer conv1, conv2, conv3;
+    Layer enc_fc1, enc_fc2;
+    Norm enc_ln1, enc_ln2;
+    Layer head_fc1, head_fc2, head_fc3;
+    Norm head_ln1, head_ln2, head_ln3;
+
+    void save(const std::string& path, PolicyRuntime::Precision precision) const;
+};
+
+} // namespace bcod
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "mapped_file.hpp"
+#include "sensor_defs.hpp"
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <ostream>
+#include <string>
+
+namespace bcod {
+
+// Sensor power logs, one event per line:
+//
+//     2024-06-01T12:00:00[.fff] <sensor index> ON|OFF
+//
+// A log is cut into chunks at line boundaries and each chunk is reduced on
+// its own to a per-sensor summary. Summaries are stitched in file order, so
+// an ON in one chunk is closed by the matching OFF of the same sensor in a
+// later one. Memory stays constant in the size of the log.
+
+// Fixed-format YYYY-MM-DDTHH:MM:SS with an optional fraction, in ns since the
+// epoch; advances `p` past it. Timestamps are taken as UTC, so durations
+// never jump across DST changes. Returns false on anything else.
+bool parse_timestamp(const char*& p, const char* end, int64_t& ns);
+
+struct PowerEvent {
+    int64_t ns;
+    int sensor;
+    bool on;
+};
+
+// One line without its '\n'; a trailing '\r' is accepted.
+bool parse_power_event(const char* p, const char* end, PowerEvent& event);
+
+// What one chunk did to one sensor, independent of the state it started in.
+// Up to the first OFF the outcome depends on whether the sensor was already
+// on; after it the sensor is known to be off and everything is final.
+struct SensorSummary {
+    std::optional<int64_t> first_off;
+    std::optional<int64_t> first_on;   // First ON before first_off
+    uint64_t ons_before_off = 0;
+
+    int64_t on_ns = 0;                  // Closed intervals after first_off
+    uint64_t activations = 0;
+    uint64_t repeated_on = 0;
+    uint64_t stray_off = 0;
+    uint64_t out_of_order = 0;
+
+    bool on = false;                    // State at the end of the chunk, once first_off is seen
+    int64_t on_since = 0;
+
+    void add(const PowerEvent& e);
+};
+
+struct ChunkSummary {
+    std::array<SensorSummary, kNumSensors> sensors;
+    uint64_t events = 0;
+    uint64_t malformed = 0;
+    int64_t last_ns = std::numeric_limits<int64_t>::min();
+};
+
+// Reduces the lines in [begin, end), which must start at a line boundary.
+void scan_power_chunk(const char* begin, const char* end, ChunkSummary& out);
+
+struct SensorTotals {
+    int64_t on_ns = 0;
+    uint64_t activations = 0;
+    uint64_t repeated_on = 0;
+    uint64_t stray_off = 0;
+    uint64_t out_of_order = 0;
+    bool on = false;
+    int64_t on_since = 0;
+
+    void interval(int64_t from, int64_t to);
+
+    // Applies a chunk summary on top of the state left by earlier chunks.
+    void stitch(const SensorSummary& s);
+};
+
+class PowerAnalyzer {
+public:
+    static constexpr size_t DEFAULT_CHUNK_BYTES = 64 << 20;
+
+    explicit PowerAnalyzer(const std::string& log_path, size_t chunk_bytes = DEFAULT_CHUNK_BYTES);
+
+    // One worker per thread, each taking the next unscanned chunk. Sensors
+    // still on at the end of the log draw power until its last event.
+    void analyze(int num_threads);
+
+    void write_report(std::ostream& report) const;
+
+    const std::array<SensorTotals, kNumSensors>& totals() const { return totals_; }
+    uint64_t events() const { return events_; }
+    uint64_t malformed() const { return malformed_; }
+
+private:
+    MappedFile file_;
+    size_t chunk_bytes_;
+    std::array<SensorTotals, kNumSensors> totals_{};
+    uint64_t events_ = 0;
+    uint64_t malformed_ = 0;
+    int64_t last_ns_ = std::numeric_limits<int64_t>::min();
+};
+
+} // namespace bcod
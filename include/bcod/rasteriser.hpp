@@ -1,14 +1,15 @@
 #pragma once
 
 #include "belief_types.hpp"
-#include "json_config.hpp"
+#include "rasteriser_params.hpp"
 #include <memory>
 
 namespace bcod {
 
 class BeliefRasteriser {
 public:
-    explicit BeliefRasteriser(const JsonConfig& config);
+    explicit BeliefRasteriser(const RasteriserParams& params);
+    ~BeliefRasteriser();
     
     void generate(const ParticleSet& particles, BeliefRaster& raster) const;
     
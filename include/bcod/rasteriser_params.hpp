@@ -0,0 +1,14 @@
+#pragma once
+
+namespace bcod {
+
+// Grid rasteriser settings, compiled from the rasteriser.* config keys.
+struct RasteriserParams {
+    double resolution;   // m per cell
+    double max_range;    // m
+    double min_weight;   // Particles lighter than this are skipped
+    double origin_x;
+    double origin_y;
+};
+
+} // namespace bcod
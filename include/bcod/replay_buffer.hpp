@@ -0,0 +1,39 @@
+#pragma once
+
+#include <torch/torch.h>
+#include <cstdint>
+#include <deque>
+#include <random>
+#include <vector>
+
+namespace bcod {
+
+// Fixed-capacity FIFO experience replay with uniform sampling, used by
+// SACScheduler::update.
+class ReplayBuffer {
+public:
+    struct Transition {
+        torch::Tensor state;
+        torch::Tensor context;
+        torch::Tensor action;
+        double reward;
+        torch::Tensor next_state;
+        torch::Tensor next_context;
+        bool done;
+    };
+
+    explicit ReplayBuffer(int capacity, uint64_t seed = std::random_device{}());
+
+    void push(const Transition& transition);
+    std::vector<Transition> sample(int batch_size);
+    int size() const;
+    int capacity() const;
+    void seed(uint64_t seed);
+
+private:
+    std::deque<Transition> buffer_;
+    int capacity_;
+    std::mt19937 rng_;
+};
+
+} // namespace bcod
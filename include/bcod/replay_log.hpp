@@ -0,0 +1,83 @@
+#pragma once
+
+#include "belief_rasteriser.hpp"
+#include "mapped_file.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace bcod {
+
+// Binary flight log of everything the control loop consumed: one frame per
+// tick with the particle set, the sensor mask that was active and the pose and
+// goal used to build the planning context. Frames are variable length and
+// 8-byte aligned, so the reader works directly on the mapped file.
+struct ReplayLogHeader {
+    static constexpr char MAGIC[8] = {'B', 'C', 'O', 'D', 'L', 'O', 'G', '\0'};
+    static constexpr uint32_t VERSION = 1;
+
+    char magic[8];
+    uint32_t version;
+    uint32_t particle_size;
+};
+
+struct ReplayFrameHeader {
+    int64_t timestamp_ns;
+    uint32_t sensor_mask;
+    uint32_t num_particles;
+    float pose[3];          // x, y, yaw of the estimate
+    float goal[2];
+    float goal_distance;
+};
+
+struct LoggedParticle {
+    float x, y, yaw, weight;
+    float covariance[3];    // xx, xy, yy
+    float confidence;
+};
+
+static_assert(sizeof(ReplayLogHeader) % 8 == 0 && sizeof(ReplayFrameHeader) % 8 == 0 &&
+              sizeof(LoggedParticle) % 8 == 0, "Replay log records must keep 8-byte alignment");
+
+class ReplayLogWriter {
+public:
+    explicit ReplayLogWriter(const std::string& path);
+    ~ReplayLogWriter();
+
+    ReplayLogWriter(const ReplayLogWriter&) = delete;
+    ReplayLogWriter& operator=(const ReplayLogWriter&) = delete;
+
+    void append(int64_t timestamp_ns, uint32_t sensor_mask, const Eigen::Vector3d& pose,
+                const Eigen::Vector2d& goal, double goal_distance, const std::vector<Particle>& particles);
+    void close();
+
+private:
+    FILE* file_ = nullptr;
+    std::vector<char> buffer_;
+    std::vector<LoggedParticle> packed_;
+};
+
+// Random access over a mapped log. Opening walks the frame headers once to
+// build the offset index; nothing is copied.
+class ReplayLog {
+public:
+    struct Frame {
+        const ReplayFrameHeader* header;
+        const LoggedParticle* particles;
+    };
+
+    explicit ReplayLog(const std::string& path);
+
+    size_t size() const { return offsets_.size(); }
+    Frame operator[](size_t i) const;
+
+    // Decodes a frame's particles into `out`, reusing its storage.
+    static void unpack(const Frame& frame, std::vector<Particle>& out);
+
+private:
+    MappedFile file_;
+    std::vector<size_t> offsets_;
+};
+
+} // namespace bcod
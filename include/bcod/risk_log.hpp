@@ -0,0 +1,120 @@
+#pragma once
+
+#include "mapped_file.hpp"
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace bcod {
+
+// Risk logs, one planning step per line:
+//
+//     <predicted risk> <realised error>
+//
+// The log is mapped and parsed in line-aligned chunks by a pool of workers.
+// Every chunk reduces to mergeable, fixed-size accumulators, so memory does
+// not grow with the number of steps:
+//   - Welford mean/variance of the absolute error |predicted - realised|
+//   - a fine log-spaced histogram of that error for quantiles (~1% relative)
+//   - a coarse log-spaced histogram of predicted risk, which also carries the
+//     sums for the calibration curve (mean predicted vs mean realised per bin)
+
+// Welford's running mean and variance; merge() is Chan's parallel update.
+struct RunningStats {
+    uint64_t n = 0;
+    double mean = 0.0;
+    double m2 = 0.0;
+    double max = 0.0;
+
+    void add(double x);
+    void merge(const RunningStats& other);
+
+    double stddev() const;
+};
+
+// Log-spaced bins over [lo, hi) with an underflow bin (everything below lo,
+// including zero and negatives) and an overflow bin.
+class LogBins {
+public:
+    LogBins(double lo, double hi, int bins);
+
+    int size() const { return bins_ + 2; }
+    int underflow() const { return 0; }
+    int overflow() const { return bins_ + 1; }
+
+    int index(double x) const;
+
+    // Lower edge of bin i (1 ≤ i ≤ overflow())
+    double edge(int i) const;
+
+    // Geometric centre of bin i, clamped to the range for the outer bins
+    double centre(int i) const;
+
+private:
+    double lo_;
+    double log_lo_;
+    int bins_;
+    double scale_;
+};
+
+struct CalibrationBin {
+    uint64_t count = 0;
+    double predicted = 0.0;
+    double realised = 0.0;
+    double abs_error = 0.0;
+};
+
+struct RiskAccumulator {
+    // Error quantiles resolve 100 bins per decade from 1e-9 to 1e3.
+    static const LogBins ERROR_BINS;
+
+    LogBins risk;
+    RunningStats error;
+    std::vector<uint64_t> error_bins;
+    std::vector<CalibrationBin> risk_bins;
+    uint64_t malformed = 0;
+
+    explicit RiskAccumulator(const LogBins& risk);
+
+    void add(double predicted, double realised);
+
+    // Both sides must share the same risk bins.
+    void merge(const RiskAccumulator& other);
+
+    // Quantile of the absolute error, read off the fine log histogram at the
+    // geometric centre of the bin holding the requested rank.
+    double error_quantile(double q) const;
+
+    // Calibration curve as TSV, one row per non-empty risk bin.
+    void write_calibration(std::ostream& out) const;
+};
+
+// One line without its '\n'; a trailing '\r' is accepted. Non-finite values
+// are rejected.
+bool parse_risk_line(const char* p, const char* end, double& predicted, double& realised);
+
+class RiskAnalyzer {
+public:
+    static constexpr size_t DEFAULT_CHUNK_BYTES = 16 << 20;
+
+    RiskAnalyzer(const std::string& log_path, double min_risk, double max_risk, int num_bins,
+                 size_t chunk_bytes = DEFAULT_CHUNK_BYTES);
+
+    // One accumulator per worker, merged once all chunks are scanned. Throws
+    // if the log holds no valid sample.
+    void analyze(int num_threads);
+
+    void log_summary() const;
+
+    const RiskAccumulator& totals() const { return totals_; }
+
+private:
+    MappedFile file_;
+    size_t chunk_bytes_;
+    RiskAccumulator totals_;
+
+    void scan(const MappedFile::Range& range, RiskAccumulator& acc) const;
+};
+
+} // namespace bcod
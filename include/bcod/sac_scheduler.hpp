@@ -1,6 +1,5 @@
 #pragma once
 
-#include "belief_types.hpp"
 #include "json_config.hpp"
 #include <memory>
 #include <string>
@@ -28,6 +27,10 @@ struct SchedulerState {
     std::vector<double> sensor_uncertainties;  // Current uncertainties
     std::vector<double> environment_features;  // Environmental conditions
     std::vector<double> task_requirements;     // Task-specific requirements
+    std::vector<double> risk_forecast;  // Per-waypoint risk, Trajectory::risk_scores, for lookahead mode
+    std::vector<bool> forecast_sensors; // Mask cvar_risk was forecast under (the planner's active_sensors); prev_actions when empty
+    double forecast_dt = 0.0;           // s between waypoints, 0 disables lookahead for this call
+    uint64_t stream = 0;                // Lookahead keeps warmup clocks per stream, e.g. one per vehicle
 };
 
 struct SchedulerAction {
@@ -57,7 +60,8 @@ struct SchedulerParams {
     double weight_decay;
     double temperature;
     double target_entropy;
-    double tau;
+    double tau;                 // Polyak coefficient for soft target updates
+    double discount_factor;
     int batch_size;
     int buffer_size;
     int update_interval;
@@ -77,6 +81,21 @@ struct SchedulerParams {
     double safety_weight;
     double goal_weight;
     
+    // Plan-and-pick mode: score every sensor subset with the critics instead
+    // of sampling the actor. Without share_encoder this runs both critic
+    // encoders on each new frame, twice the conv work of the actor.
+    bool use_mask_search;
+    double power_budget;       // W, masks drawing more are never selected
+
+    // Shared-trunk mode: the actor and both critics read one belief encoder
+    // (critic1's), which then runs once per frame and is cached by raster
+    bool share_encoder;
+
+    // Lookahead mode: on top of the mask picked above, switch slow sensors on
+    // early when the risk forecast needs them warm (see WarmupLookahead)
+    bool use_lookahead;
+    int lookahead_max_lead;    // Latest switch-on step considered, 0 for the whole horizon
+    
     // Sensor parameters
     std::vector<double> power_coefficients;
     std::vector<double> uncertainty_coefficients;
@@ -93,6 +112,10 @@ struct SchedulerParams {
     bool use_dynamic_shapes;
     bool use_fp16;
     
+    // Deployment parameters
+    bool inference_only;       // Load only the packed actor, no critics/optimizers/libtorch graph
+    std::string policy_path;   // Written by SACScheduler::export_policy
+    
     // Logging parameters
     std::string log_level;
     std::string log_file;
@@ -107,9 +130,18 @@ public:
     ~SACScheduler();
 
     SchedulerAction schedule(const SchedulerState& state);
+    // schedule() on each state in turn, with the actor run once for all.
+    // States of unrelated vehicles must differ in `stream`.
+    std::vector<SchedulerAction> schedule_batch(const std::vector<SchedulerState>& states);
+    // The actor mean without sampling: the policy head's sigmoid
+    // probabilities, which PolicyRuntime reproduces from an exported policy;
+    // schedule() itself in inference-only mode. No mask search and no
+    // lookahead.
+    SchedulerAction schedule_mean(const SchedulerState& state);
     void update(const SchedulerState& state, const SchedulerAction& action, double reward, const SchedulerState& next_state);
     void load_model(const std::string& path);
     void save_model(const std::string& path);
+    void export_policy(const std::string& path, bool quantize_int8 = false);
     void set_params(const SchedulerParams& params);
     void set_device(const std::string& device);
     void set_batch_size(int batch_size);
@@ -119,10 +151,17 @@ public:
     void set_energy_weight(double weight);
     void set_safety_weight(double weight);
     void set_goal_weight(double weight);
+    void set_mask_search(bool enabled, double power_budget);
+    void set_lookahead(bool enabled, int max_lead_steps = 0);
     void set_feature_weights(const std::vector<double>& weights);
     void set_risk_weights(const std::vector<double>& weights);
     void set_safety_weights(const std::vector<double>& weights);
     void set_debug(bool debug);
+    // Makes action sampling and replay sampling reproducible from here on,
+    // independent of the global torch generator and of other schedulers.
+    void set_seed(uint64_t seed);
+    // Drops the lookahead state of a stream that will not be scheduled again
+    void end_stream(uint64_t stream);
     void reset();
 
 private:
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "mapped_file.hpp"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace bcod {
+
+// Offline dataset of scheduler transitions for hyperparameter sweeps:
+// fixed-size records after a small header, so every sweep worker can index
+// the shared read-only mapping directly.
+struct SweepDatasetHeader {
+    static constexpr char MAGIC[8] = {'B', 'C', 'O', 'D', 'R', 'P', 'L', '\0'};
+    static constexpr uint32_t VERSION = 1;
+
+    char magic[8];
+    uint32_t version;
+    uint32_t count;
+};
+
+struct SweepRecord {
+    static constexpr int RASTER_FLOATS = 64 * 64 * 5;
+
+    float belief[RASTER_FLOATS];        // HWC, as produced by BeliefRasteriser
+    float next_belief[RASTER_FLOATS];
+    float cvar_risk;
+    float next_cvar_risk;
+    float goal_distance;
+    float next_goal_distance;
+    float reward;
+    uint32_t prev_mask;
+    uint32_t action_mask;
+    uint32_t done;
+};
+
+class SweepDataset {
+public:
+    explicit SweepDataset(const std::string& path);
+
+    size_t size() const { return header_.count; }
+
+    const SweepRecord& operator[](size_t i) const {
+        return reinterpret_cast<const SweepRecord*>(file_.data() + sizeof(SweepDatasetHeader))[i];
+    }
+
+private:
+    MappedFile file_;
+    SweepDatasetHeader header_;
+};
+
+// Rolls the simulator over `environment` (the "environment" block of an
+// environment config) with a random behaviour policy and writes `steps`
+// transitions per environment to `out_path`. Pose error stands in for the
+// planner's CVaR forecast.
+void simulate_sweep_dataset(const nlohmann::json& environment, const std::string& out_path, int steps,
+                            int envs, uint64_t seed);
+
+struct SweepResult {
+    std::map<std::string, double> point;
+    double mean_power;
+    double violation_rate;
+    double cvar95_risk;
+    bool pareto;
+};
+
+// Trains one SACScheduler per grid point on the dataset and evaluates it.
+// Point i is seeded with seed + i. With one worker a sweep is reproducible;
+// with several, concurrent points draw their dropout masks from torch's
+// process-wide generator, so results can differ from run to run.
+class SweepRunner {
+public:
+    // Throws std::invalid_argument on an empty dataset.
+    SweepRunner(const SweepDataset& data, int train_steps, int eval_records, uint64_t seed);
+
+    // Axes: risk_threshold, violation_rate, lambda_{init,lr,min,max},
+    // energy_weight, safety_weight.
+    void add_axis(const std::string& name, const std::vector<double>& values);
+
+    // One thread per worker, each pinned to its own core.
+    std::vector<SweepResult> run(int num_workers) const;
+
+private:
+    const SweepDataset& data_;
+    int train_steps_;
+    int eval_records_;
+    uint64_t seed_;
+    std::vector<std::pair<std::string, std::vector<double>>> axes_;
+
+    SweepResult run_point(const std::map<std::string, double>& point, uint64_t seed) const;
+};
+
+// Marks the results no other result beats on both mean power and violation rate.
+void mark_pareto(std::vector<SweepResult>& results);
+
+} // namespace bcod
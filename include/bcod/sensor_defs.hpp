@@ -1,7 +1,11 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <vector>
 
 namespace bcod {
 
@@ -44,4 +48,50 @@ struct SensorConfig {
     };
 };
 
+constexpr int kNumSensors = static_cast<int>(SensorType::SENSOR_COUNT);
+
+inline uint32_t to_bitmask(const std::vector<bool>& mask) {
+    uint32_t bits = 0;
+    for (size_t i = 0; i < mask.size() && i < 32; ++i) {
+        if (mask[i]) bits |= (1u << i);
+    }
+    return bits;
+}
+
+inline double mask_power(uint32_t mask) {
+    double power = 0.0;
+    for (int i = 0; i < kNumSensors; ++i) {
+        if (mask & (1u << i)) power += SensorConfig::POWER_CONSUMPTION[i];
+    }
+    return power;
+}
+
+// Localisation information of a sensor subset, sum of 1 / sigma^2 over the
+// active sensors.
+inline double mask_information(uint32_t mask) {
+    double info = 0.0;
+    for (int i = 0; i < kNumSensors; ++i) {
+        if (mask & (1u << i)) {
+            info += 1.0 / (SensorConfig::MEASUREMENT_NOISE[i] * SensorConfig::MEASUREMENT_NOISE[i]);
+        }
+    }
+    return info;
+}
+
+// Risk of a mask that measures nothing. Kept finite because the library
+// builds with -ffast-math, which assumes infinities never occur, so costs
+// built from an infinite risk would not compare reliably.
+constexpr double kUnboundedRisk = 1e6;
+
+// Counterfactual risk model: rescales a CVaR forecast made under mask `from`
+// to mask `to`, assuming localisation error scales with 1 / sqrt(information).
+// Capped at kUnboundedRisk.
+inline double rescale_risk(double risk, uint32_t from, uint32_t to) {
+    const double info_from = mask_information(from);
+    const double info_to = mask_information(to);
+    if (info_to <= 0.0) return kUnboundedRisk;
+    if (info_from <= 0.0) return risk;
+    return std::min(kUnboundedRisk, risk * std::sqrt(info_from / info_to));
+}
+
 } // namespace bcod 
\ No newline at end of file
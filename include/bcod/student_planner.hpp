@@ -1,7 +1,7 @@
 #pragma once
 
-#include "belief_types.hpp"
 #include "json_config.hpp"
+#include "belief_rasteriser.hpp"
 #include <memory>
 #include <string>
 #include <Eigen/Dense>
@@ -18,6 +18,9 @@
 
 namespace bcod {
 
+class DistanceField;
+class MapStore;
+
 struct Trajectory {
     std::vector<Eigen::Vector3d> waypoints;  // x, y, yaw increments
     std::vector<double> log_variances;
@@ -30,13 +33,14 @@ struct Trajectory {
     bool is_valid;
     double total_length;
     double max_curvature;
-    double min_clearance;
+    double min_clearance;    // m to the nearest obstacle, infinity without a distance field
     std::vector<double> feature_vector;
 };
 
 struct PlanningContext {
     cv::Mat belief_image;      // 5-channel belief raster
-    cv::Mat semantic_map;      // Co-cropped map slice
+    cv::Mat semantic_map;      // Co-cropped map slice, or empty to crop it from the map store
+    RasterWindow map_window;   // Belief raster window the map store crop follows
     cv::Mat goal_mask;         // Binary goal mask
     std::vector<bool> active_sensors;
     Eigen::Vector3d current_pose;
@@ -50,6 +54,7 @@ struct PlanningContext {
     bool use_adaptive_horizon;
     int min_horizon;
     int max_horizon;
+    double goal_distance;      // m, 0 when unknown
     double safety_margin;
     double energy_weight;
     double risk_weight;
@@ -76,6 +81,14 @@ struct StudentParams {
     bool use_residual;
     bool use_attention;
     bool use_adaptive_horizon;
+    int min_horizon;                 // Adaptive horizon bounds in waypoints, 0 for 1 / trajectory_horizon
+    int max_horizon;
+    double waypoint_interval;        // s between waypoints, converts speed to waypoints for the horizon
+    bool skip_unimodal_attention;    // Bypass attention when the belief is concentrated
+    double unimodal_circ_var;        // Mass-weighted mean circ_var below which the belief counts as unimodal
+    double unimodal_logdet;          // ... and mass-weighted mean logdet_cov below which it does
+    int plan_cache_size;          // Plans kept for reuse on near-identical inputs, 0 disables
+    double plan_cache_tolerance;  // Quantisation step of the pooled inputs in the cache key
     std::string model_path;
     std::vector<int> encoder_channels;
     std::vector<int> decoder_channels;
@@ -85,12 +98,39 @@ struct StudentParams {
     std::vector<double> safety_weights;
 };
 
+// Fills cvar_95, variance summaries, length and curvature of a decoded
+// trajectory from its waypoints and log-variances.
+void compute_trajectory_metrics(Trajectory& traj, double cvar_percentile);
+
+// As above, and min_clearance from `field` with the waypoints laid out from
+// `start` (x, y, yaw).
+void compute_trajectory_metrics(Trajectory& traj, double cvar_percentile, const DistanceField& field,
+                                const Eigen::Vector3d& start);
+
+// Waypoints worth decoding: enough to cover the remaining distance to the
+// goal at full speed, clamped to [min_horizon, max_horizon] and never beyond
+// trajectory_horizon. The bounds come from the context when it asks for an
+// adaptive horizon, else from the params.
+int resolve_horizon(const StudentParams& params, const PlanningContext& context);
+
+// Whether the mass-weighted mean circular variance and covariance logdet of a
+// 5-channel belief raster are both below the unimodal_* thresholds, i.e. the
+// belief is concentrated and attention has nothing to mix.
+bool unimodal_belief(const StudentParams& params, const cv::Mat& belief);
+
+// Self-attention over one-token sequences, one per row of `features`: softmax
+// over the only key is 1, so this is the value and output projections alone.
+torch::Tensor attend_single_token(torch::nn::MultiheadAttention& attention, const torch::Tensor& features);
+
 class StudentPlanner {
 public:
     StudentPlanner(const StudentParams& params);
     ~StudentPlanner();
 
     Trajectory plan(const PlanningContext& context);
+    // Same results as plan() on each context in turn, but every context that
+    // misses the plan cache goes through one batched forward pass.
+    std::vector<Trajectory> plan_batch(const std::vector<PlanningContext>& contexts);
     void load_model(const std::string& path);
     void save_model(const std::string& path);
     void set_params(const StudentParams& params);
@@ -108,6 +148,11 @@ public:
     void set_feature_weights(const std::vector<double>& weights);
     void set_risk_weights(const std::vector<double>& weights);
     void set_safety_weights(const std::vector<double>& weights);
+    // Field used for min_clearance; the caller keeps it current between plans.
+    void set_distance_field(std::shared_ptr<const DistanceField> field);
+    // 3-channel map the semantic slice is cropped from, straight into the
+    // network input, whenever a context carries no semantic_map.
+    void set_map_store(std::shared_ptr<const MapStore> store);
     void set_debug(bool debug);
     void reset();
 
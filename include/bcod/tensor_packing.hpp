@@ -0,0 +1,71 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <torch/torch.h>
+#include <functional>
+#include <initializer_list>
+#include <vector>
+
+namespace bcod {
+
+// Per-channel affine applied while packing: out = in * scale + offset.
+struct ChannelTransform {
+    float scale = 1.0f;
+    float offset = 0.0f;
+};
+
+// Transposes an interleaved HWC image (height x width, `channels` channels)
+// into `channels` consecutive planes of height * width floats at `dst`. The
+// image may be any depth (non-float input is converted first) and need not be
+// continuous; an empty image writes zero planes. `transforms` is either null
+// or holds one entry per channel.
+void pack_planes(const cv::Mat& image, int height, int width, int channels, float* dst,
+                 const ChannelTransform* transforms = nullptr);
+
+// Network input stage shared by StudentPlanner and SACScheduler. The rasters
+// of one sample (e.g. belief, semantic map, goal mask) are written side by
+// side into a preallocated [1, C, H, W] tensor in a single pass, replacing
+// from_blob on HWC memory and the cat/permute copies that would fix it.
+class InputPacker {
+public:
+    using Rasters = std::initializer_list<std::reference_wrapper<const cv::Mat>>;
+
+    // `channels` lists the channel count of each raster, in packing order.
+    InputPacker(std::vector<int> channels, int height, int width);
+
+    // Packs into the shared buffer and returns it. The contents are only valid
+    // until the next call, so callers must not keep the tensor.
+    const torch::Tensor& pack(Rasters rasters);
+
+    // Packs into a newly allocated tensor the caller owns, e.g. for replay.
+    torch::Tensor pack_owned(Rasters rasters) const;
+
+    // Packs one sample of channels() * height() * width() floats at `dst`,
+    // e.g. one row of a [N, C, H, W] batch the caller owns.
+    void pack_sample(Rasters rasters, float* dst) const { pack_into(rasters, dst); }
+
+    // First plane of raster `index` in the shared buffer, for producers that
+    // write their planes in place after pack().
+    float* planes(size_t index);
+    // The same plane's offset in floats from the start of any packed sample.
+    size_t plane_offset(size_t index) const;
+
+    // One transform per packed channel, or empty for none.
+    void set_transforms(std::vector<ChannelTransform> transforms);
+
+    int channels() const { return total_channels_; }
+    int height() const { return height_; }
+    int width() const { return width_; }
+
+private:
+    std::vector<int> channels_;
+    int total_channels_;
+    int height_;
+    int width_;
+    std::vector<ChannelTransform> transforms_;
+    torch::Tensor buffer_;
+
+    void pack_into(Rasters rasters, float* dst) const;
+};
+
+} // namespace bcod
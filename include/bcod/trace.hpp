@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace bcod {
+
+enum class TraceEvent : uint32_t {
+    PLAN = 1,
+    SCHEDULE = 2,
+    UPDATE = 3
+};
+
+// One fixed-size telemetry sample. The meaning of `values` depends on the
+// event; trace_fields() lists the names in order, unused slots are zero.
+struct TraceRecord {
+    static constexpr int MAX_VALUES = 12;
+
+    int64_t wall_ns;
+    uint32_t event;
+    uint32_t mask;      // Sensor bitmask: active sensors (PLAN) or chosen mask (SCHEDULE, UPDATE)
+    float values[MAX_VALUES];
+};
+
+static_assert(sizeof(TraceRecord) == 64, "TraceRecord is a fixed 64-byte on-disk record");
+
+struct TraceFileHeader {
+    static constexpr char MAGIC[8] = {'B', 'C', 'O', 'D', 'T', 'R', 'C', '\0'};
+    static constexpr uint32_t VERSION = 1;
+
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+};
+
+inline double elapsed_ms(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+const char* trace_event_name(TraceEvent event);
+const std::vector<const char*>& trace_fields(TraceEvent event);
+
+// Binary telemetry sink for per-step numbers that are too frequent for the
+// text log. Records go through a large stdio buffer straight to disk and are
+// decoded offline with bcod_trace_decode.
+class Tracer {
+public:
+    static Tracer& instance();
+
+    void open(const std::string& path);
+    void close();
+
+    bool enabled() const {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    template<typename... Values>
+    void write(TraceEvent event, uint32_t mask, Values... values) {
+        static_assert(sizeof...(Values) <= TraceRecord::MAX_VALUES, "Too many trace values");
+        const float packed[] = {static_cast<float>(values)..., 0.0f};
+        write_values(event, mask, packed, sizeof...(Values));
+    }
+
+private:
+    Tracer() = default;
+    ~Tracer();
+
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+    void write_values(TraceEvent event, uint32_t mask, const float* values, int count);
+
+    std::mutex mutex_;
+    FILE* file_ = nullptr;
+    std::vector<char> buffer_;
+    std::atomic<bool> enabled_{false};
+};
+
+#ifndef BCOD_ENABLE_TRACE
+#define BCOD_ENABLE_TRACE 1
+#endif
+
+// Arguments are only evaluated while a trace file is open, and the whole site
+// is compiled out when BCOD_ENABLE_TRACE is 0.
+#define BCOD_TRACE(event, mask, ...) \
+    do { \
+        if constexpr (BCOD_ENABLE_TRACE != 0) { \
+            bcod::Tracer& bcod_tracer_ = bcod::Tracer::instance(); \
+            if (bcod_tracer_.enabled()) { \
+                bcod_tracer_.write(event, mask, __VA_ARGS__); \
+            } \
+        } \
+    } while (0)
+
+} // namespace bcod
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "belief_rasteriser.hpp"
+#include "environment.hpp"
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+namespace bcod {
+
+// K independent simulated lakes stepped in parallel, producing batched belief
+// rasters for scheduler training. Environments auto-reset when they finish;
+// the returned raster for a finished environment is the first observation of
+// its next episode. Each lake runs its own filter, applying one sensor at a
+// time from the lake's RNG stream; it does not use ParticleFilter or its
+// fused per-mask updates.
+class VectorEnv {
+public:
+    struct Params {
+        int num_envs;
+        int num_threads;
+        int num_particles;
+        uint64_t seed;
+        double initial_spread;      // Std-dev of the initial particle cloud (m)
+        double min_goal_distance;   // Lower bound on start-goal separation (m)
+        double goal_tolerance;
+        double goal_reward;
+        double collision_penalty;
+        double progress_weight;     // Reward per metre of progress towards the goal
+        double energy_weight;       // Penalty per joule of sensing energy
+        double error_weight;        // Penalty per metre of localisation error
+        double lost_threshold;      // Episode ends once the estimate drifts this far
+        BeliefRasteriser::Params rasteriser;
+        WorldParams world;
+    };
+
+    struct StepResult {
+        std::vector<float> belief;          // [K, 5, H, W], NCHW
+        std::vector<float> rewards;         // [K]
+        std::vector<uint8_t> dones;         // [K]
+        std::vector<double> energy;         // Sensing energy spent this step (J)
+        std::vector<double> warmup_energy;  // Portion spent on sensors still warming up (J)
+        std::vector<double> pose_error;     // |estimate - truth| (m)
+        std::vector<double> goal_distance;  // Estimated distance to goal (m)
+    };
+
+    explicit VectorEnv(const Params& params);
+    ~VectorEnv();
+
+    const StepResult& reset();
+    const StepResult& step(const std::vector<uint32_t>& sensor_masks);
+
+    int num_envs() const;
+    int raster_height() const;
+    int raster_width() const;
+    static constexpr int channels() { return 5; }
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+} // namespace bcod
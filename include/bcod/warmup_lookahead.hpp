@@ -0,0 +1,68 @@
+#pragma once
+
+#include "sensor_defs.hpp"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace bcod {
+
+// Just-in-time activation of slow sensors.
+//
+// Tracks how long each powered sensor still needs before it measures, and
+// given a per-waypoint risk forecast (Trajectory::risk_scores) rolls out a
+// batch of candidate schedules: every subset of the slow sensors the base
+// mask leaves off, switched on at every lead step of the horizon. Risk along
+// a schedule is the forecast rescaled (rescale_risk) from the sensors
+// measuring now to those measuring at each waypoint, power is drawn from
+// switch-on. Schedules with the fewest waypoints over the risk threshold
+// win, then the cheapest, so a sensor is switched on as late as still lets
+// it warm up in time. Only schedules starting now change the current mask;
+// later ones are revisited on the next tick.
+class WarmupLookahead {
+public:
+    struct Params {
+        double risk_threshold;
+        double energy_weight;
+        double safety_weight;
+        double power_budget;                    // W, schedules drawing more are skipped, 0 for none
+        int max_lead_steps;                     // Latest switch-on step considered, 0 for the whole horizon
+        std::vector<double> power_coefficients; // W per sensor, empty for SensorConfig::POWER_CONSUMPTION
+    };
+
+    struct Plan {
+        uint32_t mask;          // Sensors to power now
+        uint32_t preactivated;  // Of those, the ones added to the base mask
+        int lead_steps;         // Steps until the chosen extra sensors switch on, -1 for none
+        int violations;         // Waypoints over the risk threshold
+        double peak_risk;
+        double warmup_energy;   // J drawn by sensors that are not measuring yet
+        double cost;
+    };
+
+    explicit WarmupLookahead(const Params& params);
+
+    // Advances the warmup clocks by `elapsed` seconds during which `powered`
+    // was on. Sensors missing from `powered` cool down immediately.
+    void advance(uint32_t powered, double elapsed);
+
+    // `base_mask` is what the policy wants now, `risk_forecast[i]` the risk at
+    // waypoint i, reached (i + 1) * dt seconds from now, under the sensors
+    // measuring now. `lambda` weighs risk excess as in the mask search.
+    Plan plan(uint32_t base_mask, const std::vector<double>& risk_forecast, double dt, double lambda) const;
+
+    uint32_t powered() const { return powered_; }
+    uint32_t ready() const;  // Powered and warm
+    double warmup_left(SensorType sensor) const { return warmup_left_[static_cast<int>(sensor)]; }
+
+    void set_params(const Params& params);
+    void reset();
+
+private:
+    Params params_;
+    std::array<double, kNumSensors> power_{};
+    uint32_t powered_ = 0;
+    std::array<double, kNumSensors> warmup_left_{};  // s
+};
+
+} // namespace bcod
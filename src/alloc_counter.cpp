@@ -0,0 +1,42 @@
+// Built only with BCOD_COUNT_ALLOCATIONS. Replaces the global allocation
+// functions of the whole process to count heap allocations per thread, which
+// ScopedTimer attributes to the enclosing scope.
+#include <bcod/instrumentation.hpp>
+#include <cstdlib>
+#include <new>
+
+namespace {
+    thread_local uint64_t allocations = 0;
+
+    void* counted_alloc(std::size_t size) {
+        ++allocations;
+        if (size == 0) size = 1;
+        for (;;) {
+            if (void* p = std::malloc(size)) return p;
+            std::new_handler handler = std::get_new_handler();
+            if (!handler) throw std::bad_alloc();
+            handler();
+        }
+    }
+}
+
+namespace bcod {
+
+uint64_t thread_allocation_count() {
+    return allocations;
+}
+
+} // namespace bcod
+
+void* operator new(std::size_t size) { return counted_alloc(size); }
+void* operator new[](std::size_t size) { return counted_alloc(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try { return counted_alloc(size); } catch (...) { return nullptr; }
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try { return counted_alloc(size); } catch (...) { return nullptr; }
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
@@ -1,4 +1,5 @@
 #include <bcod/belief_rasteriser.hpp>
+#include <bcod/instrumentation.hpp>
 #include <Eigen/Eigenvalues>
 #include <opencv2/imgproc.hpp>
 #include <random>
@@ -13,6 +14,25 @@
 
 namespace bcod {
 
+namespace {
+    // Uniform read access to AoS and SoA particle sets for the templated passes.
+    struct ParticleVector {
+        const std::vector<Particle>& p;
+        size_t size() const { return p.size(); }
+        Eigen::Vector2d position(size_t i) const { return p[i].position; }
+        double yaw(size_t i) const { return p[i].yaw; }
+        double weight(size_t i) const { return p[i].weight; }
+    };
+
+    struct ParticleColumns {
+        const ParticleArrays& a;
+        size_t size() const { return a.size; }
+        Eigen::Vector2d position(size_t i) const { return {a.x[i], a.y[i]}; }
+        double yaw(size_t i) const { return a.yaw[i]; }
+        double weight(size_t i) const { return a.weight[i]; }
+    };
+}
+
 struct BeliefRasteriser::Impl {
     Params params;
     std::vector<double> normalization;
@@ -20,18 +40,19 @@ struct BeliefRasteriser::Impl {
     std::mutex mtx;
     Impl(const Params& p) : params(p), normalization(p.normalization), debug(false) {}
 
-    RasterWindow compute_window(const std::vector<Particle>& particles) const {
+    template<class Source>
+    RasterWindow compute_window(const Source& particles) const {
         Eigen::Vector2d mean = Eigen::Vector2d::Zero();
         double total_w = 0;
-        for (const auto& p : particles) {
-            mean += p.position * p.weight;
-            total_w += p.weight;
+        for (size_t i = 0; i < particles.size(); ++i) {
+            mean += particles.position(i) * particles.weight(i);
+            total_w += particles.weight(i);
         }
         if (total_w > 0) mean /= total_w;
         Eigen::Matrix2d cov = Eigen::Matrix2d::Zero();
-        for (const auto& p : particles) {
-            Eigen::Vector2d d = p.position - mean;
-            cov += p.weight * (d * d.transpose());
+        for (size_t i = 0; i < particles.size(); ++i) {
+            Eigen::Vector2d d = particles.position(i) - mean;
+            cov += particles.weight(i) * (d * d.transpose());
         }
         if (total_w > 0) cov /= total_w;
         Eigen::SelfAdjointEigenSolver<Eigen::Matrix2d> eig(cov);
@@ -40,12 +61,20 @@ struct BeliefRasteriser::Impl {
         double win_size = std::clamp(params.sigma_scale * max_eig, params.min_window, params.max_window);
         int grid_size = params.raster_H;
         double scale = win_size / grid_size;
-        double angle = std::atan2(eig.eigenvectors()(1,0), eig.eigenvectors()(0,0));
-        RasterWindow w{mean, win_size, grid_size, scale, eig.eigenvectors(), max_eig, min_eig, angle};
+        // Cells follow the principal axes only with align_axes; otherwise the
+        // axes are the identity, so the window always describes the cell grid.
+        Eigen::Matrix2d axes = Eigen::Matrix2d::Identity();
+        if (params.align_axes) {
+            axes = eig.eigenvectors();
+            if (axes.determinant() < 0) axes.col(1) = -axes.col(1);
+        }
+        double angle = std::atan2(axes(1,0), axes(0,0));
+        RasterWindow w{mean, win_size, grid_size, scale, axes, max_eig, min_eig, angle};
         return w;
     }
 
-    void fill_cells(const std::vector<Particle>& particles, RasterWindow& window, std::vector<RasterCell>& cells) const {
+    template<class Source>
+    void fill_cells(const Source& particles, RasterWindow& window, std::vector<RasterCell>& cells) const {
         int H = window.grid_size, W = window.grid_size;
         cells.resize(H*W);
         for (auto& c : cells) {
@@ -53,26 +82,29 @@ struct BeliefRasteriser::Impl {
             c.max_weight = -1e9; c.min_weight = 1e9; c.sum_yaw = 0; c.sum_yaw2 = 0;
             c.sum_x = 0; c.sum_y = 0; c.sum_x2 = 0; c.sum_y2 = 0; c.sum_xy = 0;
         }
-        for (const auto& p : particles) {
-            Eigen::Vector2d rel = p.position - window.center;
+        for (size_t i = 0; i < particles.size(); ++i) {
+            const Eigen::Vector2d position = particles.position(i);
+            const double yaw = particles.yaw(i);
+            const double weight = particles.weight(i);
+            Eigen::Vector2d rel = window.axes.transpose() * (position - window.center);
             int u = static_cast<int>(std::floor((rel.x() + window.size/2) / window.scale));
             int v = static_cast<int>(std::floor((rel.y() + window.size/2) / window.scale));
             if (u < 0 || u >= W || v < 0 || v >= H) continue;
             int idx = v*W + u;
             auto& c = cells[idx];
-            c.mass += p.weight;
-            c.mean_sin += std::sin(p.yaw) * p.weight;
-            c.mean_cos += std::cos(p.yaw) * p.weight;
+            c.mass += weight;
+            c.mean_sin += std::sin(yaw) * weight;
+            c.mean_cos += std::cos(yaw) * weight;
             c.count++;
-            c.max_weight = std::max(c.max_weight, p.weight);
-            c.min_weight = std::min(c.min_weight, p.weight);
-            c.sum_yaw += p.yaw * p.weight;
-            c.sum_yaw2 += p.yaw * p.yaw * p.weight;
-            c.sum_x += p.position.x() * p.weight;
-            c.sum_y += p.position.y() * p.weight;
-            c.sum_x2 += p.position.x()*p.position.x()*p.weight;
-            c.sum_y2 += p.position.y()*p.position.y()*p.weight;
-            c.sum_xy += p.position.x()*p.position.y()*p.weight;
+            c.max_weight = std::max(c.max_weight, weight);
+            c.min_weight = std::min(c.min_weight, weight);
+            c.sum_yaw += yaw * weight;
+            c.sum_yaw2 += yaw * yaw * weight;
+            c.sum_x += position.x() * weight;
+            c.sum_y += position.y() * weight;
+            c.sum_x2 += position.x()*position.x()*weight;
+            c.sum_y2 += position.y()*position.y()*weight;
+            c.sum_xy += position.x()*position.y()*weight;
         }
         for (auto& c : cells) {
             if (c.mass > 0) {
@@ -180,16 +212,19 @@ struct BeliefRasteriser::Impl {
     void set_mass_limits(double minm, double maxm) { }
     void set_debug(bool d) { debug = d; }
     void reset() {}
+
+    template<class Source>
+    BeliefRaster rasterise(const Source& particles);
 };
 
 BeliefRasteriser::BeliefRasteriser(const Params& params) : impl_(std::make_unique<Impl>(params)) {}
 BeliefRasteriser::~BeliefRasteriser() = default;
 
-BeliefRaster BeliefRasteriser::rasterise(const std::vector<Particle>& particles) {
-    std::lock_guard<std::mutex> lock(impl_->mtx);
-    RasterWindow window = impl_->compute_window(particles);
+template<class Source>
+BeliefRaster BeliefRasteriser::Impl::rasterise(const Source& particles) {
+    RasterWindow window = compute_window(particles);
     std::vector<RasterCell> cells;
-    impl_->fill_cells(particles, window, cells);
+    fill_cells(particles, window, cells);
     int H = window.grid_size, W = window.grid_size, C = 5;
     cv::Mat data(H, W, CV_32FC(C));
     for (int v = 0; v < H; ++v) {
@@ -204,16 +239,28 @@ BeliefRaster BeliefRasteriser::rasterise(const std::vector<Particle>& particles)
         }
     }
     BeliefRaster raster{data, window, cells, H, W, C, {0,0,0,0,0}, {}, {}};
-    if (impl_->params.normalize) impl_->normalize_raster(raster);
+    if (params.normalize) normalize_raster(raster);
     return raster;
 }
 
+BeliefRaster BeliefRasteriser::rasterise(const std::vector<Particle>& particles) {
+    BCOD_SCOPED_TIMER("rasteriser.rasterise");
+    std::lock_guard<std::mutex> lock(impl_->mtx);
+    return impl_->rasterise(ParticleVector{particles});
+}
+
+BeliefRaster BeliefRasteriser::rasterise(const ParticleArrays& particles) {
+    BCOD_SCOPED_TIMER("rasteriser.rasterise");
+    std::lock_guard<std::mutex> lock(impl_->mtx);
+    return impl_->rasterise(ParticleColumns{particles});
+}
+
 RasterWindow BeliefRasteriser::compute_window(const std::vector<Particle>& particles) const {
-    return impl_->compute_window(particles);
+    return impl_->compute_window(ParticleVector{particles});
 }
 
 void BeliefRasteriser::fill_cells(const std::vector<Particle>& particles, RasterWindow& window, std::vector<RasterCell>& cells) const {
-    impl_->fill_cells(particles, window, cells);
+    impl_->fill_cells(ParticleVector{particles}, window, cells);
 }
 
 void BeliefRasteriser::normalize_raster(BeliefRaster& raster) const {
@@ -256,4 +303,13 @@ void BeliefRasteriser::set_mass_limits(double minm, double maxm) { impl_->set_ma
 void BeliefRasteriser::set_debug(bool debug) { impl_->set_debug(debug); }
 void BeliefRasteriser::reset() { impl_->reset(); }
 
+void rasterise_goal(const RasterWindow& window, const Eigen::Vector2d& goal, cv::Mat& mask) {
+    mask.setTo(0.0f);
+    const Eigen::Vector2d rel = window.axes.transpose() * (goal - window.center);
+    const auto cell = [&](double r, int n) {
+        return std::clamp(static_cast<int>(std::floor((r + window.size / 2) / window.scale)), 0, n - 1);
+    };
+    mask.at<float>(cell(rel.y(), mask.rows), cell(rel.x(), mask.cols)) = 1.0f;
+}
+
 } // namespace bcod 
\ No newline at end of file
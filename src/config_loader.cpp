@@ -0,0 +1,277 @@
+#include <bcod/config_loader.hpp>
+#include <bcod/logging.hpp>
+#include <yaml-cpp/yaml.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+namespace bcod {
+
+namespace {
+    namespace fs = std::filesystem;
+
+    constexpr char CACHE_MAGIC[8] = {'B', 'C', 'O', 'D', 'C', 'F', 'G', '\0'};
+    constexpr uint32_t CACHE_VERSION = 1;
+
+    struct CacheHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t num_inputs;
+        uint64_t content_hash;
+        uint64_t payload_size;
+    };
+
+    std::string read_file(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            BCOD_ERROR("Failed to open config file: ", path);
+            throw std::runtime_error("Failed to open config file: " + path);
+        }
+        std::ostringstream text;
+        text << in.rdbuf();
+        return text.str();
+    }
+
+    // FNV-1a, 64 bit
+    uint64_t hash_bytes(uint64_t h, const void* data, size_t size) {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            h ^= bytes[i];
+            h *= 0x100000001b3ull;
+        }
+        return h;
+    }
+
+    constexpr uint64_t HASH_SEED = 0xcbf29ce484222325ull;
+
+    uint64_t hash_input(uint64_t h, const std::string& path, const std::string& text) {
+        const uint64_t sizes[2] = {path.size(), text.size()};
+        h = hash_bytes(h, sizes, sizeof(sizes));
+        h = hash_bytes(h, path.data(), path.size());
+        return hash_bytes(h, text.data(), text.size());
+    }
+
+    // Plain scalars are typed the way YAML 1.1 would read them; quoted ones
+    // stay strings.
+    nlohmann::json scalar_to_json(const YAML::Node& node) {
+        if (node.Tag() == "!") return node.Scalar();
+        bool b;
+        long long i;
+        double d;
+        if (YAML::convert<bool>::decode(node, b)) return b;
+        if (YAML::convert<long long>::decode(node, i)) return i;
+        if (YAML::convert<double>::decode(node, d)) return d;
+        return node.Scalar();
+    }
+
+    nlohmann::json yaml_to_json(const YAML::Node& node) {
+        switch (node.Type()) {
+            case YAML::NodeType::Scalar:
+                return scalar_to_json(node);
+            case YAML::NodeType::Sequence: {
+                nlohmann::json array = nlohmann::json::array();
+                for (const auto& item : node) array.push_back(yaml_to_json(item));
+                return array;
+            }
+            case YAML::NodeType::Map: {
+                nlohmann::json object = nlohmann::json::object();
+                for (const auto& kv : node) object[kv.first.as<std::string>()] = yaml_to_json(kv.second);
+                return object;
+            }
+            default:
+                return nullptr;
+        }
+    }
+
+    void flatten(const nlohmann::json& node, const std::string& prefix, nlohmann::json& out) {
+        if (!node.is_object() || node.empty()) {
+            out[prefix] = node;
+            return;
+        }
+        for (const auto& [key, value] : node.items()) {
+            flatten(value, prefix.empty() ? key : prefix + "." + key, out);
+        }
+    }
+
+    nlohmann::json parse_document(const std::string& path, const std::string& text) {
+        const std::string ext = fs::path(path).extension().string();
+        try {
+            if (ext == ".json") return nlohmann::json::parse(text);
+            return yaml_to_json(YAML::Load(text));
+        } catch (const std::exception& e) {
+            BCOD_ERROR("Failed to parse config file ", path, ": ", e.what());
+            throw std::runtime_error("Failed to parse config file: " + path);
+        }
+    }
+
+    // Depth-first walk of the import graph. Files reached twice through
+    // different parents are merged once, at their first position.
+    struct ImportGraph {
+        nlohmann::json merged = nlohmann::json::object();
+        std::vector<std::string> inputs;
+        std::vector<std::string> stack;
+        uint64_t hash = HASH_SEED;
+
+        void load(const fs::path& file) {
+            const std::string path = fs::weakly_canonical(file).string();
+            if (std::find(stack.begin(), stack.end(), path) != stack.end()) {
+                BCOD_ERROR("Config import cycle through ", path);
+                throw std::runtime_error("Config import cycle through " + path);
+            }
+            if (std::find(inputs.begin(), inputs.end(), path) != inputs.end()) return;
+            stack.push_back(path);
+
+            const std::string text = read_file(path);
+            nlohmann::json doc = parse_document(path, text);
+            if (doc.is_null()) doc = nlohmann::json::object();
+            if (!doc.is_object()) {
+                BCOD_ERROR("Config file ", path, " must contain a mapping at the top level");
+                throw std::runtime_error("Config root is not a mapping: " + path);
+            }
+
+            if (doc.contains("imports")) {
+                const nlohmann::json imports = doc["imports"];
+                doc.erase("imports");
+                if (!imports.is_array()) {
+                    BCOD_ERROR("imports in ", path, " must be a list of paths");
+                    throw std::runtime_error("imports must be a list: " + path);
+                }
+                for (const auto& import : imports) {
+                    if (!import.is_string()) {
+                        BCOD_ERROR("imports in ", path, " must be a list of paths");
+                        throw std::runtime_error("imports must be a list of paths: " + path);
+                    }
+                    const fs::path target = fs::path(path).parent_path() / import.get<std::string>();
+                    if (!fs::exists(target)) {
+                        BCOD_ERROR("Config ", path, " imports missing file ", target.string());
+                        throw std::runtime_error("Missing config import: " + target.string());
+                    }
+                    load(target);
+                }
+            }
+
+            flatten(doc, "", merged);
+            inputs.push_back(path);
+            hash = hash_input(hash, path, text);
+            stack.pop_back();
+        }
+    };
+
+    std::optional<LoadedConfig> read_cache(const std::string& cache_path, const std::string& root) {
+        std::ifstream in(cache_path, std::ios::binary);
+        if (!in) return std::nullopt;
+
+        CacheHeader header;
+        if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+            std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 ||
+            header.version != CACHE_VERSION) {
+            BCOD_WARN("Ignoring unreadable config cache ", cache_path);
+            return std::nullopt;
+        }
+
+        std::vector<std::string> inputs(header.num_inputs);
+        for (auto& input : inputs) {
+            uint32_t length = 0;
+            in.read(reinterpret_cast<char*>(&length), sizeof(length));
+            input.resize(length);
+            in.read(input.data(), length);
+        }
+        if (!in || inputs.empty() || inputs.back() != root) return std::nullopt;
+        for (const auto& input : inputs) {
+            if (!fs::exists(input)) return std::nullopt;
+        }
+
+        uint64_t hash;
+        try {
+            hash = hash_config_inputs(inputs);
+        } catch (const std::exception&) {
+            return std::nullopt;
+        }
+        if (hash != header.content_hash) return std::nullopt;
+
+        std::vector<uint8_t> payload(header.payload_size);
+        if (!in.read(reinterpret_cast<char*>(payload.data()), payload.size())) return std::nullopt;
+
+        nlohmann::json merged;
+        try {
+            merged = nlohmann::json::from_msgpack(payload);
+        } catch (const nlohmann::json::exception& e) {
+            BCOD_WARN("Ignoring corrupt config cache ", cache_path, ": ", e.what());
+            return std::nullopt;
+        }
+        return LoadedConfig{JsonConfig::from_json(std::move(merged)), std::move(inputs), hash, true};
+    }
+
+    // Written to a temporary file and renamed, so a concurrent reader sees
+    // either the old cache or the new one.
+    void write_cache(const std::string& cache_path, const LoadedConfig& loaded) {
+        const std::vector<uint8_t> payload = nlohmann::json::to_msgpack(loaded.config.data());
+        const std::string tmp = cache_path + ".tmp";
+        {
+            std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+            if (!out) {
+                BCOD_WARN("Cannot write config cache ", cache_path);
+                return;
+            }
+            CacheHeader header{};
+            std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+            header.version = CACHE_VERSION;
+            header.num_inputs = static_cast<uint32_t>(loaded.inputs.size());
+            header.content_hash = loaded.content_hash;
+            header.payload_size = payload.size();
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            for (const auto& input : loaded.inputs) {
+                const auto length = static_cast<uint32_t>(input.size());
+                out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+                out.write(input.data(), length);
+            }
+            out.write(reinterpret_cast<const char*>(payload.data()), payload.size());
+            if (!out) {
+                BCOD_WARN("Failed writing config cache ", cache_path);
+                std::remove(tmp.c_str());
+                return;
+            }
+        }
+        std::error_code ec;
+        fs::rename(tmp, cache_path, ec);
+        if (ec) {
+            BCOD_WARN("Failed to install config cache ", cache_path, ": ", ec.message());
+            std::remove(tmp.c_str());
+        }
+    }
+}
+
+uint64_t hash_config_inputs(const std::vector<std::string>& inputs) {
+    uint64_t hash = HASH_SEED;
+    for (const auto& path : inputs) hash = hash_input(hash, path, read_file(path));
+    return hash;
+}
+
+nlohmann::json load_config_document(const std::string& path) {
+    return parse_document(path, read_file(path));
+}
+
+LoadedConfig load_config(const std::string& path, const std::string& cache_path) {
+    const std::string cache = cache_path.empty() ? path + ".cache" : cache_path;
+    const std::string root = fs::weakly_canonical(path).string();
+
+    if (auto cached = read_cache(cache, root)) {
+        BCOD_DEBUG("Loaded config ", path, " from cache ", cache);
+        return std::move(*cached);
+    }
+
+    ImportGraph graph;
+    graph.load(path);
+    LoadedConfig loaded{JsonConfig::from_json(std::move(graph.merged)), std::move(graph.inputs), graph.hash, false};
+    write_cache(cache, loaded);
+    BCOD_INFO("Loaded config ", path, " from ", loaded.inputs.size(), " file(s)");
+    return loaded;
+}
+
+} // namespace bcod
@@ -0,0 +1,291 @@
+#include <bcod/config_snapshot.hpp>
+#include <bcod/logging.hpp>
+#include <bcod/sensor_defs.hpp>
+#include <stdexcept>
+#include <system_error>
+
+namespace bcod {
+
+namespace {
+    template<typename T>
+    T read(const JsonConfig& config, const std::string& key, const T& fallback) {
+        try {
+            return config.get<T>(key, fallback);
+        } catch (const nlohmann::json::exception& e) {
+            BCOD_ERROR("Config key ", key, " has the wrong type: ", e.what());
+            throw std::invalid_argument("Config key has the wrong type: " + key);
+        }
+    }
+
+    template<typename T>
+    std::vector<T> read_array(const JsonConfig& config, const std::string& key, const std::vector<T>& fallback) {
+        if (!config.has(key)) return fallback;
+        try {
+            return config.get_array<T>(key);
+        } catch (const nlohmann::json::exception& e) {
+            BCOD_ERROR("Config key ", key, " has the wrong type: ", e.what());
+            throw std::invalid_argument("Config key has the wrong type: " + key);
+        }
+    }
+
+    void require(bool valid, const std::string& key, const char* constraint) {
+        if (!valid) {
+            BCOD_ERROR("Config key ", key, " must be ", constraint);
+            throw std::invalid_argument("Invalid value for config key: " + key);
+        }
+    }
+
+    bool same_shape(const ConfigSnapshot& a, const ConfigSnapshot& b) {
+        return a.student.input_channels == b.student.input_channels &&
+               a.student.hidden_dim == b.student.hidden_dim &&
+               a.student.num_layers == b.student.num_layers &&
+               a.student.num_heads == b.student.num_heads &&
+               a.student.trajectory_horizon == b.student.trajectory_horizon &&
+               a.scheduler.belief_dim == b.scheduler.belief_dim &&
+               a.scheduler.hidden_dim == b.scheduler.hidden_dim &&
+               a.scheduler.num_layers == b.scheduler.num_layers &&
+               a.scheduler.share_encoder == b.scheduler.share_encoder &&
+               a.scheduler.power_coefficients.size() == b.scheduler.power_coefficients.size();
+    }
+
+    bool same_profiling(const ProfilingParams& a, const ProfilingParams& b) {
+        return a.enabled == b.enabled && a.interval_ms == b.interval_ms && a.output == b.output &&
+               a.monitor_process == b.monitor_process;
+    }
+
+    std::filesystem::file_time_type modification_time(const std::string& path) {
+        std::error_code ec;
+        const auto t = std::filesystem::last_write_time(path, ec);
+        return ec ? std::filesystem::file_time_type::min() : t;
+    }
+}
+
+RasteriserParams compile_rasteriser_params(const JsonConfig& config) {
+    RasteriserParams p{};
+    p.resolution = read(config, "rasteriser.resolution", 0.1);
+    p.max_range = read(config, "rasteriser.max_range", 10.0);
+    p.min_weight = read(config, "rasteriser.min_weight", 0.01);
+    p.origin_x = read(config, "rasteriser.origin_x", 0.0);
+    p.origin_y = read(config, "rasteriser.origin_y", 0.0);
+
+    require(p.resolution > 0.0, "rasteriser.resolution", "positive");
+    require(p.max_range > 0.0, "rasteriser.max_range", "positive");
+    require(p.min_weight >= 0.0, "rasteriser.min_weight", "non-negative");
+    return p;
+}
+
+StudentParams compile_student_params(const JsonConfig& config) {
+    StudentParams p{};
+    p.input_channels = read(config, "planner.input_channels", 9);  // belief, semantic map, goal mask
+    p.hidden_dim = read(config, "planner.hidden_dim", 256);
+    p.num_layers = read(config, "planner.num_layers", 4);
+    p.num_heads = read(config, "planner.num_heads", 4);
+    p.trajectory_horizon = read(config, "planner.sequence_length", 50);
+    p.dropout_rate = read(config, "planner.dropout_rate", 0.1);
+    p.learning_rate = read(config, "planner.learning_rate", 0.001);
+    p.weight_decay = read(config, "planner.weight_decay", 0.0001);
+    p.kl_weight = read(config, "planner.kl_weight", 1.0);
+    p.kl_ramp_steps = read(config, "planner.kl_ramp_steps", 10000.0);
+    p.min_kl_weight = read(config, "planner.min_kl_weight", 0.0);
+    p.max_kl_weight = read(config, "planner.max_kl_weight", 1.0);
+    p.cvar_percentile = read(config, "planner.cvar_percentile", 0.95);
+    p.risk_threshold = read(config, "planner.risk_threshold", 0.1);
+    p.safety_margin = read(config, "planner.safety_margin", 0.5);
+    p.use_layer_norm = read(config, "planner.use_layer_norm", true);
+    p.use_residual = read(config, "planner.use_residual", true);
+    p.use_attention = read(config, "planner.use_attention", true);
+    p.use_adaptive_horizon = read(config, "planner.use_adaptive_horizon", false);
+    p.min_horizon = read(config, "planner.min_horizon", 0);
+    p.max_horizon = read(config, "planner.max_horizon", 0);
+    p.waypoint_interval = read(config, "planner.waypoint_interval", 0.1);
+    p.skip_unimodal_attention = read(config, "planner.skip_unimodal_attention", false);
+    p.unimodal_circ_var = read(config, "planner.unimodal_circ_var", 0.05);
+    p.unimodal_logdet = read(config, "planner.unimodal_logdet", -2.0);
+    p.plan_cache_size = read(config, "planner.plan_cache_size", 0);
+    p.plan_cache_tolerance = read(config, "planner.plan_cache_tolerance", 0.02);
+    p.model_path = read(config, "planner.model_path", std::string());
+    p.feature_weights = read_array<double>(config, "planner.feature_weights", {});
+    p.risk_weights = read_array<double>(config, "planner.risk_weights", {});
+    p.safety_weights = read_array<double>(config, "planner.safety_weights", {});
+
+    require(p.input_channels > 0, "planner.input_channels", "positive");
+    require(p.hidden_dim > 0, "planner.hidden_dim", "positive");
+    require(p.num_heads > 0 && p.hidden_dim % p.num_heads == 0, "planner.num_heads", "a positive divisor of planner.hidden_dim");
+    require(p.trajectory_horizon > 0, "planner.sequence_length", "positive");
+    require(p.min_horizon >= 0 && p.min_horizon <= p.trajectory_horizon, "planner.min_horizon",
+            "in [0, planner.sequence_length]");
+    require(p.max_horizon >= 0 && p.max_horizon <= p.trajectory_horizon, "planner.max_horizon",
+            "in [0, planner.sequence_length]");
+    require(p.waypoint_interval > 0.0, "planner.waypoint_interval", "positive");
+    require(p.plan_cache_size >= 0, "planner.plan_cache_size", "non-negative");
+    require(p.plan_cache_tolerance > 0.0, "planner.plan_cache_tolerance", "positive");
+    require(p.dropout_rate >= 0.0 && p.dropout_rate < 1.0, "planner.dropout_rate", "in [0, 1)");
+    require(p.cvar_percentile > 0.0 && p.cvar_percentile < 1.0, "planner.cvar_percentile", "in (0, 1)");
+    require(p.min_kl_weight <= p.max_kl_weight, "planner.min_kl_weight", "at most planner.max_kl_weight");
+    return p;
+}
+
+SchedulerParams compile_scheduler_params(const JsonConfig& config) {
+    SchedulerParams p{};
+    p.belief_dim = read(config, "scheduler.observation_dim", 64);
+    p.hidden_dim = read(config, "scheduler.hidden_dim", 256);
+    p.num_layers = read(config, "scheduler.num_layers", 3);
+    p.num_heads = read(config, "scheduler.num_heads", 4);
+    p.dropout_rate = read(config, "scheduler.dropout_rate", 0.1);
+    p.use_layer_norm = read(config, "scheduler.use_layer_norm", true);
+
+    p.learning_rate = read(config, "scheduler.learning_rate", 0.001);
+    p.weight_decay = read(config, "scheduler.weight_decay", 0.0001);
+    p.temperature = read(config, "scheduler.temperature", 0.1);
+    p.target_entropy = read(config, "scheduler.target_entropy", -static_cast<double>(kNumSensors));
+    p.tau = read(config, "scheduler.tau", 0.005);
+    p.discount_factor = read(config, "scheduler.discount_factor", 0.99);
+    p.batch_size = read(config, "scheduler.batch_size", 256);
+    p.buffer_size = read(config, "scheduler.buffer_size", 1000000);
+    p.update_interval = read(config, "scheduler.update_interval", 1);
+    p.target_update_interval = read(config, "scheduler.target_update_interval", 1);
+    p.warmup_steps = read(config, "scheduler.warmup_steps", 1000);
+    p.max_steps = read(config, "scheduler.max_steps", 100000);
+
+    p.risk_threshold = read(config, "scheduler.target_risk", 0.05);
+    p.violation_rate = read(config, "scheduler.violation_rate", 0.05);
+    p.lambda_init = read(config, "scheduler.lambda", 0.1);
+    p.lambda_lr = read(config, "scheduler.lambda_lr", 0.001);
+    p.lambda_min = read(config, "scheduler.lambda_min", 0.0);
+    p.lambda_max = read(config, "scheduler.lambda_max", 10.0);
+    p.energy_weight = read(config, "scheduler.energy_weight", 0.3);
+    p.safety_weight = read(config, "scheduler.safety_weight", 0.7);
+    p.goal_weight = read(config, "scheduler.goal_weight", 0.0);
+
+    p.use_mask_search = read(config, "scheduler.mask_search", false);
+    p.power_budget = read(config, "scheduler.power_budget", 1e9);
+    p.share_encoder = read(config, "scheduler.share_encoder", false);
+    p.use_lookahead = read(config, "scheduler.lookahead", false);
+    p.lookahead_max_lead = read(config, "scheduler.lookahead_max_lead", 0);
+    require(p.lookahead_max_lead >= 0, "scheduler.lookahead_max_lead", "non-negative");
+
+    const std::vector<double> default_power(SensorConfig::POWER_CONSUMPTION.begin(),
+                                            SensorConfig::POWER_CONSUMPTION.end());
+    p.power_coefficients = read_array<double>(config, "scheduler.power_coefficients", default_power);
+    p.uncertainty_coefficients = read_array<double>(config, "scheduler.uncertainty_coefficients", {});
+    p.feature_weights = read_array<double>(config, "scheduler.feature_weights", {});
+    p.risk_weights = read_array<double>(config, "scheduler.risk_weights", {});
+    p.safety_weights = read_array<double>(config, "scheduler.safety_weights", {});
+
+    p.device = read(config, "scheduler.device", std::string("cpu"));
+    p.num_threads = read(config, "scheduler.num_threads", 1);
+    p.inference_only = read(config, "scheduler.inference_only", false);
+    p.policy_path = read(config, "scheduler.policy_path", std::string());
+    p.log_level = read(config, "scheduler.log_level", std::string("info"));
+    p.log_file = read(config, "scheduler.log_file", std::string());
+
+    const int action_dim = read(config, "scheduler.action_dim", kNumSensors);
+    require(action_dim == kNumSensors, "scheduler.action_dim", "the number of sensors");
+    require(static_cast<int>(p.power_coefficients.size()) == kNumSensors,
+            "scheduler.power_coefficients", "one entry per sensor");
+    require(p.belief_dim > 0, "scheduler.observation_dim", "positive");
+    require(p.hidden_dim > 0, "scheduler.hidden_dim", "positive");
+    require(p.batch_size > 0, "scheduler.batch_size", "positive");
+    require(p.buffer_size >= p.batch_size, "scheduler.buffer_size", "at least scheduler.batch_size");
+    require(p.tau > 0.0 && p.tau <= 1.0, "scheduler.tau", "in (0, 1]");
+    require(p.discount_factor >= 0.0 && p.discount_factor < 1.0, "scheduler.discount_factor", "in [0, 1)");
+    require(p.temperature > 0.0, "scheduler.temperature", "positive");
+    require(p.lambda_min <= p.lambda_init && p.lambda_init <= p.lambda_max,
+            "scheduler.lambda", "within [scheduler.lambda_min, scheduler.lambda_max]");
+    require(p.num_threads > 0, "scheduler.num_threads", "positive");
+    require(!p.inference_only || !p.policy_path.empty(), "scheduler.policy_path", "set when scheduler.inference_only is true");
+    return p;
+}
+
+ProfilingParams compile_profiling_params(const JsonConfig& config) {
+    ProfilingParams p{};
+    p.enabled = read(config, "performance.profiling.enabled", false);
+    p.interval_ms = read(config, "performance.profiling.interval", 1000);
+    p.output = read(config, "performance.profiling.output", std::string("profiles/"));
+    p.monitor_process = read(config, "performance.monitoring.enabled", false);
+
+    require(p.interval_ms > 0, "performance.profiling.interval", "positive");
+    return p;
+}
+
+std::shared_ptr<const ConfigSnapshot> compile_config(const JsonConfig& config, uint64_t version) {
+    auto snapshot = std::make_shared<ConfigSnapshot>();
+    snapshot->version = version;
+    snapshot->rasteriser = compile_rasteriser_params(config);
+    snapshot->student = compile_student_params(config);
+    snapshot->scheduler = compile_scheduler_params(config);
+    snapshot->profiling = compile_profiling_params(config);
+    return snapshot;
+}
+
+ConfigStore::ConfigStore(const std::string& path, const std::string& cache_path)
+    : path_(path), cache_path_(cache_path) {
+    LoadedConfig loaded = load_config(path_, cache_path_);
+    publish(compile_config(loaded.config, 1));
+    track(std::move(loaded.inputs));
+}
+
+std::shared_ptr<const ConfigSnapshot> ConfigStore::current() const {
+    return std::atomic_load_explicit(&snapshot_, std::memory_order_acquire);
+}
+
+bool ConfigStore::reload() {
+    std::lock_guard<std::mutex> lock(reload_mutex_);
+    std::shared_ptr<const ConfigSnapshot> next;
+    std::vector<std::string> inputs;
+    try {
+        LoadedConfig loaded = load_config(path_, cache_path_);
+        next = compile_config(loaded.config, version() + 1);
+        inputs = std::move(loaded.inputs);
+    } catch (const std::exception& e) {
+        BCOD_ERROR("Config reload from ", path_, " failed, keeping version ", version(), ": ", e.what());
+        return false;
+    }
+    track(std::move(inputs));
+
+    if (!same_shape(*current(), *next)) {
+        BCOD_ERROR("Config reload from ", path_, " changes network shapes, keeping version ", version());
+        return false;
+    }
+    publish(std::move(next));
+    BCOD_INFO("Config reloaded from ", path_, " as version ", version());
+    return true;
+}
+
+bool ConfigStore::reload_if_changed() {
+    {
+        std::lock_guard<std::mutex> lock(reload_mutex_);
+        bool changed = false;
+        for (size_t i = 0; i < inputs_.size() && !changed; ++i) {
+            changed = modification_time(inputs_[i]) != loaded_mtimes_[i];
+        }
+        if (!changed) return false;
+    }
+    return reload();
+}
+
+void ConfigStore::track(std::vector<std::string> inputs) {
+    inputs_ = std::move(inputs);
+    loaded_mtimes_.clear();
+    for (const auto& input : inputs_) loaded_mtimes_.push_back(modification_time(input));
+}
+
+void ConfigStore::publish(std::shared_ptr<const ConfigSnapshot> snapshot) {
+    // Instrumentation is process-wide; only touch it when the config changes
+    // what it asks for, so a reload does not restart the profile file.
+    const auto previous = current();
+    const ProfilingParams& profiling = snapshot->profiling;
+    if (previous ? !same_profiling(previous->profiling, profiling) : profiling.enabled || profiling.monitor_process) {
+        try {
+            Instrumentation::instance().configure(profiling);
+        } catch (const std::exception& e) {
+            BCOD_ERROR("Failed to apply profiling settings from ", path_, ": ", e.what());
+        }
+    }
+
+    const uint64_t v = snapshot->version;
+    std::atomic_store_explicit(&snapshot_, std::move(snapshot), std::memory_order_release);
+    version_.store(v, std::memory_order_release);
+}
+
+} // namespace bcod
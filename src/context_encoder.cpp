@@ -1,5 +1,8 @@
 #include "bcod/context_encoder.hpp"
 #include "bcod/logging.hpp"
+#include "bcod/instrumentation.hpp"
+#include <algorithm>
+#include <cmath>
 #include <fstream>
 #include <cstring>
 
@@ -45,6 +48,7 @@ ContextEncoder::~ContextEncoder() = default;
 void ContextEncoder::encode(const BeliefRaster& raster,
                           const Eigen::Vector2d& goal,
                           std::vector<float>& context) const {
+    BCOD_SCOPED_TIMER("context_encoder.encode");
     const int input_size = BeliefRaster::WIDTH * BeliefRaster::HEIGHT * 
                           BeliefRaster::CHANNELS + 2;
     const int output_size = pimpl_->hidden_dim_;
@@ -66,49 +70,47 @@ void ContextEncoder::encode(const BeliefRaster& raster,
     context.resize(output_size);
     std::fill(context.begin(), context.end(), 0.0f);
     
+    // Layer l maps input_dim -> output_size; the first layer sees the raster,
+    // later ones the previous layer's output.
+    const float* layer_weights = pimpl_->weights_.data();
+    int input_dim = input_size;
     for (int layer = 0; layer < pimpl_->num_layers_; ++layer) {
-        const float* layer_weights = pimpl_->weights_.data() + 
-            layer * (input_size * output_size + 2 * output_size);
-            
-        const float* gamma = layer_weights + input_size * output_size;
+        const float* gamma = layer_weights + input_dim * output_size;
         const float* beta = gamma + output_size;
         
-        apply_film(input.data(), gamma, beta, context.data(),
+        apply_film(input.data(), input_dim, layer_weights, gamma, beta, context.data(),
                  1, output_size);
                  
         input = context;
+        layer_weights = beta + output_size;
+        input_dim = output_size;
     }
 }
 
 void ContextEncoder::apply_film(const float* input,
+                              int input_dim,
+                              const float* weights,
                               const float* gamma,
                               const float* beta,
                               float* output,
                               int batch_size,
                               int channels) const {
     for (int b = 0; b < batch_size; ++b) {
+        const float* x = input + b * input_dim;
         for (int c = 0; c < channels; ++c) {
             float sum = 0.0f;
-            for (int i = 0; i < BeliefRaster::WIDTH * BeliefRaster::HEIGHT * 
-                            BeliefRaster::CHANNELS + 2; ++i) {
-                sum += input[b * (BeliefRaster::WIDTH * BeliefRaster::HEIGHT * 
-                                BeliefRaster::CHANNELS + 2) + i] *
-                       gamma[c * (BeliefRaster::WIDTH * BeliefRaster::HEIGHT * 
-                                BeliefRaster::CHANNELS + 2) + i];
+            for (int i = 0; i < input_dim; ++i) {
+                sum += x[i] * weights[c * input_dim + i];
             }
             
             if (pimpl_->use_layer_norm_) {
-                float mean = sum / (BeliefRaster::WIDTH * BeliefRaster::HEIGHT * 
-                                  BeliefRaster::CHANNELS + 2);
+                float mean = sum / input_dim;
                 float var = 0.0f;
-                for (int i = 0; i < BeliefRaster::WIDTH * BeliefRaster::HEIGHT * 
-                                BeliefRaster::CHANNELS + 2; ++i) {
-                    float diff = input[b * (BeliefRaster::WIDTH * BeliefRaster::HEIGHT * 
-                                          BeliefRaster::CHANNELS + 2) + i] - mean;
+                for (int i = 0; i < input_dim; ++i) {
+                    float diff = x[i] - mean;
                     var += diff * diff;
                 }
-                var /= (BeliefRaster::WIDTH * BeliefRaster::HEIGHT * 
-                       BeliefRaster::CHANNELS + 2);
+                var /= input_dim;
                 
                 output[b * channels + c] = (sum - mean) / std::sqrt(var + 1e-5f) *
                                          gamma[c] + beta[c];
@@ -119,4 +121,4 @@ void ContextEncoder::apply_film(const float* input,
     }
 }
 
-} // namespace bcod 
\ No newline at end of file
+} // namespace bcod
@@ -0,0 +1,212 @@
+#include <bcod/distance_field.hpp>
+#include <bcod/instrumentation.hpp>
+#include <bcod/logging.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace bcod {
+
+namespace {
+    constexpr double kUnreached = 1e20;
+
+    // Axis-aligned bounds of an obstacle's footprint at time t.
+    void bounds(const Obstacle& o, double t, Eigen::Vector2d& lo, Eigen::Vector2d& hi) {
+        switch (o.shape) {
+            case ObstacleShape::CIRCLE:
+                lo = o.center.array() - o.radius;
+                hi = o.center.array() + o.radius;
+                break;
+            case ObstacleShape::RECTANGLE:
+                lo = o.center - o.size / 2.0;
+                hi = o.center + o.size / 2.0;
+                break;
+            case ObstacleShape::POLYGON:
+                lo = hi = o.vertices.empty() ? o.center : o.vertices.front();
+                for (const auto& v : o.vertices) {
+                    lo = lo.cwiseMin(v);
+                    hi = hi.cwiseMax(v);
+                }
+                break;
+        }
+        if (o.dynamic) {
+            lo += o.velocity * t;
+            hi += o.velocity * t;
+        }
+    }
+
+    // Felzenszwalb-Huttenlocher lower envelope of parabolas: d[q] becomes
+    // min over p of (q - p)^2 + f[p], exactly, in O(n).
+    void edt_1d(const double* f, int n, double* d, int* v, double* z) {
+        int k = 0;
+        v[0] = 0;
+        z[0] = -kUnreached;
+        z[1] = kUnreached;
+        for (int q = 1; q < n; ++q) {
+            double s = ((f[q] + double(q) * q) - (f[v[k]] + double(v[k]) * v[k])) / (2.0 * (q - v[k]));
+            while (s <= z[k]) {
+                --k;
+                s = ((f[q] + double(q) * q) - (f[v[k]] + double(v[k]) * v[k])) / (2.0 * (q - v[k]));
+            }
+            ++k;
+            v[k] = q;
+            z[k] = s;
+            z[k + 1] = kUnreached;
+        }
+        k = 0;
+        for (int q = 0; q < n; ++q) {
+            while (z[k + 1] < q) ++k;
+            const double dq = q - v[k];
+            d[q] = dq * dq + f[v[k]];
+        }
+    }
+
+    // Squared distance in cells from every cell to the nearest cell where
+    // `seed` is true, separably over columns then rows.
+    std::vector<double> squared_edt(const std::vector<char>& seed, int width, int height) {
+        std::vector<double> grid(seed.size());
+        for (size_t i = 0; i < seed.size(); ++i) grid[i] = seed[i] ? 0.0 : kUnreached;
+
+        const int n = std::max(width, height);
+        std::vector<double> f(n), d(n), z(n + 1);
+        std::vector<int> v(n);
+        for (int x = 0; x < width; ++x) {
+            for (int y = 0; y < height; ++y) f[y] = grid[static_cast<size_t>(y) * width + x];
+            edt_1d(f.data(), height, d.data(), v.data(), z.data());
+            for (int y = 0; y < height; ++y) grid[static_cast<size_t>(y) * width + x] = d[y];
+        }
+        for (int y = 0; y < height; ++y) {
+            double* row = grid.data() + static_cast<size_t>(y) * width;
+            std::copy(row, row + width, f.begin());
+            edt_1d(f.data(), width, row, v.data(), z.data());
+        }
+        return grid;
+    }
+}
+
+DistanceField::DistanceField(const WorldParams& world, double dynamic_radius)
+    : origin_(world.origin), resolution_(world.resolution), dynamic_radius_(dynamic_radius) {
+    if (!(resolution_ > 0.0) || !(world.size.x() > 0.0) || !(world.size.y() > 0.0) || !(dynamic_radius_ > 0.0)) {
+        BCOD_ERROR("Invalid distance field: size ", world.size.x(), "x", world.size.y(), ", resolution ",
+                   resolution_, ", dynamic radius ", dynamic_radius_);
+        throw std::invalid_argument("Distance field needs a positive world size, resolution and dynamic radius");
+    }
+    BCOD_SCOPED_TIMER("distance_field.build");
+    width_ = std::max(1, static_cast<int>(std::ceil(world.size.x() / resolution_ - 1e-9)));
+    height_ = std::max(1, static_cast<int>(std::ceil(world.size.y() / resolution_ - 1e-9)));
+    const size_t cells = static_cast<size_t>(width_) * height_;
+
+    // Occupancy of the static obstacles, testing only cells inside each one's bounds.
+    std::vector<char> occupied(cells, 0);
+    bool any = false;
+    for (const auto& o : world.obstacles) {
+        if (o.dynamic) {
+            dynamic_.push_back(o);
+            continue;
+        }
+        Eigen::Vector2d lo, hi;
+        bounds(o, 0.0, lo, hi);
+        const int x0 = std::max(0, static_cast<int>(std::floor((lo.x() - origin_.x()) / resolution_)));
+        const int y0 = std::max(0, static_cast<int>(std::floor((lo.y() - origin_.y()) / resolution_)));
+        const int x1 = std::min(width_, static_cast<int>(std::ceil((hi.x() - origin_.x()) / resolution_)) + 1);
+        const int y1 = std::min(height_, static_cast<int>(std::ceil((hi.y() - origin_.y()) / resolution_)) + 1);
+        for (int y = y0; y < y1; ++y) {
+            for (int x = x0; x < x1; ++x) {
+                const Eigen::Vector2d c = origin_ + resolution_ * Eigen::Vector2d(x + 0.5, y + 0.5);
+                if (signed_distance(o, c) <= 0.0) {
+                    occupied[static_cast<size_t>(y) * width_ + x] = 1;
+                    any = true;
+                }
+            }
+        }
+    }
+
+    // Centre-to-centre distances overshoot the boundary by half a cell on
+    // each side, hence the correction.
+    const float far = static_cast<float>(world.size.norm() + dynamic_radius_);
+    static_field_.assign(cells, far);
+    if (any) {
+        const auto to_obstacle = squared_edt(occupied, width_, height_);
+        for (auto& o : occupied) o = !o;  // Now marks free cells
+        const auto to_free = squared_edt(occupied, width_, height_);
+        for (size_t i = 0; i < cells; ++i) {
+            const bool free = occupied[i];
+            const double d = free ? std::sqrt(to_obstacle[i]) - 0.5 : 0.5 - std::sqrt(to_free[i]);
+            static_field_[i] = std::clamp(static_cast<float>(d * resolution_), -far, far);
+        }
+    }
+
+    field_ = static_field_;
+    update(0.0);
+}
+
+DistanceField::Window DistanceField::window(const Obstacle& obstacle, double t) const {
+    Eigen::Vector2d lo, hi;
+    bounds(obstacle, t, lo, hi);
+    lo = (lo - origin_).array() / resolution_ - dynamic_radius_ / resolution_;
+    hi = (hi - origin_).array() / resolution_ + dynamic_radius_ / resolution_;
+    Window w;
+    w.x0 = static_cast<int>(std::clamp(std::floor(lo.x()), 0.0, double(width_)));
+    w.y0 = static_cast<int>(std::clamp(std::floor(lo.y()), 0.0, double(height_)));
+    w.x1 = static_cast<int>(std::clamp(std::ceil(hi.x()) + 1.0, 0.0, double(width_)));
+    w.y1 = static_cast<int>(std::clamp(std::ceil(hi.y()) + 1.0, 0.0, double(height_)));
+    return w;
+}
+
+void DistanceField::update(double t) {
+    BCOD_SCOPED_TIMER("distance_field.update");
+    // Restore every window first so overlapping obstacles cannot wipe each
+    // other's new footprint.
+    for (const auto& w : windows_) {
+        for (int y = w.y0; y < w.y1; ++y) {
+            const size_t row = static_cast<size_t>(y) * width_;
+            std::copy(static_field_.begin() + row + w.x0, static_field_.begin() + row + w.x1, field_.begin() + row + w.x0);
+        }
+    }
+
+    windows_.clear();
+    for (const auto& o : dynamic_) {
+        const Window w = window(o, t);
+        for (int y = w.y0; y < w.y1; ++y) {
+            float* row = field_.data() + static_cast<size_t>(y) * width_;
+            for (int x = w.x0; x < w.x1; ++x) {
+                const Eigen::Vector2d c = origin_ + resolution_ * Eigen::Vector2d(x + 0.5, y + 0.5);
+                row[x] = std::min(row[x], static_cast<float>(signed_distance(o, c, t)));
+            }
+        }
+        windows_.push_back(w);
+    }
+    time_ = t;
+}
+
+double DistanceField::distance(const Eigen::Vector2d& p) const {
+    const double u = std::clamp((p.x() - origin_.x()) / resolution_ - 0.5, 0.0, double(width_ - 1));
+    const double v = std::clamp((p.y() - origin_.y()) / resolution_ - 0.5, 0.0, double(height_ - 1));
+    const int x0 = static_cast<int>(u);
+    const int y0 = static_cast<int>(v);
+    const int x1 = std::min(x0 + 1, width_ - 1);
+    const int y1 = std::min(y0 + 1, height_ - 1);
+    const double fx = u - x0;
+    const double fy = v - y0;
+
+    const float* r0 = field_.data() + static_cast<size_t>(y0) * width_;
+    const float* r1 = field_.data() + static_cast<size_t>(y1) * width_;
+    const double top = r0[x0] + fx * (r0[x1] - r0[x0]);
+    const double bottom = r1[x0] + fx * (r1[x1] - r1[x0]);
+    return top + fy * (bottom - top);
+}
+
+double trajectory_clearance(const std::vector<Eigen::Vector3d>& waypoints, const Eigen::Vector3d& start,
+                            const DistanceField& field) {
+    const double c = std::cos(start.z());
+    const double s = std::sin(start.z());
+    double clearance = std::numeric_limits<double>::infinity();
+    for (const auto& w : waypoints) {
+        const Eigen::Vector2d p(start.x() + c * w.x() - s * w.y(), start.y() + s * w.x() + c * w.y());
+        clearance = std::min(clearance, field.distance(p));
+    }
+    return clearance;
+}
+
+} // namespace bcod
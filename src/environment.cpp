@@ -0,0 +1,165 @@
+#include <bcod/environment.hpp>
+#include <bcod/sensor_defs.hpp>
+#include <bcod/logging.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace bcod {
+
+namespace {
+    Eigen::Vector2d to_vec2(const nlohmann::json& j) {
+        return Eigen::Vector2d(j.at(0).get<double>(), j.at(1).get<double>());
+    }
+
+    int sensor_index(const std::string& type) {
+        if (type == "lidar")   return static_cast<int>(SensorType::LIDAR);
+        if (type == "rgb")     return static_cast<int>(SensorType::RGB);
+        if (type == "thermal") return static_cast<int>(SensorType::THERMAL);
+        if (type == "gnss")    return static_cast<int>(SensorType::GNSS);
+        if (type == "imu")     return static_cast<int>(SensorType::IMU);
+        if (type == "exo2")    return static_cast<int>(SensorType::EXO2);
+        return -1;
+    }
+
+    double segment_distance(const Eigen::Vector2d& p, const Eigen::Vector2d& a, const Eigen::Vector2d& b) {
+        Eigen::Vector2d ab = b - a;
+        double len2 = ab.squaredNorm();
+        double t = len2 > 0 ? std::clamp((p - a).dot(ab) / len2, 0.0, 1.0) : 0.0;
+        return (p - (a + t * ab)).norm();
+    }
+}
+
+WorldParams parse_world(const nlohmann::json& environment) {
+    try {
+        const auto& world = environment.at("world");
+        WorldParams w;
+        w.size = to_vec2(world.at("size"));
+        w.resolution = world.value("resolution", 0.1);
+        w.origin = world.contains("origin") ? to_vec2(world.at("origin")) : Eigen::Vector2d::Zero();
+
+        for (const auto& o : world.value("obstacles", nlohmann::json::array())) {
+            Obstacle obs{};
+            obs.dynamic = o.value("type", std::string("static")) == "dynamic";
+            obs.velocity = o.contains("velocity") ? to_vec2(o.at("velocity")) : Eigen::Vector2d::Zero();
+            const std::string shape = o.at("shape").get<std::string>();
+            if (shape == "polygon") {
+                obs.shape = ObstacleShape::POLYGON;
+                for (const auto& v : o.at("vertices")) obs.vertices.push_back(to_vec2(v));
+                obs.center = Eigen::Vector2d::Zero();
+                for (const auto& v : obs.vertices) obs.center += v;
+                if (!obs.vertices.empty()) obs.center /= static_cast<double>(obs.vertices.size());
+            } else if (shape == "circle") {
+                obs.shape = ObstacleShape::CIRCLE;
+                obs.center = to_vec2(o.at("center"));
+                obs.radius = o.at("radius").get<double>();
+            } else if (shape == "rectangle") {
+                obs.shape = ObstacleShape::RECTANGLE;
+                obs.center = to_vec2(o.at("position"));
+                obs.size = to_vec2(o.at("size"));
+            } else {
+                BCOD_WARN("Ignoring obstacle with unknown shape: ", shape);
+                continue;
+            }
+            w.obstacles.push_back(std::move(obs));
+        }
+
+        for (const auto& f : world.value("features", nlohmann::json::array())) {
+            const std::string type = f.value("type", std::string());
+            if (type == "landmark") {
+                w.landmarks.push_back({to_vec2(f.at("position")), f.value("uncertainty", 0.0)});
+            } else if (type == "noise_source") {
+                w.noise_sources.push_back({to_vec2(f.at("position")), f.value("intensity", 0.0), f.value("radius", 1.0)});
+            }
+        }
+
+        const auto& sim = environment.value("simulation", nlohmann::json::object());
+        w.time_step = sim.value("time_step", 0.1);
+        w.max_steps = sim.value("max_steps", 1000);
+        const auto& noise = sim.value("noise", nlohmann::json::object());
+        w.position_noise = noise.value("position", 0.1);
+        w.orientation_noise = noise.value("orientation", 0.01);
+
+        // Cameras need a landmark in view to localise; GNSS and IMU do not.
+        w.sensor_ranges = {30.0, 25.0, 25.0, 0.0, 0.0, 20.0};
+        const auto& robot = environment.value("robot", nlohmann::json::object());
+        w.max_velocity = robot.value("max_velocity", 2.0);
+        w.max_angular_velocity = robot.value("max_angular_velocity", 1.0);
+        for (const auto& s : robot.value("sensors", nlohmann::json::array())) {
+            int idx = sensor_index(s.value("type", std::string()));
+            if (idx >= 0 && s.contains("range")) w.sensor_ranges[idx] = s.at("range").get<double>();
+        }
+        return w;
+    } catch (const nlohmann::json::exception& e) {
+        BCOD_ERROR("Failed to parse environment config: ", e.what());
+        throw std::runtime_error("Invalid environment config");
+    }
+}
+
+double signed_distance(const Obstacle& obstacle, const Eigen::Vector2d& p, double t) {
+    Eigen::Vector2d offset = obstacle.dynamic ? Eigen::Vector2d(obstacle.velocity * t) : Eigen::Vector2d::Zero();
+    Eigen::Vector2d q = p - offset;
+    switch (obstacle.shape) {
+        case ObstacleShape::CIRCLE:
+            return (q - obstacle.center).norm() - obstacle.radius;
+        case ObstacleShape::RECTANGLE: {
+            Eigen::Vector2d d = (q - obstacle.center).cwiseAbs() - obstacle.size / 2.0;
+            double outside = d.cwiseMax(0.0).norm();
+            double inside = std::min(std::max(d.x(), d.y()), 0.0);
+            return outside + inside;
+        }
+        case ObstacleShape::POLYGON: {
+            const auto& v = obstacle.vertices;
+            double dist = std::numeric_limits<double>::max();
+            bool in = false;
+            for (size_t i = 0, j = v.size() - 1; i < v.size(); j = i++) {
+                dist = std::min(dist, segment_distance(q, v[j], v[i]));
+                if (((v[i].y() > q.y()) != (v[j].y() > q.y())) &&
+                    (q.x() < (v[j].x() - v[i].x()) * (q.y() - v[i].y()) / (v[j].y() - v[i].y()) + v[i].x())) {
+                    in = !in;
+                }
+            }
+            return in ? -dist : dist;
+        }
+    }
+    return std::numeric_limits<double>::max();
+}
+
+double signed_distance(const WorldParams& world, const Eigen::Vector2d& p, double t) {
+    double d = std::numeric_limits<double>::max();
+    for (const auto& o : world.obstacles) {
+        d = std::min(d, signed_distance(o, p, t));
+    }
+    return d;
+}
+
+double noise_inflation(const WorldParams& world, const Eigen::Vector2d& p) {
+    double k = 1.0;
+    for (const auto& n : world.noise_sources) {
+        double r = (p - n.position).norm();
+        if (r < n.radius) k += n.intensity * (1.0 - r / n.radius);
+    }
+    return k;
+}
+
+const Landmark* visible_landmark(const WorldParams& world, const Eigen::Vector2d& p, double range) {
+    const Landmark* best = nullptr;
+    double best_d = range;
+    for (const auto& l : world.landmarks) {
+        double d = (p - l.position).norm();
+        if (d <= best_d) {
+            best = &l;
+            best_d = d;
+        }
+    }
+    return best;
+}
+
+bool inside_world(const WorldParams& world, const Eigen::Vector2d& p) {
+    Eigen::Vector2d rel = p - world.origin;
+    return rel.x() >= 0 && rel.y() >= 0 && rel.x() <= world.size.x() && rel.y() <= world.size.y();
+}
+
+} // namespace bcod
@@ -0,0 +1,79 @@
+#include <bcod/feature_cache.hpp>
+#include <bcod/instrumentation.hpp>
+#include <algorithm>
+#include <cstring>
+
+namespace bcod {
+
+namespace {
+    inline uint64_t mix(uint64_t h, uint64_t v) {
+        h ^= v * 0x9e3779b97f4a7c15ULL;
+        h = (h ^ (h >> 32)) * 0xd6e8feb86659fd93ULL;
+        return h ^ (h >> 32);
+    }
+}
+
+uint64_t hash_raster(const cv::Mat& raster) {
+    uint64_t h = mix(0, (static_cast<uint64_t>(raster.rows) << 32) | static_cast<uint32_t>(raster.cols));
+    h = mix(h, static_cast<uint64_t>(raster.type()));
+    const size_t row_bytes = raster.cols * raster.elemSize();
+    for (int y = 0; y < raster.rows; ++y) {
+        const uint8_t* row = raster.ptr<uint8_t>(y);
+        size_t i = 0;
+        for (; i + 8 <= row_bytes; i += 8) {
+            uint64_t word;
+            std::memcpy(&word, row + i, 8);
+            h = mix(h, word);
+        }
+        if (i < row_bytes) {
+            uint64_t tail = 0;
+            std::memcpy(&tail, row + i, row_bytes - i);
+            h = mix(h, tail);
+        }
+    }
+    return h;
+}
+
+uint64_t feature_key(uint64_t raster_hash, uint32_t encoder) {
+    return mix(raster_hash, static_cast<uint64_t>(encoder) + 1);
+}
+
+FeatureCache::FeatureCache(size_t capacity) : capacity_(std::max<size_t>(capacity, 1)) {
+    entries_.reserve(capacity_);
+}
+
+torch::Tensor FeatureCache::get_or_compute(uint64_t key, const std::function<torch::Tensor()>& encode) {
+    static Counter& hits = Instrumentation::instance().counter("features.cache_hits");
+    static Counter& misses = Instrumentation::instance().counter("features.cache_misses");
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& entry : entries_) {
+            if (entry.key == key) {
+                hits.add();
+                return entry.features;
+            }
+        }
+    }
+
+    // Encode outside the lock; a concurrent miss on the same key just
+    // computes the same features twice
+    misses.add();
+    torch::Tensor features = encode();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (entries_.size() < capacity_) {
+        entries_.push_back({key, features});
+    } else {
+        entries_[next_] = {key, features};
+        next_ = (next_ + 1) % capacity_;
+    }
+    return features;
+}
+
+void FeatureCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    next_ = 0;
+}
+
+} // namespace bcod
@@ -0,0 +1,272 @@
+#include <bcod/instrumentation.hpp>
+#include <bcod/logging.hpp>
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <sys/resource.h>
+#include <unistd.h>
+
+namespace bcod {
+
+namespace detail {
+    std::atomic<bool> instrumentation_enabled{false};
+}
+
+#ifndef BCOD_COUNT_ALLOCATIONS
+uint64_t thread_allocation_count() {
+    return 0;
+}
+#endif
+
+namespace {
+    using Histogram = LatencyHistogram;
+
+    int bucket_index(int64_t ns) {
+        if (ns < Histogram::SUB_BUCKETS) return ns < 0 ? 0 : static_cast<int>(ns);
+        const int e = 63 - __builtin_clzll(static_cast<uint64_t>(ns));
+        if (e > Histogram::MAX_EXPONENT) return Histogram::NUM_BUCKETS - 1;
+        const int sub = static_cast<int>((ns >> (e - Histogram::SUB_BITS)) & (Histogram::SUB_BUCKETS - 1));
+        return (e - Histogram::SUB_BITS + 1) * Histogram::SUB_BUCKETS + sub;
+    }
+
+    // Exclusive upper bound of a bucket, in ns
+    double bucket_upper(int i) {
+        if (i < Histogram::SUB_BUCKETS) return i + 1;
+        const int e = i / Histogram::SUB_BUCKETS + Histogram::SUB_BITS - 1;
+        const int sub = i % Histogram::SUB_BUCKETS;
+        return std::ldexp(Histogram::SUB_BUCKETS + sub + 1, e - Histogram::SUB_BITS);
+    }
+
+    double process_cpu_seconds() {
+        rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+               1e-6 * (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+    }
+
+    double process_rss_mb() {
+        long pages = 0, resident = 0;
+        FILE* statm = std::fopen("/proc/self/statm", "r");
+        if (!statm) return 0.0;
+        if (std::fscanf(statm, "%ld %ld", &pages, &resident) != 2) resident = 0;
+        std::fclose(statm);
+        return resident * static_cast<double>(sysconf(_SC_PAGESIZE)) / (1024.0 * 1024.0);
+    }
+}
+
+void LatencyHistogram::record(int64_t ns) {
+    buckets_[bucket_index(ns)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_ns_.fetch_add(ns, std::memory_order_relaxed);
+    int64_t prev = max_ns_.load(std::memory_order_relaxed);
+    while (ns > prev && !max_ns_.compare_exchange_weak(prev, ns, std::memory_order_relaxed)) {}
+}
+
+uint64_t LatencyHistogram::count() const {
+    return count_.load(std::memory_order_relaxed);
+}
+
+double LatencyHistogram::percentile(double p) const {
+    std::array<uint64_t, NUM_BUCKETS> counts;
+    uint64_t total = 0;
+    for (int i = 0; i < NUM_BUCKETS; ++i) {
+        counts[i] = buckets_[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+    if (total == 0) return 0.0;
+
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(std::clamp(p, 0.0, 1.0) * total)));
+    const double max_ns = static_cast<double>(max_ns_.load(std::memory_order_relaxed));
+    uint64_t seen = 0;
+    for (int i = 0; i < NUM_BUCKETS; ++i) {
+        seen += counts[i];
+        if (seen >= rank) return std::min(bucket_upper(i), max_ns) * 1e-6;
+    }
+    return max_ns * 1e-6;
+}
+
+double LatencyHistogram::mean_ms() const {
+    const uint64_t n = count();
+    return n ? sum_ns_.load(std::memory_order_relaxed) * 1e-6 / n : 0.0;
+}
+
+double LatencyHistogram::max_ms() const {
+    return max_ns_.load(std::memory_order_relaxed) * 1e-6;
+}
+
+void LatencyHistogram::reset() {
+    for (auto& b : buckets_) b.store(0, std::memory_order_relaxed);
+    count_.store(0, std::memory_order_relaxed);
+    sum_ns_.store(0, std::memory_order_relaxed);
+    max_ns_.store(0, std::memory_order_relaxed);
+}
+
+struct Instrumentation::Impl {
+    std::mutex registry_mutex;
+    std::map<std::string, std::unique_ptr<LatencyHistogram>> histograms;
+    std::map<std::string, std::unique_ptr<Counter>> counters;
+    std::map<std::string, std::unique_ptr<Gauge>> gauges;
+
+    ProfilingParams params{false, 1000, "profiles/", false};
+    std::string profile_path;
+    std::mutex dump_mutex;
+
+    std::mutex reporter_mutex;
+    std::condition_variable reporter_wake;
+    bool stopping = false;
+    std::thread reporter;
+
+    double last_cpu = 0.0;
+    std::chrono::steady_clock::time_point last_sample = std::chrono::steady_clock::now();
+
+    template<typename T>
+    T& lookup(std::map<std::string, std::unique_ptr<T>>& metrics, const std::string& name) {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        auto& slot = metrics[name];
+        if (!slot) slot = std::make_unique<T>();
+        return *slot;
+    }
+
+    void sample_process() {
+        const auto now = std::chrono::steady_clock::now();
+        const double cpu = process_cpu_seconds();
+        const double wall = std::chrono::duration<double>(now - last_sample).count();
+        if (wall > 0.0) {
+            lookup(gauges, "process.cpu_percent").set(100.0 * (cpu - last_cpu) / wall);
+        }
+        lookup(gauges, "process.rss_mb").set(process_rss_mb());
+        last_cpu = cpu;
+        last_sample = now;
+    }
+
+    void dump() {
+        std::lock_guard<std::mutex> dump_lock(dump_mutex);
+        if (params.monitor_process) sample_process();
+        if (profile_path.empty()) return;
+
+        FILE* out = std::fopen(profile_path.c_str(), "a");
+        if (!out) {
+            BCOD_WARN("Failed to open profile output: ", profile_path);
+            return;
+        }
+        const double wall_s = std::chrono::duration<double>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        for (const auto& [name, h] : histograms) {
+            if (h->count() == 0) continue;
+            std::fprintf(out, "%.3f\t%s\t%llu\t%.4f\t%.4f\t%.4f\t%.4f\t%.4f\t\n", wall_s, name.c_str(),
+                         static_cast<unsigned long long>(h->count()), h->mean_ms(), h->percentile(0.50),
+                         h->percentile(0.95), h->percentile(0.99), h->max_ms());
+        }
+        for (const auto& [name, c] : counters) {
+            std::fprintf(out, "%.3f\t%s\t\t\t\t\t\t\t%llu\n", wall_s, name.c_str(),
+                         static_cast<unsigned long long>(c->value()));
+        }
+        for (const auto& [name, g] : gauges) {
+            std::fprintf(out, "%.3f\t%s\t\t\t\t\t\t\t%g\n", wall_s, name.c_str(), g->value());
+        }
+        std::fclose(out);
+    }
+
+    void start_reporter() {
+        stop_reporter();
+        stopping = false;
+        reporter = std::thread([this] {
+            std::unique_lock<std::mutex> lock(reporter_mutex);
+            const auto interval = std::chrono::milliseconds(std::max(params.interval_ms, 1));
+            while (!reporter_wake.wait_for(lock, interval, [this] { return stopping; })) {
+                lock.unlock();
+                dump();
+                lock.lock();
+            }
+        });
+    }
+
+    void stop_reporter() {
+        if (!reporter.joinable()) return;
+        {
+            std::lock_guard<std::mutex> lock(reporter_mutex);
+            stopping = true;
+        }
+        reporter_wake.notify_one();
+        reporter.join();
+    }
+
+    void configure(const ProfilingParams& p) {
+        stop_reporter();
+        params = p;
+        profile_path.clear();
+
+        if (params.enabled && !params.output.empty()) {
+            std::error_code ec;
+            std::filesystem::create_directories(params.output, ec);
+            if (ec) {
+                BCOD_ERROR("Failed to create profile directory ", params.output, ": ", ec.message());
+                throw std::runtime_error("Failed to create profile directory: " + params.output);
+            }
+            profile_path = (std::filesystem::path(params.output) /
+                            ("profile_" + std::to_string(getpid()) + ".tsv")).string();
+            FILE* out = std::fopen(profile_path.c_str(), "w");
+            if (out) {
+                std::fprintf(out, "wall_s\tmetric\tcount\tmean_ms\tp50_ms\tp95_ms\tp99_ms\tmax_ms\tvalue\n");
+                std::fclose(out);
+            }
+        }
+
+        last_cpu = process_cpu_seconds();
+        last_sample = std::chrono::steady_clock::now();
+        detail::instrumentation_enabled.store(params.enabled, std::memory_order_relaxed);
+        if (params.enabled && (!profile_path.empty() || params.monitor_process)) start_reporter();
+    }
+};
+
+Instrumentation& Instrumentation::instance() {
+    static Instrumentation instance;
+    return instance;
+}
+
+Instrumentation::Instrumentation() : impl_(std::make_unique<Impl>()) {}
+
+Instrumentation::~Instrumentation() {
+    impl_->stop_reporter();
+    if (enabled()) impl_->dump();
+}
+
+void Instrumentation::configure(const ProfilingParams& params) {
+    impl_->configure(params);
+}
+
+void Instrumentation::set_enabled(bool enabled) {
+    detail::instrumentation_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+LatencyHistogram& Instrumentation::histogram(const std::string& name) {
+    return impl_->lookup(impl_->histograms, name);
+}
+
+Counter& Instrumentation::counter(const std::string& name) {
+    return impl_->lookup(impl_->counters, name);
+}
+
+Gauge& Instrumentation::gauge(const std::string& name) {
+    return impl_->lookup(impl_->gauges, name);
+}
+
+void Instrumentation::dump() {
+    impl_->dump();
+}
+
+void Instrumentation::reset() {
+    std::lock_guard<std::mutex> lock(impl_->registry_mutex);
+    for (auto& [name, h] : impl_->histograms) h->reset();
+    for (auto& [name, c] : impl_->counters) c->reset();
+}
+
+} // namespace bcod
@@ -1,7 +1,9 @@
 #include "bcod/json_config.hpp"
 #include "bcod/logging.hpp"
 #include <fstream>
+#include <iomanip>
 #include <stdexcept>
+#include <utility>
 
 namespace bcod {
 
@@ -22,6 +24,18 @@ JsonConfig::JsonConfig(const std::string& config_path) {
     }
 }
 
+JsonConfig JsonConfig::from_json(nlohmann::json config) {
+    if (!config.is_object()) {
+        BCOD_ERROR("Config root must be an object, got ", config.type_name());
+        throw std::runtime_error("Config root must be an object");
+    }
+    JsonConfig result;
+    result.config_ = std::move(config);
+    result.validate_config();
+    result.set_defaults();
+    return result;
+}
+
 void JsonConfig::save(const std::string& path) const {
     try {
         std::ofstream file(path);
@@ -99,6 +113,26 @@ void JsonConfig::set_defaults() {
     if (!config_.contains("scheduler.discount_factor")) {
         config_["scheduler.discount_factor"] = 0.99;
     }
+    
+    if (!config_.contains("scheduler.tau")) {
+        config_["scheduler.tau"] = 0.005;
+    }
+
+    if (!config_.contains("performance.profiling.enabled")) {
+        config_["performance.profiling.enabled"] = false;
+    }
+
+    if (!config_.contains("performance.profiling.interval")) {
+        config_["performance.profiling.interval"] = 1000;
+    }
+
+    if (!config_.contains("performance.profiling.output")) {
+        config_["performance.profiling.output"] = "profiles/";
+    }
+
+    if (!config_.contains("performance.monitoring.enabled")) {
+        config_["performance.monitoring.enabled"] = false;
+    }
 }
 
 } // namespace bcod 
\ No newline at end of file
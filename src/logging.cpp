@@ -1,21 +1,33 @@
 #include "bcod/logging.hpp"
-#include <iostream>
-#include <fstream>
+#include "bcod/lockfree.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <ctime>
 #include <mutex>
-#include <chrono>
-#include <iomanip>
+#include <thread>
+#include <vector>
 
 namespace bcod {
 
 namespace {
-    std::mutex log_mutex;
-    std::ofstream log_file;
-    bool use_colors = true;
-    
-    const char* get_color_code(LogLevel level) {
-        if (!use_colors) return "";
-        
-        switch (level) {
+    constexpr size_t RING_CAPACITY = 1024;
+    constexpr size_t MAX_BATCH = 4096;
+    constexpr auto IDLE_WAIT = std::chrono::milliseconds(2);
+
+    const char* get_level_str(uint8_t level) {
+        switch (static_cast<LogLevel>(level)) {
+            case LogLevel::DEBUG:   return "DEBUG";
+            case LogLevel::INFO:    return "INFO";
+            case LogLevel::WARNING: return "WARNING";
+            case LogLevel::ERROR:   return "ERROR";
+            case LogLevel::FATAL:   return "FATAL";
+            default:               return "UNKNOWN";
+        }
+    }
+
+    const char* get_color_code(uint8_t level) {
+        switch (static_cast<LogLevel>(level)) {
             case LogLevel::DEBUG:   return "\033[36m";  // Cyan
             case LogLevel::INFO:    return "\033[32m";  // Green
             case LogLevel::WARNING: return "\033[33m";  // Yellow
@@ -24,41 +36,312 @@ namespace {
             default:               return "";
         }
     }
-    
-    const char* get_reset_code() {
-        return use_colors ? "\033[0m" : "";
-    }
+
+    struct ThreadBuffer {
+        SpscRing<detail::LogRecord> ring{RING_CAPACITY};
+        std::atomic<bool> closed{false};
+    };
+
+    // Marks the calling thread's ring as closed on thread exit; the logging
+    // thread drains and releases it.
+    struct ThreadHandle {
+        std::shared_ptr<ThreadBuffer> buffer;
+        ~ThreadHandle() {
+            if (buffer) buffer->closed.store(true, std::memory_order_release);
+        }
+    };
+
+    thread_local ThreadHandle thread_handle;
 }
 
-void Logger::write_log(LogLevel level, const std::string& message) {
-    std::lock_guard<std::mutex> lock(log_mutex);
-    
-    const char* color = get_color_code(level);
-    const char* reset = get_reset_code();
-    
-    std::cerr << color << message << reset << std::endl;
-    
-    if (log_file.is_open()) {
-        log_file << message << std::endl;
+struct Logger::Impl {
+    std::mutex registry_mutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    uint64_t registry_version = 0;
+
+    std::mutex io_mutex;
+    FILE* log_file = nullptr;
+    bool use_colors = true;
+
+    std::mutex wake_mutex;
+    std::condition_variable wake;
+    std::condition_variable flushed;
+    uint64_t flush_requested = 0;
+    uint64_t flush_done = 0;
+    bool stopping = false;
+
+    std::atomic<uint64_t> dropped{0};
+    uint64_t dropped_reported = 0;
+
+    // Logging-thread state
+    std::vector<std::shared_ptr<ThreadBuffer>> snapshot;
+    uint64_t snapshot_version = ~0ull;
+    std::vector<detail::LogRecord> batch;
+    std::vector<const detail::LogRecord*> order;
+    std::string err_out;
+    std::string file_out;
+    std::string message;
+    int64_t stamp_second = -1;
+    char stamp[32] = {};
+
+    std::thread worker;
+
+    Impl() {
+        batch.reserve(MAX_BATCH);
+        order.reserve(MAX_BATCH);
+        worker = std::thread([this] { run(); });
+    }
+
+    ~Impl() {
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        worker.join();
+        if (log_file) std::fclose(log_file);
+    }
+
+    std::shared_ptr<ThreadBuffer> register_thread() {
+        auto buffer = std::make_shared<ThreadBuffer>();
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        buffers.push_back(buffer);
+        ++registry_version;
+        return buffer;
+    }
+
+    void refresh_snapshot() {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        // Release rings of exited threads once they are empty
+        auto dead = std::remove_if(buffers.begin(), buffers.end(), [](const auto& b) {
+            return b->closed.load(std::memory_order_acquire) && b->ring.empty();
+        });
+        if (dead != buffers.end()) {
+            buffers.erase(dead, buffers.end());
+            ++registry_version;
+        }
+        if (snapshot_version != registry_version) {
+            snapshot = buffers;
+            snapshot_version = registry_version;
+        }
+    }
+
+    // Pops up to MAX_BATCH records; returns false once every ring is empty.
+    bool drain() {
+        batch.clear();
+        bool more = false;
+        for (auto& buffer : snapshot) {
+            while (batch.size() < MAX_BATCH) {
+                detail::LogRecord* record = buffer->ring.peek();
+                if (!record) break;
+                batch.push_back(*record);
+                buffer->ring.pop();
+            }
+            if (batch.size() == MAX_BATCH) more = true;
+        }
+        if (!batch.empty()) write_batch();
+        return more || !batch.empty();
+    }
+
+    const char* format_stamp(int64_t wall_ns) {
+        const int64_t second = wall_ns / 1000000000;
+        if (second != stamp_second) {
+            std::time_t t = static_cast<std::time_t>(second);
+            std::tm tm;
+            localtime_r(&t, &tm);
+            std::strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &tm);
+            stamp_second = second;
+        }
+        return stamp;
+    }
+
+    void decode(const detail::LogRecord& record) {
+        char buf[64];
+        size_t pos = 0;
+        while (pos < record.size) {
+            const auto tag = static_cast<detail::LogArg>(record.payload[pos++]);
+            switch (tag) {
+                case detail::LogArg::INT: {
+                    int64_t v;
+                    std::memcpy(&v, record.payload + pos, sizeof(v));
+                    pos += sizeof(v);
+                    message.append(buf, std::snprintf(buf, sizeof(buf), "%lld", static_cast<long long>(v)));
+                    break;
+                }
+                case detail::LogArg::UINT: {
+                    uint64_t v;
+                    std::memcpy(&v, record.payload + pos, sizeof(v));
+                    pos += sizeof(v);
+                    message.append(buf, std::snprintf(buf, sizeof(buf), "%llu", static_cast<unsigned long long>(v)));
+                    break;
+                }
+                case detail::LogArg::DOUBLE: {
+                    double v;
+                    std::memcpy(&v, record.payload + pos, sizeof(v));
+                    pos += sizeof(v);
+                    // %g matches the default ostream formatting
+                    message.append(buf, std::snprintf(buf, sizeof(buf), "%g", v));
+                    break;
+                }
+                case detail::LogArg::BOOL:
+                    message += record.payload[pos++] ? '1' : '0';
+                    break;
+                case detail::LogArg::CHAR:
+                    message += record.payload[pos++];
+                    break;
+                case detail::LogArg::STRING: {
+                    uint16_t len;
+                    std::memcpy(&len, record.payload + pos, sizeof(len));
+                    pos += sizeof(len);
+                    message.append(record.payload + pos, len);
+                    pos += len;
+                    break;
+                }
+                default:
+                    pos = record.size;
+                    break;
+            }
+        }
+        if (record.truncated) message += "...";
+    }
+
+    void write_batch() {
+        // Merge records from different threads into timestamp order
+        order.clear();
+        for (const auto& record : batch) order.push_back(&record);
+        std::stable_sort(order.begin(), order.end(), [](const auto* a, const auto* b) {
+            return a->wall_ns < b->wall_ns;
+        });
+
+        std::lock_guard<std::mutex> lock(io_mutex);
+        err_out.clear();
+        file_out.clear();
+        for (const auto* record : order) {
+            char ms[8];
+            std::snprintf(ms, sizeof(ms), ".%03d", static_cast<int>((record->wall_ns / 1000000) % 1000));
+
+            message.clear();
+            message += format_stamp(record->wall_ns);
+            message += ms;
+            message += " [";
+            message += get_level_str(record->level);
+            message += "] ";
+            message += record->file;
+            message += ':';
+            message += std::to_string(record->line);
+            message += " - ";
+            decode(*record);
+
+            if (use_colors) err_out += get_color_code(record->level);
+            err_out += message;
+            if (use_colors) err_out += "\033[0m";
+            err_out += '\n';
+            if (log_file) {
+                file_out += message;
+                file_out += '\n';
+            }
+        }
+        std::fwrite(err_out.data(), 1, err_out.size(), stderr);
+        std::fflush(stderr);
+        if (log_file) {
+            std::fwrite(file_out.data(), 1, file_out.size(), log_file);
+            std::fflush(log_file);
+        }
+    }
+
+    void report_drops() {
+        const uint64_t total = dropped.load(std::memory_order_relaxed);
+        if (total == dropped_reported) return;
+        std::lock_guard<std::mutex> lock(io_mutex);
+        std::fprintf(stderr, "[WARNING] logger dropped %llu records, a thread's ring was full\n",
+                     static_cast<unsigned long long>(total - dropped_reported));
+        if (log_file) {
+            std::fprintf(log_file, "[WARNING] logger dropped %llu records, a thread's ring was full\n",
+                         static_cast<unsigned long long>(total - dropped_reported));
+        }
+        dropped_reported = total;
+    }
+
+    void run() {
+        for (;;) {
+            uint64_t target;
+            bool stop;
+            {
+                std::lock_guard<std::mutex> lock(wake_mutex);
+                target = flush_requested;
+                stop = stopping;
+            }
+
+            refresh_snapshot();
+            bool wrote = false;
+            while (drain()) wrote = true;
+            report_drops();
+
+            std::unique_lock<std::mutex> lock(wake_mutex);
+            if (flush_done != target) {
+                flush_done = target;
+                flushed.notify_all();
+            }
+            if (stop) break;
+            if (!wrote) {
+                wake.wait_for(lock, IDLE_WAIT, [this] {
+                    return stopping || flush_requested != flush_done;
+                });
+            }
+        }
+    }
+
+    void flush() {
+        std::unique_lock<std::mutex> lock(wake_mutex);
+        if (stopping) return;
+        const uint64_t ticket = ++flush_requested;
+        wake.notify_one();
+        flushed.wait(lock, [&] { return flush_done >= ticket; });
+    }
+};
+
+Logger::Logger() : impl_(std::make_unique<Impl>()) {}
+
+Logger::~Logger() = default;
+
+detail::LogRecord* Logger::claim() {
+    if (!thread_handle.buffer) {
+        thread_handle.buffer = impl_->register_thread();
     }
+    detail::LogRecord* record = thread_handle.buffer->ring.claim();
+    if (!record) impl_->dropped.fetch_add(1, std::memory_order_relaxed);
+    return record;
+}
+
+void Logger::commit(LogLevel level) {
+    thread_handle.buffer->ring.commit();
+    if (level == LogLevel::FATAL) impl_->flush();
+}
+
+void Logger::flush() {
+    impl_->flush();
+}
+
+uint64_t Logger::dropped() const {
+    return impl_->dropped.load(std::memory_order_relaxed);
 }
 
 void Logger::set_log_file(const std::string& path) {
-    std::lock_guard<std::mutex> lock(log_mutex);
-    
-    if (log_file.is_open()) {
-        log_file.close();
+    std::lock_guard<std::mutex> lock(impl_->io_mutex);
+
+    if (impl_->log_file) {
+        std::fclose(impl_->log_file);
     }
-    
-    log_file.open(path, std::ios::app);
-    if (!log_file) {
-        std::cerr << "Failed to open log file: " << path << std::endl;
+
+    impl_->log_file = std::fopen(path.c_str(), "a");
+    if (!impl_->log_file) {
+        std::fprintf(stderr, "Failed to open log file: %s\n", path.c_str());
     }
 }
 
 void Logger::set_use_colors(bool use) {
-    std::lock_guard<std::mutex> lock(log_mutex);
-    use_colors = use;
+    std::lock_guard<std::mutex> lock(impl_->io_mutex);
+    impl_->use_colors = use;
 }
 
-} // namespace bcod 
\ No newline at end of file
+} // namespace bcod
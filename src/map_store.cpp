@@ -0,0 +1,269 @@
+#include <bcod/map_store.hpp>
+#include <bcod/instrumentation.hpp>
+#include <bcod/logging.hpp>
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace bcod {
+
+namespace {
+    constexpr uint64_t kPageAlign = 4096;
+    constexpr int kMaxChannels = 4;
+
+    uint64_t align_up(uint64_t n) { return (n + kPageAlign - 1) / kPageAlign * kPageAlign; }
+
+    uint64_t tile_key(int level, int tx, int ty) {
+        return (static_cast<uint64_t>(level) << 48) | (static_cast<uint64_t>(ty) << 24) | static_cast<uint64_t>(tx);
+    }
+
+    // Exact 2x box downsample; odd edges are replicated first so every level
+    // pixel spans exactly twice the one below.
+    cv::Mat halve(const cv::Mat& image) {
+        cv::Mat even = image;
+        if (image.cols % 2 || image.rows % 2) {
+            cv::copyMakeBorder(image, even, 0, image.rows % 2, 0, image.cols % 2, cv::BORDER_REPLICATE);
+        }
+        cv::Mat half;
+        cv::resize(even, half, cv::Size(even.cols / 2, even.rows / 2), 0, 0, cv::INTER_AREA);
+        return half;
+    }
+}
+
+MapStore::MapStore(const std::string& path, size_t tile_capacity)
+    : file_(path, MappedFile::Access::RANDOM), tile_capacity_(std::max<size_t>(tile_capacity, 1)) {
+    if (file_.size() < sizeof(MapStoreHeader)) {
+        BCOD_ERROR("Map store too short: ", path);
+        throw std::runtime_error("Map store file too short");
+    }
+    std::memcpy(&header_, file_.data(), sizeof(header_));
+    if (std::memcmp(header_.magic, MapStoreHeader::MAGIC, sizeof(header_.magic)) != 0) {
+        BCOD_ERROR("Not a map store: ", path);
+        throw std::runtime_error("Not a map store file");
+    }
+    if (header_.version != MapStoreHeader::VERSION || header_.channels == 0 || header_.channels > kMaxChannels ||
+        header_.tile_size == 0 || header_.levels == 0 || !(header_.resolution > 0.0) ||
+        file_.size() < sizeof(MapStoreHeader) + header_.levels * sizeof(MapLevelHeader)) {
+        BCOD_ERROR("Unsupported or corrupt map store: ", path);
+        throw std::runtime_error("Unsupported map store version or corrupt header");
+    }
+
+    levels_.resize(header_.levels);
+    std::memcpy(levels_.data(), file_.data() + sizeof(MapStoreHeader), header_.levels * sizeof(MapLevelHeader));
+    for (const auto& level : levels_) {
+        const uint64_t tiles = static_cast<uint64_t>(level.tiles_x) * level.tiles_y;
+        if (level.offset + tiles * tile_bytes() > file_.size()) {
+            BCOD_ERROR("Map store level runs past the end of ", path);
+            throw std::runtime_error("Truncated map store");
+        }
+    }
+    resident_.reserve(tile_capacity_ + 1);
+}
+
+void MapStore::build(const cv::Mat& image, double resolution, const Eigen::Vector2d& origin,
+                     const std::string& path, int tile_size) {
+    if (image.empty() || image.depth() != CV_8U || image.channels() > kMaxChannels || tile_size <= 0 ||
+        !(resolution > 0.0)) {
+        BCOD_ERROR("Cannot build map store from ", image.cols, "x", image.rows, " image of depth ", image.depth(),
+                   " with tile size ", tile_size, " and resolution ", resolution);
+        throw std::invalid_argument("Map store needs a non-empty 8-bit image of 1-4 channels, positive tile size "
+                                    "and resolution");
+    }
+
+    std::vector<cv::Mat> pyramid = {image};
+    while (pyramid.back().cols > tile_size || pyramid.back().rows > tile_size) {
+        pyramid.push_back(halve(pyramid.back()));
+    }
+
+    const int channels = image.channels();
+    const size_t tile_bytes = static_cast<size_t>(tile_size) * tile_size * channels;
+    MapStoreHeader header{};
+    std::memcpy(header.magic, MapStoreHeader::MAGIC, sizeof(header.magic));
+    header.version = MapStoreHeader::VERSION;
+    header.channels = channels;
+    header.tile_size = tile_size;
+    header.levels = static_cast<uint32_t>(pyramid.size());
+    header.resolution = resolution;
+    header.origin_x = origin.x();
+    header.origin_y = origin.y();
+
+    std::vector<MapLevelHeader> levels(pyramid.size());
+    uint64_t offset = align_up(sizeof(header) + levels.size() * sizeof(MapLevelHeader));
+    for (size_t l = 0; l < pyramid.size(); ++l) {
+        auto& level = levels[l];
+        level.width = pyramid[l].cols;
+        level.height = pyramid[l].rows;
+        level.tiles_x = (level.width + tile_size - 1) / tile_size;
+        level.tiles_y = (level.height + tile_size - 1) / tile_size;
+        level.offset = offset;
+        offset = align_up(offset + static_cast<uint64_t>(level.tiles_x) * level.tiles_y * tile_bytes);
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        BCOD_ERROR("Failed to open map store for writing: ", path);
+        throw std::runtime_error("Failed to open map store for writing");
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(levels.data()), levels.size() * sizeof(MapLevelHeader));
+
+    std::vector<char> tile(tile_bytes);
+    for (size_t l = 0; l < pyramid.size(); ++l) {
+        const auto& level = levels[l];
+        const cv::Mat& src = pyramid[l];
+        out.seekp(level.offset);
+        for (uint32_t ty = 0; ty < level.tiles_y; ++ty) {
+            for (uint32_t tx = 0; tx < level.tiles_x; ++tx) {
+                std::fill(tile.begin(), tile.end(), 0);
+                const int x0 = tx * tile_size;
+                const int y0 = ty * tile_size;
+                const int w = std::min(tile_size, src.cols - x0);
+                const int h = std::min(tile_size, src.rows - y0);
+                for (int y = 0; y < h; ++y) {
+                    std::memcpy(tile.data() + static_cast<size_t>(y) * tile_size * channels,
+                                src.ptr<uint8_t>(y0 + y) + static_cast<size_t>(x0) * channels,
+                                static_cast<size_t>(w) * channels);
+                }
+                out.write(tile.data(), tile.size());
+            }
+        }
+    }
+    // Pad the final level so its page-aligned extent lies inside the file.
+    out.seekp(offset - 1);
+    out.put(0);
+    if (!out) {
+        BCOD_ERROR("Failed to write map store: ", path);
+        throw std::runtime_error("Failed to write map store");
+    }
+}
+
+size_t MapStore::tile_bytes() const {
+    return static_cast<size_t>(header_.tile_size) * header_.tile_size * header_.channels;
+}
+
+size_t MapStore::resident_tiles() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return lru_.size();
+}
+
+// Caller holds mtx_.
+const uint8_t* MapStore::touch(int level, int tx, int ty) const {
+    static Counter& hits = Instrumentation::instance().counter("map.tile_hits");
+    static Counter& misses = Instrumentation::instance().counter("map.tile_misses");
+
+    const auto& l = levels_[level];
+    const uint64_t offset = l.offset + (static_cast<uint64_t>(ty) * l.tiles_x + tx) * tile_bytes();
+    const uint64_t key = tile_key(level, tx, ty);
+    auto it = resident_.find(key);
+    if (it != resident_.end()) {
+        hits.add();
+        lru_.splice(lru_.begin(), lru_, it->second);
+    } else {
+        misses.add();
+        lru_.push_front(key);
+        resident_.emplace(key, lru_.begin());
+        if (lru_.size() > tile_capacity_) {
+            const uint64_t victim = lru_.back();
+            const int vl = static_cast<int>(victim >> 48);
+            const uint64_t vy = (victim >> 24) & 0xffffff;
+            const uint64_t vx = victim & 0xffffff;
+            const auto& level_v = levels_[vl];
+            file_.release(level_v.offset + (vy * level_v.tiles_x + vx) * tile_bytes(), tile_bytes());
+            resident_.erase(victim);
+            lru_.pop_back();
+        }
+    }
+    return file_.data() + offset;
+}
+
+void MapStore::crop(const RasterWindow& window, int rows, int cols, float* dst) const {
+    BCOD_SCOPED_TIMER("map.crop");
+    const int C = header_.channels;
+    const size_t plane = static_cast<size_t>(rows) * cols;
+
+    // Coarsest level whose pixels are no larger than an output cell.
+    int level = 0;
+    if (window.scale > header_.resolution) {
+        level = std::min(static_cast<int>(std::floor(std::log2(window.scale / header_.resolution))),
+                         static_cast<int>(header_.levels) - 1);
+    }
+    const auto& l = levels_[level];
+    const double res = header_.resolution * std::ldexp(1.0, level);
+    const int T = header_.tile_size;
+
+    // Output cell (u, v) -> level pixel coordinates (pixel centres at integers).
+    const Eigen::Matrix2d to_pixels = window.axes * (window.scale / res);
+    const Eigen::Vector2d base = (window.center - origin()) / res - Eigen::Vector2d(0.5, 0.5) +
+                                 window.axes * Eigen::Vector2d::Constant((0.5 * window.scale - 0.5 * window.size) / res);
+
+    // Pin every tile under the window once, so the sampling loop indexes a
+    // local table instead of the LRU.
+    Eigen::Vector2d lo = base, hi = base;
+    for (const Eigen::Vector2d corner : {Eigen::Vector2d(cols - 1, 0), Eigen::Vector2d(0, rows - 1),
+                                         Eigen::Vector2d(cols - 1, rows - 1)}) {
+        const Eigen::Vector2d p = base + to_pixels * corner;
+        lo = lo.cwiseMin(p);
+        hi = hi.cwiseMax(p);
+    }
+    const int px0 = std::clamp(static_cast<int>(std::floor(lo.x())), 0, static_cast<int>(l.width) - 1);
+    const int py0 = std::clamp(static_cast<int>(std::floor(lo.y())), 0, static_cast<int>(l.height) - 1);
+    const int px1 = std::clamp(static_cast<int>(std::floor(hi.x())) + 1, 0, static_cast<int>(l.width) - 1);
+    const int py1 = std::clamp(static_cast<int>(std::floor(hi.y())) + 1, 0, static_cast<int>(l.height) - 1);
+    const int tx0 = px0 / T, ty0 = py0 / T, ntx = px1 / T - tx0 + 1, nty = py1 / T - ty0 + 1;
+    std::vector<const uint8_t*> tiles(static_cast<size_t>(ntx) * nty);
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        for (int ty = 0; ty < nty; ++ty) {
+            for (int tx = 0; tx < ntx; ++tx) tiles[ty * ntx + tx] = touch(level, tx0 + tx, ty0 + ty);
+        }
+    }
+
+    const float norm = 1.0f / 255.0f;
+    float tap[4][kMaxChannels];
+    for (int v = 0; v < rows; ++v) {
+        for (int u = 0; u < cols; ++u) {
+            const Eigen::Vector2d p = base + to_pixels * Eigen::Vector2d(u, v);
+            const int x = static_cast<int>(std::floor(p.x()));
+            const int y = static_cast<int>(std::floor(p.y()));
+            const float fx = static_cast<float>(p.x() - x);
+            const float fy = static_cast<float>(p.y() - y);
+            for (int k = 0; k < 4; ++k) {
+                const int sx = x + (k & 1);
+                const int sy = y + (k >> 1);
+                if (sx < px0 || sx > px1 || sy < py0 || sy > py1) {
+                    std::fill(tap[k], tap[k] + C, 0.0f);
+                    continue;
+                }
+                const uint8_t* tile = tiles[(sy / T - ty0) * ntx + (sx / T - tx0)];
+                const uint8_t* pixel = tile + (static_cast<size_t>(sy % T) * T + sx % T) * C;
+                for (int c = 0; c < C; ++c) tap[k][c] = pixel[c];
+            }
+
+            const size_t idx = static_cast<size_t>(v) * cols + u;
+            for (int c = 0; c < C; ++c) {
+                const float top = tap[0][c] + fx * (tap[1][c] - tap[0][c]);
+                const float bottom = tap[2][c] + fx * (tap[3][c] - tap[2][c]);
+                dst[c * plane + idx] = (top + fy * (bottom - top)) * norm;
+            }
+        }
+    }
+}
+
+cv::Mat MapStore::crop(const RasterWindow& window, int rows, int cols) const {
+    const int C = header_.channels;
+    std::vector<float> planes(static_cast<size_t>(C) * rows * cols);
+    crop(window, rows, cols, planes.data());
+    cv::Mat image(rows, cols, CV_32FC(C));
+    for (int v = 0; v < rows; ++v) {
+        float* row = image.ptr<float>(v);
+        for (int u = 0; u < cols; ++u) {
+            for (int c = 0; c < C; ++c) row[u * C + c] = planes[(static_cast<size_t>(c) * rows + v) * cols + u];
+        }
+    }
+    return image;
+}
+
+} // namespace bcod
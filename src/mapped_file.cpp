@@ -0,0 +1,97 @@
+#include <bcod/mapped_file.hpp>
+#include <bcod/logging.hpp>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace bcod {
+
+MappedFile::MappedFile(const std::string& path, Access access) : path_(path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        BCOD_ERROR("Failed to open file for mapping: ", path);
+        throw std::runtime_error("Failed to open file for mapping");
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        BCOD_ERROR("Failed to stat file: ", path);
+        throw std::runtime_error("Failed to stat file");
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    if (size_ > 0) {
+        void* p = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) {
+            ::close(fd);
+            BCOD_ERROR("Failed to map file: ", path);
+            throw std::runtime_error("Failed to map file");
+        }
+        ::madvise(p, size_, access == Access::SEQUENTIAL ? MADV_SEQUENTIAL : MADV_RANDOM);
+        data_ = static_cast<const uint8_t*>(p);
+    }
+    ::close(fd);
+}
+
+MappedFile::~MappedFile() {
+    unmap();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : path_(std::move(other.path_)), data_(other.data_), size_(other.size_) {
+    other.data_ = nullptr;
+    other.size_ = 0;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        unmap();
+        path_ = std::move(other.path_);
+        data_ = other.data_;
+        size_ = other.size_;
+        other.data_ = nullptr;
+        other.size_ = 0;
+    }
+    return *this;
+}
+
+void MappedFile::release(size_t offset, size_t length) const {
+    if (!data_ || offset >= size_) return;
+    const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    size_t begin = (offset + page - 1) / page * page;
+    size_t end = std::min(size_, offset + length) / page * page;
+    if (end > begin) {
+        ::madvise(const_cast<uint8_t*>(data_) + begin, end - begin, MADV_DONTNEED);
+    }
+}
+
+std::vector<MappedFile::Range> MappedFile::line_chunks(size_t chunk_bytes) const {
+    std::vector<Range> chunks;
+    chunk_bytes = std::max<size_t>(chunk_bytes, 1);
+    const char* text = reinterpret_cast<const char*>(data_);
+    size_t begin = 0;
+    while (begin < size_) {
+        size_t end = size_;
+        if (size_ - begin > chunk_bytes) {
+            const void* nl = std::memchr(text + begin + chunk_bytes - 1, '\n', size_ - begin - chunk_bytes + 1);
+            if (nl) end = static_cast<const char*>(nl) - text + 1;
+        }
+        chunks.push_back({begin, end - begin});
+        begin = end;
+    }
+    return chunks;
+}
+
+void MappedFile::unmap() {
+    if (data_) {
+        ::munmap(const_cast<uint8_t*>(data_), size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+}
+
+} // namespace bcod
@@ -0,0 +1,339 @@
+#include <bcod/particle_filter.hpp>
+#include <bcod/instrumentation.hpp>
+#include <bcod/logging.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace bcod {
+
+namespace {
+    constexpr int kBlock = 256;
+    constexpr float kTwoPi = 6.28318530717958647692f;
+    constexpr float kInvTwoPi = 1.0f / kTwoPi;
+
+    // Random streams, the last Philox counter word.
+    enum Stream : uint32_t { RESET = 0, PREDICT = 1, RESAMPLE = 2 };
+
+    // Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as
+    // 1, 2, 3"): four 32-bit words from a counter and key, no state.
+    inline void philox(uint32_t c0, uint32_t c1, uint32_t c2, uint32_t c3, uint32_t k0, uint32_t k1,
+                       uint32_t out[4]) {
+        for (int round = 0; round < 10; ++round) {
+            const uint64_t p0 = static_cast<uint64_t>(0xD2511F53u) * c0;
+            const uint64_t p1 = static_cast<uint64_t>(0xCD9E8D57u) * c2;
+            const uint32_t n0 = static_cast<uint32_t>(p1 >> 32) ^ c1 ^ k0;
+            const uint32_t n2 = static_cast<uint32_t>(p0 >> 32) ^ c3 ^ k1;
+            c1 = static_cast<uint32_t>(p1);
+            c3 = static_cast<uint32_t>(p0);
+            c0 = n0;
+            c2 = n2;
+            k0 += 0x9E3779B9u;
+            k1 += 0xBB67AE85u;
+        }
+        out[0] = c0;
+        out[1] = c1;
+        out[2] = c2;
+        out[3] = c3;
+    }
+
+    // In (0, 1), never 0 so log() stays finite.
+    inline float uniform(uint32_t bits) {
+        return (static_cast<float>(bits >> 8) + 0.5f) * (1.0f / 16777216.0f);
+    }
+
+    // GCC fuses a sin/cos pair of one angle into sincosf, which has no vector
+    // variant and keeps the whole loop scalar; a shifted cos vectorises.
+    inline float vsin(float a) {
+        return std::cos(a - 0.25f * kTwoPi);
+    }
+
+    inline float wrap(float a) {
+        return a - kTwoPi * std::floor(a * kInvTwoPi + 0.5f);
+    }
+
+    // The library builds with -ffast-math, which lets the compiler assume
+    // std::isfinite is true and fold NaN-sensitive comparisons. The exponent
+    // bits say the same without a floating-point test.
+    inline bool finite(double v) {
+        uint64_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        return ((bits >> 52) & 0x7ff) != 0x7ff;
+    }
+
+    // Three standard normals per particle of [begin, begin + count) for one
+    // step and stream, by Box-Muller on a single Philox block.
+    void gaussians(uint64_t seed, uint64_t step, Stream stream, size_t begin, int count,
+                   float* n0, float* n1, float* n2) {
+        const uint32_t k0 = static_cast<uint32_t>(seed);
+        const uint32_t k1 = static_cast<uint32_t>(seed >> 32);
+        const uint32_t s0 = static_cast<uint32_t>(step);
+        const uint32_t s1 = static_cast<uint32_t>(step >> 32);
+        float u0[kBlock], u1[kBlock], u2[kBlock], u3[kBlock];
+        for (int i = 0; i < count; ++i) {
+            uint32_t r[4];
+            philox(static_cast<uint32_t>(begin + i), s0, s1, stream, k0, k1, r);
+            u0[i] = uniform(r[0]);
+            u1[i] = uniform(r[1]);
+            u2[i] = uniform(r[2]);
+            u3[i] = uniform(r[3]);
+        }
+        for (int i = 0; i < count; ++i) {
+            const float a = std::sqrt(-2.0f * std::log(u0[i]));
+            const float b = std::sqrt(-2.0f * std::log(u2[i]));
+            n0[i] = a * std::cos(kTwoPi * u1[i]);
+            n1[i] = a * vsin(kTwoPi * u1[i]);
+            n2[i] = b * std::cos(kTwoPi * u3[i]);
+        }
+    }
+
+    constexpr uint32_t kMaskCount = 1u << kNumSensors;
+    constexpr uint32_t kPositionSensors = (kMaskCount - 1) & ~(1u << static_cast<int>(SensorType::IMU));
+    constexpr uint32_t kHeadingSensors = (kMaskCount - 1) & ~(1u << static_cast<int>(SensorType::GNSS));
+
+    // Constants of one fused update. The position terms of all active
+    // sensors add up to a single quadratic around their precision-weighted
+    // mean, plus a constant that reweight() subtracts anyway; heading errors
+    // wrap, so those stay one term per sensor.
+    struct FusedReadings {
+        float position_scale;  // Sum of -0.5 / sigma^2 over the position sensors
+        float x, y;
+        std::array<float, kNumSensors> yaw;
+        std::array<float, kNumSensors> yaw_scale;
+    };
+
+    template <uint32_t Mask, int S = 0>
+    inline float heading_terms(float yaw, const FusedReadings& r) {
+        if constexpr (S == kNumSensors) {
+            return 0.0f;
+        } else if constexpr (((Mask & kHeadingSensors) >> S) & 1u) {
+            const float d = wrap(yaw - r.yaw[S]);
+            return r.yaw_scale[S] * d * d + heading_terms<Mask, S + 1>(yaw, r);
+        } else {
+            return heading_terms<Mask, S + 1>(yaw, r);
+        }
+    }
+
+    template <uint32_t Mask>
+    void fused_log_likelihood(const float* __restrict__ x, const float* __restrict__ y,
+                              const float* __restrict__ yaw, size_t n, const FusedReadings& r,
+                              float* __restrict__ ll) {
+        for (size_t i = 0; i < n; ++i) {
+            float acc = 0.0f;
+            if constexpr ((Mask & kPositionSensors) != 0) {
+                const float dx = x[i] - r.x, dy = y[i] - r.y;
+                acc += r.position_scale * (dx * dx + dy * dy);
+            }
+            ll[i] = acc + heading_terms<Mask>(yaw[i], r);
+        }
+    }
+
+    using Kernel = void (*)(const float*, const float*, const float*, size_t, const FusedReadings&, float*);
+
+    template <size_t... Masks>
+    constexpr std::array<Kernel, sizeof...(Masks)> make_kernels(std::index_sequence<Masks...>) {
+        return {{&fused_log_likelihood<static_cast<uint32_t>(Masks)>...}};
+    }
+
+    constexpr auto kKernels = make_kernels(std::make_index_sequence<kMaskCount>{});
+
+    LatencyHistogram& mask_latency(uint32_t mask) {
+        static const auto histograms = [] {
+            std::array<LatencyHistogram*, kMaskCount> h{};
+            for (uint32_t m = 0; m < kMaskCount; ++m) {
+                std::string name = "filter.update.";
+                for (int i = 0; i < kNumSensors; ++i) name += (m >> i) & 1u ? '1' : '0';
+                h[m] = &Instrumentation::instance().histogram(name);
+            }
+            return h;
+        }();
+        return *histograms[mask];
+    }
+}
+
+ParticleFilter::ParticleFilter(const Params& params) : params_(params) {
+    if (params_.num_particles <= 0 || params_.position_noise < 0.0 || params_.orientation_noise < 0.0 ||
+        params_.resample_ratio < 0.0 || params_.resample_ratio > 1.0) {
+        BCOD_ERROR("Invalid particle filter: ", params_.num_particles, " particles, noise ",
+                   params_.position_noise, "/", params_.orientation_noise, ", resample ratio ",
+                   params_.resample_ratio);
+        throw std::invalid_argument("Particle filter needs particles, non-negative noise and a ratio in [0, 1]");
+    }
+    if (params_.resample_ratio == 0.0) params_.resample_ratio = 0.5;
+
+    const size_t n = params_.num_particles;
+    for (auto* v : {&x_, &y_, &yaw_, &weight_, &scratch_x_, &scratch_y_, &scratch_yaw_, &log_likelihood_}) {
+        v->assign(n, 0.0f);
+    }
+    reset(Eigen::Vector3d::Zero(), 0.0, 0.0);
+}
+
+void ParticleFilter::reset(const Eigen::Vector3d& pose, double position_spread, double yaw_spread) {
+    const size_t n = x_.size();
+    const float px = static_cast<float>(pose.x()), py = static_cast<float>(pose.y());
+    const float pyaw = static_cast<float>(pose.z());
+    const float sxy = static_cast<float>(position_spread), syaw = static_cast<float>(yaw_spread);
+    float n0[kBlock], n1[kBlock], n2[kBlock];
+    for (size_t begin = 0; begin < n; begin += kBlock) {
+        const int count = static_cast<int>(std::min<size_t>(kBlock, n - begin));
+        gaussians(params_.seed, step_, RESET, begin, count, n0, n1, n2);
+        float* __restrict__ x = x_.data() + begin;
+        float* __restrict__ y = y_.data() + begin;
+        float* __restrict__ yaw = yaw_.data() + begin;
+        for (int i = 0; i < count; ++i) {
+            x[i] = px + sxy * n0[i];
+            y[i] = py + sxy * n1[i];
+            yaw[i] = wrap(pyaw + syaw * n2[i]);
+        }
+    }
+    std::fill(weight_.begin(), weight_.end(), 1.0f / n);
+    ++step_;
+}
+
+void ParticleFilter::predict(double velocity, double angular_velocity, double dt, double inflation) {
+    BCOD_SCOPED_TIMER("filter.predict");
+    const size_t n = x_.size();
+    const float ds = static_cast<float>(velocity * dt);
+    const float dyaw = static_cast<float>(angular_velocity * dt);
+    const float sxy = static_cast<float>(params_.position_noise * inflation * std::sqrt(dt));
+    const float syaw = static_cast<float>(params_.orientation_noise * inflation * std::sqrt(dt));
+    float n0[kBlock], n1[kBlock], n2[kBlock];
+    for (size_t begin = 0; begin < n; begin += kBlock) {
+        const int count = static_cast<int>(std::min<size_t>(kBlock, n - begin));
+        gaussians(params_.seed, step_, PREDICT, begin, count, n0, n1, n2);
+        float* __restrict__ x = x_.data() + begin;
+        float* __restrict__ y = y_.data() + begin;
+        float* __restrict__ yaw = yaw_.data() + begin;
+        for (int i = 0; i < count; ++i) {
+            const float heading = wrap(yaw[i] + dyaw + syaw * n0[i]);
+            yaw[i] = heading;
+            x[i] += ds * std::cos(heading) + sxy * n1[i];
+            y[i] += ds * vsin(heading) + sxy * n2[i];
+        }
+    }
+    ++step_;
+}
+
+void ParticleFilter::update(const Measurement& z) {
+    const int s = static_cast<int>(z.sensor);
+    if (s < 0 || s >= kNumSensors) {
+        BCOD_ERROR("Measurement from unknown sensor ", s);
+        throw std::invalid_argument("Unknown sensor in measurement");
+    }
+    std::array<Measurement, kNumSensors> readings{};
+    readings[s] = z;
+    update(1u << s, readings);
+}
+
+void ParticleFilter::update(uint32_t mask, const std::array<Measurement, kNumSensors>& readings) {
+    if (mask >= kMaskCount) {
+        BCOD_ERROR("Sensor mask ", mask, " has bits beyond the ", kNumSensors, " sensors");
+        throw std::invalid_argument("Sensor mask out of range");
+    }
+    if (mask == 0) return;
+    BCOD_SCOPED_TIMER("filter.update");
+    ScopedTimer timer(mask_latency(mask));
+
+    FusedReadings r{};
+    double precision = 0.0, px = 0.0, py = 0.0;
+    for (int s = 0; s < kNumSensors; ++s) {
+        if (!(mask & (1u << s))) continue;
+        const Measurement& z = readings[s];
+        const double sigma = SensorConfig::MEASUREMENT_NOISE[s] * z.inflation + z.extra_sigma;
+        if (!finite(sigma) || sigma <= 0.0) {
+            BCOD_ERROR("Measurement of sensor ", s, " has sigma ", sigma, " (inflation ", z.inflation,
+                       ", extra ", z.extra_sigma, ")");
+            throw std::invalid_argument("Measurement sigma must be positive and finite");
+        }
+        const double p = 1.0 / (sigma * sigma);
+        if (kPositionSensors & (1u << s)) {
+            precision += p;
+            px += p * z.position.x();
+            py += p * z.position.y();
+        }
+        r.yaw[s] = static_cast<float>(z.yaw);
+        r.yaw_scale[s] = static_cast<float>(-0.5 * p);
+    }
+    if (precision > 0.0) {
+        r.position_scale = static_cast<float>(-0.5 * precision);
+        r.x = static_cast<float>(px / precision);
+        r.y = static_cast<float>(py / precision);
+    }
+
+    kKernels[mask](x_.data(), y_.data(), yaw_.data(), x_.size(), r, log_likelihood_.data());
+    reweight();
+}
+
+// Multiplies the weights by exp(log_likelihood_) relative to its maximum,
+// so the best particle's factor is 1 and nothing underflows wholesale, then
+// normalises. A degenerate result falls back to uniform weights.
+void ParticleFilter::reweight() {
+    const size_t n = x_.size();
+    const float best = *std::max_element(log_likelihood_.begin(), log_likelihood_.end());
+    const float* __restrict__ ll = log_likelihood_.data();
+    float* __restrict__ w = weight_.data();
+    double total = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        w[i] *= std::exp(ll[i] - best);
+        total += w[i];
+    }
+    if (!finite(total) || !(total > 0.0)) {
+        BCOD_WARN("Particle weights degenerated, resetting to uniform");
+        std::fill(weight_.begin(), weight_.end(), 1.0f / n);
+        return;
+    }
+    const float inv = static_cast<float>(1.0 / total);
+    for (size_t i = 0; i < n; ++i) w[i] *= inv;
+}
+
+double ParticleFilter::effective_sample_size() const {
+    double sq = 0.0;
+    for (float w : weight_) sq += static_cast<double>(w) * w;
+    return sq > 0.0 ? 1.0 / sq : 0.0;
+}
+
+bool ParticleFilter::resample() {
+    BCOD_SCOPED_TIMER("filter.resample");
+    const size_t n = x_.size();
+    if (effective_sample_size() >= params_.resample_ratio * n) return false;
+
+    // One offset for the whole comb, from the resample stream of this step.
+    uint32_t r[4];
+    philox(0, static_cast<uint32_t>(step_), static_cast<uint32_t>(step_ >> 32), RESAMPLE,
+           static_cast<uint32_t>(params_.seed), static_cast<uint32_t>(params_.seed >> 32), r);
+    const double stride = 1.0 / n;
+    const double offset = uniform(r[0]) * stride;
+
+    double cumulative = weight_[0];
+    size_t j = 0;
+    for (size_t k = 0; k < n; ++k) {
+        const double target = offset + k * stride;
+        while (target > cumulative && j + 1 < n) cumulative += weight_[++j];
+        scratch_x_[k] = x_[j];
+        scratch_y_[k] = y_[j];
+        scratch_yaw_[k] = yaw_[j];
+    }
+    x_.swap(scratch_x_);
+    y_.swap(scratch_y_);
+    yaw_.swap(scratch_yaw_);
+    std::fill(weight_.begin(), weight_.end(), 1.0f / n);
+    ++step_;
+    return true;
+}
+
+Eigen::Vector3d ParticleFilter::estimate() const {
+    double mx = 0.0, my = 0.0, s = 0.0, c = 0.0;
+    for (size_t i = 0; i < x_.size(); ++i) {
+        const double w = weight_[i];
+        mx += w * x_[i];
+        my += w * y_[i];
+        s += w * std::sin(yaw_[i]);
+        c += w * std::cos(yaw_[i]);
+    }
+    return Eigen::Vector3d(mx, my, std::atan2(s, c));
+}
+
+} // namespace bcod
@@ -0,0 +1,238 @@
+#include <bcod/pipeline.hpp>
+#include <bcod/lockfree.hpp>
+#include <bcod/logging.hpp>
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace bcod {
+
+namespace {
+    std::atomic<uint64_t> instances{0};
+
+    int64_t now_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
+
+struct BcodPipeline::Impl {
+    BeliefRasteriser& rasteriser;
+    StudentPlanner& planner;
+    SACScheduler& scheduler;
+    Params params;
+    Callback on_result;
+    int64_t max_latency_ns;
+    const ConfigStore* config = nullptr;
+
+    // input -> rasterise -> rasterised -> plan -> planned -> schedule
+    TripleBuffer<PipelineFrame> input;
+    TripleBuffer<PipelineFrame> rasterised;
+    TripleBuffer<PipelineFrame> planned;
+
+    std::array<LatencyHistogram*, NUM_STAGES> stage_hist;
+    LatencyHistogram* end_to_end_hist;
+    std::atomic<uint64_t> next_sequence{0};
+    std::atomic<uint64_t> completed{0};
+    std::atomic<uint64_t> overwritten{0};
+    std::atomic<uint64_t> stale{0};
+
+    std::atomic<bool> is_running{false};
+    std::vector<std::thread> workers;
+
+    Impl(BeliefRasteriser& r, StudentPlanner& p, SACScheduler& s, const Params& prm, Callback cb)
+        : rasteriser(r), planner(p), scheduler(s), params(prm), on_result(std::move(cb)) {
+        if (params.max_latency <= 0.0) {
+            BCOD_ERROR("Pipeline max_latency must be positive, got ", params.max_latency);
+            throw std::invalid_argument("Pipeline max_latency must be positive");
+        }
+        if (params.waypoint_interval <= 0.0) {
+            BCOD_ERROR("Pipeline waypoint_interval must be positive, got ", params.waypoint_interval);
+            throw std::invalid_argument("Pipeline waypoint_interval must be positive");
+        }
+        max_latency_ns = static_cast<int64_t>(params.max_latency * 1e9);
+
+        // Two pipelines sharing histograms would mix their latencies
+        const std::string name = params.name.empty() ? "pipeline." + std::to_string(instances.fetch_add(1))
+                                                     : params.name;
+        auto& metrics = Instrumentation::instance();
+        stage_hist = {&metrics.histogram(name + ".rasterise"), &metrics.histogram(name + ".plan"),
+                      &metrics.histogram(name + ".schedule")};
+        end_to_end_hist = &metrics.histogram(name + ".end_to_end");
+    }
+
+    bool is_stale(const PipelineFrame& frame) {
+        if (now_ns() - frame.capture_ns <= max_latency_ns) return false;
+        stale.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Hand the frame to the next stage. Swapping keeps the buffers of whatever
+    // the back slot held alive for reuse instead of freeing them here.
+    void handoff(TripleBuffer<PipelineFrame>& next, PipelineFrame& frame) {
+        std::swap(next.back(), frame);
+        if (next.publish()) overwritten.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void finish(PipelineFrame& frame) {
+        frame.end_to_end_ns = now_ns() - frame.capture_ns;
+        if (is_stale(frame)) return;
+        end_to_end_hist->record(frame.end_to_end_ns);
+        completed.fetch_add(1, std::memory_order_relaxed);
+        if (on_result) on_result(frame);
+    }
+
+    // Runs `body` on every fresh frame arriving in `source` and passes the
+    // result on to `sink`, or to the callback for the last stage.
+    template<typename Body>
+    void run_stage(Stage stage, TripleBuffer<PipelineFrame>& source,
+                   TripleBuffer<PipelineFrame>* sink, Body body) {
+        const auto idle = std::chrono::microseconds(std::max(params.idle_sleep_us, 1));
+        auto ready = [&] { return source.has_new(); };
+        auto alive = [&] { return is_running.load(std::memory_order_acquire); };
+
+        while (wait_until(ready, alive, idle)) {
+            source.fetch();
+            PipelineFrame& frame = source.front();
+            if (is_stale(frame)) continue;
+
+            const int64_t t0 = now_ns();
+            try {
+                body(frame);
+            } catch (const std::exception& e) {
+                BCOD_ERROR("Pipeline stage ", static_cast<int>(stage), " failed on frame ",
+                           frame.sequence, ": ", e.what());
+                continue;
+            }
+            frame.stage_ns[stage] = now_ns() - t0;
+            stage_hist[stage]->record(frame.stage_ns[stage]);
+
+            if (sink) {
+                handoff(*sink, frame);
+            } else {
+                finish(frame);
+            }
+        }
+    }
+
+    // Applies the active snapshot if it is newer than `applied`. Runs on the
+    // stage thread, the only user of its component.
+    template<typename Apply>
+    void refresh_config(uint64_t& applied, Apply apply) {
+        if (!config || config->version() == applied) return;
+        const auto snapshot = config->current();
+        apply(*snapshot);
+        applied = snapshot->version;
+    }
+
+    void rasterise_loop() {
+        run_stage(RASTERISE, input, &rasterised, [&](PipelineFrame& frame) {
+            frame.raster = rasteriser.rasterise(frame.particles);
+            frame.planning.belief_image = frame.raster.data;
+        });
+    }
+
+    void plan_loop() {
+        uint64_t applied = config ? config->version() : 0;
+        double waypoint_interval = params.waypoint_interval;
+        run_stage(PLAN, rasterised, &planned, [&](PipelineFrame& frame) {
+            refresh_config(applied, [&](const ConfigSnapshot& c) {
+                planner.set_params(c.student);
+                waypoint_interval = c.student.waypoint_interval;
+            });
+            frame.trajectory = planner.plan(frame.planning);
+            frame.scheduling.belief_raster = frame.raster.data;
+            frame.scheduling.cvar_risk = frame.trajectory.cvar_95;
+            frame.scheduling.risk_forecast = frame.trajectory.risk_scores;
+            frame.scheduling.forecast_dt = waypoint_interval;
+            frame.scheduling.forecast_sensors = frame.planning.active_sensors;
+        });
+    }
+
+    void schedule_loop() {
+        uint64_t applied = config ? config->version() : 0;
+        run_stage(SCHEDULE, planned, nullptr, [&](PipelineFrame& frame) {
+            refresh_config(applied, [&](const ConfigSnapshot& c) { scheduler.set_params(c.scheduler); });
+            frame.action = scheduler.schedule(frame.scheduling);
+        });
+    }
+
+    void start() {
+        if (is_running.exchange(true)) return;
+        workers.emplace_back([this] { rasterise_loop(); });
+        workers.emplace_back([this] { plan_loop(); });
+        workers.emplace_back([this] { schedule_loop(); });
+    }
+
+    void stop() {
+        if (!is_running.exchange(false)) return;
+        for (auto& w : workers) w.join();
+        workers.clear();
+    }
+};
+
+BcodPipeline::BcodPipeline(BeliefRasteriser& rasteriser, StudentPlanner& planner,
+                           SACScheduler& scheduler, const Params& params, Callback on_result)
+    : impl_(std::make_unique<Impl>(rasteriser, planner, scheduler, params, std::move(on_result))) {}
+
+BcodPipeline::~BcodPipeline() {
+    impl_->stop();
+}
+
+void BcodPipeline::watch_config(const ConfigStore* store) {
+    if (running()) {
+        BCOD_ERROR("watch_config called on a running pipeline");
+        throw std::logic_error("watch_config called on a running pipeline");
+    }
+    impl_->config = store;
+}
+
+void BcodPipeline::start() {
+    impl_->start();
+}
+
+void BcodPipeline::stop() {
+    impl_->stop();
+}
+
+bool BcodPipeline::running() const {
+    return impl_->is_running.load(std::memory_order_acquire);
+}
+
+uint64_t BcodPipeline::submit(PipelineFrame frame) {
+    const uint64_t sequence = impl_->next_sequence.fetch_add(1, std::memory_order_relaxed);
+    frame.sequence = sequence;
+    frame.capture_ns = now_ns();
+    impl_->handoff(impl_->input, frame);
+    return sequence;
+}
+
+BcodPipeline::Stats BcodPipeline::stats() const {
+    Stats s;
+    s.submitted = impl_->next_sequence.load(std::memory_order_relaxed);
+    s.completed = impl_->completed.load(std::memory_order_relaxed);
+    s.overwritten = impl_->overwritten.load(std::memory_order_relaxed);
+    s.stale = impl_->stale.load(std::memory_order_relaxed);
+    return s;
+}
+
+const LatencyHistogram& BcodPipeline::stage_latency(Stage stage) const {
+    return *impl_->stage_hist.at(stage);
+}
+
+const LatencyHistogram& BcodPipeline::end_to_end_latency() const {
+    return *impl_->end_to_end_hist;
+}
+
+void BcodPipeline::reset_stats() {
+    for (auto* h : impl_->stage_hist) h->reset();
+    impl_->end_to_end_hist->reset();
+    impl_->completed.store(0);
+    impl_->overwritten.store(0);
+    impl_->stale.store(0);
+}
+
+} // namespace bcod
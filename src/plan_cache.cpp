@@ -0,0 +1,121 @@
+#include <bcod/plan_cache.hpp>
+#include <bcod/sensor_defs.hpp>
+#include <bcod/instrumentation.hpp>
+#include <bcod/logging.hpp>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace bcod {
+
+namespace {
+    inline uint64_t mix(uint64_t h, uint64_t v) {
+        h ^= v * 0x9e3779b97f4a7c15ULL;
+        h = (h ^ (h >> 32)) * 0xd6e8feb86659fd93ULL;
+        return h ^ (h >> 32);
+    }
+}
+
+PlanCache::PlanCache(size_t capacity, double tolerance, int grid)
+    : capacity_(capacity), tolerance_(tolerance), grid_(grid) {
+    if (capacity_ == 0 || !(tolerance_ > 0.0) || grid_ < 1) {
+        BCOD_ERROR("Invalid plan cache: capacity ", capacity_, ", tolerance ", tolerance_, ", grid ", grid_);
+        throw std::invalid_argument("Plan cache needs a positive capacity, tolerance and grid");
+    }
+    index_.reserve(capacity_);
+}
+
+// Means over a grid x grid partition of the raster, channel-interleaved.
+// Empty rasters contribute nothing.
+void PlanCache::pool(const cv::Mat& raster, std::vector<double>& cells) const {
+    if (raster.empty()) return;
+    cv::Mat values;
+    if (raster.depth() == CV_32F) values = raster;
+    else raster.convertTo(values, CV_32F);
+
+    const int C = values.channels();
+    const size_t base = cells.size();
+    cells.resize(base + static_cast<size_t>(grid_) * grid_ * C, 0.0);
+    std::vector<int> counts(static_cast<size_t>(grid_) * grid_, 0);
+
+    for (int y = 0; y < values.rows; ++y) {
+        const float* row = values.ptr<float>(y);
+        const int gy = y * grid_ / values.rows;
+        for (int x = 0; x < values.cols; ++x) {
+            const int cell = gy * grid_ + x * grid_ / values.cols;
+            double* out = cells.data() + base + static_cast<size_t>(cell) * C;
+            for (int c = 0; c < C; ++c) out[c] += row[x * C + c];
+            ++counts[cell];
+        }
+    }
+    for (size_t cell = 0; cell < counts.size(); ++cell) {
+        if (counts[cell] == 0) continue;
+        double* out = cells.data() + base + cell * C;
+        for (int c = 0; c < C; ++c) out[c] /= counts[cell];
+    }
+}
+
+uint64_t PlanCache::fingerprint(const PlanningContext& context, uint64_t variant) const {
+    std::vector<double> cells;
+    pool(context.belief_image, cells);
+    const size_t belief_cells = cells.size();
+    pool(context.semantic_map, cells);
+    const size_t map_cells = cells.size() - belief_cells;
+    pool(context.goal_mask, cells);
+
+    // Segment sizes keep e.g. a missing map from aliasing a missing goal mask
+    uint64_t h = mix(to_bitmask(context.active_sensors), belief_cells);
+    h = mix(h, map_cells);
+    h = mix(h, variant);
+    if (context.semantic_map.empty() && context.map_window.size > 0.0) {
+        // The planner crops the map from its store; hash the window that selects the slice.
+        const double q = tolerance_ * context.map_window.size;
+        h = mix(h, static_cast<uint64_t>(std::llround(context.map_window.center.x() / q)));
+        h = mix(h, static_cast<uint64_t>(std::llround(context.map_window.center.y() / q)));
+        h = mix(h, static_cast<uint64_t>(std::llround(context.map_window.size / q)));
+        h = mix(h, static_cast<uint64_t>(std::llround(context.map_window.angle / tolerance_)));
+    }
+    for (double v : cells) {
+        h = mix(h, static_cast<uint64_t>(static_cast<int64_t>(std::floor(v / tolerance_))));
+    }
+    return h;
+}
+
+bool PlanCache::lookup(uint64_t key, Trajectory& out) {
+    static Counter& hits = Instrumentation::instance().counter("planner.cache_hits");
+    static Counter& misses = Instrumentation::instance().counter("planner.cache_misses");
+
+    auto it = index_.find(key);
+    if (it == index_.end()) {
+        ++misses_;
+        misses.add();
+        return false;
+    }
+    entries_.splice(entries_.begin(), entries_, it->second);
+    out = it->second->second;
+    ++hits_;
+    hits.add();
+    return true;
+}
+
+void PlanCache::insert(uint64_t key, const Trajectory& trajectory) {
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        it->second->second = trajectory;
+        entries_.splice(entries_.begin(), entries_, it->second);
+        return;
+    }
+    if (entries_.size() >= capacity_) {
+        index_.erase(entries_.back().first);
+        entries_.pop_back();
+    }
+    entries_.emplace_front(key, trajectory);
+    index_[key] = entries_.begin();
+}
+
+void PlanCache::clear() {
+    entries_.clear();
+    index_.clear();
+}
+
+} // namespace bcod
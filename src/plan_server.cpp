@@ -0,0 +1,505 @@
+#include <bcod/plan_server.hpp>
+#include <bcod/logging.hpp>
+#include <bcod/sensor_defs.hpp>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <iterator>
+#include <list>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace bcod {
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    int64_t ns_between(Clock::time_point from, Clock::time_point to) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count();
+    }
+
+    std::vector<bool> mask_bits(uint32_t mask) {
+        std::vector<bool> bits(kNumSensors);
+        for (int i = 0; i < kNumSensors; ++i) bits[i] = (mask >> i) & 1u;
+        return bits;
+    }
+
+    bool read_full(int fd, void* dst, size_t size) {
+        auto* p = static_cast<char*>(dst);
+        while (size > 0) {
+            const ssize_t n = ::recv(fd, p, size, 0);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            p += n;
+            size -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    // MSG_NOSIGNAL: a client that went away must not SIGPIPE the server.
+    bool write_full(int fd, const void* src, size_t size) {
+        auto* p = static_cast<const char*>(src);
+        while (size > 0) {
+            const ssize_t n = ::send(fd, p, size, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            p += n;
+            size -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    sockaddr_un socket_address(const std::string& path) {
+        sockaddr_un addr{};
+        if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+            BCOD_ERROR("Socket path must have 1 to ", sizeof(addr.sun_path) - 1, " characters: ", path);
+            throw std::invalid_argument("Invalid Unix socket path");
+        }
+        addr.sun_family = AF_UNIX;
+        std::memcpy(addr.sun_path, path.c_str(), path.size());
+        return addr;
+    }
+
+    bool valid_kind(RequestKind kind) {
+        return kind == RequestKind::PLAN || kind == RequestKind::SCHEDULE || kind == RequestKind::STEP;
+    }
+}
+
+struct PlanServer::Impl {
+    struct Connection {
+        int fd;
+        uint64_t id;              // SchedulerState::stream of its requests
+        std::mutex write_mutex;
+        std::thread reader;
+        std::atomic<bool> done{false};
+
+        Connection(int f, uint64_t i) : fd(f), id(i) {}
+        ~Connection() { ::close(fd); }
+    };
+
+    struct Pending {
+        ServerRequest request;
+        std::vector<Particle> particles;
+        std::shared_ptr<Connection> connection;
+        Clock::time_point arrival;
+    };
+
+    BeliefRasteriser& rasteriser;
+    StudentPlanner& planner;
+    SACScheduler& scheduler;
+    Params params;
+
+    int listen_fd = -1;
+    std::atomic<bool> is_running{false};
+    std::thread acceptor;
+    std::thread worker;
+    std::mutex connections_mutex;
+    std::list<std::shared_ptr<Connection>> connections;
+
+    std::mutex queue_mutex;
+    std::condition_variable queue_cv;
+    std::deque<Pending> queue;
+    bool stopping = false;
+    bool reap_needed = false;
+
+    LatencyHistogram* queue_hist;
+    LatencyHistogram* compute_hist;
+    std::atomic<uint64_t> requests{0};
+    std::atomic<uint64_t> batches{0};
+    std::atomic<uint64_t> rejected{0};
+    std::atomic<uint64_t> accepted{0};
+
+    Impl(BeliefRasteriser& r, StudentPlanner& p, SACScheduler& s, const Params& prm)
+        : rasteriser(r), planner(p), scheduler(s), params(prm) {
+        if (params.max_batch <= 0 || params.batch_window_us < 0 || params.max_particles == 0) {
+            BCOD_ERROR("Invalid plan server: batches of ", params.max_batch, " within ", params.batch_window_us,
+                       " us, up to ", params.max_particles, " particles");
+            throw std::invalid_argument("Plan server needs a positive batch size and particle limit");
+        }
+        socket_address(params.socket_path);
+
+        auto& metrics = Instrumentation::instance();
+        queue_hist = &metrics.histogram("server.queue");
+        compute_hist = &metrics.histogram("server.compute");
+    }
+
+    void start() {
+        if (is_running.load()) return;
+        const sockaddr_un addr = socket_address(params.socket_path);
+
+        // A socket file left by a server that died is replaced; anything else
+        // at the path is not ours to remove.
+        struct stat st;
+        if (::lstat(params.socket_path.c_str(), &st) == 0) {
+            if (!S_ISSOCK(st.st_mode)) {
+                BCOD_ERROR("Not a socket, refusing to replace: ", params.socket_path);
+                throw std::runtime_error("Socket path is taken by another file");
+            }
+            ::unlink(params.socket_path.c_str());
+        }
+
+        listen_fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (listen_fd < 0 || ::bind(listen_fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0 ||
+            ::listen(listen_fd, SOMAXCONN) != 0) {
+            const int err = errno;
+            if (listen_fd >= 0) ::close(listen_fd);
+            listen_fd = -1;
+            BCOD_ERROR("Failed to listen on ", params.socket_path, ": ", std::strerror(err));
+            throw std::runtime_error("Failed to listen on Unix socket");
+        }
+
+        stopping = false;
+        reap_needed = false;
+        is_running.store(true);
+        worker = std::thread([this] { work_loop(); });
+        acceptor = std::thread([this] { accept_loop(); });
+        BCOD_INFO("Serving plans on ", params.socket_path);
+    }
+
+    void stop() {
+        if (!is_running.exchange(false)) return;
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            stopping = true;
+        }
+        queue_cv.notify_all();
+
+        // shutdown() wakes the blocked accept() and recv() calls
+        ::shutdown(listen_fd, SHUT_RDWR);
+        acceptor.join();
+        ::close(listen_fd);
+        listen_fd = -1;
+        worker.join();
+        {
+            std::lock_guard<std::mutex> lock(connections_mutex);
+            for (auto& c : connections) ::shutdown(c->fd, SHUT_RDWR);
+        }
+        for (auto& c : connections) {
+            c->reader.join();
+            scheduler.end_stream(c->id);
+        }
+        connections.clear();
+        queue.clear();
+        ::unlink(params.socket_path.c_str());
+    }
+
+    void accept_loop() {
+        while (true) {
+            const int fd = ::accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (fd < 0) {
+                if (!is_running.load()) return;
+                if (errno != EINTR) {
+                    BCOD_WARN("accept failed on ", params.socket_path, ": ", std::strerror(errno));
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                }
+                continue;
+            }
+            const uint64_t id = accepted.fetch_add(1, std::memory_order_relaxed) + 1;
+            auto connection = std::make_shared<Connection>(fd, id);
+            std::lock_guard<std::mutex> lock(connections_mutex);
+            reap_connections();
+            connection->reader = std::thread([this, connection] { read_loop(connection); });
+            connections.push_back(std::move(connection));
+        }
+    }
+
+    // Joins readers whose client has gone; called with connections_mutex held.
+    void reap_connections() {
+        for (auto it = connections.begin(); it != connections.end();) {
+            if (!(*it)->done.load()) {
+                ++it;
+                continue;
+            }
+            (*it)->reader.join();
+            scheduler.end_stream((*it)->id);
+            it = connections.erase(it);
+        }
+    }
+
+    void read_loop(const std::shared_ptr<Connection>& connection) {
+        std::vector<LoggedParticle> logged;
+        while (true) {
+            Pending pending;
+            ServerRequest& request = pending.request;
+            if (!read_full(connection->fd, &request, sizeof(request))) break;
+            const uint32_t n = request.frame.num_particles;
+            // Without a valid header the stream cannot be resynchronised.
+            if (request.magic != ServerRequest::MAGIC || n > params.max_particles) {
+                BCOD_WARN("Closing connection after malformed request ", request.id, " (", n, " particles)");
+                reject(*connection, request.id);
+                // Replies still queued for this connection are dropped with it
+                ::shutdown(connection->fd, SHUT_RDWR);
+                break;
+            }
+            logged.resize(n);
+            if (n > 0 && !read_full(connection->fd, logged.data(), n * sizeof(LoggedParticle))) break;
+            if (n == 0 || !valid_kind(request.kind)) {
+                BCOD_WARN("Rejecting request ", request.id, " of kind ", static_cast<uint32_t>(request.kind),
+                          " with ", n, " particles");
+                reject(*connection, request.id);
+                continue;
+            }
+
+            ReplayLog::unpack({&request.frame, logged.data()}, pending.particles);
+            pending.connection = connection;
+            pending.arrival = Clock::now();
+            {
+                std::lock_guard<std::mutex> lock(queue_mutex);
+                queue.push_back(std::move(pending));
+            }
+            queue_cv.notify_one();
+        }
+        // The fd closes with the last reference: once the worker has reaped
+        // this reader and sent whatever replies were still queued for it.
+        connection->done.store(true);
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            reap_needed = true;
+        }
+        queue_cv.notify_one();
+    }
+
+    void reject(Connection& connection, uint64_t id) {
+        rejected.fetch_add(1, std::memory_order_relaxed);
+        ServerReply reply{};
+        reply.magic = ServerRequest::MAGIC;
+        reply.status = ServerReply::REJECTED;
+        reply.id = id;
+        std::lock_guard<std::mutex> lock(connection.write_mutex);
+        write_full(connection.fd, &reply, sizeof(reply));
+    }
+
+    // Waits for a first request, then up to batch_window_us for company, and
+    // processes whatever has queued by then as one batch. Readers that have
+    // finished are joined in between.
+    void work_loop() {
+        std::vector<Pending> batch;
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        while (true) {
+            queue_cv.wait(lock, [&] { return stopping || reap_needed || !queue.empty(); });
+            if (stopping) return;
+            if (reap_needed) {
+                reap_needed = false;
+                lock.unlock();
+                {
+                    std::lock_guard<std::mutex> guard(connections_mutex);
+                    reap_connections();
+                }
+                lock.lock();
+                continue;
+            }
+            const auto deadline = queue.front().arrival + std::chrono::microseconds(params.batch_window_us);
+            const size_t max_batch = static_cast<size_t>(params.max_batch);
+            queue_cv.wait_until(lock, deadline, [&] { return stopping || queue.size() >= max_batch; });
+            if (stopping) return;
+
+            const size_t n = std::min(queue.size(), max_batch);
+            batch.clear();
+            std::move(queue.begin(), queue.begin() + n, std::back_inserter(batch));
+            queue.erase(queue.begin(), queue.begin() + n);
+            lock.unlock();
+            process(batch);
+            batch.clear();  // Lets connections that are gone close now
+            lock.lock();
+        }
+    }
+
+    void process(std::vector<Pending>& batch) {
+        const auto start = Clock::now();
+        std::vector<ServerReply> replies(batch.size());
+        std::vector<std::vector<ServerWaypoint>> waypoints(batch.size());
+        try {
+            run(batch, replies, waypoints);
+        } catch (const std::exception& e) {
+            BCOD_ERROR("Batch of ", batch.size(), " requests failed: ", e.what());
+            for (size_t i = 0; i < batch.size(); ++i) {
+                replies[i] = ServerReply{};
+                replies[i].status = ServerReply::FAILED;
+                waypoints[i].clear();
+            }
+        }
+        const int64_t compute_ns = ns_between(start, Clock::now());
+        compute_hist->record(compute_ns);
+        batches.fetch_add(1, std::memory_order_relaxed);
+        requests.fetch_add(batch.size(), std::memory_order_relaxed);
+
+        for (size_t i = 0; i < batch.size(); ++i) {
+            ServerReply& reply = replies[i];
+            reply.magic = ServerRequest::MAGIC;
+            reply.id = batch[i].request.id;
+            reply.queue_ns = ns_between(batch[i].arrival, start);
+            reply.compute_ns = compute_ns;
+            reply.batch_size = static_cast<uint32_t>(batch.size());
+            reply.num_waypoints = static_cast<uint32_t>(waypoints[i].size());
+            queue_hist->record(reply.queue_ns);
+
+            Connection& connection = *batch[i].connection;
+            std::lock_guard<std::mutex> lock(connection.write_mutex);
+            if (!write_full(connection.fd, &reply, sizeof(reply)) ||
+                (!waypoints[i].empty() &&
+                 !write_full(connection.fd, waypoints[i].data(), waypoints[i].size() * sizeof(ServerWaypoint)))) {
+                BCOD_WARN("Dropped reply ", reply.id, ", its client went away");
+            }
+        }
+    }
+
+    PlanningContext make_context(const ReplayFrameHeader& frame, const BeliefRaster& raster) const {
+        PlanningContext context{};
+        context.belief_image = raster.data;
+        context.map_window = raster.window;   // semantic_map stays empty: zeros, or the planner's map store
+        context.goal_mask = cv::Mat::zeros(raster.data.rows, raster.data.cols, CV_32FC1);
+        rasterise_goal(raster.window, Eigen::Vector2d(frame.goal[0], frame.goal[1]), context.goal_mask);
+        context.active_sensors = mask_bits(frame.sensor_mask);
+        context.current_pose = Eigen::Vector3d(frame.pose[0], frame.pose[1], frame.pose[2]);
+        context.max_velocity = params.max_velocity;
+        context.max_angular_velocity = params.max_angular_velocity;
+        context.goal_distance = frame.goal_distance;
+        context.timestamp = frame.timestamp_ns;
+        return context;
+    }
+
+    void run(const std::vector<Pending>& batch, std::vector<ServerReply>& replies,
+             std::vector<std::vector<ServerWaypoint>>& waypoints) {
+        const size_t n = batch.size();
+        std::vector<BeliefRaster> rasters(n);
+        for (size_t i = 0; i < n; ++i) rasters[i] = rasteriser.rasterise(batch[i].particles);
+
+        std::vector<size_t> plan_rows;
+        std::vector<PlanningContext> contexts;
+        for (size_t i = 0; i < n; ++i) {
+            if (batch[i].request.kind == RequestKind::SCHEDULE) continue;
+            plan_rows.push_back(i);
+            contexts.push_back(make_context(batch[i].request.frame, rasters[i]));
+        }
+        std::vector<Trajectory> trajectories = contexts.empty() ? std::vector<Trajectory>()
+                                                                : planner.plan_batch(contexts);
+        std::vector<const Trajectory*> plan_of(n, nullptr);
+        for (size_t k = 0; k < plan_rows.size(); ++k) {
+            const size_t i = plan_rows[k];
+            const Trajectory& traj = trajectories[k];
+            plan_of[i] = &traj;
+            replies[i].cvar_95 = static_cast<float>(traj.cvar_95);
+            replies[i].min_clearance = static_cast<float>(traj.min_clearance);
+            waypoints[i].resize(traj.waypoints.size());
+            for (size_t w = 0; w < traj.waypoints.size(); ++w) {
+                const Eigen::Vector3d& p = traj.waypoints[w];
+                waypoints[i][w] = {static_cast<float>(p.x()), static_cast<float>(p.y()), static_cast<float>(p.z()),
+                                   static_cast<float>(traj.risk_scores[w])};
+            }
+        }
+
+        std::vector<size_t> schedule_rows;
+        std::vector<SchedulerState> states;
+        for (size_t i = 0; i < n; ++i) {
+            const ServerRequest& request = batch[i].request;
+            if (request.kind == RequestKind::PLAN) continue;
+            SchedulerState state{};
+            state.belief_raster = rasters[i].data;
+            state.cvar_risk = plan_of[i] ? plan_of[i]->cvar_95 : request.cvar_risk;
+            state.goal_distance = request.frame.goal_distance;
+            state.prev_actions = mask_bits(request.prev_mask);
+            state.timestamp = request.frame.timestamp_ns;
+            state.stream = batch[i].connection->id;
+            if (plan_of[i]) {
+                state.risk_forecast = plan_of[i]->risk_scores;
+                state.forecast_dt = params.waypoint_interval;
+                state.forecast_sensors = mask_bits(request.frame.sensor_mask);
+            }
+            schedule_rows.push_back(i);
+            states.push_back(std::move(state));
+        }
+        if (states.empty()) return;
+        const std::vector<SchedulerAction> actions = scheduler.schedule_batch(states);
+        for (size_t k = 0; k < schedule_rows.size(); ++k) {
+            ServerReply& reply = replies[schedule_rows[k]];
+            reply.sensor_mask = to_bitmask(actions[k].sensor_mask);
+            reply.total_power = static_cast<float>(actions[k].total_power);
+        }
+    }
+};
+
+PlanServer::PlanServer(BeliefRasteriser& rasteriser, StudentPlanner& planner, SACScheduler& scheduler,
+                       const Params& params)
+    : impl_(std::make_unique<Impl>(rasteriser, planner, scheduler, params)) {}
+
+PlanServer::~PlanServer() {
+    impl_->stop();
+}
+
+void PlanServer::start() {
+    impl_->start();
+}
+
+void PlanServer::stop() {
+    impl_->stop();
+}
+
+bool PlanServer::running() const {
+    return impl_->is_running.load(std::memory_order_acquire);
+}
+
+PlanServer::Stats PlanServer::stats() const {
+    Stats s;
+    s.requests = impl_->requests.load(std::memory_order_relaxed);
+    s.batches = impl_->batches.load(std::memory_order_relaxed);
+    s.rejected = impl_->rejected.load(std::memory_order_relaxed);
+    s.connections = impl_->accepted.load(std::memory_order_relaxed);
+    return s;
+}
+
+const LatencyHistogram& PlanServer::queue_latency() const {
+    return *impl_->queue_hist;
+}
+
+const LatencyHistogram& PlanServer::compute_latency() const {
+    return *impl_->compute_hist;
+}
+
+PlanClient::PlanClient(const std::string& socket_path) {
+    const sockaddr_un addr = socket_address(socket_path);
+    fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd_ < 0 || ::connect(fd_, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0) {
+        const int err = errno;
+        if (fd_ >= 0) ::close(fd_);
+        BCOD_ERROR("Failed to connect to ", socket_path, ": ", std::strerror(err));
+        throw std::runtime_error("Failed to connect to plan server");
+    }
+}
+
+PlanClient::~PlanClient() {
+    ::close(fd_);
+}
+
+void PlanClient::send(ServerRequest request, const std::vector<LoggedParticle>& particles) {
+    request.magic = ServerRequest::MAGIC;
+    request.frame.num_particles = static_cast<uint32_t>(particles.size());
+    if (!write_full(fd_, &request, sizeof(request)) ||
+        (!particles.empty() && !write_full(fd_, particles.data(), particles.size() * sizeof(LoggedParticle)))) {
+        throw std::runtime_error("Plan server connection closed while sending");
+    }
+}
+
+ServerReply PlanClient::receive(std::vector<ServerWaypoint>* waypoints) {
+    ServerReply reply;
+    std::vector<ServerWaypoint> scratch;
+    auto& out = waypoints ? *waypoints : scratch;
+    if (!read_full(fd_, &reply, sizeof(reply))) {
+        throw std::runtime_error("Plan server connection closed while receiving");
+    }
+    out.resize(reply.num_waypoints);
+    if (reply.num_waypoints > 0 && !read_full(fd_, out.data(), out.size() * sizeof(ServerWaypoint))) {
+        throw std::runtime_error("Plan server connection closed while receiving");
+    }
+    return reply;
+}
+
+} // namespace bcod
@@ -0,0 +1,363 @@
+#include <bcod/policy_runtime.hpp>
+#include <bcod/logging.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace bcod {
+
+namespace {
+    constexpr char kMagic[8] = {'B', 'C', 'O', 'D', 'P', 'O', 'L', '\0'};
+    constexpr float kNormEps = 1e-5f;
+
+    struct FileHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t precision;
+        int32_t in_channels;
+        int32_t height;
+        int32_t width;
+        int32_t hidden_dim;
+        int32_t num_sensors;
+        int32_t context_dim;
+    };
+
+    // Weights of one conv (as GEMM) or linear layer. INT8 layers keep a
+    // per-row scale and are dequantised in the accumulation epilogue.
+    struct Dense {
+        int rows = 0;
+        int cols = 0;
+        std::vector<float> w;
+        std::vector<int8_t> q;
+        std::vector<float> scale;
+        std::vector<float> bias;
+    };
+
+    struct Norm {
+        std::vector<float> gamma;
+        std::vector<float> beta;
+    };
+
+    struct ConvShape {
+        int in_c, in_h, in_w;
+        int out_c, out_h, out_w;
+        int stride;
+    };
+
+    void write_layer(std::ofstream& out, const PackedPolicy::Layer& layer, PolicyRuntime::Precision precision) {
+        int32_t dims[2] = {layer.rows, layer.cols};
+        out.write(reinterpret_cast<const char*>(dims), sizeof(dims));
+        if (precision == PolicyRuntime::Precision::INT8) {
+            std::vector<float> scales(layer.rows);
+            std::vector<int8_t> q(static_cast<size_t>(layer.rows) * layer.cols);
+            for (int r = 0; r < layer.rows; ++r) {
+                const float* row = layer.weight.data() + static_cast<size_t>(r) * layer.cols;
+                float amax = 0.0f;
+                for (int c = 0; c < layer.cols; ++c) amax = std::max(amax, std::abs(row[c]));
+                scales[r] = amax > 0.0f ? amax / 127.0f : 1.0f;
+                for (int c = 0; c < layer.cols; ++c) {
+                    float v = std::round(row[c] / scales[r]);
+                    q[static_cast<size_t>(r) * layer.cols + c] = static_cast<int8_t>(std::clamp(v, -127.0f, 127.0f));
+                }
+            }
+            out.write(reinterpret_cast<const char*>(scales.data()), scales.size() * sizeof(float));
+            out.write(reinterpret_cast<const char*>(q.data()), q.size());
+        } else {
+            out.write(reinterpret_cast<const char*>(layer.weight.data()), layer.weight.size() * sizeof(float));
+        }
+        out.write(reinterpret_cast<const char*>(layer.bias.data()), layer.bias.size() * sizeof(float));
+    }
+
+    void write_norm(std::ofstream& out, const PackedPolicy::Norm& norm) {
+        int32_t n = static_cast<int32_t>(norm.gamma.size());
+        out.write(reinterpret_cast<const char*>(&n), sizeof(n));
+        out.write(reinterpret_cast<const char*>(norm.gamma.data()), n * sizeof(float));
+        out.write(reinterpret_cast<const char*>(norm.beta.data()), n * sizeof(float));
+    }
+
+    template<typename T>
+    void read_into(std::ifstream& in, T* dst, size_t count) {
+        in.read(reinterpret_cast<char*>(dst), count * sizeof(T));
+        if (!in) throw std::runtime_error("Truncated policy file");
+    }
+
+    Dense read_dense(std::ifstream& in, PolicyRuntime::Precision precision, int expect_rows, int expect_cols) {
+        int32_t dims[2];
+        read_into(in, dims, 2);
+        if (dims[0] != expect_rows || dims[1] != expect_cols) {
+            BCOD_ERROR("Policy layer shape mismatch: got ", dims[0], "x", dims[1],
+                       ", expected ", expect_rows, "x", expect_cols);
+            throw std::runtime_error("Policy layer shape mismatch");
+        }
+        Dense d;
+        d.rows = dims[0];
+        d.cols = dims[1];
+        const size_t n = static_cast<size_t>(d.rows) * d.cols;
+        if (precision == PolicyRuntime::Precision::INT8) {
+            d.scale.resize(d.rows);
+            d.q.resize(n);
+            read_into(in, d.scale.data(), d.scale.size());
+            read_into(in, d.q.data(), n);
+        } else {
+            d.w.resize(n);
+            read_into(in, d.w.data(), n);
+        }
+        d.bias.resize(d.rows);
+        read_into(in, d.bias.data(), d.bias.size());
+        return d;
+    }
+
+    Norm read_norm(std::ifstream& in, int expect) {
+        int32_t n;
+        read_into(in, &n, 1);
+        if (n != expect) throw std::runtime_error("Policy norm shape mismatch");
+        Norm norm;
+        norm.gamma.resize(n);
+        norm.beta.resize(n);
+        read_into(in, norm.gamma.data(), n);
+        read_into(in, norm.beta.data(), n);
+        return norm;
+    }
+
+    // C[M, N] = A[M, K] * B[K, N] + bias, optionally followed by ReLU.
+    // i-k-j order keeps the innermost loop contiguous in B and C so it
+    // vectorises; K is blocked to keep the active rows of B in cache.
+    void gemm(const Dense& a, const float* B, int N, float* C, bool relu) {
+        const int M = a.rows, K = a.cols;
+        constexpr int KB = 128;
+        for (int i = 0; i < M; ++i) {
+            float* c = C + static_cast<size_t>(i) * N;
+            std::fill(c, c + N, 0.0f);
+        }
+        for (int k0 = 0; k0 < K; k0 += KB) {
+            const int k1 = std::min(K, k0 + KB);
+            for (int i = 0; i < M; ++i) {
+                float* c = C + static_cast<size_t>(i) * N;
+                for (int k = k0; k < k1; ++k) {
+                    const size_t idx = static_cast<size_t>(i) * K + k;
+                    const float av = a.q.empty() ? a.w[idx] : static_cast<float>(a.q[idx]);
+                    const float* b = B + static_cast<size_t>(k) * N;
+                    for (int j = 0; j < N; ++j) c[j] += av * b[j];
+                }
+            }
+        }
+        for (int i = 0; i < M; ++i) {
+            float* c = C + static_cast<size_t>(i) * N;
+            const float s = a.q.empty() ? 1.0f : a.scale[i];
+            const float bias = a.bias[i];
+            for (int j = 0; j < N; ++j) {
+                float v = c[j] * s + bias;
+                c[j] = relu ? std::max(v, 0.0f) : v;
+            }
+        }
+    }
+
+    // y[rows] = W x + b
+    void gemv(const Dense& a, const float* x, float* y) {
+        for (int r = 0; r < a.rows; ++r) {
+            float acc = 0.0f;
+            const size_t base = static_cast<size_t>(r) * a.cols;
+            if (a.q.empty()) {
+                const float* w = a.w.data() + base;
+                for (int c = 0; c < a.cols; ++c) acc += w[c] * x[c];
+                y[r] = acc + a.bias[r];
+            } else {
+                const int8_t* w = a.q.data() + base;
+                for (int c = 0; c < a.cols; ++c) acc += static_cast<float>(w[c]) * x[c];
+                y[r] = acc * a.scale[r] + a.bias[r];
+            }
+        }
+    }
+
+    void layer_norm(float* x, const Norm& norm, int n, bool relu) {
+        float mean = 0.0f, var = 0.0f;
+        for (int i = 0; i < n; ++i) mean += x[i];
+        mean /= n;
+        for (int i = 0; i < n; ++i) var += (x[i] - mean) * (x[i] - mean);
+        var /= n;
+        const float inv = 1.0f / std::sqrt(var + kNormEps);
+        for (int i = 0; i < n; ++i) {
+            float v = (x[i] - mean) * inv * norm.gamma[i] + norm.beta[i];
+            x[i] = relu ? std::max(v, 0.0f) : v;
+        }
+    }
+
+    // 3x3, padding 1. col is [in_c * 9, out_h * out_w].
+    void im2col(const float* src, const ConvShape& s, float* col) {
+        const int plane = s.out_h * s.out_w;
+        for (int c = 0; c < s.in_c; ++c) {
+            const float* img = src + static_cast<size_t>(c) * s.in_h * s.in_w;
+            for (int ky = 0; ky < 3; ++ky) {
+                for (int kx = 0; kx < 3; ++kx) {
+                    float* dst = col + static_cast<size_t>((c * 3 + ky) * 3 + kx) * plane;
+                    for (int oy = 0; oy < s.out_h; ++oy) {
+                        const int iy = oy * s.stride + ky - 1;
+                        float* row = dst + oy * s.out_w;
+                        if (iy < 0 || iy >= s.in_h) {
+                            std::fill(row, row + s.out_w, 0.0f);
+                            continue;
+                        }
+                        const float* in_row = img + iy * s.in_w;
+                        for (int ox = 0; ox < s.out_w; ++ox) {
+                            const int ix = ox * s.stride + kx - 1;
+                            row[ox] = (ix >= 0 && ix < s.in_w) ? in_row[ix] : 0.0f;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    ConvShape conv_shape(int in_c, int in_h, int in_w, int out_c, int stride) {
+        return {in_c, in_h, in_w, out_c, (in_h + 2 - 3) / stride + 1, (in_w + 2 - 3) / stride + 1, stride};
+    }
+}
+
+void PackedPolicy::save(const std::string& path, PolicyRuntime::Precision precision) const {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        BCOD_ERROR("Failed to open policy output file: ", path);
+        throw std::runtime_error("Failed to open policy output file");
+    }
+    FileHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = PolicyRuntime::FORMAT_VERSION;
+    header.precision = static_cast<uint32_t>(precision);
+    header.in_channels = in_channels;
+    header.height = height;
+    header.width = width;
+    header.hidden_dim = hidden_dim;
+    header.num_sensors = num_sensors;
+    header.context_dim = context_dim;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    write_layer(out, conv1, precision);
+    write_layer(out, conv2, precision);
+    write_layer(out, conv3, precision);
+    write_layer(out, enc_fc1, precision);
+    write_norm(out, enc_ln1);
+    write_layer(out, enc_fc2, precision);
+    write_norm(out, enc_ln2);
+    write_layer(out, head_fc1, precision);
+    write_norm(out, head_ln1);
+    write_layer(out, head_fc2, precision);
+    write_norm(out, head_ln2);
+    write_layer(out, head_fc3, precision);
+    write_norm(out, head_ln3);
+}
+
+struct PolicyRuntime::Impl {
+    FileHeader header;
+    Precision precision;
+    ConvShape s1, s2, s3;
+    Dense conv1, conv2, conv3, enc_fc1, enc_fc2, head_fc1, head_fc2, head_fc3;
+    Norm enc_ln1, enc_ln2, head_ln1, head_ln2, head_ln3;
+
+    // Scratch buffers sized once at load time
+    std::vector<float> col, act1, act2, act3, hidden_a, hidden_b, head_in, logits;
+
+    Impl(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            BCOD_ERROR("Failed to open policy file: ", path);
+            throw std::runtime_error("Failed to open policy file");
+        }
+        read_into(in, &header, 1);
+        if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != FORMAT_VERSION) {
+            BCOD_ERROR("Unsupported policy file: ", path);
+            throw std::runtime_error("Unsupported policy file");
+        }
+        if (header.precision != static_cast<uint32_t>(Precision::FP32) &&
+            header.precision != static_cast<uint32_t>(Precision::INT8)) {
+            BCOD_ERROR("Unknown precision ", header.precision, " in policy file: ", path);
+            throw std::runtime_error("Unknown policy precision");
+        }
+        if (header.in_channels <= 0 || header.height <= 0 || header.width <= 0 || header.hidden_dim <= 0 ||
+            header.num_sensors <= 0 || header.context_dim < 0) {
+            BCOD_ERROR("Invalid dimensions in policy file: ", path);
+            throw std::runtime_error("Invalid policy dimensions");
+        }
+        precision = static_cast<Precision>(header.precision);
+        const int H = header.hidden_dim;
+        s1 = conv_shape(header.in_channels, header.height, header.width, 64, 1);
+        s2 = conv_shape(64, s1.out_h, s1.out_w, 128, 2);
+        s3 = conv_shape(128, s2.out_h, s2.out_w, H, 2);
+        const int flat = H * s3.out_h * s3.out_w;
+
+        conv1 = read_dense(in, precision, 64, s1.in_c * 9);
+        conv2 = read_dense(in, precision, 128, s2.in_c * 9);
+        conv3 = read_dense(in, precision, H, s3.in_c * 9);
+        enc_fc1 = read_dense(in, precision, H, flat);
+        enc_ln1 = read_norm(in, H);
+        enc_fc2 = read_dense(in, precision, H, H);
+        enc_ln2 = read_norm(in, H);
+        head_fc1 = read_dense(in, precision, H, H + header.context_dim);
+        head_ln1 = read_norm(in, H);
+        head_fc2 = read_dense(in, precision, H, H);
+        head_ln2 = read_norm(in, H);
+        head_fc3 = read_dense(in, precision, header.num_sensors, H);
+        head_ln3 = read_norm(in, header.num_sensors);
+
+        size_t col_size = std::max({static_cast<size_t>(s1.in_c) * 9 * s1.out_h * s1.out_w,
+                                    static_cast<size_t>(s2.in_c) * 9 * s2.out_h * s2.out_w,
+                                    static_cast<size_t>(s3.in_c) * 9 * s3.out_h * s3.out_w});
+        col.resize(col_size);
+        act1.resize(static_cast<size_t>(64) * s1.out_h * s1.out_w);
+        act2.resize(static_cast<size_t>(128) * s2.out_h * s2.out_w);
+        act3.resize(static_cast<size_t>(flat));
+        hidden_a.resize(H);
+        hidden_b.resize(H);
+        head_in.resize(H + header.context_dim);
+        logits.resize(header.num_sensors);
+    }
+
+    void forward(const float* belief, const float* context, float* probabilities) {
+        const int H = header.hidden_dim;
+
+        // Encoder: (conv + folded BN + ReLU) x 3
+        im2col(belief, s1, col.data());
+        gemm(conv1, col.data(), s1.out_h * s1.out_w, act1.data(), true);
+        im2col(act1.data(), s2, col.data());
+        gemm(conv2, col.data(), s2.out_h * s2.out_w, act2.data(), true);
+        im2col(act2.data(), s3, col.data());
+        gemm(conv3, col.data(), s3.out_h * s3.out_w, act3.data(), true);
+
+        gemv(enc_fc1, act3.data(), hidden_a.data());
+        layer_norm(hidden_a.data(), enc_ln1, H, true);
+        gemv(enc_fc2, hidden_a.data(), hidden_b.data());
+        layer_norm(hidden_b.data(), enc_ln2, H, true);
+
+        // Policy head on [features, context]
+        std::copy(hidden_b.begin(), hidden_b.end(), head_in.begin());
+        std::copy(context, context + header.context_dim, head_in.begin() + H);
+        gemv(head_fc1, head_in.data(), hidden_a.data());
+        layer_norm(hidden_a.data(), head_ln1, H, true);
+        gemv(head_fc2, hidden_a.data(), hidden_b.data());
+        layer_norm(hidden_b.data(), head_ln2, H, true);
+        gemv(head_fc3, hidden_b.data(), logits.data());
+        layer_norm(logits.data(), head_ln3, header.num_sensors, false);
+
+        for (int i = 0; i < header.num_sensors; ++i) {
+            probabilities[i] = 1.0f / (1.0f + std::exp(-logits[i]));
+        }
+    }
+};
+
+PolicyRuntime::PolicyRuntime(const std::string& path) : impl_(std::make_unique<Impl>(path)) {}
+PolicyRuntime::~PolicyRuntime() = default;
+
+void PolicyRuntime::forward(const float* belief, const float* context, float* probabilities) {
+    impl_->forward(belief, context, probabilities);
+}
+
+int PolicyRuntime::in_channels() const { return impl_->header.in_channels; }
+int PolicyRuntime::height() const { return impl_->header.height; }
+int PolicyRuntime::width() const { return impl_->header.width; }
+int PolicyRuntime::num_sensors() const { return impl_->header.num_sensors; }
+int PolicyRuntime::hidden_dim() const { return impl_->header.hidden_dim; }
+int PolicyRuntime::context_dim() const { return impl_->header.context_dim; }
+PolicyRuntime::Precision PolicyRuntime::precision() const { return impl_->precision; }
+
+} // namespace bcod
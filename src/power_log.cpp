@@ -0,0 +1,251 @@
+#include <bcod/power_log.hpp>
+#include <bcod/logging.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iomanip>
+#include <thread>
+#include <vector>
+
+namespace bcod {
+
+namespace {
+    constexpr int64_t kNsPerSecond = 1000000000;
+
+    // Days since 1970-01-01 of a proleptic Gregorian date (Howard Hinnant's
+    // days_from_civil).
+    int64_t days_from_civil(int64_t y, unsigned m, unsigned d) {
+        y -= m <= 2;
+        const int64_t era = (y >= 0 ? y : y - 399) / 400;
+        const unsigned yoe = static_cast<unsigned>(y - era * 400);
+        const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+        const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+        return era * 146097 + static_cast<int64_t>(doe) - 719468;
+    }
+
+    const char* get_sensor_name(SensorType sensor) {
+        switch (sensor) {
+            case SensorType::LIDAR:   return "LIDAR";
+            case SensorType::RGB:     return "RGB Camera";
+            case SensorType::THERMAL: return "Thermal Camera";
+            case SensorType::GNSS:    return "GNSS";
+            case SensorType::IMU:     return "IMU";
+            case SensorType::EXO2:    return "EXO2";
+            default:                  return "Unknown";
+        }
+    }
+}
+
+bool parse_timestamp(const char*& p, const char* end, int64_t& ns) {
+    if (end - p < 19) return false;
+    auto digits = [&](int offset, int count, int& value) {
+        value = 0;
+        for (int i = 0; i < count; ++i) {
+            const char c = p[offset + i];
+            if (c < '0' || c > '9') return false;
+            value = value * 10 + (c - '0');
+        }
+        return true;
+    };
+    int year, month, day, hour, minute, second;
+    if (!digits(0, 4, year) || p[4] != '-' || !digits(5, 2, month) || p[7] != '-' ||
+        !digits(8, 2, day) || (p[10] != 'T' && p[10] != ' ') || !digits(11, 2, hour) || p[13] != ':' ||
+        !digits(14, 2, minute) || p[16] != ':' || !digits(17, 2, second)) {
+        return false;
+    }
+    if (month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60) return false;
+
+    p += 19;
+    int64_t fraction = 0;
+    if (p < end && *p == '.') {
+        ++p;
+        int64_t scale = kNsPerSecond;
+        while (p < end && *p >= '0' && *p <= '9') {
+            if (scale > 1) {
+                scale /= 10;
+                fraction += (*p - '0') * scale;
+            }
+            ++p;
+        }
+    }
+    const int64_t seconds = days_from_civil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second;
+    ns = seconds * kNsPerSecond + fraction;
+    return true;
+}
+
+bool parse_power_event(const char* p, const char* end, PowerEvent& event) {
+    auto skip_blank = [&] { while (p < end && (*p == ' ' || *p == '\t')) ++p; };
+    skip_blank();
+    if (!parse_timestamp(p, end, event.ns)) return false;
+    skip_blank();
+
+    if (p == end || *p < '0' || *p > '9') return false;
+    int sensor = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        sensor = sensor * 10 + (*p++ - '0');
+        if (sensor >= kNumSensors) return false;
+    }
+    event.sensor = sensor;
+    skip_blank();
+
+    const size_t rest = end - p;
+    if (rest >= 3 && std::memcmp(p, "OFF", 3) == 0) {
+        event.on = false;
+        p += 3;
+    } else if (rest >= 2 && std::memcmp(p, "ON", 2) == 0) {
+        event.on = true;
+        p += 2;
+    } else {
+        return false;
+    }
+    skip_blank();
+    return p == end || *p == '\r';
+}
+
+void SensorSummary::add(const PowerEvent& e) {
+    if (!first_off) {
+        if (e.on) {
+            if (!first_on) first_on = e.ns;
+            ++ons_before_off;
+        } else {
+            first_off = e.ns;
+        }
+        return;
+    }
+    if (e.on) {
+        if (on) {
+            ++repeated_on;
+        } else {
+            on = true;
+            on_since = e.ns;
+            ++activations;
+        }
+    } else if (!on) {
+        ++stray_off;
+    } else {
+        if (e.ns >= on_since) on_ns += e.ns - on_since;
+        else ++out_of_order;
+        on = false;
+    }
+}
+
+void scan_power_chunk(const char* begin, const char* end, ChunkSummary& out) {
+    const char* p = begin;
+    PowerEvent event;
+    while (p < end) {
+        const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        const char* line_end = nl ? nl : end;
+        if (line_end > p && !(line_end - p == 1 && *p == '\r')) {
+            if (parse_power_event(p, line_end, event)) {
+                out.sensors[event.sensor].add(event);
+                out.last_ns = std::max(out.last_ns, event.ns);
+                ++out.events;
+            } else {
+                ++out.malformed;
+            }
+        }
+        p = line_end + 1;
+    }
+}
+
+void SensorTotals::interval(int64_t from, int64_t to) {
+    if (to >= from) on_ns += to - from;
+    else ++out_of_order;
+}
+
+void SensorTotals::stitch(const SensorSummary& s) {
+    if (s.first_off) {
+        if (on) {
+            interval(on_since, *s.first_off);
+            repeated_on += s.ons_before_off;
+        } else if (s.first_on) {
+            ++activations;
+            interval(*s.first_on, *s.first_off);
+            repeated_on += s.ons_before_off - 1;
+        } else {
+            ++stray_off;
+        }
+        on_ns += s.on_ns;
+        activations += s.activations;
+        repeated_on += s.repeated_on;
+        stray_off += s.stray_off;
+        out_of_order += s.out_of_order;
+        on = s.on;
+        on_since = s.on_since;
+    } else if (s.ons_before_off > 0) {
+        if (on) {
+            repeated_on += s.ons_before_off;
+        } else {
+            ++activations;
+            repeated_on += s.ons_before_off - 1;
+            on = true;
+            on_since = *s.first_on;
+        }
+    }
+}
+
+PowerAnalyzer::PowerAnalyzer(const std::string& log_path, size_t chunk_bytes)
+    : file_(log_path, MappedFile::Access::SEQUENTIAL), chunk_bytes_(chunk_bytes) {}
+
+void PowerAnalyzer::analyze(int num_threads) {
+    const auto ranges = file_.line_chunks(chunk_bytes_);
+    std::vector<ChunkSummary> chunks(ranges.size());
+    std::atomic<size_t> next{0};
+
+    std::vector<std::thread> workers;
+    for (int w = 0; w < std::max(1, num_threads); ++w) {
+        workers.emplace_back([&] {
+            for (size_t c = next++; c < ranges.size(); c = next++) {
+                const char* begin = reinterpret_cast<const char*>(file_.data()) + ranges[c].offset;
+                scan_power_chunk(begin, begin + ranges[c].length, chunks[c]);
+                file_.release(ranges[c].offset, ranges[c].length);
+            }
+        });
+    }
+    for (auto& t : workers) t.join();
+
+    for (const auto& chunk : chunks) {
+        for (int s = 0; s < kNumSensors; ++s) totals_[s].stitch(chunk.sensors[s]);
+        events_ += chunk.events;
+        malformed_ += chunk.malformed;
+        last_ns_ = std::max(last_ns_, chunk.last_ns);
+    }
+
+    for (auto& t : totals_) {
+        if (t.on) t.interval(t.on_since, last_ns_);
+    }
+    if (malformed_ > 0) {
+        BCOD_WARN("Skipped ", malformed_, " malformed line(s) in ", file_.path());
+    }
+}
+
+void PowerAnalyzer::write_report(std::ostream& report) const {
+    report << std::fixed << std::setprecision(2);
+    report << "Power Consumption Report\n";
+    report << "=======================\n\n";
+
+    double total_energy_wh = 0.0;
+    for (int i = 0; i < kNumSensors; ++i) {
+        const SensorTotals& t = totals_[i];
+        const double seconds = static_cast<double>(t.on_ns) / kNsPerSecond;
+        const double energy_wh = SensorConfig::POWER_CONSUMPTION[i] * seconds / 3600.0;
+
+        report << get_sensor_name(static_cast<SensorType>(i)) << ":\n";
+        report << "  Activations: " << t.activations << "\n";
+        report << "  Total time: " << seconds << " seconds\n";
+        report << "  Energy: " << energy_wh << " Wh\n";
+        report << "  Average power: " << SensorConfig::POWER_CONSUMPTION[i] << " W\n";
+        if (t.on) report << "  Still on at end of log\n";
+        if (t.repeated_on || t.stray_off || t.out_of_order) {
+            report << "  Ignored events: " << t.repeated_on << " repeated ON, " << t.stray_off
+                   << " OFF while off, " << t.out_of_order << " out of order\n";
+        }
+        report << "\n";
+        total_energy_wh += energy_wh;
+    }
+
+    report << "Total energy consumption: " << total_energy_wh << " Wh\n";
+    report << "Events: " << events_ << ", malformed lines: " << malformed_ << "\n";
+}
+
+} // namespace bcod
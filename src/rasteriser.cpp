@@ -6,16 +6,11 @@
 namespace bcod {
 
 struct BeliefRasteriser::Impl {
-    Impl(const JsonConfig& config) {
-        resolution_ = config.get<double>("rasteriser.resolution", 0.1);
-        max_range_ = config.get<double>("rasteriser.max_range", 10.0);
-        min_weight_ = config.get<double>("rasteriser.min_weight", 0.01);
-        
-        origin_ = Eigen::Vector2d(
-            config.get<double>("rasteriser.origin_x", 0.0),
-            config.get<double>("rasteriser.origin_y", 0.0)
-        );
-    }
+    Impl(const RasteriserParams& params)
+        : resolution_(params.resolution),
+          max_range_(params.max_range),
+          min_weight_(params.min_weight),
+          origin_(params.origin_x, params.origin_y) {}
     
     double resolution_;
     double max_range_;
@@ -23,8 +18,8 @@ struct BeliefRasteriser::Impl {
     Eigen::Vector2d origin_;
 };
 
-BeliefRasteriser::BeliefRasteriser(const JsonConfig& config)
-    : pimpl_(std::make_unique<Impl>(config)) {}
+BeliefRasteriser::BeliefRasteriser(const RasteriserParams& params)
+    : pimpl_(std::make_unique<Impl>(params)) {}
 
 BeliefRasteriser::~BeliefRasteriser() = default;
 
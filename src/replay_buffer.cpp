@@ -0,0 +1,36 @@
+#include <bcod/replay_buffer.hpp>
+
+namespace bcod {
+
+ReplayBuffer::ReplayBuffer(int capacity, uint64_t seed) : capacity_(capacity), rng_(seed) {}
+
+void ReplayBuffer::push(const Transition& transition) {
+    if (static_cast<int>(buffer_.size()) >= capacity_) {
+        buffer_.pop_front();
+    }
+    buffer_.push_back(transition);
+}
+
+std::vector<ReplayBuffer::Transition> ReplayBuffer::sample(int batch_size) {
+    std::uniform_int_distribution<int> dist(0, static_cast<int>(buffer_.size()) - 1);
+    std::vector<Transition> batch;
+    batch.reserve(batch_size);
+    for (int i = 0; i < batch_size; ++i) {
+        batch.push_back(buffer_[dist(rng_)]);
+    }
+    return batch;
+}
+
+int ReplayBuffer::size() const {
+    return static_cast<int>(buffer_.size());
+}
+
+int ReplayBuffer::capacity() const {
+    return capacity_;
+}
+
+void ReplayBuffer::seed(uint64_t seed) {
+    rng_.seed(static_cast<std::mt19937::result_type>(seed));
+}
+
+} // namespace bcod
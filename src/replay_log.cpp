@@ -0,0 +1,117 @@
+#include <bcod/replay_log.hpp>
+#include <bcod/logging.hpp>
+#include <cstring>
+#include <stdexcept>
+
+namespace bcod {
+
+namespace {
+    constexpr size_t STDIO_BUFFER = 1 << 20;
+}
+
+ReplayLogWriter::ReplayLogWriter(const std::string& path) {
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) {
+        BCOD_ERROR("Failed to open replay log: ", path);
+        throw std::runtime_error("Failed to open replay log: " + path);
+    }
+    buffer_.resize(STDIO_BUFFER);
+    std::setvbuf(file_, buffer_.data(), _IOFBF, buffer_.size());
+
+    ReplayLogHeader header;
+    std::memcpy(header.magic, ReplayLogHeader::MAGIC, sizeof(header.magic));
+    header.version = ReplayLogHeader::VERSION;
+    header.particle_size = sizeof(LoggedParticle);
+    std::fwrite(&header, sizeof(header), 1, file_);
+}
+
+ReplayLogWriter::~ReplayLogWriter() {
+    close();
+}
+
+void ReplayLogWriter::append(int64_t timestamp_ns, uint32_t sensor_mask, const Eigen::Vector3d& pose,
+                             const Eigen::Vector2d& goal, double goal_distance,
+                             const std::vector<Particle>& particles) {
+    if (!file_) {
+        BCOD_ERROR("Append to a closed replay log");
+        throw std::logic_error("Append to a closed replay log");
+    }
+
+    ReplayFrameHeader frame{};
+    frame.timestamp_ns = timestamp_ns;
+    frame.sensor_mask = sensor_mask;
+    frame.num_particles = static_cast<uint32_t>(particles.size());
+    for (int i = 0; i < 3; ++i) frame.pose[i] = static_cast<float>(pose[i]);
+    frame.goal[0] = static_cast<float>(goal.x());
+    frame.goal[1] = static_cast<float>(goal.y());
+    frame.goal_distance = static_cast<float>(goal_distance);
+
+    packed_.resize(particles.size());
+    for (size_t i = 0; i < particles.size(); ++i) {
+        const Particle& p = particles[i];
+        packed_[i] = {static_cast<float>(p.position.x()), static_cast<float>(p.position.y()),
+                      static_cast<float>(p.yaw), static_cast<float>(p.weight),
+                      {static_cast<float>(p.covariance[0]), static_cast<float>(p.covariance[1]),
+                       static_cast<float>(p.covariance[3])},
+                      static_cast<float>(p.confidence)};
+    }
+
+    std::fwrite(&frame, sizeof(frame), 1, file_);
+    std::fwrite(packed_.data(), sizeof(LoggedParticle), packed_.size(), file_);
+}
+
+void ReplayLogWriter::close() {
+    if (file_) {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+}
+
+ReplayLog::ReplayLog(const std::string& path) : file_(path, MappedFile::Access::SEQUENTIAL) {
+    ReplayLogHeader header;
+    if (file_.size() < sizeof(header)) {
+        throw std::runtime_error("Replay log too short: " + path);
+    }
+    std::memcpy(&header, file_.data(), sizeof(header));
+    if (std::memcmp(header.magic, ReplayLogHeader::MAGIC, sizeof(header.magic)) != 0) {
+        throw std::runtime_error("Not a replay log: " + path);
+    }
+    if (header.version != ReplayLogHeader::VERSION || header.particle_size != sizeof(LoggedParticle)) {
+        throw std::runtime_error("Unsupported replay log version in " + path);
+    }
+
+    size_t offset = sizeof(header);
+    while (offset + sizeof(ReplayFrameHeader) <= file_.size()) {
+        const auto* frame = reinterpret_cast<const ReplayFrameHeader*>(file_.data() + offset);
+        const size_t next = offset + sizeof(ReplayFrameHeader) + frame->num_particles * sizeof(LoggedParticle);
+        if (next > file_.size()) break;
+        offsets_.push_back(offset);
+        offset = next;
+    }
+    if (offset != file_.size()) {
+        BCOD_WARN("Ignoring truncated trailing frame in ", path);
+    }
+}
+
+ReplayLog::Frame ReplayLog::operator[](size_t i) const {
+    const uint8_t* base = file_.data() + offsets_[i];
+    return {reinterpret_cast<const ReplayFrameHeader*>(base),
+            reinterpret_cast<const LoggedParticle*>(base + sizeof(ReplayFrameHeader))};
+}
+
+void ReplayLog::unpack(const Frame& frame, std::vector<Particle>& out) {
+    out.resize(frame.header->num_particles);
+    for (size_t i = 0; i < out.size(); ++i) {
+        const LoggedParticle& q = frame.particles[i];
+        Particle& p = out[i];
+        p.position = Eigen::Vector2d(q.x, q.y);
+        p.yaw = q.yaw;
+        p.weight = q.weight;
+        p.covariance = {q.covariance[0], q.covariance[1], q.covariance[1], q.covariance[2]};
+        p.confidence = q.confidence;
+        p.timestamp = frame.header->timestamp_ns;
+        p.features.clear();
+    }
+}
+
+} // namespace bcod
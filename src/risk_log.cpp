@@ -0,0 +1,182 @@
+#include <bcod/risk_log.hpp>
+#include <bcod/logging.hpp>
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+
+namespace bcod {
+
+namespace {
+    // The library builds with -ffast-math, which lets the compiler assume
+    // std::isfinite is true. The exponent bits say the same without a
+    // floating-point test.
+    bool finite(double v) {
+        uint64_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        return ((bits >> 52) & 0x7ff) != 0x7ff;
+    }
+}
+
+void RunningStats::add(double x) {
+    ++n;
+    const double delta = x - mean;
+    mean += delta / n;
+    m2 += delta * (x - mean);
+    max = std::max(max, x);
+}
+
+void RunningStats::merge(const RunningStats& other) {
+    if (other.n == 0) return;
+    const double total = static_cast<double>(n + other.n);
+    const double delta = other.mean - mean;
+    mean += delta * other.n / total;
+    m2 += other.m2 + delta * delta * n * other.n / total;
+    n += other.n;
+    max = std::max(max, other.max);
+}
+
+double RunningStats::stddev() const { return n ? std::sqrt(m2 / n) : 0.0; }
+
+LogBins::LogBins(double lo, double hi, int bins)
+    : lo_(lo), log_lo_(std::log(lo)), bins_(bins), scale_(bins / (std::log(hi) - std::log(lo))) {}
+
+int LogBins::index(double x) const {
+    if (!(x >= lo_)) return underflow();
+    const double i = (std::log(x) - log_lo_) * scale_;
+    return i >= bins_ ? overflow() : 1 + static_cast<int>(i);
+}
+
+double LogBins::edge(int i) const { return std::exp(log_lo_ + (i - 1) / scale_); }
+
+double LogBins::centre(int i) const {
+    if (i <= underflow()) return 0.0;
+    if (i >= overflow()) return edge(overflow());
+    return std::exp(log_lo_ + (i - 0.5) / scale_);
+}
+
+const LogBins RiskAccumulator::ERROR_BINS(1e-9, 1e3, 1200);
+
+RiskAccumulator::RiskAccumulator(const LogBins& risk)
+    : risk(risk), error_bins(ERROR_BINS.size(), 0), risk_bins(risk.size()) {}
+
+void RiskAccumulator::add(double predicted, double realised) {
+    const double e = std::abs(predicted - realised);
+    error.add(e);
+    ++error_bins[ERROR_BINS.index(e)];
+
+    CalibrationBin& bin = risk_bins[risk.index(predicted)];
+    ++bin.count;
+    bin.predicted += predicted;
+    bin.realised += realised;
+    bin.abs_error += e;
+}
+
+void RiskAccumulator::merge(const RiskAccumulator& other) {
+    error.merge(other.error);
+    for (size_t i = 0; i < error_bins.size(); ++i) error_bins[i] += other.error_bins[i];
+    for (size_t i = 0; i < risk_bins.size(); ++i) {
+        risk_bins[i].count += other.risk_bins[i].count;
+        risk_bins[i].predicted += other.risk_bins[i].predicted;
+        risk_bins[i].realised += other.risk_bins[i].realised;
+        risk_bins[i].abs_error += other.risk_bins[i].abs_error;
+    }
+    malformed += other.malformed;
+}
+
+double RiskAccumulator::error_quantile(double q) const {
+    const uint64_t n = error.n;
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(std::clamp(q, 0.0, 1.0) * n)));
+    uint64_t seen = 0;
+    for (int i = 0; i < ERROR_BINS.size(); ++i) {
+        seen += error_bins[i];
+        if (seen >= rank) return std::min(ERROR_BINS.centre(i), error.max);
+    }
+    return error.max;
+}
+
+void RiskAccumulator::write_calibration(std::ostream& out) const {
+    out << std::setprecision(7);
+    out << "bin_lo\tbin_hi\tcount\tmean_predicted\tmean_realised\tmean_abs_error\n";
+    for (int i = 0; i < risk.size(); ++i) {
+        const CalibrationBin& bin = risk_bins[i];
+        if (bin.count == 0) continue;
+        const double lo = i == risk.underflow() ? -std::numeric_limits<double>::infinity() : risk.edge(i);
+        const double hi = i == risk.overflow() ? std::numeric_limits<double>::infinity() : risk.edge(i + 1);
+        out << lo << '\t' << hi << '\t' << bin.count << '\t' << bin.predicted / bin.count << '\t'
+            << bin.realised / bin.count << '\t' << bin.abs_error / bin.count << '\n';
+    }
+}
+
+bool parse_risk_line(const char* p, const char* end, double& predicted, double& realised) {
+    auto skip_blank = [&] { while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) ++p; };
+    auto number = [&](double& value) {
+        skip_blank();
+        const auto result = std::from_chars(p, end, value);
+        if (result.ec != std::errc()) return false;
+        p = result.ptr;
+        return finite(value);
+    };
+    if (!number(predicted) || !number(realised)) return false;
+    skip_blank();
+    return p == end;
+}
+
+RiskAnalyzer::RiskAnalyzer(const std::string& log_path, double min_risk, double max_risk, int num_bins,
+                           size_t chunk_bytes)
+    : file_(log_path, MappedFile::Access::SEQUENTIAL), chunk_bytes_(chunk_bytes),
+      totals_(LogBins(min_risk, max_risk, num_bins)) {}
+
+void RiskAnalyzer::analyze(int num_threads) {
+    const auto ranges = file_.line_chunks(chunk_bytes_);
+    std::atomic<size_t> next{0};
+    std::vector<RiskAccumulator> partial(std::max(1, num_threads), RiskAccumulator(totals_.risk));
+
+    std::vector<std::thread> workers;
+    for (size_t w = 0; w < partial.size(); ++w) {
+        workers.emplace_back([&, w] {
+            for (size_t c = next++; c < ranges.size(); c = next++) {
+                scan(ranges[c], partial[w]);
+                file_.release(ranges[c].offset, ranges[c].length);
+            }
+        });
+    }
+    for (auto& t : workers) t.join();
+    for (const auto& acc : partial) totals_.merge(acc);
+
+    if (totals_.malformed > 0) {
+        BCOD_WARN("Skipped ", totals_.malformed, " malformed line(s) in ", file_.path());
+    }
+    if (totals_.error.n == 0) {
+        throw std::runtime_error("No risk samples in " + file_.path());
+    }
+}
+
+void RiskAnalyzer::log_summary() const {
+    BCOD_INFO("Risk samples: ", totals_.error.n, ", error mean ", totals_.error.mean,
+              " std ", totals_.error.stddev(), " p50 ", totals_.error_quantile(0.5),
+              " p95 ", totals_.error_quantile(0.95), " p99 ", totals_.error_quantile(0.99),
+              " max ", totals_.error.max);
+}
+
+void RiskAnalyzer::scan(const MappedFile::Range& range, RiskAccumulator& acc) const {
+    const char* p = reinterpret_cast<const char*>(file_.data()) + range.offset;
+    const char* stop = p + range.length;
+    double predicted, realised;
+    while (p < stop) {
+        const char* nl = static_cast<const char*>(std::memchr(p, '\n', stop - p));
+        const char* line_end = nl ? nl : stop;
+        if (line_end > p && !(line_end - p == 1 && *p == '\r')) {
+            if (parse_risk_line(p, line_end, predicted, realised)) acc.add(predicted, realised);
+            else ++acc.malformed;
+        }
+        p = line_end + 1;
+    }
+}
+
+} // namespace bcod
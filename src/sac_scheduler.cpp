@@ -1,6 +1,16 @@
 #include <bcod/sac_scheduler.hpp>
+#include <bcod/policy_runtime.hpp>
+#include <bcod/replay_buffer.hpp>
+#include <bcod/sensor_defs.hpp>
+#include <bcod/logging.hpp>
+#include <bcod/trace.hpp>
+#include <bcod/instrumentation.hpp>
+#include <bcod/tensor_packing.hpp>
+#include <bcod/feature_cache.hpp>
+#include <bcod/warmup_lookahead.hpp>
 #include <bcod/utils.hpp>
 #include <torch/torch.h>
+#include <ATen/CPUGeneratorImpl.h>
 #include <Eigen/Dense>
 #include <opencv2/opencv.hpp>
 #include <random>
@@ -19,6 +29,48 @@
 
 namespace bcod {
 
+namespace {
+    PackedPolicy::Layer pack_layer(torch::Tensor weight, torch::Tensor bias) {
+        weight = weight.detach().cpu().to(torch::kFloat32).reshape({weight.size(0), -1}).contiguous();
+        bias = bias.detach().cpu().to(torch::kFloat32).contiguous();
+        PackedPolicy::Layer layer;
+        layer.rows = static_cast<int>(weight.size(0));
+        layer.cols = static_cast<int>(weight.size(1));
+        layer.weight.assign(weight.data_ptr<float>(), weight.data_ptr<float>() + weight.numel());
+        layer.bias.assign(bias.data_ptr<float>(), bias.data_ptr<float>() + bias.numel());
+        return layer;
+    }
+
+    // Folds eval-mode BatchNorm into the preceding convolution.
+    PackedPolicy::Layer pack_conv_bn(torch::nn::Conv2d& conv, torch::nn::BatchNorm2d& bn) {
+        auto scale = bn->weight.detach() * (bn->running_var + bn->options.eps()).rsqrt();
+        auto weight = conv->weight.detach() * scale.view({-1, 1, 1, 1});
+        auto bias = conv->bias.defined() ? conv->bias.detach() : torch::zeros_like(bn->running_mean);
+        bias = (bias - bn->running_mean) * scale + bn->bias.detach();
+        return pack_layer(weight, bias);
+    }
+
+    WarmupLookahead::Params lookahead_params(const SchedulerParams& p) {
+        WarmupLookahead::Params l{};
+        l.risk_threshold = p.risk_threshold;
+        l.energy_weight = p.energy_weight;
+        l.safety_weight = p.safety_weight;
+        l.power_budget = std::max(0.0, p.power_budget);
+        l.max_lead_steps = std::max(0, p.lookahead_max_lead);
+        if (p.power_coefficients.size() == static_cast<size_t>(kNumSensors)) l.power_coefficients = p.power_coefficients;
+        return l;
+    }
+
+    PackedPolicy::Norm pack_norm(torch::nn::LayerNorm& ln) {
+        auto gamma = ln->weight.detach().cpu().to(torch::kFloat32).contiguous();
+        auto beta = ln->bias.detach().cpu().to(torch::kFloat32).contiguous();
+        PackedPolicy::Norm norm;
+        norm.gamma.assign(gamma.data_ptr<float>(), gamma.data_ptr<float>() + gamma.numel());
+        norm.beta.assign(beta.data_ptr<float>(), beta.data_ptr<float>() + beta.numel());
+        return norm;
+    }
+}
+
 struct SACScheduler::Impl {
     struct ActorNetwork : torch::nn::Module {
         struct Encoder : torch::nn::Module {
@@ -176,42 +228,6 @@ struct SACScheduler::Impl {
         }
     };
 
-    struct ReplayBuffer {
-        struct Transition {
-            torch::Tensor state;
-            torch::Tensor context;
-            torch::Tensor action;
-            double reward;
-            torch::Tensor next_state;
-            torch::Tensor next_context;
-            bool done;
-        };
-
-        std::deque<Transition> buffer;
-        int capacity;
-        std::mt19937 rng;
-
-        ReplayBuffer(int capacity) : capacity(capacity), rng(std::random_device{}()) {}
-
-        void push(const Transition& transition) {
-            if (buffer.size() >= capacity) {
-                buffer.pop_front();
-            }
-            buffer.push_back(transition);
-        }
-
-        std::vector<Transition> sample(int batch_size) {
-            std::uniform_int_distribution<int> dist(0, buffer.size() - 1);
-            std::vector<Transition> batch;
-            for (int i = 0; i < batch_size; ++i) {
-                batch.push_back(buffer[dist(rng)]);
-            }
-            return batch;
-        }
-
-        int size() const { return buffer.size(); }
-    };
-
     SchedulerParams params;
     std::unique_ptr<ActorNetwork> actor;
     std::unique_ptr<CriticNetwork> critic1;
@@ -223,14 +239,47 @@ struct SACScheduler::Impl {
     torch::optim::Adam critic2_optimizer{nullptr};
     torch::Device device;
     std::mt19937 rng;
+    c10::optional<at::Generator> generator;   // Set by set_seed; otherwise the global torch generator
     std::mutex mtx;
     std::atomic<bool> debug;
     ReplayBuffer replay_buffer;
     double lambda;
     int64_t training_steps;
 
+    // Flattened online/target tensor lists, gathered once so the soft update
+    // never walks the module tree or builds ordered dicts on the hot path.
+    std::vector<torch::Tensor> online_params, target_params;
+    std::vector<torch::Tensor> online_buffers, target_buffers;
+
+    // Inference-only mode: the actor runs through the packed runtime and no
+    // libtorch module is ever constructed.
+    std::unique_ptr<PolicyRuntime> runtime;
+    std::vector<float> runtime_probabilities;
+    InputPacker belief_packer{{5}, 64, 64};
+    FeatureCache feature_cache;   // Critic encoder features of recent rasters, for inference only
+    static constexpr uint32_t CRITIC1_ENCODER = 0;   // feature_key() tags; critic1's is also the shared trunk
+    static constexpr uint32_t CRITIC2_ENCODER = 1;
+
+    // [2^S, S] table of every sensor subset, built on first use per device
+    torch::Tensor candidate_masks;
+
+    // Lookahead mode: warmup clocks of the sensors, advanced from prev_actions,
+    // for each stream of states (SchedulerState::stream)
+    struct LookaheadStream {
+        WarmupLookahead lookahead;
+        int64_t last_timestamp = -1;
+    };
+    std::unordered_map<uint64_t, LookaheadStream> lookahead_streams;
+
     Impl(const SchedulerParams& p) : params(p), device(torch::kCPU), rng(std::random_device{}()), debug(false), 
         replay_buffer(p.buffer_size), lambda(p.lambda_init), training_steps(0) {
+        if (params.inference_only) {
+            load_runtime(params.policy_path);
+            if (params.use_mask_search) {
+                BCOD_WARN("Mask search needs the critics, ignored in inference-only mode");
+            }
+            return;
+        }
         actor = std::make_unique<ActorNetwork>(params);
         critic1 = std::make_unique<CriticNetwork>(params);
         critic2 = std::make_unique<CriticNetwork>(params);
@@ -247,16 +296,112 @@ struct SACScheduler::Impl {
         critic1_optimizer = torch::optim::Adam(critic1->parameters(), torch::optim::AdamOptions(params.learning_rate));
         critic2_optimizer = torch::optim::Adam(critic2->parameters(), torch::optim::AdamOptions(params.learning_rate));
         
-        target_critic1->load_state_dict(critic1->state_dict());
-        target_critic2->load_state_dict(critic2->state_dict());
+        collect_target_tensors();
+        hard_update_targets();
+    }
+
+    void collect_target_tensors() {
+        online_params.clear(); target_params.clear();
+        online_buffers.clear(); target_buffers.clear();
+        auto gather = [this](CriticNetwork& online, CriticNetwork& target) {
+            auto op = online.parameters(), tp = target.parameters();
+            online_params.insert(online_params.end(), op.begin(), op.end());
+            target_params.insert(target_params.end(), tp.begin(), tp.end());
+            auto ob = online.buffers(), tb = target.buffers();
+            for (size_t i = 0; i < ob.size(); ++i) {
+                // num_batches_tracked is integral and has no meaningful average
+                if (!ob[i].is_floating_point()) continue;
+                online_buffers.push_back(ob[i]);
+                target_buffers.push_back(tb[i]);
+            }
+        };
+        gather(*critic1, *target_critic1);
+        gather(*critic2, *target_critic2);
+        for (auto& t : target_params) t.set_requires_grad(false);
+    }
+
+    // target <- (1 - tau) * target + tau * online, fused over all tensors.
+    void soft_update_targets(double tau) {
+        torch::NoGradGuard no_grad;
+        torch::_foreach_mul_(target_params, 1.0 - tau);
+        torch::_foreach_add_(target_params, online_params, tau);
+        torch::_foreach_mul_(target_buffers, 1.0 - tau);
+        torch::_foreach_add_(target_buffers, online_buffers, tau);
+    }
+
+    void hard_update_targets() {
+        torch::NoGradGuard no_grad;
+        for (size_t i = 0; i < target_params.size(); ++i) target_params[i].copy_(online_params[i]);
+        for (size_t i = 0; i < target_buffers.size(); ++i) target_buffers[i].copy_(online_buffers[i]);
     }
 
     SchedulerAction schedule(const SchedulerState& state) {
+        BCOD_SCOPED_TIMER("scheduler.schedule");
+        const auto start = std::chrono::steady_clock::now();
         std::lock_guard<std::mutex> lock(mtx);
+        SchedulerAction action = runtime ? schedule_runtime(state)
+                               : params.use_mask_search ? schedule_search(state)
+                               : schedule_actor(state);
+        finish(state, action, start);
+        return action;
+    }
+
+    SchedulerAction schedule_mean(const SchedulerState& state) {
+        std::lock_guard<std::mutex> lock(mtx);
+        return runtime ? schedule_runtime(state) : schedule_actor(state, false);
+    }
+
+    // schedule() over several states in order. Only the sampled actor batches
+    // its forward pass; the packed runtime and the mask search, which already
+    // scores every mask in one batch, run state by state.
+    std::vector<SchedulerAction> schedule_batch(const std::vector<SchedulerState>& states) {
+        BCOD_SCOPED_TIMER("scheduler.schedule_batch");
+        const auto start = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lock(mtx);
+        std::vector<SchedulerAction> actions;
+        if (runtime || params.use_mask_search || states.size() < 2) {
+            actions.reserve(states.size());
+            for (const auto& state : states) {
+                actions.push_back(runtime ? schedule_runtime(state)
+                                  : params.use_mask_search ? schedule_search(state)
+                                  : schedule_actor(state));
+            }
+        } else {
+            actions = schedule_actor_batch(states);
+        }
+        for (size_t i = 0; i < states.size(); ++i) finish(states[i], actions[i], start);
+        return actions;
+    }
+
+    void finish(const SchedulerState& state, SchedulerAction& action, std::chrono::steady_clock::time_point start) {
+        if (params.use_lookahead) apply_lookahead(state, action);
+
+        BCOD_TRACE(TraceEvent::SCHEDULE, to_bitmask(action.sensor_mask),
+                   state.cvar_risk, state.goal_distance, action.total_power, action.risk_violation,
+                   action.energy_cost, action.safety_cost, action.total_cost, lambda, elapsed_ms(start));
+    }
+
+    // Inference features of one critic encoder for a raster, computed at most
+    // once per frame.
+    torch::Tensor critic_features(const SchedulerState& state, uint64_t raster_hash, uint32_t encoder) {
+        auto& critic = encoder == CRITIC1_ENCODER ? critic1 : critic2;
+        return feature_cache.get_or_compute(feature_key(raster_hash, encoder), [&] {
+            critic->eval();
+            return critic->encoder(belief_packer.pack({state.belief_raster}).to(device));
+        });
+    }
+
+    torch::Tensor trunk_features(const SchedulerState& state) {
+        return critic_features(state, hash_raster(state.belief_raster), CRITIC1_ENCODER);
+    }
+
+    // Stochastic policy: one sample from the libtorch actor, or its mean.
+    SchedulerAction schedule_actor(const SchedulerState& state, bool sample = true) {
         actor->eval();
         torch::NoGradGuard no_grad;
 
-        auto belief_tensor = torch::from_blob(state.belief_raster.data, {1, 5, 64, 64}, torch::kFloat32).to(device);
+        auto features = params.share_encoder ? trunk_features(state)
+                                             : actor->encoder(belief_packer.pack({state.belief_raster}).to(device));
         auto context_tensor = torch::zeros({1, 3}, torch::kFloat32).to(device);
         context_tensor[0][0] = state.cvar_risk;
         context_tensor[0][1] = state.goal_distance;
@@ -264,13 +409,200 @@ struct SACScheduler::Impl {
             context_tensor[0][2] = state.prev_actions[i] ? 1.0f : 0.0f;
         }
 
-        auto [mean, log_std] = actor->forward(belief_tensor, context_tensor);
-        auto action = mean + torch::randn_like(mean) * torch::exp(log_std);
+        auto [mean, log_std] = actor->policy_head(features, context_tensor);
+        if (!sample) {
+            // policy_head already squashes its mean through the sigmoid
+            auto action_cpu = mean.cpu();
+            return make_action(state, action_cpu.data_ptr<float>());
+        }
+        auto noise = generator
+            ? torch::randn(mean.sizes(), generator, mean.options().device(torch::kCPU)).to(mean.device())
+            : torch::randn_like(mean);
+        auto action = mean + noise * torch::exp(log_std);
         action = torch::sigmoid(action);
 
         auto action_cpu = action.cpu();
-        auto action_data = action_cpu.data_ptr<float>();
+        return make_action(state, action_cpu.data_ptr<float>());
+    }
 
+    // schedule_actor() for several states with one encoder and head pass.
+    // Eval-mode BatchNorm and LayerNorm keep the rows independent.
+    std::vector<SchedulerAction> schedule_actor_batch(const std::vector<SchedulerState>& states) {
+        actor->eval();
+        torch::NoGradGuard no_grad;
+
+        const int64_t B = static_cast<int64_t>(states.size());
+        const size_t sample = static_cast<size_t>(belief_packer.channels()) * belief_packer.height() * belief_packer.width();
+        auto beliefs = torch::empty({B, belief_packer.channels(), belief_packer.height(), belief_packer.width()},
+                                    torch::kFloat32);
+        auto context = torch::zeros({B, 3}, torch::kFloat32);
+        auto c = context.accessor<float, 2>();
+        for (int64_t b = 0; b < B; ++b) {
+            const SchedulerState& state = states[b];
+            belief_packer.pack_sample({state.belief_raster}, beliefs.data_ptr<float>() + b * sample);
+            c[b][0] = static_cast<float>(state.cvar_risk);
+            c[b][1] = static_cast<float>(state.goal_distance);
+            c[b][2] = (!state.prev_actions.empty() && state.prev_actions.back()) ? 1.0f : 0.0f;
+        }
+
+        torch::Tensor features;
+        if (params.share_encoder) {
+            critic1->eval();
+            features = critic1->encoder(beliefs.to(device));
+        } else {
+            features = actor->encoder(beliefs.to(device));
+        }
+        auto [mean, log_std] = actor->policy_head(features, context.to(device));
+        // Drawn row by row, so a seeded batch samples what schedule() on each
+        // state in turn would
+        torch::Tensor noise;
+        if (generator) {
+            std::vector<torch::Tensor> rows;
+            rows.reserve(states.size());
+            for (int64_t b = 0; b < B; ++b) {
+                rows.push_back(torch::randn({1, mean.size(1)}, generator, mean.options().device(torch::kCPU)));
+            }
+            noise = torch::cat(rows).to(mean.device());
+        } else {
+            noise = torch::randn_like(mean);
+        }
+        auto action = torch::sigmoid(mean + noise * torch::exp(log_std)).contiguous().cpu();
+
+        std::vector<SchedulerAction> actions;
+        actions.reserve(states.size());
+        const int64_t S = action.size(1);
+        for (int64_t b = 0; b < B; ++b) actions.push_back(make_action(states[b], action.data_ptr<float>() + b * S));
+        return actions;
+    }
+
+    // Deterministic policy: the actor mean is used directly, no sampling.
+    SchedulerAction schedule_runtime(const SchedulerState& state) {
+        float context[3] = {static_cast<float>(state.cvar_risk), static_cast<float>(state.goal_distance),
+                            state.prev_actions.empty() ? 0.0f : (state.prev_actions.back() ? 1.0f : 0.0f)};
+        const auto& belief = belief_packer.pack({state.belief_raster});
+        runtime->forward(belief.data_ptr<float>(), context, runtime_probabilities.data());
+        return make_action(state, runtime_probabilities.data());
+    }
+
+    torch::Tensor make_context(const SchedulerState& state) const {
+        auto context = torch::zeros({1, 3}, torch::kFloat32);
+        auto c = context.accessor<float, 2>();
+        c[0][0] = static_cast<float>(state.cvar_risk);
+        c[0][1] = static_cast<float>(state.goal_distance);
+        c[0][2] = (!state.prev_actions.empty() && state.prev_actions.back()) ? 1.0f : 0.0f;
+        return context.to(device);
+    }
+
+    const torch::Tensor& all_masks() {
+        if (!candidate_masks.defined()) {
+            const int S = static_cast<int>(params.power_coefficients.size());
+            auto table = torch::zeros({1 << S, S}, torch::kFloat32);
+            auto t = table.accessor<float, 2>();
+            for (int m = 0; m < (1 << S); ++m) {
+                for (int i = 0; i < S; ++i) t[m][i] = (m >> i) & 1 ? 1.0f : 0.0f;
+            }
+            candidate_masks = table.to(device);
+        }
+        return candidate_masks;
+    }
+
+    // Deterministic plan-and-pick: each critic encodes the raster once per frame
+    // (or the shared trunk does, for both), the feature is broadcast over all 2^S masks
+    // and both Q heads score them in one batch. Masks over the power budget are discarded; among the rest the
+    // cheapest mask whose predicted CVaR stays under the threshold wins, or the
+    // cheapest overall when none does.
+    SchedulerAction schedule_search(const SchedulerState& state) {
+        critic1->eval();
+        critic2->eval();
+        torch::NoGradGuard no_grad;
+
+        const auto& masks = all_masks();
+        const int64_t M = masks.size(0);
+        auto context = make_context(state).expand({M, -1});
+        torch::Tensor f1, f2;
+        if (params.share_encoder) {
+            f1 = f2 = trunk_features(state).expand({M, -1});
+        } else {
+            const uint64_t raster_hash = hash_raster(state.belief_raster);
+            f1 = critic_features(state, raster_hash, CRITIC1_ENCODER).expand({M, -1});
+            f2 = critic_features(state, raster_hash, CRITIC2_ENCODER).expand({M, -1});
+        }
+        auto q = torch::min(critic1->q_head(f1, context, masks), critic2->q_head(f2, context, masks))
+                     .to(torch::kCPU).contiguous();
+        const float* q_data = q.data_ptr<float>();
+
+        // The forecast is rescaled from the sensors it was made under. On a
+        // stream's first tick prev_actions is empty, and rescaling from no
+        // sensors would leave the risk unscaled for every candidate.
+        const uint32_t reference = to_bitmask(state.forecast_sensors.empty() ? state.prev_actions
+                                                                             : state.forecast_sensors);
+        const int S = static_cast<int>(params.power_coefficients.size());
+        int64_t best = -1;
+        bool best_feasible = false;
+        double best_cost = 0.0, best_risk = 0.0;
+        for (int64_t m = 0; m < M; ++m) {
+            double power = 0.0;
+            for (int i = 0; i < S; ++i) {
+                if ((m >> i) & 1) power += params.power_coefficients[i];
+            }
+            if (power > params.power_budget) continue;
+            const double risk = rescale_risk(state.cvar_risk, reference, static_cast<uint32_t>(m));
+            const bool feasible = risk <= params.risk_threshold;
+            const double excess = std::max(0.0, risk - params.risk_threshold);
+            const double cost = params.energy_weight * power + params.safety_weight * lambda * excess - q_data[m];
+            if (best < 0 || (feasible && !best_feasible) || (feasible == best_feasible && cost < best_cost)) {
+                best = m;
+                best_feasible = feasible;
+                best_cost = cost;
+                best_risk = risk;
+            }
+        }
+        if (best < 0) {
+            BCOD_WARN("No sensor mask fits the ", params.power_budget, " W budget, switching all sensors off");
+            best = 0;
+            best_risk = rescale_risk(state.cvar_risk, reference, 0);
+        }
+
+        std::vector<float> chosen(S);
+        for (int i = 0; i < S; ++i) chosen[i] = (best >> i) & 1 ? 1.0f : 0.0f;
+        SchedulerAction action = make_action(state, chosen.data());
+        action.risk_violation = best_risk > params.risk_threshold ? 1.0 : 0.0;
+        action.safety_cost = action.risk_violation;
+        action.total_cost = params.energy_weight * action.energy_cost + params.safety_weight * action.safety_cost;
+        return action;
+    }
+
+    // Receding-horizon warmup planning on top of whichever policy picked the
+    // mask. The clocks advance by the time since the previous call of the same
+    // stream (state timestamps in ns), or one waypoint step on its first call.
+    void apply_lookahead(const SchedulerState& state, SchedulerAction& action) {
+        BCOD_SCOPED_TIMER("scheduler.lookahead");
+        static Counter& preactivations = Instrumentation::instance().counter("scheduler.preactivations");
+        auto it = lookahead_streams.find(state.stream);
+        if (it == lookahead_streams.end()) {
+            it = lookahead_streams.emplace(state.stream, LookaheadStream{WarmupLookahead(lookahead_params(params))}).first;
+        }
+        LookaheadStream& stream = it->second;
+        double elapsed = state.forecast_dt;
+        if (stream.last_timestamp >= 0 && state.timestamp > stream.last_timestamp) {
+            elapsed = (state.timestamp - stream.last_timestamp) * 1e-9;
+        }
+        stream.last_timestamp = state.timestamp;
+        stream.lookahead.advance(to_bitmask(state.prev_actions), elapsed);
+
+        const auto plan = stream.lookahead.plan(to_bitmask(action.sensor_mask), state.risk_forecast, state.forecast_dt, lambda);
+        if (plan.preactivated == 0) return;
+        for (size_t i = 0; i < action.sensor_mask.size(); ++i) {
+            if (!((plan.preactivated >> i) & 1u)) continue;
+            action.sensor_mask[i] = true;
+            action.total_power += params.power_coefficients[i];
+            preactivations.add();
+        }
+        action.energy_cost = -action.total_power;
+        action.total_cost = params.energy_weight * action.energy_cost + params.safety_weight * action.safety_cost;
+    }
+
+    SchedulerAction make_action(const SchedulerState& state, const float* action_data) const {
         SchedulerAction scheduler_action;
         scheduler_action.sensor_mask.resize(params.power_coefficients.size());
         scheduler_action.probabilities.resize(params.power_coefficients.size());
@@ -297,10 +629,14 @@ struct SACScheduler::Impl {
     }
 
     void update(const SchedulerState& state, const SchedulerAction& action, double reward, const SchedulerState& next_state) {
+        BCOD_SCOPED_TIMER("scheduler.update");
+        const auto start = std::chrono::steady_clock::now();
         std::lock_guard<std::mutex> lock(mtx);
+        require_training_mode("update");
         
-        auto belief_tensor = torch::from_blob(state.belief_raster.data, {1, 5, 64, 64}, torch::kFloat32).to(device);
-        auto next_belief_tensor = torch::from_blob(next_state.belief_raster.data, {1, 5, 64, 64}, torch::kFloat32).to(device);
+        // Transitions outlive the caller's rasters, so they get their own copies
+        auto belief_tensor = belief_packer.pack_owned({state.belief_raster}).to(device);
+        auto next_belief_tensor = belief_packer.pack_owned({next_state.belief_raster}).to(device);
         
         auto context_tensor = torch::zeros({1, 3}, torch::kFloat32).to(device);
         context_tensor[0][0] = state.cvar_risk;
@@ -332,19 +668,24 @@ struct SACScheduler::Impl {
         }
 
         auto batch = replay_buffer.sample(params.batch_size);
-        update_critics(batch);
-        update_actor(batch);
+        auto [critic1_loss, critic2_loss] = update_critics(batch);
+        auto actor_loss = update_actor(batch);
         update_lambda(batch);
+        feature_cache.clear();
         
-        if (training_steps % params.target_update_interval == 0) {
-            target_critic1->load_state_dict(critic1->state_dict());
-            target_critic2->load_state_dict(critic2->state_dict());
+        if (params.target_update_interval <= 1 || training_steps % params.target_update_interval == 0) {
+            soft_update_targets(params.tau);
         }
         
         training_steps++;
+
+        // item() synchronises with the device, so only pay for it while tracing
+        BCOD_TRACE(TraceEvent::UPDATE, to_bitmask(action.sensor_mask),
+                   reward, critic1_loss.item<float>(), critic2_loss.item<float>(), actor_loss.item<float>(),
+                   lambda, training_steps, elapsed_ms(start));
     }
 
-    void update_critics(const std::vector<ReplayBuffer::Transition>& batch) {
+    std::pair<torch::Tensor, torch::Tensor> update_critics(const std::vector<ReplayBuffer::Transition>& batch) {
         critic1->train();
         critic2->train();
         
@@ -361,36 +702,61 @@ struct SACScheduler::Impl {
             dones[i][0] = batch[i].done ? 1.0f : 0.0f;
         }
 
-        auto [next_actions, next_log_probs] = actor->forward(next_states, next_contexts);
-        auto target_q1 = target_critic1->forward(next_states, next_contexts, next_actions);
-        auto target_q2 = target_critic2->forward(next_states, next_contexts, next_actions);
-        auto target_q = torch::min(target_q1, target_q2);
-        auto target = rewards + (1.0 - dones) * params.tau * (target_q - params.temperature * next_log_probs);
+        torch::Tensor target;
+        {
+            // The bootstrapped target is a constant for the critic losses
+            torch::NoGradGuard no_grad;
+            const bool shared = params.share_encoder;
+            auto next_features = shared ? target_critic1->encoder(next_states) : torch::Tensor();
+            auto [next_actions, next_log_probs] =
+                actor->policy_head(shared ? critic1->encoder(next_states) : actor->encoder(next_states), next_contexts);
+            auto target_q1 = target_critic1->q_head(shared ? next_features : target_critic1->encoder(next_states),
+                                                    next_contexts, next_actions);
+            auto target_q2 = target_critic2->q_head(shared ? next_features : target_critic2->encoder(next_states),
+                                                    next_contexts, next_actions);
+            auto target_q = torch::min(target_q1, target_q2);
+            target = rewards + (1.0 - dones) * params.discount_factor * (target_q - params.temperature * next_log_probs);
+        }
 
-        auto current_q1 = critic1->forward(states, contexts, actions);
-        auto current_q2 = critic2->forward(states, contexts, actions);
+        auto f1 = critic1->encoder(states);
+        auto f2 = params.share_encoder ? f1 : critic2->encoder(states);
+        auto current_q1 = critic1->q_head(f1, contexts, actions);
+        auto current_q2 = critic2->q_head(f2, contexts, actions);
 
         auto critic1_loss = torch::mse_loss(current_q1, target);
         auto critic2_loss = torch::mse_loss(current_q2, target);
 
-        critic1_optimizer.zero_grad();
-        critic1_loss.backward();
-        critic1_optimizer.step();
+        if (params.share_encoder) {
+            // One backward through the trunk; critic1's optimizer owns it
+            critic1_optimizer.zero_grad();
+            critic2_optimizer.zero_grad();
+            (critic1_loss + critic2_loss).backward();
+            critic1_optimizer.step();
+            critic2_optimizer.step();
+        } else {
+            critic1_optimizer.zero_grad();
+            critic1_loss.backward();
+            critic1_optimizer.step();
+
+            critic2_optimizer.zero_grad();
+            critic2_loss.backward();
+            critic2_optimizer.step();
+        }
 
-        critic2_optimizer.zero_grad();
-        critic2_loss.backward();
-        critic2_optimizer.step();
+        return {critic1_loss.detach(), critic2_loss.detach()};
     }
 
-    void update_actor(const std::vector<ReplayBuffer::Transition>& batch) {
+    torch::Tensor update_actor(const std::vector<ReplayBuffer::Transition>& batch) {
         actor->train();
         
         auto states = torch::cat(std::vector<torch::Tensor>(batch.size(), batch[0].state));
         auto contexts = torch::cat(std::vector<torch::Tensor>(batch.size(), batch[0].context));
         
-        auto [actions, log_probs] = actor->forward(states, contexts);
-        auto q1 = critic1->forward(states, contexts, actions);
-        auto q2 = critic2->forward(states, contexts, actions);
+        // In shared-trunk mode only the critics train the trunk
+        auto trunk = params.share_encoder ? critic1->encoder(states).detach() : torch::Tensor();
+        auto [actions, log_probs] = actor->policy_head(params.share_encoder ? trunk : actor->encoder(states), contexts);
+        auto q1 = critic1->q_head(params.share_encoder ? trunk : critic1->encoder(states), contexts, actions);
+        auto q2 = critic2->q_head(params.share_encoder ? trunk : critic2->encoder(states), contexts, actions);
         auto q = torch::min(q1, q2);
         
         auto actor_loss = (params.temperature * log_probs - q).mean();
@@ -398,6 +764,8 @@ struct SACScheduler::Impl {
         actor_optimizer.zero_grad();
         actor_loss.backward();
         actor_optimizer.step();
+
+        return actor_loss.detach();
     }
 
     void update_lambda(const std::vector<ReplayBuffer::Transition>& batch) {
@@ -415,46 +783,165 @@ struct SACScheduler::Impl {
         lambda = std::max(params.lambda_min, std::min(params.lambda_max, lambda + params.lambda_lr * constraint_violation.item<float>()));
     }
 
+    // The packed actor is fed the 3-value context of schedule_runtime and
+    // must score exactly the configured sensors.
+    void load_runtime(const std::string& path) {
+        auto loaded = std::make_unique<PolicyRuntime>(path);
+        if (loaded->num_sensors() != static_cast<int>(params.power_coefficients.size())) {
+            BCOD_ERROR("Policy ", path, " scores ", loaded->num_sensors(), " sensors, the scheduler has ",
+                       params.power_coefficients.size(), " power coefficients");
+            throw std::runtime_error("Policy sensor count does not match power_coefficients");
+        }
+        if (loaded->in_channels() != belief_packer.channels() || loaded->height() != belief_packer.height() ||
+            loaded->width() != belief_packer.width()) {
+            BCOD_ERROR("Policy ", path, " expects a ", loaded->in_channels(), "x", loaded->height(), "x",
+                       loaded->width(), " belief, the scheduler packs ", belief_packer.channels(), "x",
+                       belief_packer.height(), "x", belief_packer.width());
+            throw std::runtime_error("Policy input shape does not match the belief raster");
+        }
+        if (loaded->context_dim() != 3) {
+            BCOD_ERROR("Policy ", path, " expects a context of ", loaded->context_dim(), " values, not 3");
+            throw std::runtime_error("Policy context size is not 3");
+        }
+        runtime = std::move(loaded);
+        runtime_probabilities.resize(runtime->num_sensors());
+    }
+
+    void require_training_mode(const char* what) const {
+        if (runtime) {
+            BCOD_ERROR("SACScheduler::", what, " is unavailable in inference-only mode");
+            throw std::logic_error("SACScheduler is in inference-only mode");
+        }
+    }
+
+    void export_policy(const std::string& path, bool quantize_int8) {
+        std::lock_guard<std::mutex> lock(mtx);
+        require_training_mode("export_policy");
+        torch::NoGradGuard no_grad;
+        auto& head = actor->policy_head;
+
+        PackedPolicy packed;
+        packed.in_channels = 5;
+        packed.height = 64;
+        packed.width = 64;
+        packed.hidden_dim = params.hidden_dim;
+        packed.num_sensors = static_cast<int>(params.power_coefficients.size());
+        packed.context_dim = 3;
+        auto pack_encoder = [&](auto& enc) {
+            packed.conv1 = pack_conv_bn(enc->conv1, enc->bn1);
+            packed.conv2 = pack_conv_bn(enc->conv2, enc->bn2);
+            packed.conv3 = pack_conv_bn(enc->conv3, enc->bn3);
+            packed.enc_fc1 = pack_layer(enc->fc1->weight, enc->fc1->bias);
+            packed.enc_ln1 = pack_norm(enc->ln1);
+            packed.enc_fc2 = pack_layer(enc->fc2->weight, enc->fc2->bias);
+            packed.enc_ln2 = pack_norm(enc->ln2);
+        };
+        // The packed actor carries whichever encoder its head was trained on
+        if (params.share_encoder) pack_encoder(critic1->encoder);
+        else pack_encoder(actor->encoder);
+        packed.head_fc1 = pack_layer(head->fc1->weight, head->fc1->bias);
+        packed.head_ln1 = pack_norm(head->ln1);
+        packed.head_fc2 = pack_layer(head->fc2->weight, head->fc2->bias);
+        packed.head_ln2 = pack_norm(head->ln2);
+        packed.head_fc3 = pack_layer(head->fc3->weight, head->fc3->bias);
+        packed.head_ln3 = pack_norm(head->ln3);
+        packed.save(path, quantize_int8 ? PolicyRuntime::Precision::INT8 : PolicyRuntime::Precision::FP32);
+    }
+
     void load_model(const std::string& path) {
+        if (runtime) {
+            load_runtime(path);
+            return;
+        }
         torch::load(actor, path + "_actor.pt");
         torch::load(critic1, path + "_critic1.pt");
         torch::load(critic2, path + "_critic2.pt");
-        target_critic1->load_state_dict(critic1->state_dict());
-        target_critic2->load_state_dict(critic2->state_dict());
+        feature_cache.clear();
+        collect_target_tensors();
+        hard_update_targets();
     }
 
     void save_model(const std::string& path) {
+        require_training_mode("save_model");
         torch::save(actor, path + "_actor.pt");
         torch::save(critic1, path + "_critic1.pt");
         torch::save(critic2, path + "_critic2.pt");
     }
 
-    void set_params(const SchedulerParams& p) { params = p; }
-    void set_device(const std::string& dev) { device = torch::Device(dev); 
+    void set_params(const SchedulerParams& p) {
+        if (runtime && p.power_coefficients.size() != static_cast<size_t>(runtime->num_sensors())) {
+            BCOD_ERROR("Loaded policy scores ", runtime->num_sensors(), " sensors, new params have ",
+                       p.power_coefficients.size(), " power coefficients");
+            throw std::invalid_argument("power_coefficients do not match the loaded policy");
+        }
+        params = p;
+        refresh_lookahead();
+        candidate_masks = torch::Tensor();
+        feature_cache.clear();
+    }
+    void set_device(const std::string& dev) {
+        if (runtime) {
+            BCOD_WARN("Inference-only scheduler always runs on CPU, ignoring device ", dev);
+            return;
+        }
+        device = torch::Device(dev);
+        candidate_masks = torch::Tensor();
+        feature_cache.clear();
         actor->to(device); critic1->to(device); critic2->to(device);
-        target_critic1->to(device); target_critic2->to(device); }
+        target_critic1->to(device); target_critic2->to(device);
+        collect_target_tensors(); }
     void set_batch_size(int bs) { }
-    void set_risk_threshold(double thresh) { params.risk_threshold = thresh; }
+    void set_risk_threshold(double thresh) { params.risk_threshold = thresh; refresh_lookahead(); }
     void set_violation_rate(double rate) { params.violation_rate = rate; }
     void set_lambda(double l) { lambda = l; }
-    void set_energy_weight(double weight) { params.energy_weight = weight; }
-    void set_safety_weight(double weight) { params.safety_weight = weight; }
+    void set_energy_weight(double weight) { params.energy_weight = weight; refresh_lookahead(); }
+    void set_safety_weight(double weight) { params.safety_weight = weight; refresh_lookahead(); }
     void set_goal_weight(double weight) { params.goal_weight = weight; }
+    void set_mask_search(bool enabled, double budget) {
+        params.use_mask_search = enabled;
+        params.power_budget = budget;
+        refresh_lookahead();
+    }
+    void set_lookahead(bool enabled, int max_lead) {
+        params.use_lookahead = enabled;
+        params.lookahead_max_lead = max_lead;
+        refresh_lookahead();
+    }
     void set_feature_weights(const std::vector<double>& w) { params.feature_weights = w; }
     void set_risk_weights(const std::vector<double>& w) { params.risk_weights = w; }
     void set_safety_weights(const std::vector<double>& w) { params.safety_weights = w; }
     void set_debug(bool d) { debug = d; }
-    void reset() { }
+    void set_seed(uint64_t seed) {
+        std::lock_guard<std::mutex> lock(mtx);
+        rng.seed(static_cast<std::mt19937::result_type>(seed));
+        generator = at::detail::createCPUGenerator(seed);
+        replay_buffer.seed(seed);
+    }
+    void refresh_lookahead() {
+        for (auto& entry : lookahead_streams) entry.second.lookahead.set_params(lookahead_params(params));
+    }
+    void end_stream(uint64_t stream) {
+        std::lock_guard<std::mutex> lock(mtx);
+        lookahead_streams.erase(stream);
+    }
+    void reset() {
+        lookahead_streams.clear();
+    }
 };
 
 SACScheduler::SACScheduler(const SchedulerParams& params) : impl_(std::make_unique<Impl>(params)) {}
 SACScheduler::~SACScheduler() = default;
 
 SchedulerAction SACScheduler::schedule(const SchedulerState& state) { return impl_->schedule(state); }
+SchedulerAction SACScheduler::schedule_mean(const SchedulerState& state) { return impl_->schedule_mean(state); }
+std::vector<SchedulerAction> SACScheduler::schedule_batch(const std::vector<SchedulerState>& states) {
+    return impl_->schedule_batch(states);
+}
 void SACScheduler::update(const SchedulerState& state, const SchedulerAction& action, double reward, const SchedulerState& next_state) { 
     impl_->update(state, action, reward, next_state); }
 void SACScheduler::load_model(const std::string& path) { impl_->load_model(path); }
 void SACScheduler::save_model(const std::string& path) { impl_->save_model(path); }
+void SACScheduler::export_policy(const std::string& path, bool quantize_int8) { impl_->export_policy(path, quantize_int8); }
 void SACScheduler::set_params(const SchedulerParams& params) { impl_->set_params(params); }
 void SACScheduler::set_device(const std::string& device) { impl_->set_device(device); }
 void SACScheduler::set_batch_size(int batch_size) { impl_->set_batch_size(batch_size); }
@@ -464,10 +951,14 @@ void SACScheduler::set_lambda(double lambda) { impl_->set_lambda(lambda); }
 void SACScheduler::set_energy_weight(double weight) { impl_->set_energy_weight(weight); }
 void SACScheduler::set_safety_weight(double weight) { impl_->set_safety_weight(weight); }
 void SACScheduler::set_goal_weight(double weight) { impl_->set_goal_weight(weight); }
+void SACScheduler::set_mask_search(bool enabled, double power_budget) { impl_->set_mask_search(enabled, power_budget); }
+void SACScheduler::set_lookahead(bool enabled, int max_lead_steps) { impl_->set_lookahead(enabled, max_lead_steps); }
 void SACScheduler::set_feature_weights(const std::vector<double>& weights) { impl_->set_feature_weights(weights); }
 void SACScheduler::set_risk_weights(const std::vector<double>& weights) { impl_->set_risk_weights(weights); }
 void SACScheduler::set_safety_weights(const std::vector<double>& weights) { impl_->set_safety_weights(weights); }
 void SACScheduler::set_debug(bool debug) { impl_->set_debug(debug); }
+void SACScheduler::set_seed(uint64_t seed) { impl_->set_seed(seed); }
+void SACScheduler::end_stream(uint64_t stream) { impl_->end_stream(stream); }
 void SACScheduler::reset() { impl_->reset(); }
 
 } // namespace bcod 
\ No newline at end of file
@@ -0,0 +1,273 @@
+#include <bcod/sac_sweep.hpp>
+#include <bcod/sac_scheduler.hpp>
+#include <bcod/sensor_defs.hpp>
+#include <bcod/vector_env.hpp>
+#include <bcod/logging.hpp>
+#include <torch/torch.h>
+#include <opencv2/core.hpp>
+#include <pthread.h>
+#include <sched.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+namespace bcod {
+
+namespace {
+    constexpr int RASTER_SIZE = 64;
+    constexpr int RASTER_CHANNELS = 5;
+
+    // Network initialisation draws from the global torch generator, so
+    // schedulers are built one at a time right after seeding it. Training
+    // draws dropout masks from the same generator and is not serialised.
+    std::mutex construction_mutex;
+
+    void pin_to_core(int core) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(core, &set);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+            BCOD_WARN("Failed to pin sweep worker to core ", core);
+        }
+    }
+
+    SchedulerParams base_params() {
+        SchedulerParams p{};
+        p.belief_dim = 64;
+        p.hidden_dim = 64;
+        p.num_layers = 3;
+        p.learning_rate = 3e-4;
+        p.temperature = 0.2;
+        p.tau = 0.005;
+        p.discount_factor = 0.99;
+        p.batch_size = 32;
+        p.buffer_size = 10000;
+        p.target_update_interval = 1;
+        p.risk_threshold = 0.2;
+        p.violation_rate = 0.05;
+        p.lambda_init = 0.5;
+        p.lambda_lr = 1e-3;
+        p.lambda_min = 0.0;
+        p.lambda_max = 10.0;
+        p.energy_weight = 0.3;
+        p.safety_weight = 0.7;
+        p.power_coefficients.assign(SensorConfig::POWER_CONSUMPTION.begin(), SensorConfig::POWER_CONSUMPTION.end());
+        p.device = "cpu";
+        p.num_threads = 1;
+        return p;
+    }
+
+    void apply(SchedulerParams& p, const std::string& name, double v) {
+        if (name == "risk_threshold") p.risk_threshold = v;
+        else if (name == "violation_rate") p.violation_rate = v;
+        else if (name == "lambda_init") p.lambda_init = v;
+        else if (name == "lambda_lr") p.lambda_lr = v;
+        else if (name == "lambda_min") p.lambda_min = v;
+        else if (name == "lambda_max") p.lambda_max = v;
+        else if (name == "energy_weight") p.energy_weight = v;
+        else if (name == "safety_weight") p.safety_weight = v;
+        else throw std::invalid_argument("Unknown sweep parameter: " + name);
+    }
+
+    // The mapping is read-only; OpenCV and torch only read through these views.
+    SchedulerState make_state(const float* belief, float risk, float distance, uint32_t prev_mask) {
+        SchedulerState s;
+        s.belief_raster = cv::Mat(RASTER_SIZE, RASTER_SIZE, CV_32FC(RASTER_CHANNELS), const_cast<float*>(belief));
+        s.cvar_risk = risk;
+        s.goal_distance = distance;
+        s.prev_actions.resize(kNumSensors);
+        for (int i = 0; i < kNumSensors; ++i) s.prev_actions[i] = (prev_mask >> i) & 1u;
+        s.timestamp = 0;
+        return s;
+    }
+}
+
+SweepDataset::SweepDataset(const std::string& path) : file_(path, MappedFile::Access::RANDOM) {
+    if (file_.size() < sizeof(SweepDatasetHeader)) {
+        BCOD_ERROR("Sweep dataset too small: ", path);
+        throw std::runtime_error("Sweep dataset too small: " + path);
+    }
+    std::memcpy(&header_, file_.data(), sizeof(header_));
+    if (std::memcmp(header_.magic, SweepDatasetHeader::MAGIC, sizeof(header_.magic)) != 0 ||
+        file_.size() < sizeof(SweepDatasetHeader) + static_cast<size_t>(header_.count) * sizeof(SweepRecord)) {
+        BCOD_ERROR("Invalid sweep dataset: ", path);
+        throw std::runtime_error("Invalid sweep dataset: " + path);
+    }
+}
+
+void simulate_sweep_dataset(const nlohmann::json& environment, const std::string& out_path, int steps,
+                            int envs, uint64_t seed) {
+    VectorEnv::Params p{};
+    p.num_envs = envs;
+    p.num_threads = static_cast<int>(std::thread::hardware_concurrency());
+    p.num_particles = 500;
+    p.seed = seed;
+    p.initial_spread = 1.0;
+    p.min_goal_distance = 20.0;
+    p.goal_tolerance = 1.0;
+    p.goal_reward = 10.0;
+    p.collision_penalty = 10.0;
+    p.progress_weight = 1.0;
+    p.energy_weight = 0.01;
+    p.error_weight = 1.0;
+    p.lost_threshold = 25.0;
+    p.rasteriser.raster_H = RASTER_SIZE;
+    p.rasteriser.raster_W = RASTER_SIZE;
+    p.rasteriser.raster_C = RASTER_CHANNELS;
+    p.rasteriser.min_window = 2.0;
+    p.rasteriser.max_window = 50.0;
+    p.rasteriser.sigma_scale = 6.0;
+    p.world = parse_world(environment);
+    VectorEnv env(p);
+
+    std::ofstream out(out_path, std::ios::binary);
+    if (!out) {
+        BCOD_ERROR("Failed to open sweep dataset output: ", out_path);
+        throw std::runtime_error("Failed to open sweep dataset output: " + out_path);
+    }
+    SweepDatasetHeader header{};
+    std::memcpy(header.magic, SweepDatasetHeader::MAGIC, sizeof(header.magic));
+    header.version = SweepDatasetHeader::VERSION;
+    header.count = static_cast<uint32_t>(steps * envs);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    constexpr int plane = RASTER_SIZE * RASTER_SIZE;
+    auto to_hwc = [](const float* nchw, float* hwc) {
+        for (int c = 0; c < RASTER_CHANNELS; ++c)
+            for (int i = 0; i < plane; ++i) hwc[i * RASTER_CHANNELS + c] = nchw[c * plane + i];
+    };
+
+    std::mt19937 rng(static_cast<uint32_t>(seed));
+    std::uniform_int_distribution<uint32_t> random_mask(0, (1u << kNumSensors) - 1);
+    VectorEnv::StepResult prev = env.reset();
+    std::vector<uint32_t> prev_masks(envs, 0), masks(envs);
+    auto record = std::make_unique<SweepRecord>();
+    for (int t = 0; t < steps; ++t) {
+        for (auto& m : masks) m = random_mask(rng);
+        const auto& next = env.step(masks);
+        for (int i = 0; i < envs; ++i) {
+            to_hwc(prev.belief.data() + static_cast<size_t>(i) * SweepRecord::RASTER_FLOATS, record->belief);
+            to_hwc(next.belief.data() + static_cast<size_t>(i) * SweepRecord::RASTER_FLOATS, record->next_belief);
+            record->cvar_risk = static_cast<float>(prev.pose_error[i]);
+            record->next_cvar_risk = static_cast<float>(next.pose_error[i]);
+            record->goal_distance = static_cast<float>(prev.goal_distance[i]);
+            record->next_goal_distance = static_cast<float>(next.goal_distance[i]);
+            record->reward = next.rewards[i];
+            record->prev_mask = prev_masks[i];
+            record->action_mask = masks[i];
+            record->done = next.dones[i];
+            out.write(reinterpret_cast<const char*>(record.get()), sizeof(SweepRecord));
+        }
+        prev = next;
+        prev_masks = masks;
+    }
+}
+
+SweepRunner::SweepRunner(const SweepDataset& data, int train_steps, int eval_records, uint64_t seed)
+    : data_(data), train_steps_(train_steps), eval_records_(eval_records), seed_(seed) {
+    if (data_.size() == 0) {
+        BCOD_ERROR("Sweep dataset holds no transitions");
+        throw std::invalid_argument("Sweep dataset holds no transitions");
+    }
+}
+
+void SweepRunner::add_axis(const std::string& name, const std::vector<double>& values) {
+    SchedulerParams probe = base_params();
+    apply(probe, name, 0.0);
+    axes_.emplace_back(name, values);
+}
+
+std::vector<SweepResult> SweepRunner::run(int num_workers) const {
+    std::vector<std::map<std::string, double>> points(1);
+    for (const auto& [name, values] : axes_) {
+        std::vector<std::map<std::string, double>> expanded;
+        for (const auto& p : points) {
+            for (double v : values) {
+                auto q = p;
+                q[name] = v;
+                expanded.push_back(q);
+            }
+        }
+        points.swap(expanded);
+    }
+
+    std::vector<SweepResult> results(points.size());
+    std::atomic<size_t> next{0};
+    const int cores = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<std::thread> workers;
+    for (int w = 0; w < std::max(1, num_workers); ++w) {
+        workers.emplace_back([&, w] {
+            pin_to_core(w % cores);
+            for (size_t i = next++; i < points.size(); i = next++) {
+                results[i] = run_point(points[i], seed_ + i);
+                BCOD_INFO("Sweep point ", i + 1, "/", points.size(), " done on core ", w % cores);
+            }
+        });
+    }
+    for (auto& t : workers) t.join();
+    mark_pareto(results);
+    return results;
+}
+
+SweepResult SweepRunner::run_point(const std::map<std::string, double>& point, uint64_t seed) const {
+    SchedulerParams params = base_params();
+    for (const auto& [name, v] : point) apply(params, name, v);
+    std::unique_ptr<SACScheduler> owned;
+    {
+        std::lock_guard<std::mutex> lock(construction_mutex);
+        torch::manual_seed(seed);
+        owned = std::make_unique<SACScheduler>(params);
+    }
+    SACScheduler& scheduler = *owned;
+    scheduler.set_seed(seed);
+
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<size_t> pick(0, data_.size() - 1);
+    for (int t = 0; t < train_steps_; ++t) {
+        const auto& r = data_[pick(rng)];
+        SchedulerAction action;
+        action.sensor_mask.resize(kNumSensors);
+        for (int i = 0; i < kNumSensors; ++i) action.sensor_mask[i] = (r.action_mask >> i) & 1u;
+        scheduler.update(make_state(r.belief, r.cvar_risk, r.goal_distance, r.prev_mask), action, r.reward,
+                         make_state(r.next_belief, r.next_cvar_risk, r.next_goal_distance, r.action_mask));
+    }
+
+    const size_t n = std::min<size_t>(std::max(0, eval_records_), data_.size());
+    double power = 0.0;
+    size_t violations = 0;
+    std::vector<double> risks;
+    risks.reserve(n);
+    for (size_t k = 0; k < n; ++k) {
+        const auto& r = data_[k * data_.size() / n];
+        auto action = scheduler.schedule(make_state(r.belief, r.cvar_risk, r.goal_distance, r.prev_mask));
+        uint32_t mask = to_bitmask(action.sensor_mask);
+        double risk = rescale_risk(r.cvar_risk, r.prev_mask, mask);
+        power += mask_power(mask);
+        violations += risk > params.risk_threshold ? 1 : 0;
+        risks.push_back(risk);
+    }
+    std::sort(risks.begin(), risks.end());
+    size_t tail = static_cast<size_t>(0.95 * risks.size());
+    double cvar = 0.0;
+    for (size_t k = tail; k < risks.size(); ++k) cvar += risks[k];
+    cvar /= std::max<size_t>(1, risks.size() - tail);
+
+    return {point, power / std::max<size_t>(1, n), static_cast<double>(violations) / std::max<size_t>(1, n), cvar, false};
+}
+
+void mark_pareto(std::vector<SweepResult>& results) {
+    for (auto& a : results) {
+        a.pareto = std::none_of(results.begin(), results.end(), [&](const SweepResult& b) {
+            return b.mean_power <= a.mean_power && b.violation_rate <= a.violation_rate &&
+                   (b.mean_power < a.mean_power || b.violation_rate < a.violation_rate);
+        });
+    }
+}
+
+} // namespace bcod
@@ -1,5 +1,13 @@
 #include <bcod/student_planner.hpp>
 #include <bcod/utils.hpp>
+#include <bcod/sensor_defs.hpp>
+#include <bcod/trace.hpp>
+#include <bcod/instrumentation.hpp>
+#include <bcod/logging.hpp>
+#include <bcod/tensor_packing.hpp>
+#include <bcod/plan_cache.hpp>
+#include <bcod/distance_field.hpp>
+#include <bcod/map_store.hpp>
 #include <torch/torch.h>
 #include <Eigen/Dense>
 #include <opencv2/opencv.hpp>
@@ -7,6 +15,8 @@
 #include <algorithm>
 #include <numeric>
 #include <cmath>
+#include <limits>
+#include <stdexcept>
 #include <vector>
 #include <array>
 #include <memory>
@@ -19,6 +29,90 @@
 
 namespace bcod {
 
+void compute_trajectory_metrics(Trajectory& traj, double cvar_percentile) {
+    const int horizon = static_cast<int>(traj.waypoints.size());
+    std::vector<double> sorted_variances = traj.log_variances;
+    std::sort(sorted_variances.begin(), sorted_variances.end());
+    int cvar_idx = static_cast<int>(horizon * (1.0 - cvar_percentile));
+    traj.cvar_95 = 0.0;
+    for (int i = cvar_idx; i < horizon; ++i) {
+        traj.cvar_95 += std::sqrt(std::exp(sorted_variances[i]));
+    }
+    traj.cvar_95 /= (horizon - cvar_idx);
+
+    traj.max_variance = std::sqrt(std::exp(*std::max_element(traj.log_variances.begin(), traj.log_variances.end())));
+    traj.mean_variance = 0.0;
+    for (double var : traj.log_variances) {
+        traj.mean_variance += std::sqrt(std::exp(var));
+    }
+    traj.mean_variance /= horizon;
+
+    traj.min_clearance = std::numeric_limits<double>::infinity();
+    traj.total_length = 0.0;
+    traj.max_curvature = 0.0;
+    for (int i = 1; i < horizon; ++i) {
+        double dx = traj.waypoints[i].x() - traj.waypoints[i-1].x();
+        double dy = traj.waypoints[i].y() - traj.waypoints[i-1].y();
+        double ds = std::sqrt(dx*dx + dy*dy);
+        traj.total_length += ds;
+
+        if (i > 1) {
+            double dx1 = traj.waypoints[i].x() - traj.waypoints[i-1].x();
+            double dy1 = traj.waypoints[i].y() - traj.waypoints[i-1].y();
+            double dx2 = traj.waypoints[i-1].x() - traj.waypoints[i-2].x();
+            double dy2 = traj.waypoints[i-1].y() - traj.waypoints[i-2].y();
+            double cross = dx1*dy2 - dy1*dx2;
+            double dot = dx1*dx2 + dy1*dy2;
+            double curvature = std::abs(cross) / (std::pow(dx1*dx1 + dy1*dy1, 1.5) + 1e-6);
+            traj.max_curvature = std::max(traj.max_curvature, curvature);
+        }
+    }
+}
+
+void compute_trajectory_metrics(Trajectory& traj, double cvar_percentile, const DistanceField& field,
+                                const Eigen::Vector3d& start) {
+    compute_trajectory_metrics(traj, cvar_percentile);
+    traj.min_clearance = trajectory_clearance(traj.waypoints, start, field);
+}
+
+int resolve_horizon(const StudentParams& params, const PlanningContext& context) {
+    const int full = params.trajectory_horizon;
+    if (!context.use_adaptive_horizon && !params.use_adaptive_horizon) return full;
+
+    const int lo = context.use_adaptive_horizon ? context.min_horizon : params.min_horizon;
+    const int hi = context.use_adaptive_horizon ? context.max_horizon : params.max_horizon;
+    const int max_h = hi > 0 ? std::min(hi, full) : full;
+    const int min_h = std::clamp(lo, 1, max_h);
+
+    const double step = context.max_velocity * params.waypoint_interval;
+    if (context.goal_distance <= 0.0 || step <= 0.0) return max_h;
+    const double needed = std::ceil(context.goal_distance / step);
+    return needed >= max_h ? max_h : std::max(min_h, static_cast<int>(needed));
+}
+
+bool unimodal_belief(const StudentParams& params, const cv::Mat& belief) {
+    if (belief.empty() || belief.channels() != 5 || belief.depth() != CV_32F) return false;
+    double mass = 0.0, circ_var = 0.0, logdet = 0.0;
+    for (int y = 0; y < belief.rows; ++y) {
+        const float* row = belief.ptr<float>(y);
+        for (int x = 0; x < belief.cols; ++x) {
+            const float* cell = row + x * 5;
+            mass += cell[0];
+            logdet += cell[0] * cell[3];
+            circ_var += cell[0] * cell[4];
+        }
+    }
+    if (mass <= 0.0) return false;
+    return circ_var / mass < params.unimodal_circ_var && logdet / mass < params.unimodal_logdet;
+}
+
+torch::Tensor attend_single_token(torch::nn::MultiheadAttention& attention, const torch::Tensor& features) {
+    const int64_t dim = features.size(-1);
+    auto w_v = attention->in_proj_weight.narrow(0, 2 * dim, dim);
+    auto b_v = attention->in_proj_bias.narrow(0, 2 * dim, dim);
+    return attention->out_proj(torch::linear(features, w_v, b_v));
+}
+
 struct StudentPlanner::Impl {
     struct StudentNetwork : torch::nn::Module {
         struct Encoder : torch::nn::Module {
@@ -96,17 +190,42 @@ struct StudentPlanner::Impl {
             attention = register_module("attention", torch::nn::MultiheadAttention(hidden_dim, params.num_heads));
         }
 
-        std::pair<torch::Tensor, torch::Tensor> forward(torch::Tensor x, torch::Tensor sensor_mask) {
+        std::pair<torch::Tensor, torch::Tensor> forward(torch::Tensor x, torch::Tensor sensor_mask,
+                                                        bool skip_attention = false) {
             auto features = encoder(x);
             auto sensor_features = sensor_embedding(sensor_mask);
             features = features + sensor_features;
-            features = attention(features, features, features).output;
+            if (!skip_attention) features = attend(features);
             return decoder(features);
         }
+
+        // Independent planning samples in one pass: every row is its own
+        // one-token sequence, and rows flagged in `skip` bypass attention.
+        std::pair<torch::Tensor, torch::Tensor> forward_batch(torch::Tensor x, torch::Tensor sensor_mask,
+                                                              torch::Tensor skip) {
+            auto features = encoder(x) + sensor_embedding(sensor_mask);
+            features = torch::where(skip.unsqueeze(1), features, attend_token(features));
+            return decoder(features);
+        }
+
+        torch::Tensor attend(torch::Tensor features) {
+            if (features.size(0) != 1) return attention(features, features, features).output;
+            return attend_token(features);
+        }
+
+        // Query/key projections and softmax are skipped; row-wise, so it
+        // serves a batch of one-token sequences too.
+        torch::Tensor attend_token(torch::Tensor features) {
+            return attend_single_token(attention, features);
+        }
     };
 
     StudentParams params;
     std::unique_ptr<StudentNetwork> network;
+    InputPacker packer{{5, 3, 1}, 64, 64};  // belief, semantic map, goal mask
+    std::unique_ptr<PlanCache> plan_cache;
+    std::shared_ptr<const DistanceField> distance_field;
+    std::shared_ptr<const MapStore> map_store;
     torch::Device device;
     std::mt19937 rng;
     std::mutex mtx;
@@ -120,93 +239,197 @@ struct StudentPlanner::Impl {
     Impl(const StudentParams& p) : params(p), device(torch::kCPU), rng(std::random_device{}()), debug(false), current_kl_weight(p.min_kl_weight), training_steps(0) {
         network = std::make_unique<StudentNetwork>(params);
         network->to(device);
+        configure_cache();
+    }
+
+    // Cached plans hold decoded trajectories, so anything that changes how an
+    // input is planned or scored invalidates them. Horizon and the attention
+    // shortcut vary per input and are part of the key instead.
+    static bool same_plans(const StudentParams& a, const StudentParams& b) {
+        return a.plan_cache_tolerance == b.plan_cache_tolerance && a.cvar_percentile == b.cvar_percentile &&
+               a.waypoint_interval == b.waypoint_interval &&
+               a.skip_unimodal_attention == b.skip_unimodal_attention &&
+               a.unimodal_circ_var == b.unimodal_circ_var && a.unimodal_logdet == b.unimodal_logdet;
+    }
+
+    static uint64_t cache_variant(int horizon, bool skip_attention) {
+        return static_cast<uint64_t>(horizon) << 1 | (skip_attention ? 1u : 0u);
+    }
+
+    void configure_cache() {
+        if (params.plan_cache_size <= 0) {
+            plan_cache.reset();
+        } else if (!plan_cache || plan_cache->capacity() != static_cast<size_t>(params.plan_cache_size)) {
+            plan_cache = std::make_unique<PlanCache>(params.plan_cache_size, params.plan_cache_tolerance);
+        }
     }
 
     Trajectory plan(const PlanningContext& context) {
+        BCOD_SCOPED_TIMER("planner.plan");
+        const auto start = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lock(mtx);
+
+        const int horizon = resolve_horizon(params, context);
+        const bool skip_attention = params.skip_unimodal_attention && unimodal_belief(params, context.belief_image);
+
+        Trajectory traj;
+        uint64_t key = 0;
+        if (plan_cache) key = plan_cache->fingerprint(context, cache_variant(horizon, skip_attention));
+        const bool cached = plan_cache && plan_cache->lookup(key, traj);
+        if (!cached) {
+            traj = infer(context, horizon, skip_attention);
+            if (plan_cache) plan_cache->insert(key, traj);
+        }
+        // Clearance depends on the pose, which the cache key leaves out.
+        if (distance_field) {
+            traj.min_clearance = trajectory_clearance(traj.waypoints, context.current_pose, *distance_field);
+        }
+
+        BCOD_TRACE(TraceEvent::PLAN, to_bitmask(context.active_sensors),
+                   traj.cvar_95, traj.max_variance, traj.mean_variance, traj.total_length,
+                   traj.max_curvature, traj.waypoints.size(), elapsed_ms(start), cached, skip_attention,
+                   traj.min_clearance);
+        return traj;
+    }
+
+    // plan() over several contexts in order, with one forward pass over all
+    // the cache misses.
+    std::vector<Trajectory> plan_batch(const std::vector<PlanningContext>& contexts) {
+        BCOD_SCOPED_TIMER("planner.plan_batch");
+        const auto start = std::chrono::steady_clock::now();
         std::lock_guard<std::mutex> lock(mtx);
+
+        const size_t n = contexts.size();
+        std::vector<Trajectory> trajs(n);
+        std::vector<int> horizons(n);
+        std::vector<bool> skip(n), cached(n);
+        std::vector<uint64_t> keys(n, 0);
+        std::vector<size_t> misses;
+        for (size_t i = 0; i < n; ++i) {
+            horizons[i] = resolve_horizon(params, contexts[i]);
+            skip[i] = params.skip_unimodal_attention && unimodal_belief(params, contexts[i].belief_image);
+            if (plan_cache) keys[i] = plan_cache->fingerprint(contexts[i], cache_variant(horizons[i], skip[i]));
+            cached[i] = plan_cache && plan_cache->lookup(keys[i], trajs[i]);
+            if (!cached[i]) misses.push_back(i);
+        }
+        if (!misses.empty()) infer_batch(contexts, misses, horizons, skip, trajs);
+
+        for (size_t i = 0; i < n; ++i) {
+            const PlanningContext& context = contexts[i];
+            Trajectory& traj = trajs[i];
+            if (!cached[i] && plan_cache) plan_cache->insert(keys[i], traj);
+            if (distance_field) {
+                traj.min_clearance = trajectory_clearance(traj.waypoints, context.current_pose, *distance_field);
+            }
+            BCOD_TRACE(TraceEvent::PLAN, to_bitmask(context.active_sensors),
+                       traj.cvar_95, traj.max_variance, traj.mean_variance, traj.total_length,
+                       traj.max_curvature, traj.waypoints.size(), elapsed_ms(start), cached[i], skip[i],
+                       traj.min_clearance);
+        }
+        return trajs;
+    }
+
+    // The decoder's final LayerNorm spans the whole horizon, so the network
+    // always produces every waypoint; only the first `horizon` are unpacked
+    // and scored.
+    Trajectory infer(const PlanningContext& context, int horizon, bool skip_attention) {
         network->eval();
         torch::NoGradGuard no_grad;
 
-        auto belief_tensor = torch::from_blob(context.belief_image.data, {1, 5, 64, 64}, torch::kFloat32).to(device);
-        auto map_tensor = torch::from_blob(context.semantic_map.data, {1, 3, 64, 64}, torch::kFloat32).to(device);
-        auto goal_tensor = torch::from_blob(context.goal_mask.data, {1, 1, 64, 64}, torch::kFloat32).to(device);
+        const auto& packed = packer.pack({context.belief_image, context.semantic_map, context.goal_mask});
+        if (map_store && context.semantic_map.empty()) {
+            map_store->crop(context.map_window, packer.height(), packer.width(), packer.planes(1));
+        }
+        auto input = packed.to(device);
         auto sensor_tensor = torch::zeros({1, context.active_sensors.size()}, torch::kFloat32).to(device);
         for (size_t i = 0; i < context.active_sensors.size(); ++i) {
             sensor_tensor[0][i] = context.active_sensors[i] ? 1.0f : 0.0f;
         }
 
-        auto input = torch::cat({belief_tensor, map_tensor, goal_tensor}, 1);
-        auto [mean, log_var] = network->forward(input, sensor_tensor);
+        auto [mean, log_var] = network->forward(input, sensor_tensor, skip_attention);
 
-        auto mean_cpu = mean.cpu();
-        auto log_var_cpu = log_var.cpu();
-        auto mean_data = mean_cpu.data_ptr<float>();
-        auto log_var_data = log_var_cpu.data_ptr<float>();
+        auto mean_cpu = mean.narrow(1, 0, horizon).contiguous().cpu();
+        auto log_var_cpu = log_var.narrow(1, 0, horizon).contiguous().cpu();
+        return unpack(mean_cpu.data_ptr<float>(), log_var_cpu.data_ptr<float>(), horizon);
+    }
 
+    // infer() for contexts[rows[b]], b < rows.size(), as one batch; results go
+    // to the same index of `out`.
+    void infer_batch(const std::vector<PlanningContext>& contexts, const std::vector<size_t>& rows,
+                     const std::vector<int>& horizons, const std::vector<bool>& skip, std::vector<Trajectory>& out) {
+        network->eval();
+        torch::NoGradGuard no_grad;
+
+        const int64_t B = static_cast<int64_t>(rows.size());
+        const int64_t S = static_cast<int64_t>(contexts[rows[0]].active_sensors.size());
+        const size_t sample = static_cast<size_t>(packer.channels()) * packer.height() * packer.width();
+        auto input = torch::empty({B, packer.channels(), packer.height(), packer.width()}, torch::kFloat32);
+        auto sensor_tensor = torch::zeros({B, S}, torch::kFloat32);
+        auto skip_tensor = torch::zeros({B}, torch::kBool);
+        auto sensors = sensor_tensor.accessor<float, 2>();
+        auto skip_rows = skip_tensor.accessor<bool, 1>();
+        for (int64_t b = 0; b < B; ++b) {
+            const PlanningContext& context = contexts[rows[b]];
+            if (static_cast<int64_t>(context.active_sensors.size()) != S) {
+                BCOD_ERROR("Planning batch mixes ", S, " and ", context.active_sensors.size(), " sensors");
+                throw std::invalid_argument("All contexts of a planning batch need the same sensor count");
+            }
+            float* dst = input.data_ptr<float>() + b * sample;
+            packer.pack_sample({context.belief_image, context.semantic_map, context.goal_mask}, dst);
+            if (map_store && context.semantic_map.empty()) {
+                map_store->crop(context.map_window, packer.height(), packer.width(), dst + packer.plane_offset(1));
+            }
+            for (int64_t i = 0; i < S; ++i) sensors[b][i] = context.active_sensors[i] ? 1.0f : 0.0f;
+            skip_rows[b] = skip[rows[b]];
+        }
+
+        auto [mean, log_var] = network->forward_batch(input.to(device), sensor_tensor.to(device), skip_tensor.to(device));
+        auto mean_cpu = mean.contiguous().cpu();
+        auto log_var_cpu = log_var.contiguous().cpu();
+        const int64_t stride = mean_cpu.size(1) * 3;
+        for (int64_t b = 0; b < B; ++b) {
+            out[rows[b]] = unpack(mean_cpu.data_ptr<float>() + b * stride, log_var_cpu.data_ptr<float>() + b * stride,
+                                  horizons[rows[b]]);
+        }
+    }
+
+    // The first `horizon` waypoints of one decoded sample, [horizon, 3] each.
+    Trajectory unpack(const float* mean_data, const float* log_var_data, int horizon) const {
         Trajectory traj;
-        traj.waypoints.resize(params.trajectory_horizon);
-        traj.log_variances.resize(params.trajectory_horizon);
-        traj.confidence.resize(params.trajectory_horizon);
-        traj.risk_scores.resize(params.trajectory_horizon);
+        traj.waypoints.resize(horizon);
+        traj.log_variances.resize(horizon);
+        traj.confidence.resize(horizon);
+        traj.risk_scores.resize(horizon);
 
-        for (int i = 0; i < params.trajectory_horizon; ++i) {
+        for (int i = 0; i < horizon; ++i) {
             traj.waypoints[i] = Eigen::Vector3d(mean_data[i*3], mean_data[i*3+1], mean_data[i*3+2]);
             traj.log_variances[i] = log_var_data[i*3];
             traj.confidence[i] = std::exp(-log_var_data[i*3]);
             traj.risk_scores[i] = std::sqrt(std::exp(log_var_data[i*3]));
         }
 
-        compute_trajectory_metrics(traj);
+        compute_trajectory_metrics(traj, params.cvar_percentile);
         return traj;
     }
 
-    void compute_trajectory_metrics(Trajectory& traj) {
-        std::vector<double> sorted_variances = traj.log_variances;
-        std::sort(sorted_variances.begin(), sorted_variances.end());
-        int cvar_idx = static_cast<int>(params.trajectory_horizon * (1.0 - params.cvar_percentile));
-        traj.cvar_95 = 0.0;
-        for (int i = cvar_idx; i < params.trajectory_horizon; ++i) {
-            traj.cvar_95 += std::sqrt(std::exp(sorted_variances[i]));
-        }
-        traj.cvar_95 /= (params.trajectory_horizon - cvar_idx);
-
-        traj.max_variance = std::sqrt(std::exp(*std::max_element(traj.log_variances.begin(), traj.log_variances.end())));
-        traj.mean_variance = 0.0;
-        for (double var : traj.log_variances) {
-            traj.mean_variance += std::sqrt(std::exp(var));
-        }
-        traj.mean_variance /= params.trajectory_horizon;
-
-        traj.total_length = 0.0;
-        traj.max_curvature = 0.0;
-        for (int i = 1; i < params.trajectory_horizon; ++i) {
-            double dx = traj.waypoints[i].x() - traj.waypoints[i-1].x();
-            double dy = traj.waypoints[i].y() - traj.waypoints[i-1].y();
-            double ds = std::sqrt(dx*dx + dy*dy);
-            traj.total_length += ds;
-
-            if (i > 1) {
-                double dx1 = traj.waypoints[i].x() - traj.waypoints[i-1].x();
-                double dy1 = traj.waypoints[i].y() - traj.waypoints[i-1].y();
-                double dx2 = traj.waypoints[i-1].x() - traj.waypoints[i-2].x();
-                double dy2 = traj.waypoints[i-1].y() - traj.waypoints[i-2].y();
-                double cross = dx1*dy2 - dy1*dx2;
-                double dot = dx1*dx2 + dy1*dy2;
-                double curvature = std::abs(cross) / (std::pow(dx1*dx1 + dy1*dy1, 1.5) + 1e-6);
-                traj.max_curvature = std::max(traj.max_curvature, curvature);
-            }
-        }
-    }
-
     void load_model(const std::string& path) {
         torch::load(network, path);
+        if (plan_cache) plan_cache->clear();
     }
 
     void save_model(const std::string& path) {
         torch::save(network, path);
     }
 
-    void set_params(const StudentParams& p) { params = p; }
+    void set_params(const StudentParams& p) {
+        std::lock_guard<std::mutex> lock(mtx);
+        const bool retune = p.plan_cache_tolerance != params.plan_cache_tolerance;
+        const bool stale = !same_plans(p, params);
+        params = p;
+        if (retune) plan_cache.reset();
+        configure_cache();
+        if (stale && plan_cache) plan_cache->clear();
+    }
     void set_device(const std::string& dev) { device = torch::Device(dev); network->to(device); }
     void set_batch_size(int bs) { }
     void set_sequence_length(int len) { }
@@ -221,6 +444,19 @@ struct StudentPlanner::Impl {
     void set_feature_weights(const std::vector<double>& w) { feature_weights = w; }
     void set_risk_weights(const std::vector<double>& w) { risk_weights = w; }
     void set_safety_weights(const std::vector<double>& w) { safety_weights = w; }
+    void set_distance_field(std::shared_ptr<const DistanceField> f) {
+        std::lock_guard<std::mutex> lock(mtx);
+        distance_field = std::move(f);
+    }
+    void set_map_store(std::shared_ptr<const MapStore> store) {
+        if (store && store->channels() != 3) {
+            BCOD_ERROR("Map store has ", store->channels(), " channels, the planner expects 3");
+            throw std::invalid_argument("Map store must have 3 channels");
+        }
+        std::lock_guard<std::mutex> lock(mtx);
+        map_store = std::move(store);
+        if (plan_cache) plan_cache->clear();
+    }
     void set_debug(bool d) { debug = d; }
     void reset() { }
 };
@@ -229,6 +465,9 @@ StudentPlanner::StudentPlanner(const StudentParams& params) : impl_(std::make_un
 StudentPlanner::~StudentPlanner() = default;
 
 Trajectory StudentPlanner::plan(const PlanningContext& context) { return impl_->plan(context); }
+std::vector<Trajectory> StudentPlanner::plan_batch(const std::vector<PlanningContext>& contexts) {
+    return impl_->plan_batch(contexts);
+}
 void StudentPlanner::load_model(const std::string& path) { impl_->load_model(path); }
 void StudentPlanner::save_model(const std::string& path) { impl_->save_model(path); }
 void StudentPlanner::set_params(const StudentParams& params) { impl_->set_params(params); }
@@ -246,6 +485,8 @@ void StudentPlanner::set_max_horizon(int horizon) { impl_->set_max_horizon(horiz
 void StudentPlanner::set_feature_weights(const std::vector<double>& weights) { impl_->set_feature_weights(weights); }
 void StudentPlanner::set_risk_weights(const std::vector<double>& weights) { impl_->set_risk_weights(weights); }
 void StudentPlanner::set_safety_weights(const std::vector<double>& weights) { impl_->set_safety_weights(weights); }
+void StudentPlanner::set_distance_field(std::shared_ptr<const DistanceField> field) { impl_->set_distance_field(std::move(field)); }
+void StudentPlanner::set_map_store(std::shared_ptr<const MapStore> store) { impl_->set_map_store(std::move(store)); }
 void StudentPlanner::set_debug(bool debug) { impl_->set_debug(debug); }
 void StudentPlanner::reset() { impl_->reset(); }
 
@@ -0,0 +1,120 @@
+#include <bcod/tensor_packing.hpp>
+#include <bcod/logging.hpp>
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace bcod {
+
+namespace {
+    // One image row into C planes. With C known at compile time every inner
+    // loop is a constant-stride gather the compiler turns into SIMD shuffles;
+    // C = 0 is the generic fallback.
+    template<int C>
+    void pack_rows(const cv::Mat& image, int channels, float* dst, const ChannelTransform* transforms) {
+        const int cn = C > 0 ? C : channels;
+        const int width = image.cols;
+        const size_t plane = static_cast<size_t>(image.rows) * width;
+        for (int y = 0; y < image.rows; ++y) {
+            const float* __restrict__ row = image.ptr<float>(y);
+            for (int c = 0; c < cn; ++c) {
+                float* __restrict__ out = dst + c * plane + static_cast<size_t>(y) * width;
+                if (transforms) {
+                    const float scale = transforms[c].scale;
+                    const float offset = transforms[c].offset;
+                    for (int x = 0; x < width; ++x) out[x] = row[x * cn + c] * scale + offset;
+                } else {
+                    for (int x = 0; x < width; ++x) out[x] = row[x * cn + c];
+                }
+            }
+        }
+    }
+}
+
+void pack_planes(const cv::Mat& image, int height, int width, int channels, float* dst,
+                 const ChannelTransform* transforms) {
+    const size_t plane = static_cast<size_t>(height) * width;
+    if (image.empty()) {
+        for (int c = 0; c < channels; ++c) {
+            const float fill = transforms ? transforms[c].offset : 0.0f;
+            std::fill(dst + c * plane, dst + (c + 1) * plane, fill);
+        }
+        return;
+    }
+    if (image.rows != height || image.cols != width || image.channels() != channels) {
+        BCOD_ERROR("Cannot pack ", image.rows, "x", image.cols, "x", image.channels(), " raster, expected ",
+                   height, "x", width, "x", channels);
+        throw std::invalid_argument("Raster shape does not match the network input");
+    }
+
+    cv::Mat converted;
+    const cv::Mat* src = &image;
+    if (image.depth() != CV_32F) {
+        image.convertTo(converted, CV_32F);
+        src = &converted;
+    }
+
+    switch (channels) {
+        case 1: pack_rows<1>(*src, channels, dst, transforms); break;
+        case 3: pack_rows<3>(*src, channels, dst, transforms); break;
+        case 5: pack_rows<5>(*src, channels, dst, transforms); break;
+        default: pack_rows<0>(*src, channels, dst, transforms); break;
+    }
+}
+
+InputPacker::InputPacker(std::vector<int> channels, int height, int width)
+    : channels_(std::move(channels)),
+      total_channels_(std::accumulate(channels_.begin(), channels_.end(), 0)),
+      height_(height), width_(width),
+      buffer_(torch::empty({1, total_channels_, height, width}, torch::kFloat32)) {}
+
+const torch::Tensor& InputPacker::pack(Rasters rasters) {
+    pack_into(rasters, buffer_.data_ptr<float>());
+    return buffer_;
+}
+
+torch::Tensor InputPacker::pack_owned(Rasters rasters) const {
+    auto tensor = torch::empty({1, total_channels_, height_, width_}, torch::kFloat32);
+    pack_into(rasters, tensor.data_ptr<float>());
+    return tensor;
+}
+
+float* InputPacker::planes(size_t index) {
+    return buffer_.data_ptr<float>() + plane_offset(index);
+}
+
+size_t InputPacker::plane_offset(size_t index) const {
+    if (index >= channels_.size()) {
+        throw std::out_of_range("Raster index " + std::to_string(index) + " out of " +
+                                std::to_string(channels_.size()));
+    }
+    const int channel = std::accumulate(channels_.begin(), channels_.begin() + index, 0);
+    return static_cast<size_t>(channel) * height_ * width_;
+}
+
+void InputPacker::set_transforms(std::vector<ChannelTransform> transforms) {
+    if (!transforms.empty() && static_cast<int>(transforms.size()) != total_channels_) {
+        BCOD_ERROR("Got ", transforms.size(), " channel transforms for ", total_channels_, " channels");
+        throw std::invalid_argument("Channel transform count does not match the packed channels");
+    }
+    transforms_ = std::move(transforms);
+}
+
+void InputPacker::pack_into(Rasters rasters, float* dst) const {
+    if (rasters.size() != channels_.size()) {
+        throw std::invalid_argument("Expected " + std::to_string(channels_.size()) + " rasters, got " +
+                                    std::to_string(rasters.size()));
+    }
+    const size_t plane = static_cast<size_t>(height_) * width_;
+    int channel = 0;
+    size_t i = 0;
+    for (const cv::Mat& raster : rasters) {
+        const ChannelTransform* transforms = transforms_.empty() ? nullptr : transforms_.data() + channel;
+        pack_planes(raster, height_, width_, channels_[i], dst + channel * plane, transforms);
+        channel += channels_[i++];
+    }
+}
+
+} // namespace bcod
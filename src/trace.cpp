@@ -0,0 +1,100 @@
+#include <bcod/trace.hpp>
+#include <bcod/logging.hpp>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+namespace bcod {
+
+namespace {
+    constexpr size_t STDIO_BUFFER = 1 << 20;
+}
+
+const char* trace_event_name(TraceEvent event) {
+    switch (event) {
+        case TraceEvent::PLAN:     return "plan";
+        case TraceEvent::SCHEDULE: return "schedule";
+        case TraceEvent::UPDATE:   return "update";
+        default:                   return "unknown";
+    }
+}
+
+const std::vector<const char*>& trace_fields(TraceEvent event) {
+    static const std::vector<const char*> plan = {
+        "cvar_95", "max_variance", "mean_variance", "total_length",
+        "max_curvature", "horizon", "latency_ms", "cache_hit", "attention_skipped",
+        "min_clearance"
+    };
+    static const std::vector<const char*> schedule = {
+        "cvar_risk", "goal_distance", "total_power", "risk_violation",
+        "energy_cost", "safety_cost", "total_cost", "lambda", "latency_ms"
+    };
+    static const std::vector<const char*> update = {
+        "reward", "critic1_loss", "critic2_loss", "actor_loss",
+        "lambda", "training_steps", "latency_ms"
+    };
+    static const std::vector<const char*> none;
+
+    switch (event) {
+        case TraceEvent::PLAN:     return plan;
+        case TraceEvent::SCHEDULE: return schedule;
+        case TraceEvent::UPDATE:   return update;
+        default:                   return none;
+    }
+}
+
+Tracer& Tracer::instance() {
+    static Tracer instance;
+    return instance;
+}
+
+Tracer::~Tracer() {
+    close();
+}
+
+void Tracer::open(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (file_) {
+        enabled_.store(false);
+        std::fclose(file_);
+    }
+
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) {
+        BCOD_ERROR("Failed to open trace file: ", path);
+        throw std::runtime_error("Failed to open trace file: " + path);
+    }
+    buffer_.resize(STDIO_BUFFER);
+    std::setvbuf(file_, buffer_.data(), _IOFBF, buffer_.size());
+
+    TraceFileHeader header;
+    std::memcpy(header.magic, TraceFileHeader::MAGIC, sizeof(header.magic));
+    header.version = TraceFileHeader::VERSION;
+    header.record_size = sizeof(TraceRecord);
+    std::fwrite(&header, sizeof(header), 1, file_);
+
+    enabled_.store(true);
+}
+
+void Tracer::close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    enabled_.store(false);
+    if (file_) {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+}
+
+void Tracer::write_values(TraceEvent event, uint32_t mask, const float* values, int count) {
+    TraceRecord record{};
+    record.wall_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    record.event = static_cast<uint32_t>(event);
+    record.mask = mask;
+    std::memcpy(record.values, values, count * sizeof(float));
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (file_) std::fwrite(&record, sizeof(record), 1, file_);
+}
+
+} // namespace bcod
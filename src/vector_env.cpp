@@ -0,0 +1,346 @@
+#include <bcod/vector_env.hpp>
+#include <bcod/sensor_defs.hpp>
+#include <bcod/logging.hpp>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+namespace bcod {
+
+namespace {
+    double wrap_angle(double a) {
+        return std::atan2(std::sin(a), std::cos(a));
+    }
+}
+
+struct VectorEnv::Impl {
+    struct Lake {
+        std::mt19937_64 rng;
+        std::unique_ptr<BeliefRasteriser> rasteriser;
+        std::vector<Particle> particles;
+        Eigen::Vector3d truth;
+        Eigen::Vector2d goal;
+        std::array<double, kNumSensors> warmup_left;
+        uint32_t active;
+        int steps;
+        double time;
+    };
+
+    Params params;
+    std::vector<Lake> lakes;
+    StepResult result;
+    std::vector<uint32_t> masks;
+    int H, W;
+
+    std::vector<std::thread> workers;
+    std::mutex mtx;
+    std::condition_variable work_cv, done_cv;
+    uint64_t generation = 0;
+    int pending = 0;
+    bool resetting = false;
+    bool stopping = false;
+
+    Impl(const Params& p) : params(p), H(p.rasteriser.raster_H), W(p.rasteriser.raster_W) {
+        if (p.num_envs <= 0 || p.num_particles <= 0) {
+            BCOD_ERROR("VectorEnv needs at least one environment and one particle");
+            throw std::invalid_argument("Invalid VectorEnv params");
+        }
+        // BeliefRasteriser lays out a raster_H x raster_H grid
+        if (H != W) {
+            BCOD_ERROR("VectorEnv needs a square raster, got ", H, "x", W);
+            throw std::invalid_argument("VectorEnv raster must be square");
+        }
+        lakes.resize(p.num_envs);
+        for (int i = 0; i < p.num_envs; ++i) {
+            lakes[i].rng.seed(p.seed + 0x9E3779B97F4A7C15ULL * static_cast<uint64_t>(i + 1));
+            lakes[i].rasteriser = std::make_unique<BeliefRasteriser>(p.rasteriser);
+        }
+        const size_t K = p.num_envs;
+        result.belief.assign(K * channels() * H * W, 0.0f);
+        result.rewards.assign(K, 0.0f);
+        result.dones.assign(K, 0);
+        result.energy.assign(K, 0.0);
+        result.warmup_energy.assign(K, 0.0);
+        result.pose_error.assign(K, 0.0);
+        result.goal_distance.assign(K, 0.0);
+        masks.assign(K, 0);
+
+        int T = std::clamp(p.num_threads, 1, p.num_envs);
+        for (int t = 0; t < T; ++t) {
+            int begin = p.num_envs * t / T, end = p.num_envs * (t + 1) / T;
+            workers.emplace_back([this, begin, end] { worker_loop(begin, end); });
+        }
+    }
+
+    ~Impl() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stopping = true;
+        }
+        work_cv.notify_all();
+        for (auto& w : workers) w.join();
+    }
+
+    void worker_loop(int begin, int end) {
+        uint64_t seen = 0;
+        for (;;) {
+            bool do_reset;
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                work_cv.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+                do_reset = resetting;
+            }
+            for (int i = begin; i < end; ++i) {
+                if (do_reset) {
+                    reset_lake(i);
+                    publish(i, 0.0f, false, 0.0, 0.0);
+                } else {
+                    step_lake(i);
+                }
+            }
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                if (--pending == 0) done_cv.notify_one();
+            }
+        }
+    }
+
+    void run(bool reset) {
+        std::unique_lock<std::mutex> lock(mtx);
+        resetting = reset;
+        pending = static_cast<int>(workers.size());
+        ++generation;
+        work_cv.notify_all();
+        done_cv.wait(lock, [&] { return pending == 0; });
+    }
+
+    Eigen::Vector2d sample_free(Lake& lake) {
+        const auto& world = params.world;
+        std::uniform_real_distribution<double> ux(0.0, world.size.x()), uy(0.0, world.size.y());
+        for (int attempt = 0; attempt < 1000; ++attempt) {
+            Eigen::Vector2d p = world.origin + Eigen::Vector2d(ux(lake.rng), uy(lake.rng));
+            if (signed_distance(world, p) > 2.0) return p;
+        }
+        return world.origin + world.size / 2.0;
+    }
+
+    Eigen::Vector3d estimate(const Lake& lake) const {
+        Eigen::Vector2d mean = Eigen::Vector2d::Zero();
+        double s = 0, c = 0, total = 0;
+        for (const auto& p : lake.particles) {
+            mean += p.weight * p.position;
+            s += p.weight * std::sin(p.yaw);
+            c += p.weight * std::cos(p.yaw);
+            total += p.weight;
+        }
+        if (total > 0) mean /= total;
+        return Eigen::Vector3d(mean.x(), mean.y(), std::atan2(s, c));
+    }
+
+    void reset_lake(int i) {
+        Lake& lake = lakes[i];
+        Eigen::Vector2d start = sample_free(lake);
+        do {
+            lake.goal = sample_free(lake);
+        } while ((lake.goal - start).norm() < params.min_goal_distance && params.min_goal_distance > 0 &&
+                 params.min_goal_distance < params.world.size.minCoeff());
+        std::uniform_real_distribution<double> uyaw(-M_PI, M_PI);
+        lake.truth = Eigen::Vector3d(start.x(), start.y(), uyaw(lake.rng));
+
+        std::normal_distribution<double> n(0.0, 1.0);
+        const int N = params.num_particles;
+        lake.particles.resize(N);
+        for (auto& p : lake.particles) {
+            p.position = start + params.initial_spread * Eigen::Vector2d(n(lake.rng), n(lake.rng));
+            p.yaw = wrap_angle(lake.truth.z() + 0.1 * n(lake.rng));
+            p.weight = 1.0 / N;
+            p.covariance = {0, 0, 0, 0};
+            p.confidence = 1.0;
+            p.timestamp = 0;
+        }
+        lake.warmup_left.fill(0.0);
+        lake.active = 0;
+        lake.steps = 0;
+        lake.time = 0.0;
+    }
+
+    void step_lake(int i) {
+        Lake& lake = lakes[i];
+        const auto& world = params.world;
+        const double dt = world.time_step;
+        std::normal_distribution<double> n(0.0, 1.0);
+
+        // Steer the estimate towards the goal; the truth follows the same command.
+        Eigen::Vector3d est = estimate(lake);
+        double prev_dist = (lake.goal - lake.truth.head<2>()).norm();
+        double bearing = std::atan2(lake.goal.y() - est.y(), lake.goal.x() - est.x());
+        double omega = std::clamp(wrap_angle(bearing - est.z()) / dt,
+                                  -world.max_angular_velocity, world.max_angular_velocity);
+        double v = std::min(world.max_velocity, (lake.goal - est.head<2>()).norm() / dt);
+
+        double drift = noise_inflation(world, lake.truth.head<2>());
+        double sigma_xy = world.position_noise * drift * std::sqrt(dt);
+        double sigma_yaw = world.orientation_noise * drift * std::sqrt(dt);
+        lake.truth.z() = wrap_angle(lake.truth.z() + omega * dt + sigma_yaw * n(lake.rng));
+        lake.truth.x() += v * dt * std::cos(lake.truth.z()) + sigma_xy * n(lake.rng);
+        lake.truth.y() += v * dt * std::sin(lake.truth.z()) + sigma_xy * n(lake.rng);
+        for (auto& p : lake.particles) {
+            p.yaw = wrap_angle(p.yaw + omega * dt + sigma_yaw * n(lake.rng));
+            p.position.x() += v * dt * std::cos(p.yaw) + sigma_xy * n(lake.rng);
+            p.position.y() += v * dt * std::sin(p.yaw) + sigma_xy * n(lake.rng);
+        }
+
+        // Sensors draw power from the moment they are switched on, but only
+        // produce measurements once their warmup has elapsed.
+        const uint32_t mask = masks[i];
+        double energy = 0.0, warmup_energy = 0.0;
+        for (int s = 0; s < kNumSensors; ++s) {
+            bool on = (mask >> s) & 1u;
+            bool was_on = (lake.active >> s) & 1u;
+            if (!on) {
+                lake.warmup_left[s] = 0.0;
+                continue;
+            }
+            if (!was_on) {
+                lake.warmup_left[s] = std::chrono::duration<double>(SensorConfig::WARMUP_TIME[s]).count();
+            }
+            double e = SensorConfig::POWER_CONSUMPTION[s] * dt;
+            energy += e;
+            if (lake.warmup_left[s] > 0.0) {
+                warmup_energy += e;
+                lake.warmup_left[s] = std::max(0.0, lake.warmup_left[s] - dt);
+                continue;
+            }
+            measure(lake, static_cast<SensorType>(s), drift);
+        }
+        lake.active = mask;
+        normalise_and_resample(lake);
+
+        lake.steps++;
+        lake.time += dt;
+        est = estimate(lake);
+        double error = (est.head<2>() - lake.truth.head<2>()).norm();
+        double dist = (lake.goal - lake.truth.head<2>()).norm();
+        bool collided = signed_distance(world, lake.truth.head<2>(), lake.time) <= 0.0 ||
+                        !inside_world(world, lake.truth.head<2>());
+        bool reached = dist < params.goal_tolerance;
+        bool lost = error > params.lost_threshold;
+        bool done = collided || reached || lost || lake.steps >= world.max_steps;
+
+        double reward = params.progress_weight * (prev_dist - dist)
+                      - params.energy_weight * energy
+                      - params.error_weight * error;
+        if (reached) reward += params.goal_reward;
+        if (collided || lost) reward -= params.collision_penalty;
+
+        if (done) reset_lake(i);
+        publish(i, static_cast<float>(reward), done, energy, warmup_energy);
+    }
+
+    void measure(Lake& lake, SensorType sensor, double inflation) {
+        const int s = static_cast<int>(sensor);
+        double sigma = SensorConfig::MEASUREMENT_NOISE[s] * inflation;
+        const double range = params.world.sensor_ranges[s];
+        if (range > 0.0) {
+            const Landmark* lm = visible_landmark(params.world, lake.truth.head<2>(), range);
+            if (!lm) return;
+            sigma += lm->uncertainty;
+        }
+        std::normal_distribution<double> n(0.0, sigma);
+        const bool has_position = sensor != SensorType::IMU;
+        const bool has_heading = sensor != SensorType::GNSS;
+        Eigen::Vector2d z_xy = lake.truth.head<2>() + Eigen::Vector2d(n(lake.rng), n(lake.rng));
+        double z_yaw = wrap_angle(lake.truth.z() + n(lake.rng));
+        const double inv_var = 1.0 / (sigma * sigma);
+        for (auto& p : lake.particles) {
+            double e2 = 0.0;
+            if (has_position) e2 += (p.position - z_xy).squaredNorm();
+            if (has_heading) {
+                double dyaw = wrap_angle(p.yaw - z_yaw);
+                e2 += dyaw * dyaw;
+            }
+            p.weight *= std::exp(-0.5 * e2 * inv_var);
+        }
+    }
+
+    void normalise_and_resample(Lake& lake) {
+        const int N = static_cast<int>(lake.particles.size());
+        double total = 0.0, sq = 0.0;
+        for (const auto& p : lake.particles) total += p.weight;
+        if (!(total > 0.0)) {
+            for (auto& p : lake.particles) p.weight = 1.0 / N;
+            return;
+        }
+        for (auto& p : lake.particles) {
+            p.weight /= total;
+            sq += p.weight * p.weight;
+        }
+        if (1.0 / sq > 0.5 * N) return;
+
+        // Systematic resampling
+        std::vector<Particle> resampled(N);
+        std::uniform_real_distribution<double> u(0.0, 1.0 / N);
+        double r = u(lake.rng), c = lake.particles[0].weight;
+        int j = 0;
+        for (int k = 0; k < N; ++k) {
+            double target = r + static_cast<double>(k) / N;
+            while (target > c && j < N - 1) c += lake.particles[++j].weight;
+            resampled[k] = lake.particles[j];
+            resampled[k].weight = 1.0 / N;
+        }
+        lake.particles.swap(resampled);
+    }
+
+    void publish(int i, float reward, bool done, double energy, double warmup_energy) {
+        const Lake& lake = lakes[i];
+        BeliefRaster raster = lake.rasteriser->rasterise(lake.particles);
+        const int plane = H * W;
+        float* out = result.belief.data() + static_cast<size_t>(i) * channels() * plane;
+        for (int v = 0; v < H; ++v) {
+            const float* row = raster.data.ptr<float>(v);
+            for (int u = 0; u < W; ++u) {
+                for (int c = 0; c < channels(); ++c) {
+                    out[c * plane + v * W + u] = row[u * channels() + c];
+                }
+            }
+        }
+        result.rewards[i] = reward;
+        result.dones[i] = done ? 1 : 0;
+        result.energy[i] = energy;
+        result.warmup_energy[i] = warmup_energy;
+        result.pose_error[i] = (estimate(lake).head<2>() - lake.truth.head<2>()).norm();
+        result.goal_distance[i] = (lake.goal - estimate(lake).head<2>()).norm();
+    }
+};
+
+VectorEnv::VectorEnv(const Params& params) : impl_(std::make_unique<Impl>(params)) {}
+VectorEnv::~VectorEnv() = default;
+
+const VectorEnv::StepResult& VectorEnv::reset() {
+    impl_->run(true);
+    return impl_->result;
+}
+
+const VectorEnv::StepResult& VectorEnv::step(const std::vector<uint32_t>& sensor_masks) {
+    if (static_cast<int>(sensor_masks.size()) != num_envs()) {
+        BCOD_ERROR("VectorEnv::step expects ", num_envs(), " masks, got ", sensor_masks.size());
+        throw std::invalid_argument("Sensor mask count mismatch");
+    }
+    impl_->masks = sensor_masks;
+    impl_->run(false);
+    return impl_->result;
+}
+
+int VectorEnv::num_envs() const { return impl_->params.num_envs; }
+int VectorEnv::raster_height() const { return impl_->H; }
+int VectorEnv::raster_width() const { return impl_->W; }
+
+} // namespace bcod
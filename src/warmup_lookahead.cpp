@@ -0,0 +1,151 @@
+#include <bcod/warmup_lookahead.hpp>
+#include <bcod/logging.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+
+namespace bcod {
+
+namespace {
+    constexpr uint32_t kMaskCount = 1u << kNumSensors;
+    constexpr uint32_t kAllSensors = kMaskCount - 1;
+
+    double warmup_seconds(int s) {
+        return std::chrono::duration<double>(SensorConfig::WARMUP_TIME[s]).count();
+    }
+
+    // Switches `sensors` on at the start of step `lead` and keeps them on.
+    struct Candidate {
+        uint32_t sensors;
+        int lead;
+    };
+}
+
+WarmupLookahead::WarmupLookahead(const Params& params) {
+    set_params(params);
+}
+
+void WarmupLookahead::set_params(const Params& params) {
+    if (!params.power_coefficients.empty() && params.power_coefficients.size() != kNumSensors) {
+        BCOD_ERROR("Lookahead needs ", kNumSensors, " power coefficients, got ", params.power_coefficients.size());
+        throw std::invalid_argument("Lookahead power coefficients do not match the sensors");
+    }
+    if (params.max_lead_steps < 0 || params.power_budget < 0.0) {
+        BCOD_ERROR("Invalid lookahead: max lead ", params.max_lead_steps, " steps, budget ", params.power_budget, " W");
+        throw std::invalid_argument("Lookahead needs a non-negative lead and power budget");
+    }
+    params_ = params;
+    for (int s = 0; s < kNumSensors; ++s) {
+        power_[s] = params_.power_coefficients.empty() ? SensorConfig::POWER_CONSUMPTION[s]
+                                                        : params_.power_coefficients[s];
+    }
+}
+
+void WarmupLookahead::reset() {
+    powered_ = 0;
+    warmup_left_.fill(0.0);
+}
+
+void WarmupLookahead::advance(uint32_t powered, double elapsed) {
+    powered &= kAllSensors;
+    for (int s = 0; s < kNumSensors; ++s) {
+        const uint32_t bit = 1u << s;
+        if (!(powered & bit)) {
+            warmup_left_[s] = 0.0;
+            continue;
+        }
+        if (!(powered_ & bit)) warmup_left_[s] = warmup_seconds(s);
+        warmup_left_[s] = std::max(0.0, warmup_left_[s] - std::max(0.0, elapsed));
+    }
+    powered_ = powered;
+}
+
+uint32_t WarmupLookahead::ready() const {
+    uint32_t mask = 0;
+    for (int s = 0; s < kNumSensors; ++s) {
+        if ((powered_ >> s) & 1u && warmup_left_[s] <= 0.0) mask |= 1u << s;
+    }
+    return mask;
+}
+
+WarmupLookahead::Plan WarmupLookahead::plan(uint32_t base_mask, const std::vector<double>& risk_forecast,
+                                            double dt, double lambda) const {
+    base_mask &= kAllSensors;
+    Plan best{base_mask, 0, -1, 0, 0.0, 0.0, 0.0};
+    const int H = static_cast<int>(risk_forecast.size());
+    if (H == 0 || !(dt > 0.0)) return best;
+
+    // Seconds until a sensor switched on now measures; one already powered
+    // keeps its warmup progress. Only sensors that cannot warm up within a
+    // step need switching on ahead of time.
+    std::array<double, kNumSensors> ready_now{};
+    uint32_t slow = 0;
+    for (int s = 0; s < kNumSensors; ++s) {
+        ready_now[s] = (powered_ >> s) & 1u ? warmup_left_[s] : warmup_seconds(s);
+        if (warmup_seconds(s) > dt) slow |= 1u << s;
+    }
+    const uint32_t optional = slow & ~base_mask;
+    const int max_lead = params_.max_lead_steps > 0 ? std::min(params_.max_lead_steps, H - 1) : H - 1;
+
+    std::vector<Candidate> batch{{0u, 0}};
+    for (uint32_t sensors = optional; sensors != 0; sensors = (sensors - 1) & optional) {
+        for (int lead = 0; lead <= max_lead; ++lead) batch.push_back({sensors, lead});
+    }
+
+    std::array<double, kMaskCount> information{}, power{};
+    for (uint32_t m = 0; m < kMaskCount; ++m) {
+        information[m] = mask_information(m);
+        for (int s = 0; s < kNumSensors; ++s) {
+            if ((m >> s) & 1u) power[m] += power_[s];
+        }
+    }
+    const double info_now = information[ready()];
+
+    bool found = false;
+    for (const Candidate& c : batch) {
+        std::array<double, kNumSensors> ready_at = ready_now;
+        for (int s = 0; s < kNumSensors; ++s) {
+            if ((c.sensors >> s) & 1u && c.lead > 0) ready_at[s] = c.lead * dt + warmup_seconds(s);
+        }
+
+        int violations = 0;
+        double peak = 0.0, warmup_energy = 0.0, max_power = 0.0, cost = 0.0;
+        for (int t = 0; t < H; ++t) {
+            const double start = t * dt, end = start + dt;
+            const uint32_t on = base_mask | (t >= c.lead ? c.sensors : 0u);
+            uint32_t measuring = 0;
+            for (int s = 0; s < kNumSensors; ++s) {
+                if (!((on >> s) & 1u)) continue;
+                if (ready_at[s] <= end + 1e-9) measuring |= 1u << s;
+                warmup_energy += power_[s] * std::clamp(ready_at[s] - start, 0.0, dt);
+            }
+            max_power = std::max(max_power, power[on]);
+
+            // rescale_risk from the sensors measuring now, off the tables
+            const double risk = information[measuring] <= 0.0 ? kUnboundedRisk
+                              : info_now <= 0.0 ? risk_forecast[t]
+                              : std::min(kUnboundedRisk, risk_forecast[t] * std::sqrt(info_now / information[measuring]));
+            peak = std::max(peak, risk);
+            if (risk > params_.risk_threshold) ++violations;
+            const double excess = std::max(0.0, risk - params_.risk_threshold);
+            cost += params_.energy_weight * power[on] + params_.safety_weight * lambda * excess;
+        }
+        cost /= H;
+        if (c.sensors != 0 && params_.power_budget > 0.0 && max_power > params_.power_budget) continue;
+
+        if (!found || violations < best.violations || (violations == best.violations && cost < best.cost)) {
+            found = true;
+            best.preactivated = c.lead == 0 ? c.sensors : 0u;
+            best.lead_steps = c.sensors ? c.lead : -1;
+            best.violations = violations;
+            best.peak_risk = peak;
+            best.warmup_energy = warmup_energy;
+            best.cost = cost;
+        }
+    }
+    best.mask = base_mask | best.preactivated;
+    return best;
+}
+
+} // namespace bcod
@@ -77,4 +77,40 @@ TEST_F(BeliefRasteriserTest, StatisticsComputation) {
     EXPECT_GE(stats.orientation_variance, 0.0f);
     EXPECT_GE(stats.risk_score, 0.0f);
     EXPECT_GE(stats.energy_cost, 0.0f);
-} 
\ No newline at end of file
+} 
+
+namespace {
+    bcod::RasterWindow goal_window(double angle) {
+        bcod::RasterWindow w{};
+        w.center = Eigen::Vector2d::Zero();
+        w.size = 6.4;
+        w.grid_size = 64;
+        w.scale = 0.1;
+        w.axes << std::cos(angle), -std::sin(angle), std::sin(angle), std::cos(angle);
+        w.angle = angle;
+        return w;
+    }
+
+    std::pair<int, int> goal_cell(const bcod::RasterWindow& window, const Eigen::Vector2d& goal) {
+        cv::Mat mask = cv::Mat::ones(64, 64, CV_32FC1);
+        bcod::rasterise_goal(window, goal, mask);
+        EXPECT_EQ(cv::countNonZero(mask), 1);
+        cv::Point cell;
+        cv::minMaxLoc(mask, nullptr, nullptr, nullptr, &cell);
+        return {cell.y, cell.x};
+    }
+}
+
+TEST(RasteriseGoalTest, FollowsWindowAxes) {
+    const Eigen::Vector2d goal(0.05, 2.05);
+    EXPECT_EQ(goal_cell(goal_window(0.0), goal), std::make_pair(52, 32));
+
+    // With align_axes the cells follow the principal axes, as the particles
+    // do: rotated a quarter turn, world +y runs along the raster columns.
+    EXPECT_EQ(goal_cell(goal_window(M_PI / 2), goal), std::make_pair(31, 52));
+}
+
+TEST(RasteriseGoalTest, ClampsGoalsOutsideTheWindow) {
+    EXPECT_EQ(goal_cell(goal_window(0.0), Eigen::Vector2d(100.0, 0.05)), std::make_pair(32, 63));
+    EXPECT_EQ(goal_cell(goal_window(0.0), Eigen::Vector2d(-0.05, -100.0)), std::make_pair(0, 31));
+}
@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+#include <bcod/config_loader.hpp>
+#include <bcod/config_snapshot.hpp>
+#include <bcod/environment.hpp>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+namespace fs = std::filesystem;
+
+class ConfigLoaderTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir = fs::temp_directory_path() / "bcod_config_loader_test";
+        fs::remove_all(dir);
+        fs::create_directories(dir / "sub");
+
+        write("base.yaml", R"(
+rasteriser:
+  resolution: 0.1
+  max_range: 10.0
+planner:
+  batch_size: 1
+  sequence_length: 16
+scheduler:
+  observation_dim: 64
+  action_dim: 6
+  device: "cpu"
+)");
+        write("sub/tuning.yaml", R"(
+scheduler:
+  temperature: 0.3
+  power_coefficients: [45.0, 12.0, 8.0, 2.5, 1.2, 35.0]
+)");
+        write("main.yaml", R"(
+imports:
+  - "base.yaml"
+  - "sub/tuning.yaml"
+planner:
+  sequence_length: 32
+  model_path: "123"
+)");
+    }
+
+    void TearDown() override {
+        fs::remove_all(dir);
+    }
+
+    void write(const std::string& name, const std::string& text) {
+        std::ofstream(dir / name) << text;
+    }
+
+    std::string path(const std::string& name) const {
+        return (dir / name).string();
+    }
+
+    fs::path dir;
+};
+
+TEST_F(ConfigLoaderTest, MergesImportGraph) {
+    auto loaded = bcod::load_config(path("main.yaml"));
+    const auto& config = loaded.config;
+
+    ASSERT_EQ(loaded.inputs.size(), 3u);
+    EXPECT_EQ(fs::path(loaded.inputs.back()).filename(), "main.yaml");
+    EXPECT_FALSE(loaded.from_cache);
+
+    EXPECT_DOUBLE_EQ(config.get<double>("rasteriser.resolution"), 0.1);
+    EXPECT_EQ(config.get<int>("planner.sequence_length"), 32);       // Importer overrides
+    EXPECT_DOUBLE_EQ(config.get<double>("scheduler.temperature"), 0.3);
+    EXPECT_EQ(config.get<std::string>("scheduler.device"), "cpu");
+    EXPECT_EQ(config.get<std::string>("planner.model_path"), "123");  // Quoted stays a string
+    EXPECT_EQ(config.get_array<double>("scheduler.power_coefficients").size(), 6u);
+    EXPECT_FALSE(config.has("imports"));
+}
+
+TEST_F(ConfigLoaderTest, ReusesCacheUntilAnInputChanges) {
+    auto first = bcod::load_config(path("main.yaml"));
+    EXPECT_FALSE(first.from_cache);
+    ASSERT_TRUE(fs::exists(path("main.yaml.cache")));
+
+    auto second = bcod::load_config(path("main.yaml"));
+    EXPECT_TRUE(second.from_cache);
+    EXPECT_EQ(second.content_hash, first.content_hash);
+    EXPECT_EQ(second.config.data(), first.config.data());
+
+    write("sub/tuning.yaml", "scheduler:\n  temperature: 0.5\n");
+    auto third = bcod::load_config(path("main.yaml"));
+    EXPECT_FALSE(third.from_cache);
+    EXPECT_NE(third.content_hash, first.content_hash);
+    EXPECT_DOUBLE_EQ(third.config.get<double>("scheduler.temperature"), 0.5);
+}
+
+TEST_F(ConfigLoaderTest, RejectsBrokenGraphs) {
+    write("missing.yaml", "imports: [\"nope.yaml\"]\n");
+    EXPECT_THROW(bcod::load_config(path("missing.yaml")), std::runtime_error);
+
+    write("a.yaml", "imports: [\"b.yaml\"]\n");
+    write("b.yaml", "imports: [\"a.yaml\"]\n");
+    EXPECT_THROW(bcod::load_config(path("a.yaml")), std::runtime_error);
+}
+
+TEST_F(ConfigLoaderTest, LoadsVehicleConfig) {
+    const std::string vehicle = std::string(BCOD_SOURCE_DIR) + "/configs/surveyor_orin_nx.yaml";
+    auto loaded = bcod::load_config(vehicle, path("vehicle.cache"));
+    EXPECT_EQ(loaded.config.get<int>("scheduler.observation_dim"), 128);
+    EXPECT_DOUBLE_EQ(loaded.config.get<double>("sensors.lidar.power"), 45.0);
+}
+
+TEST_F(ConfigLoaderTest, LoadsShippedMainConfig) {
+    const std::string main_config = std::string(BCOD_SOURCE_DIR) + "/configs/main_config.yaml";
+    auto loaded = bcod::load_config(main_config, path("main_config.cache"));
+    EXPECT_EQ(loaded.inputs.size(), 5u);
+    EXPECT_EQ(loaded.config.get<int>("planner.batch_size"), 32);
+    EXPECT_EQ(loaded.config.get<int>("scheduler.observation_dim"), 64);
+    EXPECT_DOUBLE_EQ(loaded.config.get<double>("sensors.exo2.power"), 35.0);
+
+    // Every section compiles, not just the keys validate_config requires
+    auto snapshot = bcod::compile_config(loaded.config);
+    EXPECT_EQ(snapshot->student.trajectory_horizon, 50);
+    EXPECT_EQ(snapshot->student.hidden_dim, 256);
+    EXPECT_EQ(snapshot->scheduler.batch_size, 256);
+    EXPECT_DOUBLE_EQ(snapshot->scheduler.temperature, 0.2);
+    EXPECT_EQ(snapshot->scheduler.power_coefficients.size(), 6u);
+}
+
+TEST_F(ConfigLoaderTest, LoadsEnvironmentDocument) {
+    const std::string environment = std::string(BCOD_SOURCE_DIR) + "/configs/environment_config.yaml";
+    const nlohmann::json document = bcod::load_config_document(environment);
+    ASSERT_TRUE(document.contains("environment"));
+
+    // Nested as written, so the simulator can parse it directly
+    const bcod::WorldParams world = bcod::parse_world(document.at("environment"));
+    EXPECT_DOUBLE_EQ(world.size.x(), 100.0);
+    EXPECT_EQ(world.obstacles.size(), 3u);
+    EXPECT_EQ(world.landmarks.size(), 2u);
+
+    EXPECT_THROW(bcod::load_config_document(path("missing.yaml")), std::runtime_error);
+}
@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+#include <bcod/config_snapshot.hpp>
+#include <bcod/sensor_defs.hpp>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+
+class ConfigSnapshotTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path = (std::filesystem::temp_directory_path() / "bcod_config_snapshot_test.json").string();
+        base = {
+            {"rasteriser.resolution", 0.2},
+            {"rasteriser.max_range", 10.0},
+            {"planner.batch_size", 1},
+            {"planner.sequence_length", 20},
+            {"planner.hidden_dim", 64},
+            {"scheduler.observation_dim", 64},
+            {"scheduler.action_dim", bcod::kNumSensors},
+            {"scheduler.hidden_dim", 64}
+        };
+        write(base);
+    }
+
+    void TearDown() override {
+        std::remove(path.c_str());
+        std::remove((path + ".cache").c_str());
+    }
+
+    void write(const nlohmann::json& config) {
+        std::ofstream(path) << config;
+        // Make sure the modification time moves even on coarse filesystems
+        const auto t = std::filesystem::last_write_time(path);
+        std::filesystem::last_write_time(path, t + std::chrono::seconds(++writes));
+    }
+
+    std::string path;
+    nlohmann::json base;
+    int writes = 0;
+};
+
+TEST_F(ConfigSnapshotTest, CompilesTypedParams) {
+    auto snapshot = bcod::compile_config(bcod::JsonConfig(path));
+    EXPECT_EQ(snapshot->version, 1u);
+    EXPECT_DOUBLE_EQ(snapshot->rasteriser.resolution, 0.2);
+    EXPECT_DOUBLE_EQ(snapshot->rasteriser.min_weight, 0.01);
+    EXPECT_EQ(snapshot->student.trajectory_horizon, 20);
+    EXPECT_EQ(snapshot->student.hidden_dim, 64);
+    EXPECT_EQ(snapshot->scheduler.belief_dim, 64);
+    EXPECT_EQ(snapshot->scheduler.power_coefficients.size(), static_cast<size_t>(bcod::kNumSensors));
+    EXPECT_FALSE(snapshot->profiling.enabled);
+}
+
+TEST_F(ConfigSnapshotTest, RejectsInvalidValues) {
+    auto config = base;
+    config["rasteriser.resolution"] = -1.0;
+    write(config);
+    EXPECT_THROW(bcod::compile_config(bcod::JsonConfig(path)), std::invalid_argument);
+
+    config = base;
+    config["scheduler.tau"] = "fast";
+    write(config);
+    EXPECT_THROW(bcod::compile_config(bcod::JsonConfig(path)), std::invalid_argument);
+
+    config = base;
+    config["scheduler.action_dim"] = bcod::kNumSensors + 1;
+    write(config);
+    EXPECT_THROW(bcod::compile_config(bcod::JsonConfig(path)), std::invalid_argument);
+}
+
+TEST_F(ConfigSnapshotTest, ReloadSwapsSnapshot) {
+    bcod::ConfigStore store(path);
+    auto before = store.current();
+    EXPECT_FALSE(store.reload_if_changed());
+
+    auto config = base;
+    config["scheduler.target_risk"] = 0.3;
+    write(config);
+    EXPECT_TRUE(store.reload_if_changed());
+    EXPECT_EQ(store.version(), 2u);
+    EXPECT_DOUBLE_EQ(store.current()->scheduler.risk_threshold, 0.3);
+
+    // Readers holding the old snapshot keep a consistent view
+    EXPECT_EQ(before->version, 1u);
+    EXPECT_DOUBLE_EQ(before->scheduler.risk_threshold, 0.05);
+}
+
+TEST_F(ConfigSnapshotTest, FailedReloadKeepsSnapshot) {
+    bcod::ConfigStore store(path);
+
+    std::ofstream(path) << "{ not json";
+    EXPECT_FALSE(store.reload());
+    EXPECT_EQ(store.version(), 1u);
+
+    auto config = base;
+    config["planner.hidden_dim"] = 128;
+    write(config);
+    EXPECT_FALSE(store.reload());
+    EXPECT_EQ(store.current()->student.hidden_dim, 64);
+}
+
+TEST_F(ConfigSnapshotTest, PublishingAppliesProfiling) {
+    const std::string dir = ::testing::TempDir() + "bcod_config_profiles";
+    std::filesystem::remove_all(dir);
+    const std::string profile = dir + "/profile_" + std::to_string(getpid()) + ".tsv";
+
+    auto config = base;
+    config["performance.profiling.enabled"] = true;
+    config["performance.profiling.interval"] = 60000;
+    config["performance.profiling.output"] = dir;
+    write(config);
+    {
+        bcod::ConfigStore store(path);
+        EXPECT_TRUE(bcod::Instrumentation::instance().enabled());
+        EXPECT_TRUE(std::filesystem::exists(profile));
+
+        // Switching profiling off on reload stops it
+        config["performance.profiling.enabled"] = false;
+        write(config);
+        EXPECT_TRUE(store.reload_if_changed());
+        EXPECT_FALSE(bcod::Instrumentation::instance().enabled());
+    }
+    std::filesystem::remove_all(dir);
+}
@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+#include <bcod/distance_field.hpp>
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace {
+    bcod::WorldParams world() {
+        return bcod::parse_world(nlohmann::json::parse(R"({
+            "world": {
+                "size": [40.0, 30.0],
+                "resolution": 0.1,
+                "origin": [0.0, 0.0],
+                "obstacles": [
+                    {"type": "static", "shape": "circle", "center": [10.0, 10.0], "radius": 3.0},
+                    {"type": "static", "shape": "polygon", "vertices": [[25.0, 5.0], [32.0, 6.0], [28.0, 12.0]]},
+                    {"type": "dynamic", "shape": "rectangle", "position": [20.0, 22.0], "size": [2.0, 1.0],
+                     "velocity": [1.0, -0.5]}
+                ]
+            }
+        })"));
+    }
+}
+
+TEST(DistanceFieldTest, MatchesExactGeometry) {
+    const auto w = world();
+    bcod::DistanceField field(w);
+    EXPECT_EQ(field.width(), 400);
+    EXPECT_EQ(field.height(), 300);
+
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<double> x(0.5, 39.5), y(0.5, 29.5);
+    for (int i = 0; i < 2000; ++i) {
+        const Eigen::Vector2d p(x(rng), y(rng));
+        // Dynamic obstacles are only rasterised within the default 10 m radius.
+        const double exact = std::min(bcod::signed_distance(w, p), 10.0);
+        EXPECT_NEAR(std::min(field.distance(p), 10.0), exact, w.resolution) << p.transpose();
+    }
+}
+
+TEST(DistanceFieldTest, DynamicObstaclesMoveIncrementally) {
+    const auto w = world();
+    bcod::DistanceField field(w);
+    const Eigen::Vector2d start(20.0, 22.0);
+    EXPECT_LT(field.distance(start), 0.0);
+
+    field.update(4.0);
+    EXPECT_DOUBLE_EQ(field.time(), 4.0);
+    EXPECT_GT(field.distance(start), 1.0);
+    const Eigen::Vector2d moved(24.0, 20.0);
+    EXPECT_LT(field.distance(moved), 0.0);
+    for (const Eigen::Vector2d p : {start, moved, Eigen::Vector2d(10.0, 14.5), Eigen::Vector2d(35.0, 25.0)}) {
+        const double exact = std::min(bcod::signed_distance(w, p, 4.0), 10.0);
+        EXPECT_NEAR(std::min(field.distance(p), 10.0), exact, w.resolution) << p.transpose();
+    }
+}
+
+TEST(DistanceFieldTest, TrajectoryClearanceFollowsStartPose) {
+    const auto w = world();
+    bcod::DistanceField field(w);
+    const std::vector<Eigen::Vector3d> waypoints = {{1.0, 0.0, 0.0}, {2.0, 0.0, 0.0}, {3.0, 0.0, 0.0}};
+
+    // Heading -y from (10, 20): the last waypoint is 4 m above the circle.
+    const double clearance = bcod::trajectory_clearance(waypoints, Eigen::Vector3d(10.0, 20.0, -M_PI / 2), field);
+    EXPECT_NEAR(clearance, 4.0, w.resolution);
+    EXPECT_TRUE(std::isinf(bcod::trajectory_clearance({}, Eigen::Vector3d::Zero(), field)));
+}
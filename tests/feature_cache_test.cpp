@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+#include <bcod/feature_cache.hpp>
+#include <opencv2/core.hpp>
+
+TEST(FeatureCacheTest, HashFollowsContentNotStorage) {
+    cv::Mat a(64, 64, CV_32FC5, cv::Scalar::all(0.25));
+    cv::Mat b = a.clone();
+    EXPECT_EQ(bcod::hash_raster(a), bcod::hash_raster(b));
+
+    b.at<cv::Vec<float, 5>>(10, 20)[3] = 0.5f;
+    EXPECT_NE(bcod::hash_raster(a), bcod::hash_raster(b));
+
+    // Same bytes, different shape
+    EXPECT_NE(bcod::hash_raster(a), bcod::hash_raster(a.reshape(5, 32)));
+
+    // A region of interest hashes like a continuous copy of it
+    cv::Mat big(80, 80, CV_32FC5, cv::Scalar::all(0.25));
+    EXPECT_EQ(bcod::hash_raster(big(cv::Rect(3, 7, 64, 64))), bcod::hash_raster(a));
+}
+
+TEST(FeatureCacheTest, KeysSeparateEncoders) {
+    const uint64_t h = bcod::hash_raster(cv::Mat(64, 64, CV_32FC5, cv::Scalar::all(0.25)));
+    EXPECT_NE(bcod::feature_key(h, 0), bcod::feature_key(h, 1));
+    EXPECT_NE(bcod::feature_key(h, 0), h);
+    EXPECT_EQ(bcod::feature_key(h, 1), bcod::feature_key(h, 1));
+
+    bcod::FeatureCache cache;
+    cache.get_or_compute(bcod::feature_key(h, 0), [] { return torch::full({1, 4}, 1.0f); });
+    EXPECT_EQ(cache.get_or_compute(bcod::feature_key(h, 1), [] { return torch::full({1, 4}, 2.0f); })[0][0].item<float>(),
+              2.0f);
+}
+
+TEST(FeatureCacheTest, ComputesOncePerKeyAndEvictsOldest) {
+    bcod::FeatureCache cache(2);
+    int calls = 0;
+    auto encode = [&](float value) {
+        return [&calls, value] {
+            ++calls;
+            return torch::full({1, 4}, value);
+        };
+    };
+
+    EXPECT_EQ(cache.get_or_compute(1, encode(1.0f))[0][0].item<float>(), 1.0f);
+    EXPECT_EQ(cache.get_or_compute(1, encode(9.0f))[0][0].item<float>(), 1.0f);
+    EXPECT_EQ(calls, 1);
+
+    cache.get_or_compute(2, encode(2.0f));
+    cache.get_or_compute(3, encode(3.0f));   // Evicts key 1
+    EXPECT_EQ(calls, 3);
+    cache.get_or_compute(2, encode(2.0f));
+    EXPECT_EQ(calls, 3);
+    cache.get_or_compute(1, encode(1.0f));
+    EXPECT_EQ(calls, 4);
+
+    cache.clear();
+    cache.get_or_compute(2, encode(2.0f));
+    EXPECT_EQ(calls, 5);
+}
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+#include <bcod/instrumentation.hpp>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+
+TEST(LatencyHistogramTest, Percentiles) {
+    bcod::LatencyHistogram hist;
+    for (int i = 0; i < 99; ++i) hist.record(1000000);   // 1 ms
+    hist.record(50000000);                                 // 50 ms
+
+    EXPECT_EQ(hist.count(), 100u);
+    EXPECT_NEAR(hist.percentile(0.5), 1.0, 0.07);
+    EXPECT_DOUBLE_EQ(hist.percentile(1.0), 50.0);
+    EXPECT_DOUBLE_EQ(hist.max_ms(), 50.0);
+    EXPECT_NEAR(hist.mean_ms(), 1.49, 1e-9);
+
+    hist.reset();
+    EXPECT_EQ(hist.count(), 0u);
+    EXPECT_DOUBLE_EQ(hist.percentile(0.5), 0.0);
+}
+
+TEST(LatencyHistogramTest, RelativeErrorIsBounded) {
+    for (int64_t ns : {3, 17, 999, 123456, 7654321, 2000000000}) {
+        bcod::LatencyHistogram hist;
+        hist.record(ns);
+        hist.record(ns * 4);
+        EXPECT_GE(hist.percentile(0.5) * 1e6, ns * (1 - 1e-9));
+        EXPECT_LE(hist.percentile(0.5) * 1e6, ns * 1.0625 + 1);
+    }
+}
+
+TEST(InstrumentationTest, ScopedTimerOnlyRecordsWhenEnabled) {
+    auto& metrics = bcod::Instrumentation::instance();
+    auto& hist = metrics.histogram("test.scope");
+    hist.reset();
+
+    metrics.set_enabled(false);
+    { bcod::ScopedTimer timer(hist); }
+    EXPECT_EQ(hist.count(), 0u);
+
+    metrics.set_enabled(true);
+    { bcod::ScopedTimer timer(hist); }
+    metrics.set_enabled(false);
+    EXPECT_EQ(hist.count(), 1u);
+    EXPECT_EQ(&metrics.histogram("test.scope"), &hist);
+}
+
+TEST(InstrumentationTest, DumpWritesProfile) {
+    const std::string dir = ::testing::TempDir() + "bcod_profiles";
+    std::filesystem::remove_all(dir);
+
+    auto& metrics = bcod::Instrumentation::instance();
+    metrics.configure({true, 60000, dir, true});
+    {
+        BCOD_SCOPED_TIMER("test.dump");
+    }
+    metrics.counter("test.frames").add(3);
+    metrics.dump();
+    metrics.configure({false, 1000, "", false});
+
+    std::ifstream in(dir + "/profile_" + std::to_string(getpid()) + ".tsv");
+    ASSERT_TRUE(in.good());
+    std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    EXPECT_NE(content.find("wall_s\tmetric"), std::string::npos);
+    EXPECT_NE(content.find("\ttest.dump\t1\t"), std::string::npos);
+    EXPECT_NE(content.find("\ttest.frames\t"), std::string::npos);
+    EXPECT_NE(content.find("\tprocess.rss_mb\t"), std::string::npos);
+    std::filesystem::remove_all(dir);
+}
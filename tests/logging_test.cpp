@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+#include <bcod/logging.hpp>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+class LoggingTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path = ::testing::TempDir() + "bcod_logging_test.log";
+        std::remove(path.c_str());
+        bcod::Logger::instance().set_log_file(path);
+        bcod::Logger::instance().set_level(bcod::LogLevel::DEBUG);
+    }
+
+    void TearDown() override {
+        bcod::Logger::instance().set_level(bcod::LogLevel::INFO);
+        std::remove(path.c_str());
+    }
+
+    std::vector<std::string> read_lines() {
+        bcod::Logger::instance().flush();
+        std::ifstream in(path);
+        std::vector<std::string> lines;
+        for (std::string line; std::getline(in, line);) lines.push_back(line);
+        return lines;
+    }
+
+    std::string path;
+};
+
+TEST_F(LoggingTest, FormatsArguments) {
+    const std::string name = "lidar";
+    BCOD_LOG(bcod::LogLevel::INFO, "sensor ", name, " mask ", 5u, " power ", 2.5, " ok ", true, ' ', -3);
+
+    auto lines = read_lines();
+    ASSERT_EQ(lines.size(), 1u);
+    EXPECT_NE(lines[0].find("[INFO] "), std::string::npos);
+    EXPECT_NE(lines[0].find("logging_test.cpp:"), std::string::npos);
+    EXPECT_NE(lines[0].find(" - sensor lidar mask 5 power 2.5 ok 1 -3"), std::string::npos);
+}
+
+TEST_F(LoggingTest, DisabledLevelSkipsArgumentEvaluation) {
+    bcod::Logger::instance().set_level(bcod::LogLevel::WARNING);
+    int evaluated = 0;
+    auto touch = [&] { return ++evaluated; };
+    BCOD_DEBUG("value ", touch());
+    EXPECT_EQ(evaluated, 0);
+    EXPECT_TRUE(read_lines().empty());
+}
+
+TEST_F(LoggingTest, LongMessagesAreTruncated) {
+    BCOD_LOG(bcod::LogLevel::INFO, std::string(1000, 'x'));
+    auto lines = read_lines();
+    ASSERT_EQ(lines.size(), 1u);
+    EXPECT_LT(lines[0].size(), 400u);
+    EXPECT_EQ(lines[0].substr(lines[0].size() - 3), "...");
+}
+
+TEST_F(LoggingTest, ThreadsAreMergedInOrder) {
+    constexpr int kThreads = 4;
+    constexpr int kPerThread = 200;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([t] {
+            for (int i = 0; i < kPerThread; ++i) BCOD_LOG(bcod::LogLevel::DEBUG, "thread ", t, " message ", i);
+        });
+    }
+    for (auto& th : threads) th.join();
+
+    auto lines = read_lines();
+    EXPECT_EQ(lines.size() + bcod::Logger::instance().dropped(), static_cast<size_t>(kThreads * kPerThread));
+
+    std::vector<int> next(kThreads, 0);
+    for (const auto& line : lines) {
+        auto pos = line.find(" - thread ");
+        ASSERT_NE(pos, std::string::npos);
+        int t = 0, i = 0;
+        std::sscanf(line.c_str() + pos, " - thread %d message %d", &t, &i);
+        EXPECT_GE(i, next[t]);  // Per-thread order is preserved
+        next[t] = i + 1;
+    }
+}
+
+TEST_F(LoggingTest, MinLevelCompilesSitesOut) {
+    int evaluated = 0;
+    auto touch = [&] { return ++evaluated; };
+    BCOD_DEBUG("value ", touch());
+    BCOD_ERROR("value ", touch());
+    EXPECT_EQ(evaluated, (BCOD_MIN_LOG_LEVEL <= 0) + (BCOD_MIN_LOG_LEVEL <= 3));
+}
@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+#include <bcod/map_store.hpp>
+#include <cstdio>
+
+class MapStoreTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path = ::testing::TempDir() + "bcod_map_store_test.bin";
+        image = cv::Mat(200, 300, CV_8UC3);
+        for (int y = 0; y < image.rows; ++y) {
+            for (int x = 0; x < image.cols; ++x) {
+                uint8_t* px = image.ptr<uint8_t>(y) + x * 3;
+                px[0] = static_cast<uint8_t>(x % 256);
+                px[1] = static_cast<uint8_t>(y);
+                px[2] = static_cast<uint8_t>((x + 2 * y) % 256);
+            }
+        }
+        bcod::MapStore::build(image, 0.1, origin, path, 64);
+    }
+
+    void TearDown() override {
+        std::remove(path.c_str());
+    }
+
+    // 64 x 64 window of one map pixel per cell, centred on the corner of pixel (100, 50).
+    bcod::RasterWindow window(const Eigen::Matrix2d& axes) const {
+        bcod::RasterWindow w{};
+        w.center = origin + Eigen::Vector2d(10.0, 5.0);
+        w.size = 6.4;
+        w.grid_size = 64;
+        w.scale = 0.1;
+        w.axes = axes;
+        return w;
+    }
+
+    float pixel(int x, int y, int c) const { return image.ptr<uint8_t>(y)[x * 3 + c] / 255.0f; }
+
+    std::string path;
+    cv::Mat image;
+    const Eigen::Vector2d origin{5.0, -3.0};
+};
+
+TEST_F(MapStoreTest, BuildsPyramidDownToOneTile) {
+    bcod::MapStore store(path);
+    EXPECT_EQ(store.channels(), 3);
+    EXPECT_EQ(store.width(), 300);
+    EXPECT_EQ(store.height(), 200);
+    EXPECT_EQ(store.levels(), 4);  // 300, 150, 75, 38 px wide
+    EXPECT_DOUBLE_EQ(store.origin().x(), 5.0);
+}
+
+TEST_F(MapStoreTest, CropFollowsWindowAxes) {
+    bcod::MapStore store(path);
+    std::vector<float> planes(3 * 64 * 64);
+    const size_t plane = 64 * 64;
+
+    store.crop(window(Eigen::Matrix2d::Identity()), 64, 64, planes.data());
+    for (int v = 0; v < 64; v += 7) {
+        for (int u = 0; u < 64; u += 5) {
+            for (int c = 0; c < 3; ++c) {
+                EXPECT_NEAR(planes[c * plane + v * 64 + u], pixel(68 + u, 18 + v, c), 1e-5);
+            }
+        }
+    }
+
+    // Quarter turn: cell u runs along world +y, cell v along world -x.
+    Eigen::Matrix2d rotated;
+    rotated << 0, -1,
+               1,  0;
+    const cv::Mat crop = store.crop(window(rotated), 64, 64);
+    ASSERT_EQ(crop.channels(), 3);
+    for (int v = 0; v < 64; v += 7) {
+        for (int u = 0; u < 64; u += 5) {
+            EXPECT_NEAR(crop.ptr<float>(v)[u * 3 + 1], pixel(131 - v, 18 + u, 1), 1e-5);
+        }
+    }
+}
+
+TEST_F(MapStoreTest, OffMapIsZeroAndResidencyIsBounded) {
+    bcod::MapStore store(path, 2);
+    auto w = window(Eigen::Matrix2d::Identity());
+    w.center = origin + Eigen::Vector2d(-50.0, -50.0);
+    const cv::Mat off = store.crop(w, 64, 64);
+    EXPECT_FLOAT_EQ(off.ptr<float>(10)[10 * 3], 0.0f);
+
+    // The centred window spans four level-0 tiles.
+    store.crop(window(Eigen::Matrix2d::Identity()), 64, 64);
+    EXPECT_EQ(store.resident_tiles(), 2u);
+}
@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+#include <bcod/particle_filter.hpp>
+#include <bcod/belief_rasteriser.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+    bcod::ParticleFilter::Params filter_params(int n = 4096) {
+        bcod::ParticleFilter::Params p{};
+        p.num_particles = n;
+        p.seed = 11;
+        p.position_noise = 0.1;
+        p.orientation_noise = 0.01;
+        return p;
+    }
+
+    bcod::Measurement reading(bcod::SensorType sensor, const Eigen::Vector3d& pose) {
+        bcod::Measurement z{};
+        z.sensor = sensor;
+        z.position = pose.head<2>();
+        z.yaw = pose.z();
+        return z;
+    }
+}
+
+TEST(ParticleFilterTest, SameSeedIsBitIdentical) {
+    bcod::ParticleFilter a(filter_params()), b(filter_params());
+    for (auto* f : {&a, &b}) {
+        f->reset(Eigen::Vector3d(5.0, 5.0, 0.3), 1.0, 0.2);
+        f->predict(1.0, 0.1, 0.1);
+        f->update(reading(bcod::SensorType::GNSS, Eigen::Vector3d(5.1, 5.0, 0.0)));
+        f->resample();
+    }
+    const auto pa = a.particles(), pb = b.particles();
+    ASSERT_EQ(pa.size, pb.size);
+    for (size_t i = 0; i < pa.size; ++i) {
+        ASSERT_EQ(pa.x[i], pb.x[i]);
+        ASSERT_EQ(pa.yaw[i], pb.yaw[i]);
+        ASSERT_EQ(pa.weight[i], pb.weight[i]);
+    }
+}
+
+TEST(ParticleFilterTest, TracksTruthWithGnssAndImu) {
+    bcod::ParticleFilter filter(filter_params());
+    Eigen::Vector3d truth(0.0, 0.0, 0.0);
+    filter.reset(truth + Eigen::Vector3d(0.5, -0.5, 0.1), 1.0, 0.2);
+
+    const double dt = 0.1;
+    for (int step = 0; step < 50; ++step) {
+        truth.z() += 0.2 * dt;
+        truth.x() += 1.0 * dt * std::cos(truth.z());
+        truth.y() += 1.0 * dt * std::sin(truth.z());
+        filter.predict(1.0, 0.2, dt);
+        filter.update(reading(bcod::SensorType::GNSS, truth));
+        filter.update(reading(bcod::SensorType::IMU, truth));
+        filter.resample();
+    }
+    const Eigen::Vector3d est = filter.estimate();
+    EXPECT_NEAR(est.x(), truth.x(), 0.05);
+    EXPECT_NEAR(est.y(), truth.y(), 0.05);
+    EXPECT_NEAR(est.z(), truth.z(), 0.02);
+}
+
+TEST(ParticleFilterTest, ResamplesOnlyWhenDegenerate) {
+    bcod::ParticleFilter filter(filter_params(1000));
+    filter.reset(Eigen::Vector3d::Zero(), 2.0, 0.5);
+    EXPECT_FALSE(filter.resample());
+    EXPECT_NEAR(filter.effective_sample_size(), 1000.0, 1e-3);
+
+    filter.update(reading(bcod::SensorType::GNSS, Eigen::Vector3d(1.0, 1.0, 0.0)));
+    EXPECT_LT(filter.effective_sample_size(), 500.0);
+    EXPECT_TRUE(filter.resample());
+    EXPECT_NEAR(filter.effective_sample_size(), 1000.0, 1e-3);
+    EXPECT_NEAR(filter.estimate().x(), 1.0, 0.1);
+}
+
+TEST(ParticleFilterTest, FusedUpdateMatchesSequentialReadings) {
+    bcod::ParticleFilter fused(filter_params(2000)), sequential(filter_params(2000));
+    for (auto* f : {&fused, &sequential}) f->reset(Eigen::Vector3d(3.0, -2.0, 3.0), 1.0, 0.3);
+
+    const std::vector<bcod::SensorType> active = {bcod::SensorType::RGB, bcod::SensorType::GNSS,
+                                                  bcod::SensorType::IMU};
+    std::array<bcod::Measurement, bcod::kNumSensors> readings{};
+    uint32_t mask = 0;
+    double offset = 0.0;
+    for (auto sensor : active) {
+        // Headings either side of +-pi exercise the wrap.
+        auto z = reading(sensor, Eigen::Vector3d(3.2 + offset, -2.1, offset > 0.0 ? -3.1 : 3.1));
+        z.inflation = 1.0 + offset;
+        readings[static_cast<int>(sensor)] = z;
+        mask |= 1u << static_cast<int>(sensor);
+        sequential.update(z);
+        offset += 0.1;
+    }
+    fused.update(mask, readings);
+
+    const auto pf = fused.particles(), ps = sequential.particles();
+    for (size_t i = 0; i < pf.size; ++i) {
+        ASSERT_NEAR(pf.weight[i], ps.weight[i], 1e-4f * ps.weight[i] + 1e-12f);
+    }
+}
+
+TEST(ParticleFilterTest, EmptyMaskLeavesWeightsAlone) {
+    bcod::ParticleFilter filter(filter_params(500));
+    filter.reset(Eigen::Vector3d::Zero(), 1.0, 0.3);
+    filter.update(reading(bcod::SensorType::GNSS, Eigen::Vector3d(0.5, 0.0, 0.0)));
+    const std::vector<float> before(filter.particles().weight, filter.particles().weight + filter.size());
+
+    filter.update(0u, {});
+    EXPECT_TRUE(std::equal(before.begin(), before.end(), filter.particles().weight));
+    EXPECT_THROW(filter.update(1u << bcod::kNumSensors, {}), std::invalid_argument);
+}
+
+TEST(ParticleFilterTest, RejectsNonPositiveSigma) {
+    bcod::ParticleFilter filter(filter_params(500));
+    filter.reset(Eigen::Vector3d::Zero(), 1.0, 0.3);
+    const std::vector<float> before(filter.particles().weight, filter.particles().weight + filter.size());
+
+    auto z = reading(bcod::SensorType::GNSS, Eigen::Vector3d(0.5, 0.0, 0.0));
+    z.inflation = 0.0;
+    EXPECT_THROW(filter.update(z), std::invalid_argument);
+    z.inflation = 1.0;
+    z.extra_sigma = -1.0;
+    EXPECT_THROW(filter.update(z), std::invalid_argument);
+    z.extra_sigma = std::numeric_limits<double>::quiet_NaN();
+    EXPECT_THROW(filter.update(z), std::invalid_argument);
+    z.extra_sigma = std::numeric_limits<double>::infinity();
+    EXPECT_THROW(filter.update(z), std::invalid_argument);
+    EXPECT_TRUE(std::equal(before.begin(), before.end(), filter.particles().weight));
+}
+
+TEST(ParticleFilterTest, DegenerateWeightsFallBackToUniform) {
+    bcod::ParticleFilter filter(filter_params(500));
+    filter.reset(Eigen::Vector3d::Zero(), 1.0, 0.3);
+    // Every log-likelihood overflows to -inf, so relative to the best one
+    // they are all NaN
+    filter.update(reading(bcod::SensorType::GNSS, Eigen::Vector3d(1e30, 0.0, 0.0)));
+    const auto view = filter.particles();
+    for (size_t i = 0; i < view.size; ++i) ASSERT_FLOAT_EQ(view.weight[i], 1.0f / view.size);
+}
+
+TEST(ParticleFilterTest, RasterisesWithoutConversion) {
+    bcod::ParticleFilter filter(filter_params(2000));
+    filter.reset(Eigen::Vector3d(20.0, 30.0, 0.0), 1.5, 0.3);
+
+    std::vector<bcod::Particle> copies(filter.size());
+    const auto view = filter.particles();
+    for (size_t i = 0; i < view.size; ++i) {
+        copies[i].position = Eigen::Vector2d(view.x[i], view.y[i]);
+        copies[i].yaw = view.yaw[i];
+        copies[i].weight = view.weight[i];
+    }
+
+    bcod::BeliefRasteriser::Params params{};
+    params.raster_H = 32;
+    params.raster_W = 32;
+    params.raster_C = 5;
+    params.min_window = 2.0;
+    params.max_window = 50.0;
+    params.sigma_scale = 6.0;
+    bcod::BeliefRasteriser rasteriser(params);
+    const auto from_view = rasteriser.rasterise(view);
+    const auto from_copies = rasteriser.rasterise(copies);
+    ASSERT_EQ(from_view.H, from_copies.H);
+    EXPECT_EQ(from_view.window.center, from_copies.window.center);
+    for (size_t i = 0; i < from_view.cells.size(); ++i) {
+        EXPECT_DOUBLE_EQ(from_view.cells[i].mass, from_copies.cells[i].mass);
+    }
+}
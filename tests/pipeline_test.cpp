@@ -0,0 +1,259 @@
+#include <gtest/gtest.h>
+#include <bcod/lockfree.hpp>
+#include <bcod/pipeline.hpp>
+#include <bcod/sensor_defs.hpp>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+TEST(TripleBufferTest, ConsumerSeesLatestValue) {
+    bcod::TripleBuffer<int> buffer;
+    EXPECT_FALSE(buffer.fetch());
+
+    buffer.back() = 1;
+    EXPECT_FALSE(buffer.publish());
+    buffer.back() = 2;
+    EXPECT_TRUE(buffer.publish());  // 1 was never read
+
+    ASSERT_TRUE(buffer.fetch());
+    EXPECT_EQ(buffer.front(), 2);
+    EXPECT_FALSE(buffer.fetch());
+}
+
+TEST(TripleBufferTest, ConcurrentValuesAreMonotonic) {
+    bcod::TripleBuffer<std::pair<int, int>> buffer;
+    constexpr int N = 100000;
+
+    std::thread producer([&] {
+        for (int i = 1; i <= N; ++i) {
+            buffer.back() = {i, -i};
+            buffer.publish();
+        }
+    });
+
+    int last = 0;
+    while (last < N) {
+        if (!buffer.fetch()) continue;
+        const auto& v = buffer.front();
+        ASSERT_GT(v.first, last);
+        ASSERT_EQ(v.second, -v.first);  // Never a torn value
+        last = v.first;
+    }
+    producer.join();
+}
+
+class PipelineTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        bcod::BeliefRasteriser::Params raster{};
+        raster.raster_H = 64;   // The planner and scheduler inputs are 64x64
+        raster.raster_W = 64;
+        raster.raster_C = 5;
+        raster.min_window = 2.0;
+        raster.max_window = 50.0;
+        raster.sigma_scale = 6.0;
+        rasteriser = std::make_unique<bcod::BeliefRasteriser>(raster);
+
+        bcod::StudentParams student{};
+        student.input_channels = 9;
+        student.hidden_dim = 32;
+        student.num_layers = 2;
+        student.num_heads = 4;
+        student.trajectory_horizon = 8;
+        student.cvar_percentile = 0.95;
+        student.risk_threshold = 0.1;
+        student.waypoint_interval = 0.5;
+        planner = std::make_unique<bcod::StudentPlanner>(student);
+
+        bcod::SchedulerParams sched{};
+        sched.belief_dim = 32;
+        sched.hidden_dim = 32;
+        sched.num_layers = 2;
+        sched.temperature = 0.2;
+        sched.batch_size = 8;
+        sched.buffer_size = 8;
+        sched.risk_threshold = 0.2;
+        sched.lambda_init = 0.5;
+        sched.lambda_max = 10.0;
+        sched.energy_weight = 0.3;
+        sched.safety_weight = 0.7;
+        sched.power_budget = 1e9;
+        sched.power_coefficients.assign(bcod::SensorConfig::POWER_CONSUMPTION.begin(),
+                                        bcod::SensorConfig::POWER_CONSUMPTION.end());
+        sched.device = "cpu";
+        sched.num_threads = 1;
+        scheduler = std::make_unique<bcod::SACScheduler>(sched);
+
+        params.max_latency = 10.0;
+        params.idle_sleep_us = 50;
+        params.waypoint_interval = 0.25;
+    }
+
+    std::unique_ptr<bcod::BcodPipeline> make_pipeline() {
+        return std::make_unique<bcod::BcodPipeline>(*rasteriser, *planner, *scheduler, params,
+                                                    [this](const bcod::PipelineFrame& frame) {
+            std::lock_guard<std::mutex> lock(mutex);
+            results.push_back(frame);
+        });
+    }
+
+    static bcod::PipelineFrame frame(float offset) {
+        bcod::PipelineFrame f;
+        for (int i = 0; i < 64; ++i) {
+            bcod::Particle p{};
+            p.position = Eigen::Vector2d(offset + 0.05 * i, -0.05 * i);
+            p.weight = 1.0 / 64;
+            p.covariance = {0.5, 0.0, 0.0, 0.5};
+            p.confidence = 0.9;
+            f.particles.push_back(p);
+        }
+        f.planning.semantic_map = cv::Mat::zeros(64, 64, CV_32FC3);
+        f.planning.goal_mask = cv::Mat::zeros(64, 64, CV_32FC1);
+        f.planning.active_sensors.assign(bcod::kNumSensors, true);
+        f.planning.max_velocity = 2.0;
+        f.planning.goal_distance = 10.0;
+        f.scheduling.goal_distance = 10.0;
+        f.scheduling.prev_actions.assign(bcod::kNumSensors, true);
+        return f;
+    }
+
+    // Waits until `count` results arrived or the timeout passed
+    size_t wait_for(size_t count, std::chrono::milliseconds timeout = std::chrono::seconds(30)) {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (std::chrono::steady_clock::now() < deadline) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (results.size() >= count) return results.size();
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        return results.size();
+    }
+
+    std::unique_ptr<bcod::BeliefRasteriser> rasteriser;
+    std::unique_ptr<bcod::StudentPlanner> planner;
+    std::unique_ptr<bcod::SACScheduler> scheduler;
+    bcod::BcodPipeline::Params params{};
+    std::mutex mutex;
+    std::vector<bcod::PipelineFrame> results;
+};
+
+TEST_F(PipelineTest, RejectsNonPositiveWaypointInterval) {
+    params.waypoint_interval = 0.0;
+    EXPECT_THROW(make_pipeline(), std::invalid_argument);
+}
+
+TEST_F(PipelineTest, HandsPlannerForecastToScheduler) {
+    auto pipeline = make_pipeline();
+    pipeline->start();
+    pipeline->submit(frame(0.0f));
+    ASSERT_EQ(wait_for(1), 1u);
+    pipeline->stop();
+
+    const bcod::PipelineFrame& result = results.front();
+    EXPECT_DOUBLE_EQ(result.scheduling.forecast_dt, params.waypoint_interval);
+    EXPECT_EQ(result.scheduling.risk_forecast, result.trajectory.risk_scores);
+    EXPECT_FALSE(result.scheduling.risk_forecast.empty());
+    EXPECT_FLOAT_EQ(result.scheduling.cvar_risk, result.trajectory.cvar_95);
+    EXPECT_EQ(result.action.sensor_mask.size(), static_cast<size_t>(bcod::kNumSensors));
+}
+
+TEST_F(PipelineTest, KeepsLatenciesPerInstance) {
+    auto a = make_pipeline();
+    auto b = make_pipeline();
+    EXPECT_NE(&a->end_to_end_latency(), &b->end_to_end_latency());
+    for (auto stage : {bcod::BcodPipeline::RASTERISE, bcod::BcodPipeline::PLAN, bcod::BcodPipeline::SCHEDULE}) {
+        EXPECT_NE(&a->stage_latency(stage), &b->stage_latency(stage));
+    }
+
+    params.name = "pipeline.port";
+    auto named = make_pipeline();
+    EXPECT_EQ(&named->end_to_end_latency(), &bcod::Instrumentation::instance().histogram("pipeline.port.end_to_end"));
+
+    a->start();
+    a->submit(frame(0.0f));
+    ASSERT_EQ(wait_for(1), 1u);
+    a->stop();
+    EXPECT_EQ(a->end_to_end_latency().count(), 1u);
+    EXPECT_EQ(b->end_to_end_latency().count(), 0u);
+}
+
+TEST_F(PipelineTest, DeliversNewestFramesInOrder) {
+    auto pipeline = make_pipeline();
+    pipeline->start();
+    constexpr uint64_t N = 50;
+    for (uint64_t i = 0; i < N; ++i) EXPECT_EQ(pipeline->submit(frame(0.01f * i)), i);
+
+    // Latest-value mailboxes: the last frame always gets through
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    while (std::chrono::steady_clock::now() < deadline) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!results.empty() && results.back().sequence == N - 1) break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    pipeline->stop();
+
+    ASSERT_FALSE(results.empty());
+    EXPECT_EQ(results.back().sequence, N - 1);
+    for (size_t i = 1; i < results.size(); ++i) EXPECT_GT(results[i].sequence, results[i - 1].sequence);
+    for (const auto& r : results) {
+        EXPECT_GE(r.end_to_end_ns, r.stage_ns[0] + r.stage_ns[1] + r.stage_ns[2]);
+    }
+
+    // Every frame was either acted on or dropped exactly once
+    const auto stats = pipeline->stats();
+    EXPECT_EQ(stats.submitted, N);
+    EXPECT_EQ(stats.completed, results.size());
+    EXPECT_GT(stats.overwritten, 0u);
+    EXPECT_EQ(stats.completed + stats.overwritten + stats.stale, stats.submitted);
+    EXPECT_EQ(pipeline->end_to_end_latency().count(), stats.completed);
+}
+
+TEST_F(PipelineTest, DropsStaleFrames) {
+    params.max_latency = 1e-9;   // Older than this by the first stage boundary
+    auto pipeline = make_pipeline();
+    pipeline->start();
+    for (int i = 0; i < 5; ++i) {
+        pipeline->submit(frame(0.0f));
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    pipeline->stop();
+
+    EXPECT_TRUE(results.empty());
+    const auto stats = pipeline->stats();
+    EXPECT_EQ(stats.completed, 0u);
+    EXPECT_GT(stats.stale, 0u);
+    EXPECT_EQ(stats.overwritten + stats.stale, stats.submitted);
+}
+
+TEST_F(PipelineTest, StopsAndRestarts) {
+    auto pipeline = make_pipeline();
+    EXPECT_FALSE(pipeline->running());
+    pipeline->start();
+    pipeline->start();   // Already running, no second set of stage threads
+    EXPECT_TRUE(pipeline->running());
+    pipeline->submit(frame(0.0f));
+    ASSERT_EQ(wait_for(1), 1u);
+
+    const auto t0 = std::chrono::steady_clock::now();
+    pipeline->stop();
+    EXPECT_LT(std::chrono::steady_clock::now() - t0, std::chrono::seconds(1));
+    EXPECT_FALSE(pipeline->running());
+    pipeline->stop();
+
+    // Nothing runs while stopped; the frame waits in the mailbox for start()
+    pipeline->submit(frame(0.5f));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(wait_for(2, std::chrono::milliseconds(0)), 1u);
+    pipeline->start();
+    ASSERT_EQ(wait_for(2), 2u);
+    EXPECT_EQ(results.back().sequence, 1u);
+
+    // The destructor stops a running pipeline
+    pipeline.reset();
+}
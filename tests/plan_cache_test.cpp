@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+#include <bcod/plan_cache.hpp>
+#include <opencv2/core.hpp>
+
+namespace {
+    bcod::PlanningContext context(float belief_value, bool lidar = true) {
+        bcod::PlanningContext c{};
+        c.belief_image = cv::Mat(64, 64, CV_32FC5, cv::Scalar::all(belief_value));
+        c.semantic_map = cv::Mat::zeros(64, 64, CV_32FC3);
+        c.goal_mask = cv::Mat::zeros(64, 64, CV_32FC1);
+        c.active_sensors.assign(6, false);
+        c.active_sensors[0] = lidar;
+        return c;
+    }
+
+    bcod::Trajectory plan(double cvar) {
+        bcod::Trajectory t{};
+        t.cvar_95 = cvar;
+        t.waypoints.assign(4, Eigen::Vector3d::Zero());
+        return t;
+    }
+}
+
+TEST(PlanCacheTest, FingerprintToleratesSmallChangesOnly) {
+    bcod::PlanCache cache(8, 0.1);
+    const uint64_t base = cache.fingerprint(context(0.42f));
+    EXPECT_EQ(cache.fingerprint(context(0.43f)), base);
+    EXPECT_NE(cache.fingerprint(context(0.62f)), base);
+    EXPECT_NE(cache.fingerprint(context(0.42f, false)), base);
+
+    // A local change survives pooling when it moves one cell's mean enough
+    bcod::PlanningContext goal = context(0.42f);
+    goal.goal_mask(cv::Rect(0, 0, 8, 8)).setTo(1.0f);
+    EXPECT_NE(cache.fingerprint(goal), base);
+}
+
+TEST(PlanCacheTest, LookupIsLruBounded) {
+    bcod::PlanCache cache(2, 0.1);
+    bcod::Trajectory out;
+    EXPECT_FALSE(cache.lookup(1, out));
+
+    cache.insert(1, plan(1.0));
+    cache.insert(2, plan(2.0));
+    ASSERT_TRUE(cache.lookup(1, out));   // 1 becomes most recent
+    EXPECT_EQ(out.cvar_95, 1.0);
+
+    cache.insert(3, plan(3.0));          // Evicts 2
+    EXPECT_FALSE(cache.lookup(2, out));
+    EXPECT_TRUE(cache.lookup(1, out));
+    EXPECT_TRUE(cache.lookup(3, out));
+
+    const auto stats = cache.stats();
+    EXPECT_EQ(stats.hits, 3u);
+    EXPECT_EQ(stats.misses, 2u);
+    EXPECT_EQ(stats.size, 2u);
+
+    EXPECT_THROW(bcod::PlanCache(0, 0.1), std::invalid_argument);
+}
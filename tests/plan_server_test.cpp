@@ -0,0 +1,274 @@
+#include <gtest/gtest.h>
+#include <bcod/plan_server.hpp>
+#include <bcod/sensor_defs.hpp>
+#include <cstdio>
+#include <thread>
+
+class PlanServerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        raster = bcod::BeliefRasteriser::Params{};
+        raster.raster_H = 64;   // The planner and scheduler inputs are 64x64
+        raster.raster_W = 64;
+        raster.raster_C = 5;
+        raster.min_window = 2.0;
+        raster.max_window = 50.0;
+        raster.sigma_scale = 6.0;
+        rasteriser = std::make_unique<bcod::BeliefRasteriser>(raster);
+
+        student = bcod::StudentParams{};
+        student.input_channels = 9;
+        student.hidden_dim = 32;
+        student.num_layers = 2;
+        student.num_heads = 4;
+        student.trajectory_horizon = 8;
+        student.cvar_percentile = 0.95;
+        student.risk_threshold = 0.1;
+        student.waypoint_interval = 0.5;
+        planner = make_planner();
+
+        sched = bcod::SchedulerParams{};
+        sched.belief_dim = 32;
+        sched.hidden_dim = 32;
+        sched.num_layers = 2;
+        sched.temperature = 0.2;
+        sched.batch_size = 8;
+        sched.buffer_size = 8;
+        sched.risk_threshold = 0.2;
+        sched.lambda_init = 0.5;
+        sched.lambda_max = 10.0;
+        sched.energy_weight = 0.3;
+        sched.safety_weight = 0.7;
+        sched.power_budget = 1e9;
+        sched.power_coefficients.assign(bcod::SensorConfig::POWER_CONSUMPTION.begin(),
+                                        bcod::SensorConfig::POWER_CONSUMPTION.end());
+        sched.device = "cpu";
+        sched.num_threads = 1;
+        scheduler = make_scheduler();
+
+        params.socket_path = ::testing::TempDir() + "bcod_plan_server_test.sock";
+        params.batch_window_us = 2000;
+        params.max_batch = 8;
+        params.max_particles = 256;
+        params.max_velocity = 2.0;
+        params.max_angular_velocity = 1.0;
+        params.waypoint_interval = 0.5;
+    }
+
+    void TearDown() override {
+        std::remove(params.socket_path.c_str());
+    }
+
+    // Built from the same seed, so every instance starts from the same weights
+    std::unique_ptr<bcod::StudentPlanner> make_planner() const {
+        torch::manual_seed(0);
+        return std::make_unique<bcod::StudentPlanner>(student);
+    }
+
+    std::unique_ptr<bcod::SACScheduler> make_scheduler() const {
+        torch::manual_seed(0);
+        auto s = std::make_unique<bcod::SACScheduler>(sched);
+        s->set_seed(7);
+        return s;
+    }
+
+    static bcod::ServerRequest request(bcod::RequestKind kind, uint64_t id) {
+        bcod::ServerRequest r{};
+        r.kind = kind;
+        r.id = id;
+        r.prev_mask = 0b000111;
+        r.cvar_risk = 0.1f;
+        r.frame.timestamp_ns = 1000 * static_cast<int64_t>(id);
+        r.frame.sensor_mask = 0b000111;
+        r.frame.goal[0] = 10.0f;
+        r.frame.goal[1] = 5.0f;
+        r.frame.goal_distance = 11.2f;
+        return r;
+    }
+
+    static std::vector<bcod::LoggedParticle> particles(int n) {
+        std::vector<bcod::LoggedParticle> logged(n);
+        for (int i = 0; i < n; ++i) logged[i] = {0.1f * i, -0.1f * i, 0.0f, 1.0f / n, {0.5f, 0.0f, 0.5f}, 0.9f};
+        return logged;
+    }
+
+    // Uniform mass with the given covariance logdet and circular variance in
+    // every cell; `shift` varies the mean channels between contexts.
+    static cv::Mat belief(float logdet, float circ_var, float shift) {
+        cv::Mat image(64, 64, CV_32FC5);
+        for (int y = 0; y < 64; ++y) {
+            float* row = image.ptr<float>(y);
+            for (int x = 0; x < 64; ++x) {
+                float* cell = row + x * 5;
+                cell[0] = 1.0f / (64 * 64);
+                cell[1] = shift + 0.01f * x;
+                cell[2] = shift - 0.01f * y;
+                cell[3] = logdet;
+                cell[4] = circ_var;
+            }
+        }
+        return image;
+    }
+
+    static bcod::PlanningContext context(const cv::Mat& belief_image, double goal_distance, uint32_t mask) {
+        bcod::PlanningContext c{};
+        c.belief_image = belief_image;
+        c.semantic_map = cv::Mat::zeros(64, 64, CV_32FC3);
+        c.goal_mask = cv::Mat::zeros(64, 64, CV_32FC1);
+        c.active_sensors.resize(bcod::kNumSensors);
+        for (int i = 0; i < bcod::kNumSensors; ++i) c.active_sensors[i] = (mask >> i) & 1u;
+        c.max_velocity = 2.0;
+        c.goal_distance = goal_distance;
+        return c;
+    }
+
+    static void expect_same_plan(const bcod::Trajectory& a, const bcod::Trajectory& b, size_t row) {
+        ASSERT_EQ(a.waypoints.size(), b.waypoints.size()) << "row " << row;
+        for (size_t w = 0; w < a.waypoints.size(); ++w) {
+            EXPECT_NEAR((a.waypoints[w] - b.waypoints[w]).norm(), 0.0, 1e-4) << "row " << row << " waypoint " << w;
+            EXPECT_NEAR(a.risk_scores[w], b.risk_scores[w], 1e-4) << "row " << row << " waypoint " << w;
+        }
+        EXPECT_NEAR(a.cvar_95, b.cvar_95, 1e-4) << "row " << row;
+    }
+
+    bcod::BeliefRasteriser::Params raster;
+    bcod::StudentParams student;
+    bcod::SchedulerParams sched;
+    std::unique_ptr<bcod::BeliefRasteriser> rasteriser;
+    std::unique_ptr<bcod::StudentPlanner> planner;
+    std::unique_ptr<bcod::SACScheduler> scheduler;
+    bcod::PlanServer::Params params{};
+};
+
+TEST_F(PlanServerTest, PlanBatchMatchesPlan) {
+    student.use_adaptive_horizon = true;
+    student.min_horizon = 2;
+    student.max_horizon = 8;
+    student.skip_unimodal_attention = true;
+    student.unimodal_circ_var = 0.1;
+    student.unimodal_logdet = 0.0;
+    student.plan_cache_size = 16;
+    student.plan_cache_tolerance = 1e-3;
+    auto single = make_planner();
+    auto batched = make_planner();
+
+    // Unimodal rows skip attention, multimodal ones attend; goal distances
+    // give different horizons
+    const cv::Mat concentrated = belief(-2.0f, 0.01f, 0.0f), spread = belief(1.0f, 0.5f, 0.3f);
+    const std::vector<bcod::PlanningContext> first = {
+        context(concentrated, 3.0, 0b000011), context(spread, 20.0, 0b111111),
+        context(belief(-1.0f, 0.05f, 0.6f), 5.0, 0b001001), context(spread, 20.0, 0b111111)};
+    const auto batch = batched->plan_batch(first);
+    ASSERT_EQ(batch.size(), first.size());
+    for (size_t i = 0; i < first.size(); ++i) expect_same_plan(batch[i], single->plan(first[i]), i);
+    EXPECT_EQ(batch[0].waypoints.size(), 3u);
+    EXPECT_EQ(batch[1].waypoints.size(), 8u);
+
+    // Rows 0 and 2 are cache hits now, row 1 a fresh miss
+    const std::vector<bcod::PlanningContext> second = {
+        context(concentrated, 3.0, 0b000011), context(belief(1.5f, 0.7f, 0.9f), 6.0, 0b110000),
+        context(spread, 20.0, 0b111111)};
+    const auto again = batched->plan_batch(second);
+    for (size_t i = 0; i < second.size(); ++i) expect_same_plan(again[i], single->plan(second[i]), i);
+}
+
+TEST_F(PlanServerTest, ScheduleBatchMatchesSchedule) {
+    auto single = make_scheduler();
+    auto batched = make_scheduler();
+
+    std::vector<bcod::SchedulerState> states(4);
+    for (size_t i = 0; i < states.size(); ++i) {
+        states[i].belief_raster = belief(0.2f * i, 0.1f * i, 0.1f * i);
+        states[i].cvar_risk = 0.05 * (i + 1);
+        states[i].goal_distance = 10.0 * (i + 1);
+        states[i].prev_actions.assign(bcod::kNumSensors, i % 2 == 0);
+        states[i].timestamp = 1000 * static_cast<int64_t>(i);
+    }
+
+    const auto batch = batched->schedule_batch(states);
+    ASSERT_EQ(batch.size(), states.size());
+    for (size_t i = 0; i < states.size(); ++i) {
+        const auto action = single->schedule(states[i]);
+        EXPECT_EQ(bcod::to_bitmask(batch[i].sensor_mask), bcod::to_bitmask(action.sensor_mask)) << "row " << i;
+        ASSERT_EQ(batch[i].probabilities.size(), action.probabilities.size());
+        for (size_t s = 0; s < action.probabilities.size(); ++s) {
+            EXPECT_NEAR(batch[i].probabilities[s], action.probabilities[s], 1e-4) << "row " << i << " sensor " << s;
+        }
+        EXPECT_NEAR(batch[i].total_power, action.total_power, 1e-9) << "row " << i;
+    }
+}
+
+TEST_F(PlanServerTest, AnswersEachKindOfRequest) {
+    bcod::PlanServer server(*rasteriser, *planner, *scheduler, params);
+    server.start();
+    ASSERT_TRUE(server.running());
+
+    bcod::PlanClient client(params.socket_path);
+    std::vector<bcod::ServerWaypoint> waypoints;
+    auto reply = client.call(request(bcod::RequestKind::PLAN, 1), particles(16), &waypoints);
+    EXPECT_EQ(reply.magic, bcod::ServerRequest::MAGIC);
+    EXPECT_EQ(reply.status, bcod::ServerReply::OK);
+    EXPECT_EQ(reply.id, 1u);
+    EXPECT_EQ(reply.num_waypoints, waypoints.size());
+    EXPECT_GT(reply.num_waypoints, 0u);
+
+    reply = client.call(request(bcod::RequestKind::SCHEDULE, 2), particles(16));
+    EXPECT_EQ(reply.status, bcod::ServerReply::OK);
+    EXPECT_EQ(reply.num_waypoints, 0u);
+    EXPECT_LT(reply.sensor_mask, 1u << bcod::kNumSensors);
+
+    reply = client.call(request(bcod::RequestKind::STEP, 3), particles(16), &waypoints);
+    EXPECT_EQ(reply.status, bcod::ServerReply::OK);
+    EXPECT_GT(reply.num_waypoints, 0u);
+    EXPECT_GT(reply.total_power, 0.0f);
+
+    server.stop();
+    EXPECT_FALSE(server.running());
+    EXPECT_EQ(server.stats().requests, 3u);
+}
+
+TEST_F(PlanServerTest, BatchesPipelinedRequests) {
+    params.batch_window_us = 200000;
+    bcod::PlanServer server(*rasteriser, *planner, *scheduler, params);
+    server.start();
+
+    bcod::PlanClient client(params.socket_path);
+    constexpr int kRequests = 4;
+    for (int i = 0; i < kRequests; ++i) client.send(request(bcod::RequestKind::STEP, 10 + i), particles(8));
+    for (int i = 0; i < kRequests; ++i) {
+        std::vector<bcod::ServerWaypoint> waypoints;
+        const auto reply = client.receive(&waypoints);
+        EXPECT_EQ(reply.status, bcod::ServerReply::OK);
+        EXPECT_EQ(reply.id, static_cast<uint64_t>(10 + i));
+        EXPECT_EQ(reply.batch_size, static_cast<uint32_t>(kRequests));
+        EXPECT_GE(reply.queue_ns, 0);
+        EXPECT_GT(reply.compute_ns, 0);
+    }
+    EXPECT_EQ(server.stats().batches, 1u);
+}
+
+TEST_F(PlanServerTest, RejectsInvalidRequests) {
+    bcod::PlanServer server(*rasteriser, *planner, *scheduler, params);
+    server.start();
+
+    bcod::PlanClient client(params.socket_path);
+    // An empty frame or an unknown kind is answered and the connection stays up
+    auto reply = client.call(request(bcod::RequestKind::PLAN, 1), {});
+    EXPECT_EQ(reply.status, bcod::ServerReply::REJECTED);
+    reply = client.call(request(static_cast<bcod::RequestKind>(7), 2), particles(4));
+    EXPECT_EQ(reply.status, bcod::ServerReply::REJECTED);
+    reply = client.call(request(bcod::RequestKind::PLAN, 3), particles(4));
+    EXPECT_EQ(reply.status, bcod::ServerReply::OK);
+
+    // Too many particles ends the connection; the server may hang up before
+    // the client has written them all.
+    try {
+        reply = client.call(request(bcod::RequestKind::PLAN, 4), particles(params.max_particles + 1));
+        EXPECT_EQ(reply.status, bcod::ServerReply::REJECTED);
+    } catch (const std::runtime_error&) {
+    }
+    EXPECT_THROW(client.call(request(bcod::RequestKind::PLAN, 5), particles(4)), std::runtime_error);
+
+    EXPECT_EQ(server.stats().rejected, 3u);
+    EXPECT_EQ(server.stats().requests, 1u);
+}
@@ -0,0 +1,222 @@
+#include <gtest/gtest.h>
+#include <bcod/policy_runtime.hpp>
+#include <bcod/sac_scheduler.hpp>
+#include <bcod/sensor_defs.hpp>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <random>
+
+class PolicyRuntimeTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::mt19937 rng(3);
+        std::normal_distribution<float> n(0.0f, 0.1f);
+        auto layer = [&](int rows, int cols) {
+            bcod::PackedPolicy::Layer l{rows, cols, std::vector<float>(rows * cols), std::vector<float>(rows)};
+            for (auto& v : l.weight) v = n(rng);
+            for (auto& v : l.bias) v = n(rng);
+            return l;
+        };
+        auto norm = [&](int k) {
+            bcod::PackedPolicy::Norm x{std::vector<float>(k), std::vector<float>(k)};
+            for (auto& v : x.gamma) v = 1.0f + n(rng);
+            for (auto& v : x.beta) v = n(rng);
+            return x;
+        };
+
+        const int H = 16;
+        policy.in_channels = 5;
+        policy.height = 64;
+        policy.width = 64;
+        policy.hidden_dim = H;
+        policy.num_sensors = 6;
+        policy.context_dim = 3;
+        policy.conv1 = layer(64, 5 * 9);
+        policy.conv2 = layer(128, 64 * 9);
+        policy.conv3 = layer(H, 128 * 9);
+        policy.enc_fc1 = layer(H, H * 16 * 16);
+        policy.enc_ln1 = norm(H);
+        policy.enc_fc2 = layer(H, H);
+        policy.enc_ln2 = norm(H);
+        policy.head_fc1 = layer(H, H + 3);
+        policy.head_ln1 = norm(H);
+        policy.head_fc2 = layer(H, H);
+        policy.head_ln2 = norm(H);
+        policy.head_fc3 = layer(6, H);
+        policy.head_ln3 = norm(6);
+
+        belief.resize(5 * 64 * 64);
+        std::uniform_real_distribution<float> u(0.0f, 1.0f);
+        for (auto& v : belief) v = u(rng);
+    }
+
+    void TearDown() override {
+        std::remove("policy_fp32.bin");
+        std::remove("policy_int8.bin");
+        std::remove("policy_actor.bin");
+    }
+
+    bcod::PackedPolicy policy;
+    std::vector<float> belief;
+};
+
+TEST_F(PolicyRuntimeTest, LoadsPackedPolicy) {
+    policy.save("policy_fp32.bin", bcod::PolicyRuntime::Precision::FP32);
+    bcod::PolicyRuntime runtime("policy_fp32.bin");
+    EXPECT_EQ(runtime.in_channels(), 5);
+    EXPECT_EQ(runtime.height(), 64);
+    EXPECT_EQ(runtime.width(), 64);
+    EXPECT_EQ(runtime.num_sensors(), 6);
+    EXPECT_EQ(runtime.hidden_dim(), 16);
+    EXPECT_EQ(runtime.precision(), bcod::PolicyRuntime::Precision::FP32);
+}
+
+TEST_F(PolicyRuntimeTest, Int8TracksFp32) {
+    policy.save("policy_fp32.bin", bcod::PolicyRuntime::Precision::FP32);
+    policy.save("policy_int8.bin", bcod::PolicyRuntime::Precision::INT8);
+    bcod::PolicyRuntime fp32("policy_fp32.bin"), int8("policy_int8.bin");
+
+    const float context[3] = {0.1f, 5.0f, 1.0f};
+    float a[6], b[6];
+    fp32.forward(belief.data(), context, a);
+    int8.forward(belief.data(), context, b);
+    for (int i = 0; i < 6; ++i) {
+        EXPECT_GT(a[i], 0.0f);
+        EXPECT_LT(a[i], 1.0f);
+        EXPECT_NEAR(a[i], b[i], 0.02f);
+    }
+}
+
+TEST_F(PolicyRuntimeTest, ForwardIsDeterministic) {
+    policy.save("policy_fp32.bin", bcod::PolicyRuntime::Precision::FP32);
+    bcod::PolicyRuntime runtime("policy_fp32.bin");
+    const float context[3] = {0.3f, 2.0f, 0.0f};
+    float a[6], b[6];
+    runtime.forward(belief.data(), context, a);
+    runtime.forward(belief.data(), context, b);
+    for (int i = 0; i < 6; ++i) EXPECT_EQ(a[i], b[i]);
+}
+
+TEST_F(PolicyRuntimeTest, RejectsShapeMismatch) {
+    policy.conv2 = bcod::PackedPolicy::Layer{64, 64 * 9, std::vector<float>(64 * 64 * 9), std::vector<float>(64)};
+    policy.save("policy_fp32.bin", bcod::PolicyRuntime::Precision::FP32);
+    EXPECT_THROW(bcod::PolicyRuntime("policy_fp32.bin"), std::runtime_error);
+}
+
+TEST_F(PolicyRuntimeTest, RejectsUnknownPrecision) {
+    policy.save("policy_fp32.bin", bcod::PolicyRuntime::Precision::FP32);
+    {
+        std::fstream file("policy_fp32.bin", std::ios::in | std::ios::out | std::ios::binary);
+        const uint32_t precision = 7;
+        file.seekp(12);   // magic, version
+        file.write(reinterpret_cast<const char*>(&precision), sizeof(precision));
+    }
+    EXPECT_THROW(bcod::PolicyRuntime("policy_fp32.bin"), std::runtime_error);
+}
+
+namespace {
+    bcod::SchedulerParams actor_params() {
+        bcod::SchedulerParams p{};
+        p.belief_dim = 32;
+        p.hidden_dim = 32;
+        p.num_layers = 2;
+        p.learning_rate = 1e-3;
+        p.temperature = 0.2;
+        p.tau = 0.005;
+        p.discount_factor = 0.99;
+        p.batch_size = 4;
+        p.buffer_size = 64;
+        p.target_update_interval = 1;
+        p.risk_threshold = 0.2;
+        p.lambda_init = 0.5;
+        p.lambda_max = 10.0;
+        p.energy_weight = 0.3;
+        p.safety_weight = 0.7;
+        p.power_coefficients.assign(bcod::SensorConfig::POWER_CONSUMPTION.begin(),
+                                    bcod::SensorConfig::POWER_CONSUMPTION.end());
+        p.device = "cpu";
+        p.num_threads = 1;
+        return p;
+    }
+
+    bcod::SchedulerState actor_state(std::mt19937& rng) {
+        std::uniform_real_distribution<float> u(0.0f, 1.0f);
+        bcod::SchedulerState s{};
+        s.belief_raster = cv::Mat(64, 64, CV_32FC(5));
+        for (auto it = s.belief_raster.begin<float>(); it != s.belief_raster.end<float>(); ++it) *it = u(rng);
+        s.cvar_risk = u(rng);
+        s.goal_distance = 20.0f * u(rng);
+        for (int i = 0; i < bcod::kNumSensors; ++i) s.prev_actions.push_back(u(rng) > 0.5f);
+        return s;
+    }
+}
+
+TEST_F(PolicyRuntimeTest, MatchesLibtorchActor) {
+    // With share_encoder the packed encoder is the critics' trunk
+    for (bool shared : {false, true}) {
+        SCOPED_TRACE(shared ? "shared trunk" : "own encoder");
+        auto params = actor_params();
+        params.share_encoder = shared;
+        torch::manual_seed(0);
+        bcod::SACScheduler trained(params);
+        trained.set_seed(1);
+
+        // A few updates, so BatchNorm statistics are not the identity when folded
+        std::mt19937 rng(5);
+        for (int t = 0; t < 12; ++t) {
+            const auto state = actor_state(rng), next = actor_state(rng);
+            const auto action = trained.schedule(state);
+            trained.update(state, action, 0.1 * t, next);
+        }
+        trained.export_policy("policy_actor.bin", false);
+
+        params.inference_only = true;
+        params.policy_path = "policy_actor.bin";
+        bcod::SACScheduler packed(params);
+
+        for (int k = 0; k < 4; ++k) {
+            const auto state = actor_state(rng);
+            const auto expected = trained.schedule_mean(state);
+            const auto actual = packed.schedule(state);
+            ASSERT_EQ(actual.probabilities.size(), expected.probabilities.size());
+            for (size_t i = 0; i < expected.probabilities.size(); ++i) {
+                EXPECT_NEAR(actual.probabilities[i], expected.probabilities[i], 1e-4) << "state " << k << " sensor " << i;
+            }
+            EXPECT_EQ(actual.sensor_mask, expected.sensor_mask);
+        }
+    }
+}
+
+TEST_F(PolicyRuntimeTest, RejectsPolicyForOtherSensors) {
+    torch::manual_seed(0);
+    bcod::SACScheduler trained(actor_params());
+    trained.export_policy("policy_actor.bin", false);
+
+    auto params = actor_params();
+    params.inference_only = true;
+    params.policy_path = "policy_actor.bin";
+    params.power_coefficients.pop_back();
+    EXPECT_THROW(bcod::SACScheduler packed(params), std::runtime_error);
+
+    params.power_coefficients = actor_params().power_coefficients;
+    bcod::SACScheduler packed(params);
+    auto fewer = params;
+    fewer.power_coefficients.pop_back();
+    EXPECT_THROW(packed.set_params(fewer), std::invalid_argument);
+}
+
+TEST_F(PolicyRuntimeTest, RejectsPolicyForOtherBeliefShape) {
+    // A valid packed policy over four belief channels: the runtime loads it,
+    // but the scheduler packs five and must not hand it a buffer it overreads
+    policy.in_channels = 4;
+    policy.conv1.cols = 4 * 9;
+    policy.conv1.weight.resize(64 * 4 * 9);
+    policy.save("policy_fp32.bin", bcod::PolicyRuntime::Precision::FP32);
+    EXPECT_EQ(bcod::PolicyRuntime("policy_fp32.bin").in_channels(), 4);
+
+    auto params = actor_params();
+    params.inference_only = true;
+    params.policy_path = "policy_fp32.bin";
+    EXPECT_THROW(bcod::SACScheduler packed(params), std::runtime_error);
+}
@@ -0,0 +1,188 @@
+#include <gtest/gtest.h>
+#include <bcod/power_log.hpp>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+
+namespace fs = std::filesystem;
+
+namespace {
+    constexpr int64_t kSecond = 1000000000;
+
+    bcod::ChunkSummary scan(const std::string& text) {
+        bcod::ChunkSummary summary;
+        bcod::scan_power_chunk(text.data(), text.data() + text.size(), summary);
+        return summary;
+    }
+
+    std::string event(int second, int sensor, bool on) {
+        std::ostringstream line;
+        line << "2024-06-01T12:" << (second / 60 < 10 ? "0" : "") << second / 60 << ':'
+             << (second % 60 < 10 ? "0" : "") << second % 60 << ' ' << sensor << (on ? " ON\n" : " OFF\n");
+        return line.str();
+    }
+}
+
+TEST(PowerLogTest, ParsesTimestamps) {
+    auto parse = [](const std::string& text, int64_t& ns) {
+        const char* p = text.data();
+        return bcod::parse_timestamp(p, text.data() + text.size(), ns);
+    };
+    int64_t ns = 0;
+    ASSERT_TRUE(parse("1970-01-01T00:00:01.5", ns));
+    EXPECT_EQ(ns, kSecond + kSecond / 2);
+    ASSERT_TRUE(parse("1970-01-02 00:00:00", ns));
+    EXPECT_EQ(ns, 86400 * kSecond);
+
+    // Digits beyond nanoseconds are consumed and dropped
+    const std::string precise = "1970-01-01T00:00:00.1234567891 3 ON";
+    const char* p = precise.data();
+    ASSERT_TRUE(bcod::parse_timestamp(p, precise.data() + precise.size(), ns));
+    EXPECT_EQ(ns, 123456789);
+    EXPECT_EQ(std::strcmp(p, " 3 ON"), 0);
+
+    // 2024 is a leap year
+    int64_t feb28 = 0, mar1 = 0;
+    ASSERT_TRUE(parse("2024-02-28T00:00:00", feb28));
+    ASSERT_TRUE(parse("2024-03-01T00:00:00", mar1));
+    EXPECT_EQ(mar1 - feb28, 2 * 86400 * kSecond);
+
+    EXPECT_FALSE(parse("2024-13-01T00:00:00", ns));
+    EXPECT_FALSE(parse("2024-06-01T24:00:00", ns));
+    EXPECT_FALSE(parse("2024-06-01/12:00:00", ns));
+    EXPECT_FALSE(parse("2024-06-01T12:00", ns));
+}
+
+TEST(PowerLogTest, ParsesEvents) {
+    auto parse = [](const std::string& line, bcod::PowerEvent& e) {
+        return bcod::parse_power_event(line.data(), line.data() + line.size(), e);
+    };
+    bcod::PowerEvent e{};
+    ASSERT_TRUE(parse("  2024-06-01T12:00:00.25\t4 OFF\r", e));
+    EXPECT_EQ(e.sensor, 4);
+    EXPECT_FALSE(e.on);
+    ASSERT_TRUE(parse("2024-06-01T12:00:00 0 ON", e));
+    EXPECT_EQ(e.sensor, 0);
+    EXPECT_TRUE(e.on);
+
+    EXPECT_FALSE(parse("2024-06-01T12:00:00 6 ON", e));
+    EXPECT_FALSE(parse("2024-06-01T12:00:00 1 ONCE", e));
+    EXPECT_FALSE(parse("2024-06-01T12:00:00 ON", e));
+    EXPECT_FALSE(parse("", e));
+}
+
+TEST(PowerLogTest, StitchesAcrossSensorBoundaries) {
+    // Sensor 0 turns on in the first chunk and off in the second, sensor 1
+    // repeats its ON across the boundary, sensor 2 starts the second chunk
+    // with an OFF while off and sensor 3 stays on through both.
+    const bcod::ChunkSummary first = scan(event(0, 0, true) + event(1, 1, true) + event(2, 3, true));
+    const bcod::ChunkSummary second = scan(event(3, 2, false) + event(4, 1, true) + event(10, 0, false) +
+                                           event(12, 1, false) + event(13, 0, true) + event(15, 0, false));
+    EXPECT_EQ(first.events, 3u);
+    EXPECT_EQ(second.events, 6u);
+
+    std::array<bcod::SensorTotals, bcod::kNumSensors> totals{};
+    for (const auto* chunk : {&first, &second}) {
+        for (int s = 0; s < bcod::kNumSensors; ++s) totals[s].stitch(chunk->sensors[s]);
+    }
+
+    EXPECT_EQ(totals[0].on_ns, 12 * kSecond);
+    EXPECT_EQ(totals[0].activations, 2u);
+    EXPECT_FALSE(totals[0].on);
+
+    EXPECT_EQ(totals[1].on_ns, 11 * kSecond);
+    EXPECT_EQ(totals[1].activations, 1u);
+    EXPECT_EQ(totals[1].repeated_on, 1u);
+
+    EXPECT_EQ(totals[2].on_ns, 0);
+    EXPECT_EQ(totals[2].stray_off, 1u);
+
+    EXPECT_TRUE(totals[3].on);
+    EXPECT_EQ(totals[3].activations, 1u);
+    EXPECT_EQ(totals[3].on_ns, 0);
+}
+
+TEST(PowerLogTest, StitchesRepeatedOnWithinChunk) {
+    // Both ONs land before the first OFF, so only the stitch can tell the
+    // second one is a repeat
+    const bcod::ChunkSummary chunk = scan(event(0, 5, true) + event(2, 5, true) + event(7, 5, false));
+    bcod::SensorTotals off, on;
+    off.stitch(chunk.sensors[5]);
+    EXPECT_EQ(off.on_ns, 7 * kSecond);
+    EXPECT_EQ(off.activations, 1u);
+    EXPECT_EQ(off.repeated_on, 1u);
+
+    // Already on from an earlier chunk: both ONs are repeats
+    on.on = true;
+    on.on_since = -3 * kSecond;
+    on.stitch(chunk.sensors[5]);
+    EXPECT_EQ(on.repeated_on, 2u);
+    EXPECT_EQ(on.activations, 0u);
+}
+
+class PowerAnalyzerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir = fs::temp_directory_path() / "bcod_power_log_test";
+        fs::remove_all(dir);
+        fs::create_directories(dir);
+    }
+
+    void TearDown() override {
+        fs::remove_all(dir);
+    }
+
+    std::string write_log(const std::string& text) {
+        const std::string path = (dir / "power.log").string();
+        std::ofstream(path, std::ios::binary) << text;
+        return path;
+    }
+
+    fs::path dir;
+};
+
+TEST_F(PowerAnalyzerTest, ChargesSensorsStillOnUntilLastEvent) {
+    bcod::PowerAnalyzer analyzer(write_log(event(0, 0, true) + "not an event\n" + event(20, 1, true) +
+                                           event(30, 1, false)));
+    analyzer.analyze(2);
+    EXPECT_EQ(analyzer.events(), 3u);
+    EXPECT_EQ(analyzer.malformed(), 1u);
+    EXPECT_EQ(analyzer.totals()[0].on_ns, 30 * kSecond);
+    EXPECT_TRUE(analyzer.totals()[0].on);
+    EXPECT_EQ(analyzer.totals()[1].on_ns, 10 * kSecond);
+}
+
+TEST_F(PowerAnalyzerTest, ChunkSizeDoesNotChangeTotals) {
+    // Interleaved sensors with repeated ONs and stray OFFs; chunk targets
+    // that fall mid-line must still cut at line boundaries.
+    std::mt19937 rng(7);
+    std::string text;
+    for (int t = 0; t < 400; ++t) text += event(t, static_cast<int>(rng() % bcod::kNumSensors), rng() % 2);
+    const std::string path = write_log(text);
+
+    bcod::PowerAnalyzer whole(path);
+    whole.analyze(1);
+    ASSERT_EQ(whole.events(), 400u);
+    ASSERT_EQ(whole.malformed(), 0u);
+
+    for (size_t chunk : {1u, 7u, 13u, 29u, 64u, 1000u}) {
+        for (int threads : {1, 3}) {
+            bcod::PowerAnalyzer split(path, chunk);
+            split.analyze(threads);
+            EXPECT_EQ(split.events(), whole.events()) << "chunk " << chunk;
+            EXPECT_EQ(split.malformed(), 0u) << "chunk " << chunk;
+            for (int s = 0; s < bcod::kNumSensors; ++s) {
+                const auto& a = whole.totals()[s];
+                const auto& b = split.totals()[s];
+                EXPECT_EQ(b.on_ns, a.on_ns) << "sensor " << s << ", chunk " << chunk;
+                EXPECT_EQ(b.activations, a.activations) << "sensor " << s << ", chunk " << chunk;
+                EXPECT_EQ(b.repeated_on, a.repeated_on) << "sensor " << s << ", chunk " << chunk;
+                EXPECT_EQ(b.stray_off, a.stray_off) << "sensor " << s << ", chunk " << chunk;
+                EXPECT_EQ(b.on, a.on) << "sensor " << s << ", chunk " << chunk;
+            }
+        }
+    }
+}
@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+#include <bcod/replay_log.hpp>
+#include <cstdio>
+#include <fstream>
+#include <unistd.h>
+
+class ReplayLogTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path = ::testing::TempDir() + "bcod_replay_log_test.bin";
+    }
+
+    void TearDown() override {
+        std::remove(path.c_str());
+    }
+
+    static std::vector<bcod::Particle> make_particles(int n) {
+        std::vector<bcod::Particle> particles(n);
+        for (int i = 0; i < n; ++i) {
+            auto& p = particles[i];
+            p.position = Eigen::Vector2d(i, -i);
+            p.yaw = 0.1 * i;
+            p.weight = 1.0 / n;
+            p.covariance = {0.5, 0.1, 0.1, 0.25};
+            p.confidence = 0.9;
+        }
+        return particles;
+    }
+
+    std::string path;
+};
+
+TEST_F(ReplayLogTest, FramesRoundTrip) {
+    {
+        bcod::ReplayLogWriter writer(path);
+        writer.append(1000, 0b101, Eigen::Vector3d(1, 2, 0.5), Eigen::Vector2d(10, 20), 22.0, make_particles(3));
+        writer.append(2000, 0b010, Eigen::Vector3d(2, 3, 0.6), Eigen::Vector2d(10, 20), 21.0, make_particles(0));
+        writer.append(3000, 0b111, Eigen::Vector3d(3, 4, 0.7), Eigen::Vector2d(10, 20), 20.0, make_particles(5));
+    }
+
+    bcod::ReplayLog log(path);
+    ASSERT_EQ(log.size(), 3u);
+    EXPECT_EQ(log[0].header->timestamp_ns, 1000);
+    EXPECT_EQ(log[1].header->sensor_mask, 0b010u);
+    EXPECT_EQ(log[1].header->num_particles, 0u);
+    EXPECT_FLOAT_EQ(log[2].header->goal_distance, 20.0f);
+
+    std::vector<bcod::Particle> particles;
+    bcod::ReplayLog::unpack(log[2], particles);
+    ASSERT_EQ(particles.size(), 5u);
+    EXPECT_DOUBLE_EQ(particles[4].position.x(), 4.0);
+    EXPECT_DOUBLE_EQ(particles[4].position.y(), -4.0);
+    EXPECT_FLOAT_EQ(static_cast<float>(particles[4].yaw), 0.4f);
+    EXPECT_FLOAT_EQ(static_cast<float>(particles[4].covariance[2]), 0.1f);
+    EXPECT_FLOAT_EQ(static_cast<float>(particles[4].covariance[3]), 0.25f);
+    EXPECT_EQ(particles[4].timestamp, 3000);
+}
+
+TEST_F(ReplayLogTest, IgnoresTruncatedTail) {
+    {
+        bcod::ReplayLogWriter writer(path);
+        writer.append(1000, 1, Eigen::Vector3d::Zero(), Eigen::Vector2d::Zero(), 0.0, make_particles(4));
+        writer.append(2000, 1, Eigen::Vector3d::Zero(), Eigen::Vector2d::Zero(), 0.0, make_particles(4));
+    }
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    const auto size = static_cast<size_t>(in.tellg());
+    in.close();
+    ASSERT_EQ(truncate(path.c_str(), size - sizeof(bcod::LoggedParticle)), 0);
+
+    bcod::ReplayLog log(path);
+    EXPECT_EQ(log.size(), 1u);
+}
@@ -0,0 +1,197 @@
+#include <gtest/gtest.h>
+#include <bcod/risk_log.hpp>
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+    std::vector<double> samples(int n, unsigned seed) {
+        std::mt19937 rng(seed);
+        std::lognormal_distribution<double> d(-2.0, 1.5);
+        std::vector<double> x(n);
+        for (auto& v : x) v = d(rng);
+        return x;
+    }
+
+    std::vector<std::vector<std::string>> tsv_rows(const std::string& text) {
+        std::vector<std::vector<std::string>> rows;
+        std::istringstream lines(text);
+        for (std::string line; std::getline(lines, line);) {
+            std::vector<std::string> row;
+            std::istringstream fields(line);
+            for (std::string field; std::getline(fields, field, '\t');) row.push_back(field);
+            rows.push_back(row);
+        }
+        return rows;
+    }
+}
+
+TEST(RiskLogTest, MergeMatchesSequentialStats) {
+    const auto x = samples(1000, 1);
+    bcod::RunningStats whole;
+    for (double v : x) whole.add(v);
+
+    for (size_t split : {0u, 1u, 17u, 500u, 999u, 1000u}) {
+        bcod::RunningStats a, b;
+        for (size_t i = 0; i < split; ++i) a.add(x[i]);
+        for (size_t i = split; i < x.size(); ++i) b.add(x[i]);
+        a.merge(b);
+        EXPECT_EQ(a.n, whole.n) << "split " << split;
+        EXPECT_NEAR(a.mean, whole.mean, 1e-12 * std::abs(whole.mean)) << "split " << split;
+        EXPECT_NEAR(a.m2, whole.m2, 1e-9 * whole.m2) << "split " << split;
+        EXPECT_EQ(a.max, whole.max) << "split " << split;
+    }
+
+    // Against the two-pass definition
+    double mean = 0.0, m2 = 0.0;
+    for (double v : x) mean += v / x.size();
+    for (double v : x) m2 += (v - mean) * (v - mean);
+    EXPECT_NEAR(whole.mean, mean, 1e-12 * mean);
+    EXPECT_NEAR(whole.stddev(), std::sqrt(m2 / x.size()), 1e-9 * whole.stddev());
+}
+
+TEST(RiskLogTest, BinsCoverTheirRange) {
+    const bcod::LogBins bins(1e-2, 1e2, 4);
+    EXPECT_EQ(bins.size(), 6);
+    EXPECT_EQ(bins.index(0.0), bins.underflow());
+    EXPECT_EQ(bins.index(-1.0), bins.underflow());
+    EXPECT_EQ(bins.index(0.0099), bins.underflow());
+    EXPECT_EQ(bins.index(0.05), 1);
+    EXPECT_EQ(bins.index(5.0), 3);
+    EXPECT_EQ(bins.index(50.0), 4);
+    EXPECT_EQ(bins.index(150.0), bins.overflow());
+    EXPECT_NEAR(bins.edge(1), 1e-2, 1e-12);
+    EXPECT_NEAR(bins.edge(3), 1.0, 1e-12);
+    EXPECT_NEAR(bins.edge(bins.overflow()), 1e2, 1e-9);
+    EXPECT_NEAR(bins.centre(2), std::sqrt(0.1 * 1.0), 1e-12);
+}
+
+TEST(RiskLogTest, QuantilesStayWithinOneErrorBin) {
+    // Realised is zero, so the error is the predicted value itself
+    const auto x = samples(5000, 2);
+    bcod::RiskAccumulator acc(bcod::LogBins(1e-4, 10.0, 50));
+    for (double v : x) acc.add(v, 0.0);
+
+    auto sorted = x;
+    std::sort(sorted.begin(), sorted.end());
+    // 100 bins per decade: the bin centre is within half a bin of any value in it
+    const double tolerance = std::pow(10.0, 0.5 / 100.0) - 1.0;
+    for (double q : {0.01, 0.25, 0.5, 0.9, 0.95, 0.99}) {
+        const double exact = sorted[static_cast<size_t>(std::ceil(q * x.size())) - 1];
+        EXPECT_NEAR(acc.error_quantile(q), exact, tolerance * exact * 1.0001) << "q " << q;
+    }
+    EXPECT_LE(acc.error_quantile(1.0), sorted.back());
+
+    // Merging partial accumulators reproduces the histogram exactly
+    bcod::RiskAccumulator a(acc.risk), b(acc.risk);
+    for (size_t i = 0; i < x.size(); ++i) (i % 3 ? a : b).add(x[i], 0.0);
+    a.merge(b);
+    EXPECT_EQ(a.error_bins, acc.error_bins);
+    for (double q : {0.5, 0.99}) EXPECT_EQ(a.error_quantile(q), acc.error_quantile(q));
+}
+
+TEST(RiskLogTest, ParsesLines) {
+    auto parse = [](const std::string& line, double& predicted, double& realised) {
+        return bcod::parse_risk_line(line.data(), line.data() + line.size(), predicted, realised);
+    };
+    double predicted = 0.0, realised = 0.0;
+    ASSERT_TRUE(parse(" 0.25\t1e-3\r", predicted, realised));
+    EXPECT_EQ(predicted, 0.25);
+    EXPECT_EQ(realised, 1e-3);
+
+    EXPECT_FALSE(parse("0.25", predicted, realised));
+    EXPECT_FALSE(parse("0.25 0.5 0.75", predicted, realised));
+    EXPECT_FALSE(parse("0.25 x", predicted, realised));
+    EXPECT_FALSE(parse("inf 0.5", predicted, realised));
+    EXPECT_FALSE(parse("0.25 nan", predicted, realised));
+}
+
+class RiskAnalyzerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir = fs::temp_directory_path() / "bcod_risk_log_test";
+        fs::remove_all(dir);
+        fs::create_directories(dir);
+    }
+
+    void TearDown() override {
+        fs::remove_all(dir);
+    }
+
+    std::string write_log(const std::string& text) {
+        const std::string path = (dir / "risk.log").string();
+        std::ofstream(path, std::ios::binary) << text;
+        return path;
+    }
+
+    fs::path dir;
+};
+
+TEST_F(RiskAnalyzerTest, WritesCalibrationCurve) {
+    // Bins of one decade: [0.01, 0.1), [0.1, 1), [1, 10)
+    const std::string path = write_log("0.05 0.15\n0.02 0.02\nbad line\n0.5 0.25\n0.001 0\n20 5\n");
+    bcod::RiskAnalyzer analyzer(path, 0.01, 10.0, 3);
+    analyzer.analyze(2);
+    EXPECT_EQ(analyzer.totals().error.n, 5u);
+    EXPECT_EQ(analyzer.totals().malformed, 1u);
+
+    std::ostringstream out;
+    analyzer.totals().write_calibration(out);
+    const auto rows = tsv_rows(out.str());
+    ASSERT_EQ(rows.size(), 5u);   // Header, underflow, two filled bins, overflow
+    EXPECT_EQ(rows[0][0], "bin_lo");
+
+    EXPECT_EQ(rows[1][0], "-inf");
+    EXPECT_EQ(rows[1][2], "1");
+
+    EXPECT_NEAR(std::stod(rows[2][0]), 0.01, 1e-9);
+    EXPECT_NEAR(std::stod(rows[2][1]), 0.1, 1e-9);
+    EXPECT_EQ(rows[2][2], "2");
+    EXPECT_NEAR(std::stod(rows[2][3]), 0.035, 1e-9);
+    EXPECT_NEAR(std::stod(rows[2][4]), 0.085, 1e-9);
+    EXPECT_NEAR(std::stod(rows[2][5]), 0.05, 1e-9);
+
+    EXPECT_EQ(rows[3][2], "1");
+    EXPECT_NEAR(std::stod(rows[3][5]), 0.25, 1e-9);
+
+    EXPECT_EQ(rows[4][1], "inf");
+    EXPECT_NEAR(std::stod(rows[4][4]), 5.0, 1e-9);
+}
+
+TEST_F(RiskAnalyzerTest, ChunkSizeDoesNotChangeTotals) {
+    std::mt19937 rng(4);
+    std::uniform_real_distribution<double> u(0.0, 2.0);
+    std::ostringstream text;
+    for (int i = 0; i < 300; ++i) text << u(rng) << ' ' << u(rng) << '\n';
+    const std::string path = write_log(text.str());
+
+    bcod::RiskAnalyzer whole(path, 1e-3, 10.0, 20);
+    whole.analyze(1);
+    ASSERT_EQ(whole.totals().error.n, 300u);
+
+    for (size_t chunk : {1u, 13u, 100u, 4096u}) {
+        bcod::RiskAnalyzer split(path, 1e-3, 10.0, 20, chunk);
+        split.analyze(3);
+        const auto& a = whole.totals();
+        const auto& b = split.totals();
+        EXPECT_EQ(b.error.n, a.error.n) << "chunk " << chunk;
+        EXPECT_NEAR(b.error.mean, a.error.mean, 1e-12) << "chunk " << chunk;
+        EXPECT_NEAR(b.error.m2, a.error.m2, 1e-9) << "chunk " << chunk;
+        EXPECT_EQ(b.error_bins, a.error_bins) << "chunk " << chunk;
+        for (size_t i = 0; i < a.risk_bins.size(); ++i) {
+            EXPECT_EQ(b.risk_bins[i].count, a.risk_bins[i].count) << "bin " << i << ", chunk " << chunk;
+        }
+    }
+}
+
+TEST_F(RiskAnalyzerTest, RejectsLogWithoutSamples) {
+    bcod::RiskAnalyzer analyzer(write_log("nothing here\n\n"), 0.01, 10.0, 3);
+    EXPECT_THROW(analyzer.analyze(1), std::runtime_error);
+}
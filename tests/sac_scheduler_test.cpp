@@ -1,6 +1,14 @@
 #include <gtest/gtest.h>
 #include <bcod/sac_scheduler.hpp>
+#include <bcod/sensor_defs.hpp>
 #include <opencv2/opencv.hpp>
+#include <torch/torch.h>
+#include <cmath>
+#include <filesystem>
+#include <memory>
+#include <random>
+
+namespace fs = std::filesystem;
 
 class SACSchedulerTest : public ::testing::Test {
 protected:
@@ -71,4 +79,241 @@ TEST_F(SACSchedulerTest, DeviceManagement) {
     // Test device management
     EXPECT_NO_THROW(scheduler->set_device("cuda:0"));
     EXPECT_NO_THROW(scheduler->set_batch_size(32));
-} 
\ No newline at end of file
+} 
+
+class MaskSearchTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        params = bcod::SchedulerParams{};
+        params.belief_dim = 32;
+        params.hidden_dim = 32;
+        params.num_layers = 2;
+        params.temperature = 0.2;
+        params.batch_size = 8;
+        params.buffer_size = 8;
+        params.risk_threshold = 0.2;
+        params.lambda_init = 0.5;
+        params.lambda_max = 10.0;
+        params.energy_weight = 1000.0;   // Power dominates the untrained critics' Q
+        params.safety_weight = 1.0;
+        params.use_mask_search = true;
+        params.power_budget = 1e9;
+        params.power_coefficients.assign(bcod::SensorConfig::POWER_CONSUMPTION.begin(),
+                                         bcod::SensorConfig::POWER_CONSUMPTION.end());
+        params.device = "cpu";
+        params.num_threads = 1;
+    }
+
+    std::unique_ptr<bcod::SACScheduler> make_scheduler() const {
+        torch::manual_seed(0);
+        return std::make_unique<bcod::SACScheduler>(params);
+    }
+
+    static bcod::SchedulerState state(double cvar_risk, uint32_t prev_mask) {
+        bcod::SchedulerState s{};
+        s.belief_raster = cv::Mat(64, 64, CV_32FC(5), cv::Scalar::all(0.01));
+        s.cvar_risk = cvar_risk;
+        s.goal_distance = 10.0;
+        for (int i = 0; i < bcod::kNumSensors; ++i) s.prev_actions.push_back((prev_mask >> i) & 1u);
+        return s;
+    }
+
+    static constexpr uint32_t ALL = (1u << bcod::kNumSensors) - 1;
+    bcod::SchedulerParams params;
+};
+
+TEST_F(MaskSearchTest, PicksCheapestFeasibleMask) {
+    auto scheduler = make_scheduler();
+    // IMU alone would raise 0.18 above 0.2 once rescaled from all sensors;
+    // IMU + GNSS is the cheapest mask that stays under the threshold.
+    const auto action = scheduler->schedule(state(0.18, ALL));
+    const uint32_t mask = bcod::to_bitmask(action.sensor_mask);
+    EXPECT_EQ(mask, (1u << 3) | (1u << 4));
+    EXPECT_LE(bcod::rescale_risk(0.18, ALL, mask), params.risk_threshold);
+    EXPECT_EQ(action.risk_violation, 0.0);
+}
+
+TEST_F(MaskSearchTest, RescalesFromForecastMaskOnFirstTick) {
+    auto scheduler = make_scheduler();
+    auto first = state(0.18, 0);   // No previous mask yet
+    first.forecast_sensors.assign(bcod::kNumSensors, true);
+    const uint32_t mask = bcod::to_bitmask(scheduler->schedule(first).sensor_mask);
+    EXPECT_LE(bcod::rescale_risk(0.18, ALL, mask), params.risk_threshold);
+    EXPECT_EQ(mask, bcod::to_bitmask(scheduler->schedule(state(0.18, ALL)).sensor_mask));
+}
+
+TEST_F(MaskSearchTest, RespectsPowerBudget) {
+    params.energy_weight = 0.0;   // Nothing pulls towards cheap masks but the budget
+    params.risk_threshold = 10.0;
+    for (double budget : {4.0, 15.0, 60.0}) {
+        params.power_budget = budget;
+        auto scheduler = make_scheduler();
+        for (double risk : {0.05, 0.5, 5.0}) {
+            const auto action = scheduler->schedule(state(risk, ALL));
+            EXPECT_LE(action.total_power, budget) << "budget " << budget << ", risk " << risk;
+            EXPECT_LE(bcod::mask_power(bcod::to_bitmask(action.sensor_mask)), budget);
+        }
+    }
+}
+
+TEST_F(MaskSearchTest, IsDeterministic) {
+    auto a = make_scheduler();
+    auto b = make_scheduler();
+    for (double risk : {0.05, 0.15, 0.3}) {
+        const auto s = state(risk, 0b010101);
+        const auto first = a->schedule(s);
+        EXPECT_EQ(a->schedule(s).sensor_mask, first.sensor_mask);
+        EXPECT_EQ(b->schedule(s).sensor_mask, first.sensor_mask);
+    }
+}
+
+TEST_F(MaskSearchTest, FallsBackWhenNothingIsFeasible) {
+    // No mask brings 5.0 under 0.2: the cheapest mask within budget still
+    // wins and the violation is reported.
+    auto scheduler = make_scheduler();
+    const auto action = scheduler->schedule(state(5.0, ALL));
+    const uint32_t mask = bcod::to_bitmask(action.sensor_mask);
+    EXPECT_NE(mask, 0u);   // No sensors means unbounded risk, worse than any mask
+    EXPECT_EQ(action.risk_violation, 1.0);
+    EXPECT_EQ(mask, 1u << 4);   // IMU, the cheapest single sensor
+
+    // Nothing fits a negative budget: all sensors off
+    params.power_budget = -1.0;
+    scheduler = make_scheduler();
+    const auto off = scheduler->schedule(state(0.05, ALL));
+    EXPECT_EQ(bcod::to_bitmask(off.sensor_mask), 0u);
+    EXPECT_EQ(off.risk_violation, 1.0);
+}
+
+TEST_F(MaskSearchTest, KeepsCostsFiniteWithoutLambda) {
+    // Nothing measured is the largest finite risk, so a zero multiplier
+    // cannot turn its cost into NaN
+    EXPECT_EQ(bcod::rescale_risk(0.1, ALL, 0), bcod::kUnboundedRisk);
+    params.lambda_init = 0.0;
+    params.lambda_min = 0.0;
+    auto scheduler = make_scheduler();
+    const auto action = scheduler->schedule(state(5.0, ALL));
+    EXPECT_TRUE(std::isfinite(action.total_cost));
+    EXPECT_EQ(action.risk_violation, 1.0);
+}
+
+class SharedEncoderTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir = fs::temp_directory_path() / "bcod_shared_encoder_test";
+        fs::remove_all(dir);
+        fs::create_directories(dir);
+
+        params = bcod::SchedulerParams{};
+        params.belief_dim = 32;
+        params.hidden_dim = 32;
+        params.num_layers = 2;
+        params.learning_rate = 1e-3;
+        params.temperature = 0.2;
+        params.tau = 0.005;
+        params.discount_factor = 0.99;
+        params.batch_size = 2;
+        params.buffer_size = 8;
+        params.target_update_interval = 1;
+        params.risk_threshold = 0.2;
+        params.lambda_init = 0.5;
+        params.lambda_max = 10.0;
+        params.energy_weight = 0.3;
+        params.safety_weight = 0.7;
+        params.share_encoder = true;
+        params.power_coefficients.assign(bcod::SensorConfig::POWER_CONSUMPTION.begin(),
+                                         bcod::SensorConfig::POWER_CONSUMPTION.end());
+        params.device = "cpu";
+        params.num_threads = 1;
+    }
+
+    void TearDown() override {
+        fs::remove_all(dir);
+    }
+
+    std::unique_ptr<bcod::SACScheduler> make_scheduler(uint64_t seed) const {
+        torch::manual_seed(seed);
+        auto scheduler = std::make_unique<bcod::SACScheduler>(params);
+        scheduler->set_seed(seed);
+        return scheduler;
+    }
+
+    static bcod::SchedulerState state(std::mt19937& rng) {
+        std::uniform_real_distribution<float> u(0.0f, 1.0f);
+        bcod::SchedulerState s{};
+        s.belief_raster = cv::Mat(64, 64, CV_32FC(5));
+        for (auto it = s.belief_raster.begin<float>(); it != s.belief_raster.end<float>(); ++it) *it = u(rng);
+        s.cvar_risk = u(rng);
+        s.goal_distance = 20.0f * u(rng);
+        for (int i = 0; i < bcod::kNumSensors; ++i) s.prev_actions.push_back(u(rng) > 0.5f);
+        return s;
+    }
+
+    static void train(bcod::SACScheduler& scheduler, std::mt19937& rng) {
+        const auto s = state(rng), next = state(rng);
+        scheduler.update(s, scheduler.schedule(s), 0.1, next);
+    }
+
+    // A parameter such as "encoder.fc1.weight" from a network written by
+    // save_model; submodules are nested archives.
+    torch::Tensor saved(const std::string& file, const std::string& name) const {
+        torch::serialize::InputArchive archive;
+        archive.load_from((dir / file).string());
+        size_t begin = 0;
+        for (size_t dot = name.find('.'); dot != std::string::npos; dot = name.find('.', begin)) {
+            torch::serialize::InputArchive child;
+            archive.read(name.substr(begin, dot - begin), child);
+            archive = std::move(child);
+            begin = dot + 1;
+        }
+        torch::Tensor value;
+        archive.read(name.substr(begin), value);
+        return value;
+    }
+
+    std::string prefix(const std::string& name) const { return (dir / name).string(); }
+
+    fs::path dir;
+    bcod::SchedulerParams params;
+};
+
+TEST_F(SharedEncoderTest, TrainsTrunkOncePerStep) {
+    auto scheduler = make_scheduler(0);
+    std::mt19937 rng(5);
+    train(*scheduler, rng);   // One short of a batch, no training yet
+    scheduler->save_model(prefix("before"));
+    train(*scheduler, rng);   // Exactly one training step
+    scheduler->save_model(prefix("after"));
+
+    for (const char* name : {"encoder.conv1.weight", "encoder.conv3.weight", "encoder.fc1.weight",
+                             "encoder.fc2.weight"}) {
+        // A single Adam step moves each weight by at most the learning rate;
+        // a second optimizer stepping the trunk could move it twice as far.
+        const float moved = (saved("after_critic1.pt", name) - saved("before_critic1.pt", name)).abs().max().item<float>();
+        EXPECT_GT(moved, 0.0f) << name;
+        EXPECT_LE(moved, params.learning_rate * 1.001) << name;
+
+        // Nothing reads the actor's or critic2's own encoder in shared mode
+        EXPECT_TRUE(torch::equal(saved("after_critic2.pt", name), saved("before_critic2.pt", name))) << name;
+        EXPECT_TRUE(torch::equal(saved("after_actor.pt", name), saved("before_actor.pt", name))) << name;
+    }
+}
+
+TEST_F(SharedEncoderTest, SaveLoadRoundTrips) {
+    auto trained = make_scheduler(0);
+    std::mt19937 rng(5);
+    for (int t = 0; t < 6; ++t) train(*trained, rng);
+    trained->save_model(prefix("model"));
+
+    auto loaded = make_scheduler(1);
+    loaded->load_model(prefix("model"));
+    for (int k = 0; k < 4; ++k) {
+        const auto s = state(rng);
+        const auto expected = trained->schedule_mean(s);
+        const auto actual = loaded->schedule_mean(s);
+        ASSERT_EQ(actual.probabilities.size(), expected.probabilities.size());
+        for (size_t i = 0; i < expected.probabilities.size(); ++i) {
+            EXPECT_FLOAT_EQ(actual.probabilities[i], expected.probabilities[i]) << "state " << k << " sensor " << i;
+        }
+    }
+}
@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+#include <bcod/sac_sweep.hpp>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+namespace fs = std::filesystem;
+
+class SacSweepTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir = fs::temp_directory_path() / "bcod_sac_sweep_test";
+        fs::remove_all(dir);
+        fs::create_directories(dir);
+    }
+
+    void TearDown() override {
+        fs::remove_all(dir);
+    }
+
+    // Random transitions; the sweep only needs them to be reproducible
+    std::string write_dataset(const std::string& name, uint32_t count) {
+        const std::string path = (dir / name).string();
+        std::ofstream out(path, std::ios::binary);
+        bcod::SweepDatasetHeader header{};
+        std::memcpy(header.magic, bcod::SweepDatasetHeader::MAGIC, sizeof(header.magic));
+        header.version = bcod::SweepDatasetHeader::VERSION;
+        header.count = count;
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        std::mt19937 rng(count);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        auto record = std::make_unique<bcod::SweepRecord>();
+        for (uint32_t i = 0; i < count; ++i) {
+            for (float& v : record->belief) v = unit(rng);
+            for (float& v : record->next_belief) v = unit(rng);
+            record->cvar_risk = unit(rng);
+            record->next_cvar_risk = unit(rng);
+            record->goal_distance = 50.0f * unit(rng);
+            record->next_goal_distance = 50.0f * unit(rng);
+            record->reward = unit(rng) - 0.5f;
+            record->prev_mask = rng() & 0x3f;
+            record->action_mask = rng() & 0x3f;
+            record->done = 0;
+            out.write(reinterpret_cast<const char*>(record.get()), sizeof(bcod::SweepRecord));
+        }
+        return path;
+    }
+
+    fs::path dir;
+};
+
+TEST_F(SacSweepTest, RejectsEmptyDataset) {
+    bcod::SweepDataset data(write_dataset("empty.bin", 0));
+    EXPECT_EQ(data.size(), 0u);
+    EXPECT_THROW(bcod::SweepRunner(data, 10, 10, 0), std::invalid_argument);
+}
+
+TEST_F(SacSweepTest, RejectsTruncatedDataset) {
+    const std::string path = write_dataset("short.bin", 2);
+    fs::resize_file(path, fs::file_size(path) - 1);
+    EXPECT_THROW(bcod::SweepDataset data(path), std::runtime_error);
+}
+
+TEST_F(SacSweepTest, RejectsUnknownAxis) {
+    bcod::SweepDataset data(write_dataset("data.bin", 4));
+    bcod::SweepRunner runner(data, 1, 4, 0);
+    EXPECT_THROW(runner.add_axis("learning_rate", {1e-3}), std::invalid_argument);
+}
+
+TEST_F(SacSweepTest, SerialRunsAreReproducible) {
+    bcod::SweepDataset data(write_dataset("data.bin", 48));
+    bcod::SweepRunner runner(data, 40, 16, 3);
+    runner.add_axis("energy_weight", {0.1, 0.5, 0.9});
+    runner.add_axis("risk_threshold", {0.2, 0.4});
+
+    const auto first = runner.run(1);
+    const auto second = runner.run(1);
+    ASSERT_EQ(first.size(), 6u);
+    ASSERT_EQ(second.size(), first.size());
+    for (size_t i = 0; i < first.size(); ++i) {
+        EXPECT_EQ(second[i].point, first[i].point);
+        EXPECT_DOUBLE_EQ(second[i].mean_power, first[i].mean_power) << "point " << i;
+        EXPECT_DOUBLE_EQ(second[i].violation_rate, first[i].violation_rate) << "point " << i;
+        EXPECT_DOUBLE_EQ(second[i].cvar95_risk, first[i].cvar95_risk) << "point " << i;
+        EXPECT_EQ(second[i].pareto, first[i].pareto);
+    }
+}
+
+TEST_F(SacSweepTest, ParallelRunKeepsGridOrder) {
+    bcod::SweepDataset data(write_dataset("data.bin", 48));
+    bcod::SweepRunner runner(data, 10, 8, 3);
+    runner.add_axis("energy_weight", {0.1, 0.5, 0.9});
+    runner.add_axis("risk_threshold", {0.2, 0.4});
+
+    const auto results = runner.run(4);
+    ASSERT_EQ(results.size(), 6u);
+    size_t i = 0;
+    for (double energy : {0.1, 0.5, 0.9}) {
+        for (double risk : {0.2, 0.4}) {
+            EXPECT_EQ(results[i].point.at("energy_weight"), energy) << "point " << i;
+            EXPECT_EQ(results[i].point.at("risk_threshold"), risk) << "point " << i;
+            ++i;
+        }
+    }
+}
+
+TEST(SacSweepParetoTest, MarksUndominatedResults) {
+    std::vector<bcod::SweepResult> results = {
+        {{}, 10.0, 0.10, 0.0, false},
+        {{}, 20.0, 0.05, 0.0, false},
+        {{}, 20.0, 0.10, 0.0, false},   // Dominated by both of the above
+        {{}, 10.0, 0.10, 0.0, false},   // Ties do not dominate each other
+    };
+    bcod::mark_pareto(results);
+    EXPECT_TRUE(results[0].pareto);
+    EXPECT_TRUE(results[1].pareto);
+    EXPECT_FALSE(results[2].pareto);
+    EXPECT_TRUE(results[3].pareto);
+}
@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include <bcod/student_planner.hpp>
+#include <bcod/sensor_defs.hpp>
 #include <opencv2/opencv.hpp>
 
 class StudentPlannerTest : public ::testing::Test {
@@ -78,4 +79,185 @@ TEST_F(StudentPlannerTest, DeviceManagement) {
     // Test device management
     EXPECT_NO_THROW(planner->set_device("cuda:0"));
     EXPECT_NO_THROW(planner->set_batch_size(32));
-} 
\ No newline at end of file
+} 
+namespace {
+    bcod::StudentParams horizon_params() {
+        bcod::StudentParams p{};
+        p.trajectory_horizon = 16;
+        p.waypoint_interval = 0.5;
+        p.use_adaptive_horizon = true;
+        p.min_horizon = 4;
+        p.max_horizon = 12;
+        return p;
+    }
+
+    bcod::PlanningContext horizon_context(double goal_distance) {
+        bcod::PlanningContext c{};
+        c.max_velocity = 2.0;   // 1 m per waypoint at 0.5 s
+        c.goal_distance = goal_distance;
+        return c;
+    }
+
+    // Uniform mass with the given covariance logdet and circular variance
+    cv::Mat uniform_belief(float logdet, float circ_var, int size = 16) {
+        cv::Mat image(size, size, CV_32FC(5), cv::Scalar::all(0));
+        for (int y = 0; y < image.rows; ++y) {
+            float* row = image.ptr<float>(y);
+            for (int x = 0; x < image.cols; ++x) {
+                float* cell = row + x * 5;
+                cell[0] = 1.0f / (size * size);
+                cell[3] = logdet;
+                cell[4] = circ_var;
+            }
+        }
+        return image;
+    }
+
+    bcod::StudentParams small_planner_params() {
+        bcod::StudentParams p{};
+        p.input_channels = 9;
+        p.hidden_dim = 32;
+        p.num_layers = 2;
+        p.num_heads = 4;
+        p.trajectory_horizon = 8;
+        p.cvar_percentile = 0.95;
+        p.waypoint_interval = 0.5;
+        p.unimodal_circ_var = 0.05;
+        p.unimodal_logdet = -2.0;
+        return p;
+    }
+
+    std::unique_ptr<bcod::StudentPlanner> seeded_planner(const bcod::StudentParams& params) {
+        torch::manual_seed(0);
+        return std::make_unique<bcod::StudentPlanner>(params);
+    }
+
+    bcod::PlanningContext belief_context(const cv::Mat& belief) {
+        bcod::PlanningContext c{};
+        c.semantic_map = cv::Mat::zeros(64, 64, CV_32FC3);
+        c.goal_mask = cv::Mat::zeros(64, 64, CV_32FC1);
+        c.active_sensors.assign(bcod::kNumSensors, true);
+        c.max_velocity = 2.0;
+        c.belief_image = belief;
+        return c;
+    }
+}
+
+TEST(ResolveHorizonTest, CoversGoalDistanceWithinBounds) {
+    const auto p = horizon_params();
+    EXPECT_EQ(bcod::resolve_horizon(p, horizon_context(7.5)), 8);
+    EXPECT_EQ(bcod::resolve_horizon(p, horizon_context(1.0)), 4);     // Raised to min_horizon
+    EXPECT_EQ(bcod::resolve_horizon(p, horizon_context(100.0)), 12);  // Capped at max_horizon
+    EXPECT_EQ(bcod::resolve_horizon(p, horizon_context(0.0)), 12);    // Unknown distance
+
+    auto fixed = p;
+    fixed.use_adaptive_horizon = false;
+    EXPECT_EQ(bcod::resolve_horizon(fixed, horizon_context(1.0)), 16);
+}
+
+TEST(ResolveHorizonTest, ClampsContextBoundsToTheNetwork) {
+    const auto p = horizon_params();
+    auto c = horizon_context(100.0);
+    c.use_adaptive_horizon = true;
+    c.min_horizon = 2;
+    c.max_horizon = 40;
+    EXPECT_EQ(bcod::resolve_horizon(p, c), 16);  // Never beyond trajectory_horizon
+
+    c.goal_distance = 0.5;
+    EXPECT_EQ(bcod::resolve_horizon(p, c), 2);
+
+    c.min_horizon = 30;                          // min above max collapses to max
+    c.max_horizon = 10;
+    EXPECT_EQ(bcod::resolve_horizon(p, c), 10);
+
+    c.min_horizon = 0;                           // At least one waypoint
+    c.goal_distance = 1e-3;
+    EXPECT_EQ(bcod::resolve_horizon(p, c), 1);
+}
+
+TEST(UnimodalBeliefTest, ClassifiesConcentratedBeliefs) {
+    bcod::StudentParams p{};
+    p.unimodal_circ_var = 0.05;
+    p.unimodal_logdet = -2.0;
+
+    EXPECT_TRUE(bcod::unimodal_belief(p, uniform_belief(-4.0f, 0.01f)));
+    EXPECT_FALSE(bcod::unimodal_belief(p, uniform_belief(0.0f, 0.01f)));   // Spread out
+    EXPECT_FALSE(bcod::unimodal_belief(p, uniform_belief(-4.0f, 0.5f)));   // Heading ambiguous
+
+    // Two modes: half the mass tight, half diffuse
+    cv::Mat mixed = uniform_belief(-4.0f, 0.01f);
+    for (int y = 0; y < mixed.rows / 2; ++y) {
+        for (int x = 0; x < mixed.cols; ++x) {
+            mixed.ptr<float>(y)[x * 5 + 3] = 2.0f;
+            mixed.ptr<float>(y)[x * 5 + 4] = 0.4f;
+        }
+    }
+    EXPECT_FALSE(bcod::unimodal_belief(p, mixed));
+
+    // Mass decides: diffuse cells without mass do not count
+    cv::Mat weighted = mixed.clone();
+    for (int y = 0; y < weighted.rows / 2; ++y) {
+        for (int x = 0; x < weighted.cols; ++x) weighted.ptr<float>(y)[x * 5] = 0.0f;
+    }
+    EXPECT_TRUE(bcod::unimodal_belief(p, weighted));
+
+    EXPECT_FALSE(bcod::unimodal_belief(p, cv::Mat()));
+    EXPECT_FALSE(bcod::unimodal_belief(p, cv::Mat::zeros(16, 16, CV_32FC(5))));  // No mass
+    EXPECT_FALSE(bcod::unimodal_belief(p, cv::Mat::zeros(16, 16, CV_32FC3)));
+}
+
+TEST(AttendSingleTokenTest, MatchesFullAttention) {
+    torch::manual_seed(0);
+    torch::nn::MultiheadAttention attention(32, 4);
+    attention->eval();
+    torch::NoGradGuard no_grad;
+
+    // (sequence, batch, embedding): four independent one-token sequences
+    const auto features = torch::randn({1, 4, 32});
+    const auto full = std::get<0>(attention(features, features, features));
+    const auto shortcut = bcod::attend_single_token(attention, features.squeeze(0));
+    ASSERT_EQ(shortcut.sizes(), full.squeeze(0).sizes());
+    EXPECT_TRUE(torch::allclose(shortcut, full.squeeze(0), 1e-5, 1e-5));
+}
+
+TEST(SkipUnimodalAttentionTest, BypassesAttentionOnlyForUnimodalBeliefs) {
+    auto p = small_planner_params();
+    auto full = seeded_planner(p);
+    p.skip_unimodal_attention = true;
+    auto skipping = seeded_planner(p);
+
+    const auto spread = belief_context(uniform_belief(0.0f, 0.3f, 64));
+    const auto a = full->plan(spread), b = skipping->plan(spread);
+    ASSERT_EQ(a.waypoints.size(), b.waypoints.size());
+    for (size_t i = 0; i < a.waypoints.size(); ++i) EXPECT_NEAR((a.waypoints[i] - b.waypoints[i]).norm(), 0.0, 1e-5);
+
+    const auto tight = belief_context(uniform_belief(-4.0f, 0.01f, 64));
+    const auto c = full->plan(tight), d = skipping->plan(tight);
+    ASSERT_EQ(c.waypoints.size(), d.waypoints.size());
+    double difference = 0.0;
+    for (size_t i = 0; i < c.waypoints.size(); ++i) difference += (c.waypoints[i] - d.waypoints[i]).norm();
+    EXPECT_GT(difference, 1e-6);
+}
+
+TEST(PlanCacheReloadTest, ParamChangesInvalidateCachedPlans) {
+    auto p = small_planner_params();
+    p.plan_cache_size = 8;
+    p.plan_cache_tolerance = 0.05;
+    auto planner = seeded_planner(p);
+    const auto tight = belief_context(uniform_belief(-4.0f, 0.01f, 64));
+    planner->plan(tight);
+
+    // A reload changing how plans are scored must not return the cached one
+    p.cvar_percentile = 0.5;
+    planner->set_params(p);
+    EXPECT_DOUBLE_EQ(planner->plan(tight).cvar_95, seeded_planner(p)->plan(tight).cvar_95);
+
+    // Nor one planned through attention once it is skipped for this belief
+    p.skip_unimodal_attention = true;
+    planner->set_params(p);
+    const auto reloaded = planner->plan(tight), expected = seeded_planner(p)->plan(tight);
+    ASSERT_EQ(reloaded.waypoints.size(), expected.waypoints.size());
+    for (size_t i = 0; i < expected.waypoints.size(); ++i) {
+        EXPECT_NEAR((reloaded.waypoints[i] - expected.waypoints[i]).norm(), 0.0, 1e-6) << "waypoint " << i;
+    }
+}
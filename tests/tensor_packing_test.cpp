@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+#include <bcod/tensor_packing.hpp>
+#include <opencv2/core.hpp>
+#include <vector>
+
+namespace {
+    // Pixel (y, x) channel c holds c * 10000 + y * 100 + x
+    cv::Mat numbered(int height, int width, int channels) {
+        cv::Mat image(height, width, CV_32FC(channels));
+        for (int y = 0; y < height; ++y) {
+            float* row = image.ptr<float>(y);
+            for (int x = 0; x < width; ++x) {
+                for (int c = 0; c < channels; ++c) row[x * channels + c] = c * 10000.0f + y * 100.0f + x;
+            }
+        }
+        return image;
+    }
+}
+
+TEST(TensorPackingTest, TransposesHwcToPlanes) {
+    for (int channels : {1, 3, 5, 7}) {
+        const cv::Mat image = numbered(4, 6, channels);
+        std::vector<float> planes(channels * 4 * 6, -1.0f);
+        bcod::pack_planes(image, 4, 6, channels, planes.data());
+        for (int c = 0; c < channels; ++c) {
+            for (int y = 0; y < 4; ++y) {
+                for (int x = 0; x < 6; ++x) {
+                    EXPECT_EQ(planes[(c * 4 + y) * 6 + x], c * 10000.0f + y * 100.0f + x) << "channels " << channels;
+                }
+            }
+        }
+    }
+}
+
+TEST(TensorPackingTest, HandlesRoisEmptyRastersAndTransforms) {
+    const cv::Mat full = numbered(8, 8, 3);
+    const cv::Mat roi = full(cv::Rect(2, 1, 4, 4));
+    const bcod::ChannelTransform transforms[3] = {{1.0f, 0.0f}, {0.5f, 0.0f}, {2.0f, 1.0f}};
+
+    std::vector<float> planes(3 * 16);
+    bcod::pack_planes(roi, 4, 4, 3, planes.data(), transforms);
+    EXPECT_EQ(planes[0], 102.0f);
+    EXPECT_EQ(planes[16 + 5], 0.5f * (10000.0f + 203.0f));
+    EXPECT_EQ(planes[32 + 15], 2.0f * (20000.0f + 405.0f) + 1.0f);
+
+    bcod::pack_planes(cv::Mat(), 4, 4, 3, planes.data());
+    for (float v : planes) EXPECT_EQ(v, 0.0f);
+
+    EXPECT_THROW(bcod::pack_planes(full, 4, 4, 3, planes.data()), std::invalid_argument);
+}
+
+TEST(TensorPackingTest, PackerConcatenatesRastersIntoOneTensor) {
+    bcod::InputPacker packer({5, 3, 1}, 8, 8);
+    const cv::Mat belief = numbered(8, 8, 5);
+    const cv::Mat map = numbered(8, 8, 3);
+    const cv::Mat goal = cv::Mat::ones(8, 8, CV_8UC1);
+
+    const torch::Tensor& shared = packer.pack({belief, map, goal});
+    ASSERT_EQ(shared.sizes().vec(), (std::vector<int64_t>{1, 9, 8, 8}));
+    EXPECT_EQ(shared[0][4][2][3].item<float>(), 40203.0f);
+    EXPECT_EQ(shared[0][7][1][1].item<float>(), 20101.0f);
+    EXPECT_EQ(shared[0][8][7][7].item<float>(), 1.0f);
+
+    torch::Tensor owned = packer.pack_owned({belief, map, goal});
+    EXPECT_NE(owned.data_ptr<float>(), shared.data_ptr<float>());
+    EXPECT_TRUE(torch::equal(owned, shared));
+
+    EXPECT_THROW(packer.pack({belief, map}), std::invalid_argument);
+}
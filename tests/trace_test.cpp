@@ -0,0 +1,53 @@
+#include <gtest/gtest.h>
+#include <bcod/trace.hpp>
+#include <bcod/mapped_file.hpp>
+#include <cstdio>
+#include <cstring>
+
+class TraceTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path = ::testing::TempDir() + "bcod_trace_test.bin";
+    }
+
+    void TearDown() override {
+        bcod::Tracer::instance().close();
+        std::remove(path.c_str());
+    }
+
+    std::string path;
+};
+
+TEST_F(TraceTest, RecordsRoundTrip) {
+    auto& tracer = bcod::Tracer::instance();
+    tracer.open(path);
+    ASSERT_TRUE(tracer.enabled());
+    BCOD_TRACE(bcod::TraceEvent::PLAN, 0b101u, 0.5, 1.5f, 2, 3.0);
+    BCOD_TRACE(bcod::TraceEvent::SCHEDULE, 0b11u, 7.0);
+    tracer.close();
+
+    bcod::MappedFile file(path);
+    ASSERT_EQ(file.size(), sizeof(bcod::TraceFileHeader) + (BCOD_ENABLE_TRACE ? 2 : 0) * sizeof(bcod::TraceRecord));
+
+    bcod::TraceFileHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    EXPECT_EQ(std::memcmp(header.magic, bcod::TraceFileHeader::MAGIC, 8), 0);
+    EXPECT_EQ(header.record_size, sizeof(bcod::TraceRecord));
+    if (!BCOD_ENABLE_TRACE) return;
+
+    bcod::TraceRecord r;
+    std::memcpy(&r, file.data() + sizeof(header), sizeof(r));
+    EXPECT_EQ(r.event, static_cast<uint32_t>(bcod::TraceEvent::PLAN));
+    EXPECT_EQ(r.mask, 0b101u);
+    EXPECT_FLOAT_EQ(r.values[0], 0.5f);
+    EXPECT_FLOAT_EQ(r.values[2], 2.0f);
+    EXPECT_FLOAT_EQ(r.values[3], 3.0f);
+    EXPECT_FLOAT_EQ(r.values[4], 0.0f);
+}
+
+TEST_F(TraceTest, ClosedTracerSkipsArguments) {
+    int evaluated = 0;
+    auto touch = [&] { return ++evaluated; };
+    BCOD_TRACE(bcod::TraceEvent::UPDATE, 0u, touch());
+    EXPECT_EQ(evaluated, 0);
+}
@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+#include <bcod/vector_env.hpp>
+#include <bcod/sensor_defs.hpp>
+#include <nlohmann/json.hpp>
+#include <stdexcept>
+
+class VectorEnvTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        auto environment = nlohmann::json::parse(R"({
+            "world": {
+                "size": [100.0, 100.0],
+                "resolution": 0.1,
+                "origin": [0.0, 0.0],
+                "obstacles": [
+                    {"type": "static", "shape": "circle", "center": [50.0, 50.0], "radius": 5.0}
+                ],
+                "features": [
+                    {"type": "landmark", "position": [25.0, 25.0], "uncertainty": 0.1}
+                ]
+            },
+            "simulation": {"time_step": 0.1, "max_steps": 1000}
+        })");
+
+        params.num_envs = 4;
+        params.num_threads = 2;
+        params.num_particles = 200;
+        params.seed = 7;
+        params.initial_spread = 1.0;
+        params.min_goal_distance = 20.0;
+        params.goal_tolerance = 1.0;
+        params.goal_reward = 10.0;
+        params.collision_penalty = 10.0;
+        params.progress_weight = 1.0;
+        params.energy_weight = 0.01;
+        params.error_weight = 0.1;
+        params.lost_threshold = 50.0;
+        params.rasteriser = bcod::BeliefRasteriser::Params{};
+        params.rasteriser.raster_H = 64;
+        params.rasteriser.raster_W = 64;
+        params.rasteriser.raster_C = 5;
+        params.rasteriser.min_window = 2.0;
+        params.rasteriser.max_window = 50.0;
+        params.rasteriser.sigma_scale = 6.0;
+        params.rasteriser.normalize = false;
+        params.world = bcod::parse_world(environment);
+    }
+
+    bcod::VectorEnv::Params params;
+};
+
+TEST_F(VectorEnvTest, BatchedShapes) {
+    bcod::VectorEnv env(params);
+    const auto& obs = env.reset();
+    EXPECT_EQ(obs.belief.size(), 4u * 5 * 64 * 64);
+    EXPECT_EQ(obs.rewards.size(), 4u);
+    EXPECT_EQ(obs.dones.size(), 4u);
+}
+
+TEST_F(VectorEnvTest, RasterSizeFollowsParams) {
+    params.rasteriser.raster_H = 32;
+    params.rasteriser.raster_W = 32;
+    bcod::VectorEnv env(params);
+    EXPECT_EQ(env.raster_height(), 32);
+    EXPECT_EQ(env.raster_width(), 32);
+    EXPECT_EQ(env.reset().belief.size(), 4u * 5 * 32 * 32);
+
+    params.rasteriser.raster_W = 48;
+    EXPECT_THROW(bcod::VectorEnv wide(params), std::invalid_argument);
+}
+
+TEST_F(VectorEnvTest, WarmupEnergyIsAccounted) {
+    bcod::VectorEnv env(params);
+    env.reset();
+    const uint32_t lidar = 1u << static_cast<int>(bcod::SensorType::LIDAR);
+    const auto& r = env.step(std::vector<uint32_t>(4, lidar));
+    const double expected = bcod::SensorConfig::POWER_CONSUMPTION[0] * params.world.time_step;
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_NEAR(r.energy[i], expected, 1e-9);
+        EXPECT_NEAR(r.warmup_energy[i], expected, 1e-9);
+    }
+}
+
+TEST_F(VectorEnvTest, SeededRunsAreReproducible) {
+    bcod::VectorEnv a(params), b(params);
+    a.reset();
+    b.reset();
+    const std::vector<uint32_t> masks(4, 0b001000);
+    for (int t = 0; t < 10; ++t) {
+        const auto& ra = a.step(masks);
+        const auto& rb = b.step(masks);
+        EXPECT_EQ(ra.rewards, rb.rewards);
+        EXPECT_EQ(ra.belief, rb.belief);
+    }
+}
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+#include <bcod/warmup_lookahead.hpp>
+#include <cmath>
+
+namespace {
+    constexpr uint32_t bit(bcod::SensorType s) { return 1u << static_cast<int>(s); }
+
+    bcod::WarmupLookahead::Params lookahead_params() {
+        bcod::WarmupLookahead::Params p{};
+        p.risk_threshold = 1.0;
+        p.energy_weight = 0.3;
+        p.safety_weight = 0.7;
+        return p;
+    }
+
+    // 0.5 everywhere but a spike of 1.5 from waypoint `spike` on. With only
+    // RGB measuring, EXO2 is the cheapest slow sensor that brings it under 1.
+    std::vector<double> forecast(int spike, int horizon = 10) {
+        std::vector<double> risk(horizon, 0.5);
+        for (int i = std::max(spike, 0); i < horizon; ++i) risk[i] = 1.5;
+        return risk;
+    }
+}
+
+TEST(WarmupLookaheadTest, TracksWarmupOfPoweredSensors) {
+    bcod::WarmupLookahead lookahead(lookahead_params());
+    const uint32_t lidar = bit(bcod::SensorType::LIDAR), gnss = bit(bcod::SensorType::GNSS);
+    lookahead.advance(lidar | gnss, 2.0);
+    EXPECT_DOUBLE_EQ(lookahead.warmup_left(bcod::SensorType::LIDAR), 3.0);
+    EXPECT_EQ(lookahead.ready(), gnss);
+
+    lookahead.advance(lidar, 3.0);
+    EXPECT_EQ(lookahead.ready(), lidar);
+
+    // Switching off loses the warmup
+    lookahead.advance(0, 1.0);
+    lookahead.advance(lidar, 1.0);
+    EXPECT_DOUBLE_EQ(lookahead.warmup_left(bcod::SensorType::LIDAR), 4.0);
+}
+
+TEST(WarmupLookaheadTest, SwitchesSlowSensorOnJustInTime) {
+    bcod::WarmupLookahead lookahead(lookahead_params());
+    const uint32_t rgb = bit(bcod::SensorType::RGB), exo2 = bit(bcod::SensorType::EXO2);
+    lookahead.advance(rgb, 5.0);
+
+    // The spike is reached 6 s from now and EXO2 warms up in 3 s, so it can
+    // wait three ticks.
+    int spike = 5;
+    for (int tick = 0; tick < 3; ++tick, --spike) {
+        const auto plan = lookahead.plan(rgb, forecast(spike), 1.0, 1.0);
+        EXPECT_EQ(plan.mask, rgb) << "tick " << tick;
+        EXPECT_EQ(plan.lead_steps, 3 - tick);
+        EXPECT_EQ(plan.violations, 0);
+        lookahead.advance(plan.mask, 1.0);
+    }
+    const auto plan = lookahead.plan(rgb, forecast(spike), 1.0, 1.0);
+    EXPECT_EQ(plan.preactivated, exo2);
+    EXPECT_EQ(plan.mask, rgb | exo2);
+    EXPECT_EQ(plan.violations, 0);
+    EXPECT_GT(plan.warmup_energy, 0.0);
+    EXPECT_LT(plan.peak_risk, 1.0);
+}
+
+TEST(WarmupLookaheadTest, LeavesMaskAloneWithoutRiskOrBudget) {
+    bcod::WarmupLookahead lookahead(lookahead_params());
+    const uint32_t rgb = bit(bcod::SensorType::RGB);
+    lookahead.advance(rgb, 5.0);
+
+    auto plan = lookahead.plan(rgb, forecast(10), 1.0, 1.0);
+    EXPECT_EQ(plan.mask, rgb);
+    EXPECT_EQ(plan.lead_steps, -1);
+
+    // Too late for anything to warm up: nothing is switched on in vain
+    plan = lookahead.plan(rgb, forecast(0, 1), 1.0, 1.0);
+    EXPECT_EQ(plan.mask, rgb);
+    EXPECT_EQ(plan.violations, 1);
+
+    auto p = lookahead_params();
+    p.power_budget = 20.0;
+    lookahead.set_params(p);
+    plan = lookahead.plan(rgb, forecast(0), 1.0, 1.0);
+    EXPECT_EQ(plan.mask, rgb);
+}
+
+TEST(WarmupLookaheadTest, CostsStayFiniteWithNothingMeasuring) {
+    bcod::WarmupLookahead lookahead(lookahead_params());
+    for (double lambda : {0.0, 1.0}) {
+        const auto plan = lookahead.plan(0, forecast(0), 1.0, lambda);
+        EXPECT_TRUE(std::isfinite(plan.cost)) << "lambda " << lambda;
+        EXPECT_EQ(plan.peak_risk, bcod::kUnboundedRisk) << "lambda " << lambda;
+    }
+}
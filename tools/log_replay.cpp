@@ -1 +1,308 @@
- 
\ No newline at end of file
+#include "bcod/replay_log.hpp"
+#include "bcod/belief_rasteriser.hpp"
+#include "bcod/student_planner.hpp"
+#include "bcod/sac_scheduler.hpp"
+#include "bcod/config_loader.hpp"
+#include "bcod/config_snapshot.hpp"
+#include "bcod/sensor_defs.hpp"
+#include "bcod/logging.hpp"
+#include <torch/torch.h>
+#include <opencv2/core.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace bcod;
+
+// Replays a flight log open-loop through the real rasteriser, planner and
+// scheduler. Every decision sees the logged history rather than earlier
+// replayed decisions, so frames are independent: they are spread over worker
+// threads and each one is seeded from its index. The output is identical for
+// any thread count and can be diffed line by line across library versions.
+
+struct ReplayOptions {
+    std::string log_path;
+    std::string out_path;
+    std::string config_path;
+    std::string planner_model;
+    std::string scheduler_model;
+    std::string policy_path;
+    int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    uint64_t seed = 0;
+    size_t begin = 0;
+    size_t end = SIZE_MAX;
+    bool mask_search = false;
+};
+
+struct Decision {
+    uint32_t logged_mask;
+    uint32_t mask;
+    float cvar_95;
+    float total_power;
+    float total_cost;
+    float risk_violation;
+};
+
+constexpr int kRasterSize = 64;
+
+// SplitMix64, so neighbouring frames get unrelated seeds
+uint64_t frame_seed(uint64_t seed, size_t frame) {
+    uint64_t z = seed + 0x9e3779b97f4a7c15ull * (frame + 1);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+std::vector<bool> mask_bits(uint32_t mask) {
+    std::vector<bool> bits(kNumSensors);
+    for (int i = 0; i < kNumSensors; ++i) bits[i] = (mask >> i) & 1u;
+    return bits;
+}
+
+BeliefRasteriser::Params rasteriser_params() {
+    BeliefRasteriser::Params p{};
+    p.raster_H = kRasterSize;
+    p.raster_W = kRasterSize;
+    p.raster_C = 5;
+    p.min_window = 2.0;
+    p.max_window = 50.0;
+    p.sigma_scale = 6.0;
+    p.normalize = false;
+    return p;
+}
+
+class ReplayEngine {
+public:
+    ReplayEngine(const ReplayLog& log, const ReplayOptions& options) : log_(log), options_(options) {
+        if (options_.config_path.empty()) {
+            student_ = default_student_params();
+            scheduler_ = default_scheduler_params();
+        } else {
+            auto snapshot = compile_config(load_config(options_.config_path).config);
+            Instrumentation::instance().configure(snapshot->profiling);
+            student_ = snapshot->student;
+            scheduler_ = snapshot->scheduler;
+        }
+        scheduler_.use_mask_search = options_.mask_search;
+        if (!options_.policy_path.empty()) {
+            scheduler_.inference_only = true;
+            scheduler_.policy_path = options_.policy_path;
+        }
+    }
+
+    std::vector<Decision> run(size_t begin, size_t end) {
+        std::vector<Decision> decisions(end - begin);
+        next_ = begin;
+
+        // Workers are built one after another from the same seed, so without
+        // model files they all start from identical weights.
+        std::vector<std::unique_ptr<Worker>> workers;
+        for (int w = 0; w < options_.threads; ++w) {
+            torch::manual_seed(options_.seed);
+            workers.push_back(std::make_unique<Worker>(rasteriser_params(), student_, scheduler_));
+            if (!options_.planner_model.empty()) workers.back()->planner.load_model(options_.planner_model);
+            if (!options_.scheduler_model.empty()) workers.back()->scheduler.load_model(options_.scheduler_model);
+        }
+
+        std::vector<std::thread> threads;
+        for (auto& worker : workers) {
+            threads.emplace_back([&, w = worker.get()] {
+                for (size_t i = next_.fetch_add(kChunk); i < end; i = next_.fetch_add(kChunk)) {
+                    const size_t stop = std::min(end, i + kChunk);
+                    for (size_t f = i; f < stop; ++f) decisions[f - begin] = replay_frame(*w, f);
+                }
+            });
+        }
+        for (auto& t : threads) t.join();
+        return decisions;
+    }
+
+private:
+    static constexpr size_t kChunk = 32;
+
+    // Components and scratch owned by one thread
+    struct Worker {
+        BeliefRasteriser rasteriser;
+        StudentPlanner planner;
+        SACScheduler scheduler;
+        std::vector<Particle> particles;
+        PlanningContext context{};
+        SchedulerState state{};
+
+        Worker(const BeliefRasteriser::Params& r, const StudentParams& p, const SchedulerParams& s)
+            : rasteriser(r), planner(p), scheduler(s) {
+            context.semantic_map = cv::Mat::zeros(kRasterSize, kRasterSize, CV_32FC3);
+            context.goal_mask = cv::Mat::zeros(kRasterSize, kRasterSize, CV_32FC1);
+            context.max_velocity = 2.0;
+            context.max_angular_velocity = 1.0;
+        }
+    };
+
+    const ReplayLog& log_;
+    ReplayOptions options_;
+    StudentParams student_;
+    SchedulerParams scheduler_;
+    std::atomic<size_t> next_{0};
+
+    Decision replay_frame(Worker& w, size_t f) {
+        const auto frame = log_[f];
+        const ReplayFrameHeader& h = *frame.header;
+        const uint32_t prev_mask = f > 0 ? log_[f - 1].header->sensor_mask : h.sensor_mask;
+
+        ReplayLog::unpack(frame, w.particles);
+        BeliefRaster raster = w.rasteriser.rasterise(w.particles);
+
+        w.context.belief_image = raster.data;
+        rasterise_goal(raster.window, Eigen::Vector2d(h.goal[0], h.goal[1]), w.context.goal_mask);
+        w.context.active_sensors = mask_bits(h.sensor_mask);
+        w.context.current_pose = Eigen::Vector3d(h.pose[0], h.pose[1], h.pose[2]);
+        w.context.goal_distance = h.goal_distance;
+        w.context.timestamp = h.timestamp_ns;
+        const Trajectory traj = w.planner.plan(w.context);
+
+        w.state.belief_raster = raster.data;
+        w.state.cvar_risk = traj.cvar_95;
+        w.state.goal_distance = h.goal_distance;
+        w.state.prev_actions = mask_bits(prev_mask);
+        w.state.timestamp = h.timestamp_ns;
+        w.scheduler.set_seed(frame_seed(options_.seed, f));
+        const SchedulerAction action = w.scheduler.schedule(w.state);
+
+        return {h.sensor_mask, to_bitmask(action.sensor_mask), static_cast<float>(traj.cvar_95),
+                static_cast<float>(action.total_power), static_cast<float>(action.total_cost),
+                static_cast<float>(action.risk_violation)};
+    }
+
+    static StudentParams default_student_params() {
+        StudentParams p{};
+        p.input_channels = 9;   // belief, semantic map and goal mask
+        p.hidden_dim = 64;
+        p.num_layers = 3;
+        p.num_heads = 4;
+        p.trajectory_horizon = 16;
+        p.cvar_percentile = 0.95;
+        p.risk_threshold = 0.1;
+        return p;
+    }
+
+    static SchedulerParams default_scheduler_params() {
+        SchedulerParams p{};
+        p.belief_dim = 64;
+        p.hidden_dim = 64;
+        p.num_layers = 3;
+        p.temperature = 0.2;
+        p.tau = 0.005;
+        p.discount_factor = 0.99;
+        p.batch_size = 32;
+        p.buffer_size = 32;
+        p.risk_threshold = 0.2;
+        p.violation_rate = 0.05;
+        p.lambda_init = 0.5;
+        p.lambda_max = 10.0;
+        p.energy_weight = 0.3;
+        p.safety_weight = 0.7;
+        p.power_budget = 1e9;
+        p.power_coefficients.assign(SensorConfig::POWER_CONSUMPTION.begin(), SensorConfig::POWER_CONSUMPTION.end());
+        p.device = "cpu";
+        p.num_threads = 1;
+        return p;
+    }
+};
+
+std::string mask_string(uint32_t mask) {
+    std::string s;
+    for (int i = 0; i < kNumSensors; ++i) s += (mask >> i) & 1u ? '1' : '0';
+    return s;
+}
+
+void write_decisions(FILE* out, const ReplayLog& log, size_t begin, const std::vector<Decision>& decisions) {
+    std::fprintf(out, "frame\ttimestamp_ns\tlogged_mask\tmask\tcvar_95\ttotal_power\ttotal_cost\trisk_violation\n");
+    for (size_t k = 0; k < decisions.size(); ++k) {
+        const Decision& d = decisions[k];
+        std::fprintf(out, "%zu\t%lld\t%s\t%s\t%.6f\t%.6f\t%.6f\t%.6f\n", begin + k,
+                     static_cast<long long>(log[begin + k].header->timestamp_ns),
+                     mask_string(d.logged_mask).c_str(), mask_string(d.mask).c_str(),
+                     d.cvar_95, d.total_power, d.total_cost, d.risk_violation);
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <log.bin> [options]\n"
+                  << "  --out <decisions.tsv>     Write decisions here instead of stdout\n"
+                  << "  --config <config.yaml>    Planner and scheduler parameters\n"
+                  << "  --planner-model <path>    StudentPlanner weights\n"
+                  << "  --scheduler-model <path>  SACScheduler weights\n"
+                  << "  --policy <path>           Packed policy, runs the scheduler inference-only\n"
+                  << "  --mask-search             Plan-and-pick scheduling instead of sampling the actor\n"
+                  << "  --threads N               Worker threads (default: all cores)\n"
+                  << "  --seed N                  Base seed (default 0)\n"
+                  << "  --begin N / --end N       Replay frames [begin, end)\n";
+        return 1;
+    }
+
+    try {
+        ReplayOptions options;
+        options.log_path = argv[1];
+        for (int i = 2; i < argc; ++i) {
+            std::string arg = argv[i];
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc) throw std::invalid_argument("Missing value for " + arg);
+                return argv[++i];
+            };
+            if (arg == "--out") options.out_path = value();
+            else if (arg == "--config") options.config_path = value();
+            else if (arg == "--planner-model") options.planner_model = value();
+            else if (arg == "--scheduler-model") options.scheduler_model = value();
+            else if (arg == "--policy") options.policy_path = value();
+            else if (arg == "--mask-search") options.mask_search = true;
+            else if (arg == "--threads") options.threads = std::max(1, std::stoi(value()));
+            else if (arg == "--seed") options.seed = std::stoull(value());
+            else if (arg == "--begin") options.begin = std::stoull(value());
+            else if (arg == "--end") options.end = std::stoull(value());
+            else throw std::invalid_argument("Unknown option: " + arg);
+        }
+
+        // Parallelism comes from the workers; a single intra-op thread also
+        // keeps floating-point reductions in a fixed order.
+        torch::set_num_threads(1);
+
+        ReplayLog log(options.log_path);
+        const size_t end = std::min(options.end, log.size());
+        const size_t begin = std::min(options.begin, end);
+        BCOD_INFO("Replaying frames [", begin, ", ", end, ") of ", options.log_path,
+                  " on ", options.threads, " thread(s)");
+
+        ReplayEngine engine(log, options);
+        const auto start = std::chrono::steady_clock::now();
+        const std::vector<Decision> decisions = engine.run(begin, end);
+        const double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        FILE* out = options.out_path.empty() ? stdout : std::fopen(options.out_path.c_str(), "w");
+        if (!out) throw std::runtime_error("Failed to open output: " + options.out_path);
+        write_decisions(out, log, begin, decisions);
+        if (out != stdout) std::fclose(out);
+
+        size_t agree = 0;
+        for (const auto& d : decisions) agree += d.mask == d.logged_mask ? 1 : 0;
+        const double span_s = end - begin > 1
+            ? (log[end - 1].header->timestamp_ns - log[begin].header->timestamp_ns) * 1e-9 : 0.0;
+        BCOD_INFO("Replayed ", decisions.size(), " frames in ", wall_s, " s (",
+                  decisions.size() / std::max(wall_s, 1e-9), " frames/s, ",
+                  span_s / std::max(wall_s, 1e-9), "x real time), ",
+                  decisions.empty() ? 0.0 : 100.0 * agree / decisions.size(), "% masks match the log");
+    } catch (const std::exception& e) {
+        BCOD_FATAL("Fatal error: ", e.what());
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,50 @@
+#include "bcod/map_store.hpp"
+#include "bcod/logging.hpp"
+#include <opencv2/imgcodecs.hpp>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace bcod;
+
+// Converts a semantic map image into the tiled store StudentPlanner crops
+// from. Image row 0 is taken to lie at the origin's y.
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <map_image> <out_store> [--resolution M] [--origin X Y] [--tile N]"
+                  << std::endl;
+        return 1;
+    }
+
+    try {
+        double resolution = 0.1;
+        Eigen::Vector2d origin = Eigen::Vector2d::Zero();
+        int tile = 256;
+        for (int i = 3; i < argc; ++i) {
+            const std::string arg = argv[i];
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc) throw std::invalid_argument("Missing value for " + arg);
+                return argv[++i];
+            };
+            if (arg == "--resolution") resolution = std::stod(value());
+            else if (arg == "--origin") {
+                origin.x() = std::stod(value());
+                origin.y() = std::stod(value());
+            } else if (arg == "--tile") tile = std::stoi(value());
+            else throw std::invalid_argument("Unknown option: " + arg);
+        }
+
+        const cv::Mat image = cv::imread(argv[1], cv::IMREAD_COLOR);
+        if (image.empty()) throw std::runtime_error(std::string("Failed to read map image: ") + argv[1]);
+        MapStore::build(image, resolution, origin, argv[2], tile);
+
+        MapStore store(argv[2]);
+        BCOD_INFO("Wrote ", store.width(), "x", store.height(), " map with ", store.levels(), " levels of ",
+                  store.tile_size(), " px tiles to ", argv[2]);
+    } catch (const std::exception& e) {
+        BCOD_FATAL("Fatal error: ", e.what());
+        return 1;
+    }
+
+    return 0;
+}
@@ -1,129 +1,109 @@
-#include "bcod/student_planner.hpp"
-#include "bcod/json_config.hpp"
+#include "bcod/risk_log.hpp"
 #include "bcod/logging.hpp"
 #include <opencv2/opencv.hpp>
-#include <fstream>
-#include <vector>
 #include <algorithm>
-#include <numeric>
-#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
 
 using namespace bcod;
 
-struct RiskData {
-    double predicted_risk;
-    double actual_error;
-};
+// One-pass analyser for risk logs (see bcod/risk_log.hpp for the format and
+// the accumulators): logs the error summary, draws the predicted-risk
+// histogram and optionally writes the calibration curve.
 
-class RiskAnalyzer {
-public:
-    RiskAnalyzer(const std::string& log_path) {
-        std::ifstream file(log_path);
-        if (!file) {
-            throw std::runtime_error("Failed to open log file");
-        }
-        
-        std::string line;
-        while (std::getline(file, line)) {
-            std::istringstream iss(line);
-            RiskData data;
-            iss >> data.predicted_risk >> data.actual_error;
-            data_.push_back(data);
-        }
-    }
-    
-    void compute_statistics() {
-        std::vector<double> errors;
-        for (const auto& data : data_) {
-            errors.push_back(std::abs(data.predicted_risk - data.actual_error));
-        }
-        
-        std::sort(errors.begin(), errors.end());
-        
-        mean_error_ = std::accumulate(errors.begin(), errors.end(), 0.0) / 
-                     errors.size();
-                     
-        median_error_ = errors[errors.size() / 2];
-        
-        double sum_sq = 0.0;
-        for (double e : errors) {
-            sum_sq += (e - mean_error_) * (e - mean_error_);
-        }
-        std_error_ = std::sqrt(sum_sq / errors.size());
-        
-        max_error_ = errors.back();
+void generate_histogram(const RiskAccumulator& totals, const std::string& output_path) {
+    const LogBins& risk = totals.risk;
+    const int num_bins = risk.overflow() - 1;
+    const int width = 800;
+    const int bar = std::max(1, width / num_bins);
+    uint64_t max_count = 1;
+    for (int i = 1; i <= num_bins; ++i) max_count = std::max(max_count, totals.risk_bins[i].count);
+
+    cv::Mat vis(400, width, CV_8UC3, cv::Scalar(255, 255, 255));
+    for (int i = 1; i <= num_bins; ++i) {
+        const int height = static_cast<int>(totals.risk_bins[i].count * 350.0 / max_count);
+        if (height == 0) continue;
+        cv::rectangle(vis,
+                      cv::Point((i - 1) * bar, 399),
+                      cv::Point(i * bar - 1, 399 - height),
+                      cv::Scalar(0, 0, 255),
+                      -1);
     }
-    
-    void generate_histogram(const std::string& output_path) {
-        const int num_bins = 50;
-        std::vector<int> histogram(num_bins, 0);
-        
-        double min_risk = std::numeric_limits<double>::max();
-        double max_risk = std::numeric_limits<double>::lowest();
-        
-        for (const auto& data : data_) {
-            min_risk = std::min(min_risk, data.predicted_risk);
-            max_risk = std::max(max_risk, data.predicted_risk);
-        }
-        
-        double bin_width = (max_risk - min_risk) / num_bins;
-        
-        for (const auto& data : data_) {
-            int bin = static_cast<int>((data.predicted_risk - min_risk) / 
-                                     bin_width);
-            if (bin >= 0 && bin < num_bins) {
-                histogram[bin]++;
-            }
-        }
-        
-        int max_count = *std::max_element(histogram.begin(), histogram.end());
-        
-        cv::Mat vis(400, 800, CV_8UC3, cv::Scalar(255, 255, 255));
-        
-        for (int i = 0; i < num_bins; ++i) {
-            int height = static_cast<int>(histogram[i] * 350.0 / max_count);
-            cv::rectangle(vis,
-                         cv::Point(i * 16, 399),
-                         cv::Point((i + 1) * 16 - 1, 399 - height),
-                         cv::Scalar(0, 0, 255),
-                         -1);
-        }
-        
-        std::string stats = "Mean: " + std::to_string(mean_error_) + 
-                          "  Median: " + std::to_string(median_error_) +
-                          "  Std: " + std::to_string(std_error_) +
-                          "  Max: " + std::to_string(max_error_);
-                          
-        cv::putText(vis, stats, cv::Point(10, 30),
-                   cv::FONT_HERSHEY_SIMPLEX, 0.7, cv::Scalar(0, 0, 0), 2);
-                   
-        cv::imwrite(output_path, vis);
+
+    const std::string stats = "Mean: " + std::to_string(totals.error.mean) +
+                              "  Median: " + std::to_string(totals.error_quantile(0.5)) +
+                              "  Std: " + std::to_string(totals.error.stddev()) +
+                              "  Max: " + std::to_string(totals.error.max);
+    cv::putText(vis, stats, cv::Point(10, 30),
+                cv::FONT_HERSHEY_SIMPLEX, 0.7, cv::Scalar(0, 0, 0), 2);
+
+    std::ostringstream range;
+    range << std::setprecision(3) << "Predicted risk " << risk.edge(1) << " .. "
+          << risk.edge(num_bins + 1) << " (log)  below: " << totals.risk_bins[risk.underflow()].count
+          << "  above: " << totals.risk_bins[risk.overflow()].count;
+    cv::putText(vis, range.str(), cv::Point(10, 60),
+                cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(0, 0, 0), 1);
+
+    if (!cv::imwrite(output_path, vis)) {
+        throw std::runtime_error("Failed to write histogram image: " + output_path);
     }
-    
-private:
-    std::vector<RiskData> data_;
-    double mean_error_;
-    double median_error_;
-    double std_error_;
-    double max_error_;
-};
+}
 
 int main(int argc, char** argv) {
-    if (argc != 3) {
-        std::cerr << "Usage: " << argv[0] << " <log_file> <output_image>" 
-                  << std::endl;
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <log_file> <output_image> [options]\n"
+                  << "  --threads N            Parser threads (default: hardware concurrency)\n"
+                  << "  --calibration FILE     Write the calibration curve as TSV\n"
+                  << "  --range LO HI          Predicted-risk histogram range (default: 1e-4 10)\n"
+                  << "  --bins N               Histogram bins (default: 50)" << std::endl;
         return 1;
     }
-    
+
     try {
-        RiskAnalyzer analyzer(argv[1]);
-        analyzer.compute_statistics();
-        analyzer.generate_histogram(argv[2]);
-        
+        int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        std::string calibration_path;
+        double min_risk = 1e-4, max_risk = 10.0;
+        int bins = 50;
+
+        for (int i = 3; i < argc; ++i) {
+            const std::string arg = argv[i];
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc) throw std::invalid_argument("Missing value for " + arg);
+                return argv[++i];
+            };
+            if (arg == "--threads") threads = std::max(1, std::stoi(value()));
+            else if (arg == "--calibration") calibration_path = value();
+            else if (arg == "--range") {
+                min_risk = std::stod(value());
+                max_risk = std::stod(value());
+            } else if (arg == "--bins") bins = std::stoi(value());
+            else throw std::invalid_argument("Unknown option: " + arg);
+        }
+        if (!(min_risk > 0.0 && max_risk > min_risk)) {
+            throw std::invalid_argument("--range needs 0 < LO < HI");
+        }
+        if (bins < 1) throw std::invalid_argument("--bins must be positive");
+
+        RiskAnalyzer analyzer(argv[1], min_risk, max_risk, bins);
+        analyzer.analyze(threads);
+        analyzer.log_summary();
+        generate_histogram(analyzer.totals(), argv[2]);
+        if (!calibration_path.empty()) {
+            std::ofstream out(calibration_path);
+            if (!out) throw std::runtime_error("Failed to open calibration output: " + calibration_path);
+            analyzer.totals().write_calibration(out);
+        }
+
     } catch (const std::exception& e) {
         BCOD_FATAL("Fatal error: ", e.what());
         return 1;
     }
-    
+
     return 0;
-} 
\ No newline at end of file
+}
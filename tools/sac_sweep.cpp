@@ -0,0 +1,111 @@
+#include "bcod/sac_sweep.hpp"
+#include "bcod/config_loader.hpp"
+#include "bcod/logging.hpp"
+#include <torch/torch.h>
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace bcod;
+
+std::vector<double> parse_values(const std::string& csv) {
+    std::vector<double> values;
+    std::stringstream ss(csv);
+    std::string item;
+    while (std::getline(ss, item, ',')) values.push_back(std::stod(item));
+    return values;
+}
+
+void print_table(std::ostream& out, const std::vector<SweepResult>& results) {
+    std::vector<SweepResult> sorted = results;
+    std::sort(sorted.begin(), sorted.end(), [](const SweepResult& a, const SweepResult& b) {
+        return a.mean_power < b.mean_power;
+    });
+    out << std::fixed << std::setprecision(4);
+    for (const auto& [name, v] : sorted.front().point) out << name << "\t";
+    out << "mean_power_w\tviolation_rate\tcvar95_risk\tpareto\n";
+    for (const auto& r : sorted) {
+        for (const auto& [name, v] : r.point) out << v << "\t";
+        out << r.mean_power << "\t" << r.violation_rate << "\t" << r.cvar95_risk << "\t"
+            << (r.pareto ? "*" : "") << "\n";
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <dataset> [options]\n"
+                  << "  --simulate <env.yaml>   Generate <dataset> from the simulator first (YAML or JSON)\n"
+                  << "  --sim-steps N           Simulator steps per environment (default 200)\n"
+                  << "  --sim-envs N            Parallel simulated lakes (default 16)\n"
+                  << "  --grid name=v1,v2,...   Sweep axis (risk_threshold, violation_rate, lambda_*,\n"
+                  << "                          energy_weight, safety_weight); repeatable\n"
+                  << "  --train-steps N         Updates per run (default 2000)\n"
+                  << "  --eval N                Evaluation records per run (default 1000)\n"
+                  << "  --workers N             Concurrent runs, one pinned core each; 1 is reproducible\n"
+                  << "  --seed N                Base seed (default 0)\n"
+                  << "  --out <table.tsv>       Also write the Pareto table to a file\n";
+        return 1;
+    }
+
+    try {
+        std::string dataset = argv[1], env_path, out_path;
+        int sim_steps = 200, sim_envs = 16, train_steps = 2000, eval = 1000;
+        int workers = static_cast<int>(std::thread::hardware_concurrency());
+        uint64_t seed = 0;
+        std::vector<std::pair<std::string, std::vector<double>>> axes;
+        for (int i = 2; i < argc; ++i) {
+            std::string arg = argv[i];
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc) throw std::invalid_argument("Missing value for " + arg);
+                return argv[++i];
+            };
+            if (arg == "--simulate") env_path = value();
+            else if (arg == "--sim-steps") sim_steps = std::stoi(value());
+            else if (arg == "--sim-envs") sim_envs = std::stoi(value());
+            else if (arg == "--train-steps") train_steps = std::stoi(value());
+            else if (arg == "--eval") eval = std::stoi(value());
+            else if (arg == "--workers") workers = std::stoi(value());
+            else if (arg == "--seed") seed = std::stoull(value());
+            else if (arg == "--out") out_path = value();
+            else if (arg == "--grid") {
+                std::string spec = value();
+                auto eq = spec.find('=');
+                if (eq == std::string::npos) throw std::invalid_argument("Bad --grid spec: " + spec);
+                axes.emplace_back(spec.substr(0, eq), parse_values(spec.substr(eq + 1)));
+            } else {
+                throw std::invalid_argument("Unknown option: " + arg);
+            }
+        }
+
+        // Each run owns one core; libtorch's intra-op pool would otherwise
+        // oversubscribe the machine num_workers times over.
+        torch::set_num_threads(1);
+
+        if (!env_path.empty()) {
+            const nlohmann::json env = load_config_document(env_path);
+            simulate_sweep_dataset(env.contains("environment") ? env.at("environment") : env, dataset, sim_steps,
+                                   sim_envs, seed);
+        }
+        SweepDataset data(dataset);
+        BCOD_INFO("Loaded ", data.size(), " transitions from ", dataset);
+
+        SweepRunner runner(data, train_steps, eval, seed);
+        for (const auto& [name, values] : axes) runner.add_axis(name, values);
+        auto results = runner.run(std::max(1, workers));
+
+        print_table(std::cout, results);
+        if (!out_path.empty()) {
+            std::ofstream out(out_path);
+            print_table(out, results);
+        }
+    } catch (const std::exception& e) {
+        BCOD_FATAL("Fatal error: ", e.what());
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,164 @@
+#include "bcod/plan_server.hpp"
+#include "bcod/belief_rasteriser.hpp"
+#include "bcod/student_planner.hpp"
+#include "bcod/sac_scheduler.hpp"
+#include "bcod/config_loader.hpp"
+#include "bcod/config_snapshot.hpp"
+#include "bcod/map_store.hpp"
+#include "bcod/sensor_defs.hpp"
+#include "bcod/logging.hpp"
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+using namespace bcod;
+
+// Serves plan and schedule requests of other processes (simulators, the
+// flight stack, evaluation scripts) from one set of models, batching
+// requests that arrive close together. Runs until SIGINT or SIGTERM and
+// then reports how long requests queued against how long batches took.
+
+namespace {
+    volatile std::sig_atomic_t g_stop = 0;
+
+    void handle_signal(int) {
+        g_stop = 1;
+    }
+
+    BeliefRasteriser::Params rasteriser_params() {
+        BeliefRasteriser::Params p{};
+        p.raster_H = 64;
+        p.raster_W = 64;
+        p.raster_C = 5;
+        p.min_window = 2.0;
+        p.max_window = 50.0;
+        p.sigma_scale = 6.0;
+        p.normalize = false;
+        return p;
+    }
+
+    StudentParams default_student_params() {
+        StudentParams p{};
+        p.input_channels = 9;   // belief, semantic map and goal mask
+        p.hidden_dim = 64;
+        p.num_layers = 3;
+        p.num_heads = 4;
+        p.trajectory_horizon = 16;
+        p.cvar_percentile = 0.95;
+        p.risk_threshold = 0.1;
+        return p;
+    }
+
+    SchedulerParams default_scheduler_params() {
+        SchedulerParams p{};
+        p.belief_dim = 64;
+        p.hidden_dim = 64;
+        p.num_layers = 3;
+        p.temperature = 0.2;
+        p.tau = 0.005;
+        p.discount_factor = 0.99;
+        p.batch_size = 32;
+        p.buffer_size = 32;
+        p.risk_threshold = 0.2;
+        p.violation_rate = 0.05;
+        p.lambda_init = 0.5;
+        p.lambda_max = 10.0;
+        p.energy_weight = 0.3;
+        p.safety_weight = 0.7;
+        p.power_budget = 1e9;
+        p.power_coefficients.assign(SensorConfig::POWER_CONSUMPTION.begin(), SensorConfig::POWER_CONSUMPTION.end());
+        p.device = "cpu";
+        p.num_threads = 1;
+        return p;
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <socket_path> [options]\n"
+                  << "  --config <config.yaml>    Planner and scheduler parameters\n"
+                  << "  --planner-model <path>    StudentPlanner weights\n"
+                  << "  --scheduler-model <path>  SACScheduler weights\n"
+                  << "  --policy <path>           Packed policy, runs the scheduler inference-only\n"
+                  << "  --map <store>             Tiled semantic map (bcod_map_pack) to crop from\n"
+                  << "  --window-us N             Batch requests arriving within N us (default 500)\n"
+                  << "  --max-batch N             Largest batch (default 32)\n"
+                  << "  --max-particles N         Reject larger frames (default 65536)\n";
+        return 1;
+    }
+
+    try {
+        PlanServer::Params server{};
+        server.socket_path = argv[1];
+        server.batch_window_us = 500;
+        server.max_batch = 32;
+        server.max_particles = 65536;
+        server.max_velocity = 2.0;
+        server.max_angular_velocity = 1.0;
+
+        std::string config_path, planner_model, scheduler_model, policy_path, map_path;
+        for (int i = 2; i < argc; ++i) {
+            std::string arg = argv[i];
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc) throw std::invalid_argument("Missing value for " + arg);
+                return argv[++i];
+            };
+            if (arg == "--config") config_path = value();
+            else if (arg == "--planner-model") planner_model = value();
+            else if (arg == "--scheduler-model") scheduler_model = value();
+            else if (arg == "--policy") policy_path = value();
+            else if (arg == "--map") map_path = value();
+            else if (arg == "--window-us") server.batch_window_us = std::stoi(value());
+            else if (arg == "--max-batch") server.max_batch = std::stoi(value());
+            else if (arg == "--max-particles") server.max_particles = static_cast<uint32_t>(std::stoul(value()));
+            else throw std::invalid_argument("Unknown option: " + arg);
+        }
+
+        StudentParams student = default_student_params();
+        SchedulerParams scheduler_params = default_scheduler_params();
+        if (!config_path.empty()) {
+            auto snapshot = compile_config(load_config(config_path).config);
+            Instrumentation::instance().configure(snapshot->profiling);
+            student = snapshot->student;
+            scheduler_params = snapshot->scheduler;
+        }
+        if (!policy_path.empty()) {
+            scheduler_params.inference_only = true;
+            scheduler_params.policy_path = policy_path;
+        }
+        server.waypoint_interval = student.waypoint_interval > 0.0 ? student.waypoint_interval : 0.5;
+
+        BeliefRasteriser rasteriser(rasteriser_params());
+        StudentPlanner planner(student);
+        SACScheduler scheduler(scheduler_params);
+        if (!planner_model.empty()) planner.load_model(planner_model);
+        if (!scheduler_model.empty()) scheduler.load_model(scheduler_model);
+        if (!map_path.empty()) planner.set_map_store(std::make_shared<const MapStore>(map_path));
+
+        std::signal(SIGINT, handle_signal);
+        std::signal(SIGTERM, handle_signal);
+
+        PlanServer plan_server(rasteriser, planner, scheduler, server);
+        plan_server.start();
+        while (!g_stop && plan_server.running()) std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        plan_server.stop();
+
+        const PlanServer::Stats stats = plan_server.stats();
+        const LatencyHistogram& queue = plan_server.queue_latency();
+        const LatencyHistogram& compute = plan_server.compute_latency();
+        BCOD_INFO("Served ", stats.requests, " requests in ", stats.batches, " batches (",
+                  stats.batches ? static_cast<double>(stats.requests) / stats.batches : 0.0, " per batch) on ",
+                  stats.connections, " connection(s), rejected ", stats.rejected);
+        BCOD_INFO("Queue p50 ", queue.percentile(0.5), " ms, p99 ", queue.percentile(0.99),
+                  " ms; compute p50 ", compute.percentile(0.5), " ms, p99 ", compute.percentile(0.99), " ms");
+    } catch (const std::exception& e) {
+        BCOD_FATAL("Fatal error: ", e.what());
+        return 1;
+    }
+
+    return 0;
+}
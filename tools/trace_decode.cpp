@@ -0,0 +1,107 @@
+#include "bcod/trace.hpp"
+#include "bcod/mapped_file.hpp"
+#include "bcod/logging.hpp"
+#include "bcod/sensor_defs.hpp"
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace bcod;
+
+// Prints a binary trace as TSV. With --event only that event type is printed,
+// one column per field; otherwise every record is printed as name=value pairs.
+class TraceDecoder {
+public:
+    explicit TraceDecoder(const std::string& path) : file_(path) {
+        if (file_.size() < sizeof(TraceFileHeader)) {
+            throw std::runtime_error("Trace file too short: " + path);
+        }
+        TraceFileHeader header;
+        std::memcpy(&header, file_.data(), sizeof(header));
+        if (std::memcmp(header.magic, TraceFileHeader::MAGIC, sizeof(header.magic)) != 0) {
+            throw std::runtime_error("Not a trace file: " + path);
+        }
+        if (header.version != TraceFileHeader::VERSION || header.record_size != sizeof(TraceRecord)) {
+            throw std::runtime_error("Unsupported trace version in " + path);
+        }
+        count_ = (file_.size() - sizeof(header)) / sizeof(TraceRecord);
+        if ((file_.size() - sizeof(header)) % sizeof(TraceRecord) != 0) {
+            BCOD_WARN("Ignoring truncated trailing record in ", path);
+        }
+    }
+
+    void print_table(std::ostream& out, TraceEvent event) const {
+        const auto& fields = trace_fields(event);
+        out << "wall_ns\tmask";
+        for (const char* field : fields) out << '\t' << field;
+        out << '\n';
+
+        for (size_t i = 0; i < count_; ++i) {
+            TraceRecord r = record(i);
+            if (r.event != static_cast<uint32_t>(event)) continue;
+            out << r.wall_ns << '\t' << mask_string(r.mask);
+            for (size_t f = 0; f < fields.size(); ++f) out << '\t' << r.values[f];
+            out << '\n';
+        }
+    }
+
+    void print_all(std::ostream& out) const {
+        for (size_t i = 0; i < count_; ++i) {
+            TraceRecord r = record(i);
+            const auto event = static_cast<TraceEvent>(r.event);
+            const auto& fields = trace_fields(event);
+            out << r.wall_ns << '\t' << trace_event_name(event) << "\tmask=" << mask_string(r.mask);
+            for (size_t f = 0; f < fields.size(); ++f) out << '\t' << fields[f] << '=' << r.values[f];
+            out << '\n';
+        }
+    }
+
+    size_t size() const { return count_; }
+
+private:
+    MappedFile file_;
+    size_t count_;
+
+    TraceRecord record(size_t i) const {
+        TraceRecord r;
+        std::memcpy(&r, file_.data() + sizeof(TraceFileHeader) + i * sizeof(TraceRecord), sizeof(r));
+        return r;
+    }
+
+    static std::string mask_string(uint32_t mask) {
+        std::string s;
+        for (int i = 0; i < kNumSensors; ++i) s += (mask >> i) & 1u ? '1' : '0';
+        return s;
+    }
+};
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <trace.bin> [--event plan|schedule|update]" << std::endl;
+        return 1;
+    }
+
+    try {
+        TraceDecoder decoder(argv[1]);
+        std::cout << std::setprecision(7);
+
+        if (argc >= 4 && std::string(argv[2]) == "--event") {
+            const std::string name = argv[3];
+            for (auto event : {TraceEvent::PLAN, TraceEvent::SCHEDULE, TraceEvent::UPDATE}) {
+                if (name == trace_event_name(event)) {
+                    decoder.print_table(std::cout, event);
+                    return 0;
+                }
+            }
+            throw std::invalid_argument("Unknown event: " + name);
+        }
+        decoder.print_all(std::cout);
+    } catch (const std::exception& e) {
+        BCOD_FATAL("Fatal error: ", e.what());
+        return 1;
+    }
+
+    return 0;
+}